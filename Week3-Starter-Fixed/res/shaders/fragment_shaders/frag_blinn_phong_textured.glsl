@@ -1,7 +1,17 @@
 #version 430
 
+// Optional features, defined by the program when it is compiled (see ShaderTemplate):
+//    DIFFUSE_ARRAY - The diffuse map is a layer in a texture array, selected by u_Material.DiffuseLayer
+//    SPECULAR_MAP  - Shininess and environment reflections come from u_Material.Specular
+//    NORMAL_MAP    - Normals come from the tangent space normal map in s_NormalMap
+//    TOON_SHADING  - The lit color is banded using the LUT in s_ToonTerm, skipping color correction
+
 #include "../fragments/fs_common_inputs.glsl"
 
+#ifdef NORMAL_MAP
+layout(location = 4) in mat3 inTBN;
+#endif
+
 // We output a single color to the color buffer
 layout(location = 0) out vec4 frag_color;
 
@@ -13,12 +23,35 @@ layout(location = 0) out vec4 frag_color;
 // For instance, you can think of this like material settings in 
 // Unity
 struct Material {
+#ifdef DIFFUSE_ARRAY
+	sampler2DArray Diffuse;
+#else
 	sampler2D Diffuse;
-	float     Shininess;
+#endif
+#ifdef SPECULAR_MAP
+	sampler2D Specular;
+#endif
 };
 // Create a uniform for the material
 uniform Material u_Material;
 
+layout (std140, binding = 3) uniform b_Material {
+	float     Shininess;
+#ifdef DIFFUSE_ARRAY
+	int       DiffuseLayer;
+#endif
+#ifdef TOON_SHADING
+	int       Steps;
+#endif
+} u_MaterialParams;
+
+#ifdef NORMAL_MAP
+uniform sampler2D s_NormalMap;
+#endif
+#ifdef TOON_SHADING
+uniform sampler1D s_ToonTerm;
+#endif
+
 ////////////////////////////////////////////////////////////////
 ///////////// Application Level Uniforms ///////////////////////
 ////////////////////////////////////////////////////////////////
@@ -34,17 +67,50 @@ uniform Material u_Material;
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
+#ifdef NORMAL_MAP
+	// Read our tangent from the map, and convert from the [0,1] range to [-1,1] range, then
+	// apply the TBN matrix to transform the normal from tangent space to world space
+	vec3 normal = texture(s_NormalMap, inUV).rgb * 2.0 - 1.0;
+	normal = normalize(inTBN * normal);
+#else
 	// Normalize our input normal
 	vec3 normal = normalize(inNormal);
+#endif
+
+#ifdef SPECULAR_MAP
+	float specPower = texture(u_Material.Specular, inUV).r;
+#else
+	float specPower = u_MaterialParams.Shininess;
+#endif
 
 	// Use the lighting calculation that we included from our partial file
-	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, u_Material.Shininess);
+	vec3 lightAccumulation = CalcAllLightContribution(inWorldPos, normal, u_CamPos.xyz, specPower);
 
 	// Get the albedo from the diffuse / albedo map
+#ifdef DIFFUSE_ARRAY
+	vec4 textureColor = texture(u_Material.Diffuse, vec3(inUV, u_MaterialParams.DiffuseLayer));
+#else
 	vec4 textureColor = texture(u_Material.Diffuse, inUV);
+#endif
 
 	// combine for the final result
 	vec3 result = lightAccumulation  * inColor * textureColor.rgb;
 
+#ifdef SPECULAR_MAP
+	// Shiny surfaces reflect more of the environment
+	vec3 toEye = normalize(u_CamPos.xyz - inWorldPos);
+	vec3 environmentDir = reflect(-toEye, normal);
+	result = mix(result, SampleEnvironmentMap(environmentDir), specPower);
+#endif
+
+#ifdef TOON_SHADING
+	// Using a LUT to allow artists to tweak toon shading settings
+	result.r = texture(s_ToonTerm, result.r).r;
+	result.g = texture(s_ToonTerm, result.g).g;
+	result.b = texture(s_ToonTerm, result.b).b;
+
+	frag_color = vec4(result, textureColor.a);
+#else
 	frag_color = vec4(ColorCorrect(result), textureColor.a);
+#endif
 }
\ No newline at end of file
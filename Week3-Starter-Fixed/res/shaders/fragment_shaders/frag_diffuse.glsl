@@ -9,13 +9,16 @@ layout(location = 0) out vec4 frag_color;
 
 struct Material {
 	sampler2D Diffuse;
-	float     Shininess;
-	float	  ambientstrength;
 };
 
 uniform vec3 lightPos;
 uniform Material u_Material;
 
+layout (std140, binding = 3) uniform b_Material {
+	float     Shininess;
+	float	  ambientstrength;
+} u_MaterialParams;
+
 #include "../fragments/multiple_point_lights.glsl"
 
 
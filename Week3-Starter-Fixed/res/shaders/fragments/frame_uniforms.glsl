@@ -16,7 +16,9 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     uniform uint  u_Flags;
 };
 
-// Stores uniforms that change every object/instance
+// Stores uniforms that change every object/instance. Instanced draws get these per instance instead (see
+// vs_common.glsl), std140 blocks are always active so we need to leave it out for the renderer to tell
+#ifndef INSTANCED
 layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     // Complete MVP
     uniform mat4 u_ModelViewProjection;
@@ -24,7 +26,11 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     uniform mat4 u_Model;
     // Normal Matrix for transforming normals
     uniform mat4 u_NormalMatrix;
+    // Takes the mesh's stored positions back into mesh space, as a scale and offset in xyz
+    uniform vec4 u_PositionScale;
+    uniform vec4 u_PositionOffset;
 };
+#endif
 
 #define FLAG_ENABLE_COLOR_CORRECTION (1 << 0)
 
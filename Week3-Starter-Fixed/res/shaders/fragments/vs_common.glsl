@@ -1,6 +1,8 @@
 
 // Vertex inputs
-layout(location = 0) in vec3 inPosition;
+// Quantized meshes store positions in [0, 1] across their bounds (see VertexPacking.h), so shaders
+// should read inPosition below, which is always back in mesh space
+layout(location = 0) in vec3 inStoredPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec2 inUV;
@@ -8,6 +10,17 @@ layout(location = 3) in vec2 inUV;
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBiTangent;
 
+#ifdef INSTANCED
+// Instanced draws get their transforms per instance, see RenderLayer::InstanceAttributes
+// Takes the instance's stored positions back into mesh space, as a scale and offset
+layout(location = 6) in vec3 inPositionScale;
+layout(location = 7) in vec3 inPositionOffset;
+// This will consume 4 slots, since it's essentially 4 vec4s in memory
+layout(location = 8) in mat4 inModelTransform;
+// This will consume 3 slots in memory
+layout(location = 12) in mat3 inNormalMatrix;
+#endif
+
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outColor;
@@ -17,3 +30,14 @@ layout(location = 4) out mat3 outTBN;
 
 // Include the matrices and frame level parameters
 #include "frame_uniforms.glsl"
+
+#ifdef INSTANCED
+// Point the per-object uniforms at the instance attributes, so any vertex shader built on these
+// commons can be drawn instanced without changes
+#define u_Model inModelTransform
+#define u_NormalMatrix mat4(inNormalMatrix)
+#define u_ModelViewProjection (u_ViewProjection * inModelTransform)
+#define inPosition (inStoredPosition * inPositionScale + inPositionOffset)
+#else
+#define inPosition (inStoredPosition * u_PositionScale.xyz + u_PositionOffset.xyz)
+#endif
@@ -12,20 +12,27 @@
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/Profiler.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
 #include "Graphics/Buffers/VertexBuffer.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/ShaderBinaryCache.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture2D.h"
 #include "Graphics/Textures/Texture3D.h"
+#include "Graphics/Textures/Texture2DArray.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "Graphics/VertexTypes.h"
 #include "Graphics/Font.h"
 #include "Graphics/GuiBatcher.h"
 #include "Graphics/Framebuffer.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/GlStateTracker.h"
+#include "Graphics/StreamingVertices.h"
+#include "Graphics/GpuMemoryTracker.h"
 
 // Gameplay
 #include "Gameplay/Material.h"
@@ -57,6 +64,7 @@
 #include "Layers/ImGuiDebugLayer.h"
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
+#include "Layers/ShaderReloadLayer.h"
 
 Application* Application::_singleton = nullptr;
 std::string Application::_applicationName = "INFR-2350U - DEMO";
@@ -111,6 +119,7 @@ void Application::Quit() {
 }
 
 bool Application::LoadScene(const std::string& path) {
+	PROFILE_FUNCTION();
 	if (std::filesystem::exists(path)) { 
 
 		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
@@ -144,6 +153,8 @@ void Application::SaveSettings()
 
 void Application::_Run()
 {
+	PROFILE_THREAD_NAME("Main");
+
 	// TODO: Register layers
 	_layers.push_back(std::make_shared<GLAppLayer>());
 	_layers.push_back(std::make_shared<DefaultSceneLayer>());
@@ -156,6 +167,7 @@ void Application::_Run()
 	// If we're in editor mode, we add all the editor layers
 	if (_isEditor) {
 		_layers.push_back(std::make_shared<ImGuiDebugLayer>());
+		_layers.push_back(std::make_shared<ShaderReloadLayer>());
 	}
 
 	// Either load the settings, or use the defaults
@@ -165,6 +177,10 @@ void Application::_Run()
 	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
 	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
 
+	// A budget of 0 disables the over budget warnings
+	uint32_t memoryBudgetMb = JsonGet(_appSettings, "gpu_memory_budget_mb", GpuMemoryTracker::DEFAULT_BUDGET_MB);
+	GpuMemoryTracker::SetBudget((size_t)memoryBudgetMb * 1024 * 1024);
+
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
 
@@ -175,6 +191,9 @@ void Application::_Run()
 	// Load all layers
 	_Load();
 
+	// Most of our shaders are created while loading, so this is a good time to see how the cache did
+	ShaderBinaryCache::LogStats();
+
 	// Grab current time as the previous frame
 	double lastFrame =  glfwGetTime();
 
@@ -183,13 +202,18 @@ void Application::_Run()
 
 	// Infinite loop as long as the application is running
 	while (_isRunning) {
+		PROFILE_FRAME_BEGIN();
+
 		// Handle scene switching
 		if (_targetScene != nullptr) {
 			_HandleSceneChange();
 		}
 
 		// Receive events like input and window position/size changes from GLFW
-		glfwPollEvents();
+		{
+			PROFILE_ZONE("glfwPollEvents");
+			glfwPollEvents();
+		}
 
 		// Handle closing the app via the close button
 		if (glfwWindowShouldClose(_window)) {
@@ -213,6 +237,8 @@ void Application::_Run()
 		timing._unscaledTimeSinceSceneLoad += dt;
 
 		ImGuiHelper::StartFrame();
+		GpuProfiler::BeginFrame();
+		StreamingVertices::BeginFrame();
 
 		// Core update loop
 		if (_currentScene != nullptr) {
@@ -227,9 +253,23 @@ void Application::_Run()
 		lastFrame = thisFrame;
 
 		InputEngine::EndFrame();
-		ImGuiHelper::EndFrame();
+		StreamingVertices::EndFrame();
+		GlStateTracker::EndFrame();
+		{
+			PROFILE_ZONE("ImGui");
+			GPU_PROFILE_SCOPE("ImGui");
+			ImGuiHelper::EndFrame();
+		}
+		// ImGui's renderer (and any extra viewport windows it draws) talks to GL directly
+		GlStateTracker::Invalidate();
+
+		GpuProfiler::EndFrame();
+		{
+			PROFILE_ZONE("glfwSwapBuffers");
+			glfwSwapBuffers(_window);
+		}
 
-		glfwSwapBuffers(_window);
+		PROFILE_FRAME_END();
 
 	}
 
@@ -249,6 +289,7 @@ void Application::_RegisterClasses()
 	ResourceManager::RegisterType<Texture1D>();
 	ResourceManager::RegisterType<Texture2D>();
 	ResourceManager::RegisterType<Texture3D>();
+	ResourceManager::RegisterType<Texture2DArray>();
 	ResourceManager::RegisterType<TextureCube>();
 	ResourceManager::RegisterType<ShaderProgram>();
 	ResourceManager::RegisterType<Material>();
@@ -273,11 +314,17 @@ void Application::_RegisterClasses()
 }
 
 void Application::_Load() {
+	PROFILE_FUNCTION();
+
+	// Shaders created while loading are compiled as a batch, and only checked once they're used
+	ShaderProgram::BeginCompileBatch();
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnAppLoad)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnAppLoad(_appSettings);
 		}
 	}
+	ShaderProgram::AwaitCompileBatch();
 
 	// Pass the window to the input engine and let it initialize itself
 	InputEngine::Init(_window);
@@ -289,8 +336,10 @@ void Application::_Load() {
 }
 
 void Application::_Update() {
+	PROFILE_FUNCTION();
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnUpdate)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnUpdate();
 		}
 	}
@@ -303,8 +352,10 @@ void Application::_Update() {
 }
 
 void Application::_LateUpdate() {
+	PROFILE_FUNCTION();
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnLateUpdate)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnLateUpdate();
 		}
 	}
@@ -312,9 +363,10 @@ void Application::_LateUpdate() {
 
 void Application::_PreRender()
 {
+	PROFILE_FUNCTION();
 	glm::ivec2 size ={ 0, 0 };
 	glfwGetWindowSize(_window, &size.x, &size.y);
-	glViewport(0, 0, size.x, size.y);
+	GlStateTracker::Viewport(0, 0, size.x, size.y);
 	glScissor(0, 0, size.x, size.y);
 
 	// Clear the screen
@@ -322,16 +374,20 @@ void Application::_PreRender()
 
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPreRender)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnPreRender();
 		}
 	}
 }
 
 void Application::_RenderScene() {
+	PROFILE_FUNCTION();
 
 	Framebuffer::Sptr result = nullptr;
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnRender)) {
+			PROFILE_ZONE(layer->Name.c_str());
+			GPU_PROFILE_SCOPE(layer->Name);
 			layer->OnRender(result);
 			Framebuffer::Sptr layerResult = layer->GetRenderOutput(); 
 			result = layerResult != nullptr ? layerResult : result;
@@ -342,10 +398,13 @@ void Application::_RenderScene() {
 }
 
 void Application::_PostRender() {
+	PROFILE_FUNCTION();
 	// Note that we use a reverse iterator for post render
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnPostRender)) {
+			PROFILE_ZONE(layer->Name.c_str());
+			GPU_PROFILE_SCOPE(layer->Name + " (Post)");
 			layer->OnPostRender();
 			Framebuffer::Sptr layerResult = layer->GetPostRenderOutput();
 			_renderOutput = layerResult != nullptr ? layerResult : _renderOutput;
@@ -354,7 +413,7 @@ void Application::_PostRender() {
 
 	// We can use the application's viewport to set our OpenGL viewport, as well as clip rendering to that area
 	const glm::uvec4& viewport = GetPrimaryViewport();
-	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	GlStateTracker::Viewport(viewport.x, viewport.y, viewport.z, viewport.w);
 	glScissor(viewport.x, viewport.y, viewport.z, viewport.w); 
 
 	// If we have a final output, blit it to the screen
@@ -369,31 +428,39 @@ void Application::_PostRender() {
 		glm::ivec4 viewportMinMax ={ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w };
 
 		_renderOutput->Bind(FramebufferBinding::Read);
-		glBindFramebuffer(*FramebufferBinding::Write, 0);
+		GlStateTracker::BindFramebuffer(*FramebufferBinding::Write, 0);
 		Framebuffer::Blit({ 0, 0, _renderOutput->GetWidth(), _renderOutput->GetHeight() }, viewportMinMax, BufferFlags::All, MagFilter::Nearest);
 	}
 }
 
 void Application::_Unload() {
+	PROFILE_FUNCTION();
 	// Note that we use a reverse iterator for unloading
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnAppUnload)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnAppUnload();
 		}
 	}
 
+	// Queries need to be deleted while we still have a context
+	GpuProfiler::Uninitialize();
+	StreamingVertices::Release();
+
 	// Clean up ImGui
 	ImGuiHelper::Cleanup();
 }
 
 void Application::_HandleSceneChange() {
+	PROFILE_FUNCTION();
 	// If we currently have a current scene, let the layers know it's being unloaded
 	if (_currentScene != nullptr) {
 		// Note that we use a reverse iterator, so that layers are unloaded in the opposite order that they were loaded
 		for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 			const auto& layer = *it;
 			if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnSceneUnload)) {
+				PROFILE_ZONE(layer->Name.c_str());
 				layer->OnSceneUnload();
 			}
 		}
@@ -404,6 +471,7 @@ void Application::_HandleSceneChange() {
 	// Let the layers know that we've loaded in a new scene
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnSceneLoad)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnSceneLoad();
 		}
 	}
@@ -422,6 +490,7 @@ void Application::_HandleSceneChange() {
 void Application::_HandleWindowSizeChanged(const glm::ivec2& newSize) {
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnWindowResize)) {
+			PROFILE_ZONE(layer->Name.c_str());
 			layer->OnWindowResize(_windowSize, newSize);
 		}
 	}
@@ -468,6 +537,7 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	result["gpu_memory_budget_mb"] = GpuMemoryTracker::DEFAULT_BUDGET_MB;
 	return result;
 }
 
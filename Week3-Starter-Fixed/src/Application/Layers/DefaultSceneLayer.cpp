@@ -31,6 +31,7 @@
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/StringUtils.h"
 #include "Utils/GlmDefines.h"
+#include "Utils/TextureArrayPacker.h"
 
 // Gameplay
 #include "Gameplay/Material.h"
@@ -72,7 +73,8 @@
 
 
 DefaultSceneLayer::DefaultSceneLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_blinnPhongTemplate(nullptr)
 {
 	Name = "Default Scene";
 	Overrides = AppLayerFunctions::OnAppLoad;
@@ -103,12 +105,18 @@ void DefaultSceneLayer::_CreateScene()
 		});
 		reflectiveShader->SetDebugName("Reflective");
 
-		// This shader handles our basic materials without reflections (cause they expensive)
-		ShaderProgram::Sptr basicShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		// Our blinn-phong shaders are all built from the same files, with features turned on by defines.
+		// Each combination of features is only compiled the first time we ask for it
+		_blinnPhongTemplate = std::make_shared<ShaderTemplate>("Blinn-phong", std::unordered_map<ShaderPartType, std::string>{
 			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
 			{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_blinn_phong_textured.glsl" }
-		});
-		basicShader->SetDebugName("Blinn-phong");
+		}, std::vector<std::string>{ "DIFFUSE_ARRAY", "SPECULAR_MAP", "NORMAL_MAP", "TOON_SHADING" });
+
+		// This shader handles our basic materials without reflections (cause they expensive)
+		ShaderProgram::Sptr basicShader = _blinnPhongTemplate->Get();
+
+		// Blinn-phong materials get switched to this once their textures are packed into arrays
+		ShaderProgram::Sptr basicArrayShader = _blinnPhongTemplate->Get({ "DIFFUSE_ARRAY" });
 
 		ShaderProgram::Sptr AShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
@@ -123,14 +131,8 @@ void DefaultSceneLayer::_CreateScene()
 		
 		DShader->SetDebugName("Diffuse"); 
 
-		// This shader handles our basic materials without reflections (cause they expensive)
-		ShaderProgram::Sptr specShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
-			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
-			{ ShaderPartType::Fragment, "shaders/fragment_shaders/textured_specular.glsl" }
-		});
-
-
-		specShader->SetDebugName("Textured-Specular");
+		// This shader handles materials with a specular map, which also controls environment reflections
+		ShaderProgram::Sptr specShader = _blinnPhongTemplate->Get({ "SPECULAR_MAP" });
 
 		// This shader handles our foliage vertex shader example
 		ShaderProgram::Sptr foliageShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
@@ -140,25 +142,16 @@ void DefaultSceneLayer::_CreateScene()
 		foliageShader->SetDebugName("Foliage");
 
 		// This shader handles our cel shading example
-		ShaderProgram::Sptr toonShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
-			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
-			{ ShaderPartType::Fragment, "shaders/fragment_shaders/toon_shading.glsl" }
-		});
-		toonShader->SetDebugName("Toon Shader");
+		ShaderProgram::Sptr toonShader = _blinnPhongTemplate->Get({ "TOON_SHADING" });
 
-		// This shader handles our displacement mapping example
+		// This shader handles our displacement mapping example, it has it's own vertex shader so it can't come from the template
 		ShaderProgram::Sptr displacementShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 			{ ShaderPartType::Vertex, "shaders/vertex_shaders/displacement_mapping.glsl" },
-			{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_tangentspace_normal_maps.glsl" }
-		});
+			{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_blinn_phong_textured.glsl" }
+		}, std::map<std::string, std::string>{ { "NORMAL_MAP", "1" } });
 		displacementShader->SetDebugName("Displacement Mapping");
 
-		// This shader handles our tangent space normal mapping
-		ShaderProgram::Sptr tangentSpaceMapping = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
-			{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
-			{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_tangentspace_normal_maps.glsl" }
-		});
-		tangentSpaceMapping->SetDebugName("Tangent Space Mapping");
+		// Tangent space normal mapping comes from the template's NORMAL_MAP feature, and is compiled once a material asks for it
 
 		// This shader handles our multitexturing example
 		ShaderProgram::Sptr multiTextureShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
@@ -167,19 +160,19 @@ void DefaultSceneLayer::_CreateScene()
 		});
 		multiTextureShader->SetDebugName("Multitexturing");
 
-		// Load in the meshes
-		MeshResource::Sptr monkeyMesh = ResourceManager::CreateAsset<MeshResource>("Monkey.obj");
+		// Load in the meshes, with packed normals and UVs and quantized positions to about halve their size
+		MeshResource::Sptr monkeyMesh = ResourceManager::CreateAsset<MeshResource>("Monkey.obj", VertexPacking::Quantized);
 		
 		//Objects for my scene
 		//Used in GDW Game
-		MeshResource::Sptr CharacterMesh = ResourceManager::CreateAsset<MeshResource>("CharacterFinal.obj");
-		MeshResource::Sptr magemesh = ResourceManager::CreateAsset<MeshResource>("MageEnemy.obj");
-		MeshResource::Sptr wallMesh = ResourceManager::CreateAsset<MeshResource>("Wall.obj");
-		MeshResource::Sptr WallGrateMesh = ResourceManager::CreateAsset<MeshResource>("WallGrate.obj");
-		MeshResource::Sptr SwordMesh = ResourceManager::CreateAsset<MeshResource>("Sword.obj");
-		MeshResource::Sptr RockMesh = ResourceManager::CreateAsset<MeshResource>("Rock.obj");
-		MeshResource::Sptr spikeMesh = ResourceManager::CreateAsset<MeshResource>("SpikeTrap.obj");
-		MeshResource::Sptr LeverMesh = ResourceManager::CreateAsset<MeshResource>("Lever.obj");
+		MeshResource::Sptr CharacterMesh = ResourceManager::CreateAsset<MeshResource>("CharacterFinal.obj", VertexPacking::Quantized);
+		MeshResource::Sptr magemesh = ResourceManager::CreateAsset<MeshResource>("MageEnemy.obj", VertexPacking::Quantized);
+		MeshResource::Sptr wallMesh = ResourceManager::CreateAsset<MeshResource>("Wall.obj", VertexPacking::Quantized);
+		MeshResource::Sptr WallGrateMesh = ResourceManager::CreateAsset<MeshResource>("WallGrate.obj", VertexPacking::Quantized);
+		MeshResource::Sptr SwordMesh = ResourceManager::CreateAsset<MeshResource>("Sword.obj", VertexPacking::Quantized);
+		MeshResource::Sptr RockMesh = ResourceManager::CreateAsset<MeshResource>("Rock.obj", VertexPacking::Quantized);
+		MeshResource::Sptr spikeMesh = ResourceManager::CreateAsset<MeshResource>("SpikeTrap.obj", VertexPacking::Quantized);
+		MeshResource::Sptr LeverMesh = ResourceManager::CreateAsset<MeshResource>("Lever.obj", VertexPacking::Quantized);
 
 
 		//Textures for my scene
@@ -296,6 +289,16 @@ void DefaultSceneLayer::_CreateScene()
 			rockMat->Set("u_Material.Steps", 8);
 		}
 
+		// Pack the textures of materials that share a shader into arrays, so those materials
+		// bind the same texture and only differ by their parameters
+		TextureArrayPacker packer;
+		packer.AddShaderVariant(basicShader, basicArrayShader);
+		for (const Material::Sptr& material : { stoneMat, characterMat, wallMat, swordMat }) {
+			packer.AddMaterial(material);
+		}
+		int packedMaterials = packer.Pack();
+		LOG_INFO("Moved {} materials over to texture arrays", packedMaterials);
+
 		// Create some lights for our scene
 		scene->Lights.resize(3);
 		scene->Lights[0].Position = glm::vec3(0.0f, 1.0f, 3.0f);
@@ -1,6 +1,7 @@
 #pragma once
 #include "Application/ApplicationLayer.h"
 #include "json.hpp"
+#include "Graphics/ShaderTemplate.h"
 
 /**
  * This example layer handles creating a default test scene, which we will use 
@@ -17,6 +18,13 @@ public:
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
 
+	/// <summary>
+	/// Gets the template for our blinn-phong shaders, so that other variants can be requested as they're needed
+	/// </summary>
+	const ShaderTemplate::Sptr& GetBlinnPhongTemplate() const { return _blinnPhongTemplate; }
+
 protected:
+	ShaderTemplate::Sptr _blinnPhongTemplate;
+
 	void _CreateScene();
 };
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include "GLFW/glfw3.h"
 #include "Logging.h"
 #include "Application/Application.h"
+#include "Graphics/ShaderBinaryCache.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/GlStateTracker.h"
+#include "Utils/JsonGlmHelpers.h"
 
 GLAppLayer::GLAppLayer() :
 	ApplicationLayer() {
@@ -26,7 +30,42 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 
 	LOG_ASSERT(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0, "Failed to initialize glad");
 
-	glEnable(GL_PROGRAM_POINT_SIZE);
+	GlStateTracker::Enable(GL_PROGRAM_POINT_SIZE);
+
+	// Shaders can only be loaded from the binary cache once we have a context
+	const nlohmann::json& layerConfig = config.contains(Name) ? config[Name] : GetDefaultConfig();
+	ShaderBinaryCache::Init(
+		JsonGet<std::string>(layerConfig, "shader_cache_path", "shader_cache"),
+		JsonGet(layerConfig, "shader_cache_enabled", true));
+
+	// If the driver can compile shaders on background threads, let it use as many as it wants so batched
+	// shader loads overlap. Our loader doesn't know about the extension, so we grab the function ourselves
+	bool parallelCompile = JsonGet(layerConfig, "parallel_shader_compile", true) &&
+		(glfwExtensionSupported("GL_KHR_parallel_shader_compile") || glfwExtensionSupported("GL_ARB_parallel_shader_compile"));
+	if (parallelCompile) {
+		typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+		MaxShaderCompilerThreadsProc maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+		if (maxThreads == nullptr) {
+			maxThreads = (MaxShaderCompilerThreadsProc)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+		}
+		if (maxThreads != nullptr) {
+			maxThreads(0xFFFFFFFF);
+		}
+	}
+	ShaderProgram::SetParallelCompileSupported(parallelCompile);
+	LOG_INFO("Parallel shader compilation {}", parallelCompile ? "enabled" : "not available");
+
+	// Checking the state cache against the driver stalls on every skipped call, so it's off unless we're hunting a bug
+	GlStateTracker::SetValidationEnabled(JsonGet(layerConfig, "validate_gl_state", false));
+}
+
+nlohmann::json GLAppLayer::GetDefaultConfig() {
+	return {
+		{ "shader_cache_enabled", true },
+		{ "shader_cache_path",    "shader_cache" },
+		{ "parallel_shader_compile", true },
+		{ "validate_gl_state",       false }
+	};
 }
 
 void GLAppLayer::OnAppUnload()
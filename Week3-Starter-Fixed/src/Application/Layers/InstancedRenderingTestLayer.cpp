@@ -35,6 +35,10 @@ void InstancedRenderingTestLayer::OnSceneLoad() {
 		BufferAttribute(12, 3, AttributeType::Float, sizeof(InstanceInfo), 16 * sizeof(float), AttribUsage::User0),
 		BufferAttribute(13, 3, AttributeType::Float, sizeof(InstanceInfo), 20 * sizeof(float), AttribUsage::User0),
 		BufferAttribute(14, 3, AttributeType::Float, sizeof(InstanceInfo), 24 * sizeof(float), AttribUsage::User0),
+
+		// Our mesh isn't quantized, but the shader still expects a position scale and offset
+		BufferAttribute(6, 3, AttributeType::Float, sizeof(InstanceInfo), 32 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(7, 3, AttributeType::Float, sizeof(InstanceInfo), 36 * sizeof(float), AttribUsage::User0),
 	};
 
 	// Load a file to get the base VAO, then add the instanced buffers
@@ -43,7 +47,8 @@ void InstancedRenderingTestLayer::OnSceneLoad() {
 
 	// Load our instanced shader
 	_shader = ShaderProgram::Create();
-	_shader->LoadShaderPartFromFile("shaders/vertex_shaders/basic_instanced.glsl", ShaderPartType::Vertex); 
+	_shader->SetDefine("INSTANCED");
+	_shader->LoadShaderPartFromFile("shaders/vertex_shaders/basic.glsl", ShaderPartType::Vertex); 
 	_shader->LoadShaderPartFromFile("shaders/fragment_shaders/frag_environment_mirror.glsl", ShaderPartType::Fragment);
 	_shader->Link();
 
@@ -94,7 +99,9 @@ void InstancedRenderingTestLayer::_UpdateInstances() {
 		// For now just update everything regardless of if it's changed or not
 		// A smarter system would only update if the data is old
 		data[ix].ModelMatrix  = _instances[ix]->GetTransform();
-		data[ix].NormalMatrix = glm::mat3(glm::transpose(glm::inverse(_instances[ix]->GetTransform())));
+		data[ix].NormalMatrix = glm::mat4(_instances[ix]->GetNormalMatrix());
+		data[ix].PositionScale = glm::vec4(1.0f);
+		data[ix].PositionOffset = glm::vec4(0.0f);
 	}
 
 	// Unmap the buffer so that the GPU can see it again
@@ -34,6 +34,8 @@ protected:
 	struct InstanceInfo {
 		glm::mat4 ModelMatrix;
 		glm::mat4 NormalMatrix;
+		glm::vec4 PositionScale;
+		glm::vec4 PositionOffset;
 	};
 
 	void _UpdateInstances();
@@ -1,5 +1,6 @@
 #include "InterfaceLayer.h"
 #include "Graphics/GuiBatcher.h"
+#include "Graphics/GlStateTracker.h"
 #include <GLM/glm.hpp>
 #include <GLM/gtc/matrix_transform.hpp>
 #include "../Application.h"
@@ -20,18 +21,18 @@ void InterfaceLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
 
 	// We can use the application's viewport to set our OpenGL viewport, as well as clip rendering to that area
 	const glm::uvec4& viewport = app.GetPrimaryViewport();
-	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+	GlStateTracker::Viewport(viewport.x, viewport.y, viewport.z, viewport.w);
 
 	// Disable culling
-	glDisable(GL_CULL_FACE);
+	GlStateTracker::Disable(GL_CULL_FACE);
 	// Disable depth testing, we're going to use order-dependant layering
-	glDisable(GL_DEPTH_TEST);
+	GlStateTracker::Disable(GL_DEPTH_TEST);
 	// Disable depth writing
-	glDepthMask(GL_FALSE);
+	GlStateTracker::DepthMask(false);
 
 	// Enable alpha blending
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GlStateTracker::Enable(GL_BLEND);
+	GlStateTracker::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	// Our projection matrix will be our entire window for now
 	glm::mat4 proj = glm::ortho(0.0f, (float)app.GetWindowSize().x, (float)app.GetWindowSize().y, 0.0f, -1.0f, 1.0f);
@@ -44,11 +45,11 @@ void InterfaceLayer::OnRender(const Framebuffer::Sptr& prevLayer) {
 	GuiBatcher::Flush();
 
 	// Disable alpha blending
-	glDisable(GL_BLEND);
+	GlStateTracker::Disable(GL_BLEND);
 	// Disable scissor testing
-	glDisable(GL_SCISSOR_TEST);
+	GlStateTracker::Disable(GL_SCISSOR_TEST);
 	// Re-enable depth writing
-	glDepthMask(GL_TRUE);
+	GlStateTracker::DepthMask(true);
 }
 
 void InterfaceLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) {
@@ -3,10 +3,20 @@
 #include "Graphics/GuiBatcher.h"
 #include "Gameplay/Components/Camera.h"
 #include "Graphics/DebugDraw.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/GlStateTracker.h"
+#include "Utils/Profiler.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "../Timing.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
+#include "Utils/Frustum.h"
+#include "Utils/GlmDefines.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -16,14 +26,49 @@
 #include <GLM/gtx/common.hpp> // for fmod (floating modulus)
 
 
+// Vertex shaders built on fragments/vs_common.glsl read their transforms from per-instance attributes
+// when this is defined, so any material using one of them can be automatically instanced
+static const std::string InstancedFeature = "INSTANCED";
+// The per-object uniform block, which instanced variants stop reading from
+static const std::string InstanceBlockName = "b_InstanceLevelUniforms";
+
 RenderLayer::RenderLayer() :
 	ApplicationLayer(),
 	_primaryFBO(nullptr),
 	_blitFbo(true),
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
+	_instanceStride(0),
 	_renderFlags(RenderFlags::EnableColorCorrection),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_renderQueue(),
+	_drawCommands(),
+	_drawModels(),
+	_drawNormals(),
+	_drawDequantizations(),
+	_instanceUploads(),
+	_multithreadingEnabled(true),
+	_workerPool(nullptr),
+	_packetLists(),
+	_instanceBatches(),
+	_instanceAttributes(),
+	_instanceBuffer(nullptr),
+	_instancedShaders(),
+	_instancedMeshes(),
+	_multiDrawEnabled(true),
+	_meshPools(),
+	_indirectCommands(),
+	_indirectBuffer(nullptr),
+	_renderQueueVersion(0),
+	_renderQueueSharedVersion(0),
+	_renderQueueScene(),
+	_rebuildRenderQueue(true),
+	_sortKeyIds(),
+	_renderStats({ 0 }),
+	_frustumCullingEnabled(true),
+	_cullSpheres(),
+	_cullResults(),
+	_proxyVisible()
 {
 	Name = "Rendering";
 	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnRender | AppLayerFunctions::OnWindowResize;
@@ -31,13 +76,41 @@ RenderLayer::RenderLayer() :
 
 RenderLayer::~RenderLayer() = default;
 
+// The size of RenderLayer::InstanceAttributes
+static const uint32_t InstanceAttributeStride = sizeof(glm::mat4) * 2 + sizeof(glm::vec4) * 2;
+
+// Attributes for our instance buffer, see fragments/vs_common.glsl
+// Slots 0-5 are used by our common vertex inputs, so we start at 6
+static const std::vector<BufferAttribute> InstanceAttributeDecl = {
+	// The model matrix takes up 4 slots, one per column
+	BufferAttribute(8,  4, AttributeType::Float, InstanceAttributeStride, 0, AttribUsage::User0),
+	BufferAttribute(9,  4, AttributeType::Float, InstanceAttributeStride, 4 * sizeof(float), AttribUsage::User0),
+	BufferAttribute(10, 4, AttributeType::Float, InstanceAttributeStride, 8 * sizeof(float), AttribUsage::User0),
+	BufferAttribute(11, 4, AttributeType::Float, InstanceAttributeStride, 12 * sizeof(float), AttribUsage::User0),
+	// The normal matrix takes up 3 slots, we only read the upper 3x3
+	BufferAttribute(12, 3, AttributeType::Float, InstanceAttributeStride, 16 * sizeof(float), AttribUsage::User0),
+	BufferAttribute(13, 3, AttributeType::Float, InstanceAttributeStride, 20 * sizeof(float), AttribUsage::User0),
+	BufferAttribute(14, 3, AttributeType::Float, InstanceAttributeStride, 24 * sizeof(float), AttribUsage::User0),
+	// The position scale and offset, only xyz are read
+	BufferAttribute(6,  3, AttributeType::Float, InstanceAttributeStride, 32 * sizeof(float), AttribUsage::User0),
+	BufferAttribute(7,  3, AttributeType::Float, InstanceAttributeStride, 36 * sizeof(float), AttribUsage::User0),
+};
+
+// Quantized meshes store positions in [0, 1] across their bounds, which the vertex shader undoes with
+// a scale and offset (see fragments/vs_common.glsl). Everything else gets an identity scale and offset
+static void GetPositionDequantization(const VertexArrayObject::Sptr& mesh, glm::vec4& outScale, glm::vec4& outOffset) {
+	const glm::mat4& transform = mesh->GetPositionDequantization();
+	outScale = glm::vec4(transform[0][0], transform[1][1], transform[2][2], 1.0f);
+	outOffset = glm::vec4(glm::vec3(transform[3]), 0.0f);
+}
+
 void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 {
 	using namespace Gameplay;
 
 	Application& app = Application::Get();
 
-	glViewport(0, 0, _primaryFBO->GetWidth(), _primaryFBO->GetHeight());
+	GlStateTracker::Viewport(0, 0, _primaryFBO->GetWidth(), _primaryFBO->GetHeight());
 
 	// We bind our framebuffer so we can render to it
 	_primaryFBO->Bind();
@@ -54,8 +127,8 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	DebugDrawer::Get().SetViewProjection(viewProj);
 
 	// Make sure depth testing and culling are re-enabled
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
+	GlStateTracker::Enable(GL_DEPTH_TEST);
+	GlStateTracker::Enable(GL_CULL_FACE);
 
 	// The current material that is bound for rendering
 	Material::Sptr currentMat = nullptr;
@@ -77,7 +150,6 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Here we'll bind all the UBOs to their corresponding slots
 	app.CurrentScene()->PreRender();
 	_frameUniforms->Bind(FRAME_UBO_BINDING);
-	_instanceUniforms->Bind(INSTANCE_UBO_BINDING);
 
 	// Draw physics debug
 	app.CurrentScene()->DrawPhysicsDebug();
@@ -93,51 +165,155 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	frameData.u_RenderFlags = _renderFlags;
 	_frameUniforms->Update();
 
-	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
+	// Make sure our render queue reflects the current state of the scene
+	_UpdateRenderQueue();
+	_renderStats = { 0 };
+
+	// Figure out which objects are actually in view of the camera
+	_CullRenderQueue(viewProj);
+
+	// Make sure the instance arena can fit every object, then move to the next region in the ring
+	_instanceUniforms->Reserve(static_cast<uint32_t>(_renderQueue.size()) * _instanceStride);
+	_instanceUniforms->BeginFrame();
+	// Same for indirect commands, we'll never need more than one per object
+	_indirectBuffer->Reserve(static_cast<uint32_t>(_renderQueue.size() * sizeof(DrawElementsIndirectCommand)));
+	_indirectBuffer->BeginFrame();
+
+	// Scene::PreRender has already resolved every object's world transform, walking the hierarchy parents
+	// first (see Scene::UpdateSpatialIndex). Nothing is dirty, so the getters below only read, which lets us
+	// split the work across threads
+	size_t sliceCount = _multithreadingEnabled ? _workerPool->GetChunkCount(_renderQueue.size(), MIN_WORK_SLICE) : 1;
+	if (_packetLists.size() < sliceCount) {
+		_packetLists.resize(sliceCount);
+	}
+	for (size_t ix = 0; ix < sliceCount; ix++) {
+		_packetLists[ix].Clear();
+	}
 
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
-		// Early bail if mesh not set
-		if (renderable->GetMesh() == nullptr) {
-			return;
+	// Each slice of the queue builds it's own list of draws, which we then stitch back together in order
+	auto gatherSlice = [&](size_t begin, size_t end, size_t slice) {
+		_GatherDrawCommands(begin, end, _packetLists[slice]);
+	};
+	if (sliceCount > 1) {
+		_workerPool->ParallelFor(_renderQueue.size(), MIN_WORK_SLICE, gatherSlice);
+	} else {
+		gatherSlice(0, _renderQueue.size(), 0);
+	}
+	_MergePacketLists(sliceCount);
+
+	// Instanced objects keep their slot in the instance buffer between frames, so we only need
+	// to upload the ones that moved
+	for (const glm::uvec2& upload : _instanceUploads) {
+		_instanceBuffer->UpdateSubData(&_instanceAttributes[upload.x], upload.x * sizeof(InstanceAttributes), upload.y * sizeof(InstanceAttributes));
+	}
+
+	// Non-instanced draws get one contiguous block of the instance arena, which lets us calculate
+	// all the MVP matrices straight into the arena in a single pass
+	if (!_drawModels.empty()) {
+		uint32_t baseOffset = 0;
+		uint8_t* blocks = reinterpret_cast<uint8_t*>(
+			_instanceUniforms->Allocate(static_cast<uint32_t>(_drawModels.size()) * _instanceStride, _instanceStride, baseOffset));
+		LOG_ASSERT(blocks != nullptr, "Instance arena is full!");
+
+		auto writeUniforms = [&](size_t begin, size_t end, size_t) {
+			MultiplyMatrices(viewProj, &_drawModels[begin], end - begin, blocks + begin * _instanceStride + offsetof(InstanceLevelUniforms, u_ModelViewProjection), _instanceStride);
+			for (size_t ix = begin; ix < end; ix++) {
+				InstanceLevelUniforms* instanceData = reinterpret_cast<InstanceLevelUniforms*>(blocks + ix * _instanceStride);
+				instanceData->u_Model = _drawModels[ix];
+				instanceData->u_NormalMatrix = glm::mat4(_drawNormals[ix]);
+				instanceData->u_PositionScale = _drawDequantizations[ix].Scale;
+				instanceData->u_PositionOffset = _drawDequantizations[ix].Offset;
+			}
+		};
+		if (_multithreadingEnabled) {
+			_workerPool->ParallelFor(_drawModels.size(), MIN_WORK_SLICE, writeUniforms);
+		} else {
+			writeUniforms(0, _drawModels.size(), 0);
 		}
 
-		// If we don't have a material, try getting the scene's fallback material
-		// If none exists, do not draw anything
-		if (renderable->GetMaterial() == nullptr) {
-			if (defaultMat != nullptr) {
-				renderable->SetMaterial(defaultMat);
-			} else {
-				return;
+		// Draws were storing the index of their model matrix, turn that into their offset in the arena
+		for (DrawCommand& command : _drawCommands) {
+			if (command.Batch < 0) {
+				command.InstanceOffset = baseOffset + command.InstanceOffset * _instanceStride;
 			}
 		}
+	}
+
+	// Copy the indirect commands for all our multi-draws into this frame's region in one go
+	uint32_t indirectOffset = 0;
+	if (!_indirectCommands.empty()) {
+		void* indirectData = _indirectBuffer->Allocate(static_cast<uint32_t>(_indirectCommands.size() * sizeof(DrawElementsIndirectCommand)), sizeof(uint32_t), indirectOffset);
+		LOG_ASSERT(indirectData != nullptr, "Indirect buffer is full!");
+		memcpy(indirectData, _indirectCommands.data(), _indirectCommands.size() * sizeof(DrawElementsIndirectCommand));
+	}
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+	// Render all our objects, in sorted order
+	GpuProfiler::PushScope("Objects");
+	for (const DrawCommand& command : _drawCommands) {
+		RenderComponent* renderable = command.Renderable;
+		const Material::Sptr& material = renderable->GetMaterial();
 
+		// Instanced draws use the instanced variant of the material's shader
+		const ShaderProgram::Sptr& drawShader = command.Batch >= 0 ? _instanceBatches[command.Batch].Shader : material->GetShader();
+
+		// Since the queue is sorted by shader then material, we only need to bind
+		// state when it differs from our neighbour
+		bool shaderChanged = drawShader != shader;
+		if (shaderChanged) {
+			shader = drawShader;
 			shader->Bind();
-			currentMat->Apply();
+			_renderStats.ShaderBinds++;
+		} else {
+			_renderStats.ShaderBindsAvoided++;
 		}
 
-		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+		// Material parameters are stored per-program, so we need to re-apply if the shader changed
+		if (material != currentMat || shaderChanged) {
+			// Instances of the same root material sort next to each other, switching between them only
+			// needs to send the parameters they override
+			if (!shaderChanged && currentMat != nullptr && material->GetRoot() == currentMat->GetRoot()) {
+				material->ApplyOverrides(currentMat, shader);
+				_renderStats.MaterialInstanceSwitches++;
+			} else {
+				material->Apply(shader);
+				_renderStats.MaterialBinds++;
+			}
+			currentMat = material;
+		} else {
+			_renderStats.MaterialBindsAvoided++;
+		}
 
-		// Use our uniform buffer for our instance level uniforms
-		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
-		_instanceUniforms->Update();
+		if (command.IndirectCount > 0) {
+			// Draw every mesh in the material bucket in one go
+			uint32_t offset = indirectOffset + command.IndirectStart * sizeof(DrawElementsIndirectCommand);
+			_instanceBatches[command.Batch].Vao->MultiDrawIndirect(*_indirectBuffer, offset, command.IndirectCount);
+			_renderStats.MultiDraws++;
+			_renderStats.IndirectCommands += command.IndirectCount;
+			_renderStats.InstancesDrawn += command.InstanceCount;
+		} else if (command.Batch >= 0) {
+			// Draw all the instances in one go
+			_instanceBatches[command.Batch].Vao->DrawInstanced(command.InstanceCount, DrawMode::TriangleList, command.BaseInstance);
+			_renderStats.InstancedDraws++;
+			_renderStats.InstancesDrawn += command.InstanceCount;
+		} else {
+			// Bind this object's slice of the instance arena
+			_instanceUniforms->BindRange(INSTANCE_UBO_BINDING, command.InstanceOffset, sizeof(InstanceLevelUniforms));
+
+			// Draw the object
+			renderable->GetMesh()->Draw();
+		}
+		_renderStats.DrawCalls++;
+	}
+	GpuProfiler::PopScope();
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
-	});
+	// Let the ring buffer know when the GPU is done with this frame's region
+	_instanceUniforms->EndFrame();
+	_indirectBuffer->EndFrame();
 
 	// Use our cubemap to draw our skybox
+	GpuProfiler::PushScope("Skybox");
 	app.CurrentScene()->DrawSkybox();
+	GpuProfiler::PopScope();
 
 	// Unbind our primary framebuffer so subsequent draw calls do not modify it
 	//_primaryFBO->Unbind();
@@ -162,9 +338,9 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	Application& app = Application::Get();
 
 	// GL states, we'll enable depth testing and backface fulling
-	glEnable(GL_DEPTH_TEST);
-	glEnable(GL_CULL_FACE);
-	glCullFace(GL_BACK);
+	GlStateTracker::Enable(GL_DEPTH_TEST);
+	GlStateTracker::Enable(GL_CULL_FACE);
+	GlStateTracker::CullFace(GL_BACK);
 
 	// Create a new descriptor for our FBO
 	FramebufferDescriptor fboDescriptor;
@@ -182,7 +358,29 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 
 	// Create our common uniform buffers
 	_frameUniforms = std::make_shared<UniformBuffer<FrameLevelUniforms>>(BufferUsage::DynamicDraw);
-	_instanceUniforms = std::make_shared<UniformBuffer<InstanceLevelUniforms>>(BufferUsage::DynamicDraw);
+
+	// Instance blocks need to start on the UBO offset alignment for glBindBufferRange
+	int uboAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboAlignment);
+	uboAlignment = uboAlignment > 0 ? uboAlignment : 256;
+	_instanceStride = ((sizeof(InstanceLevelUniforms) + uboAlignment - 1) / uboAlignment) * uboAlignment;
+
+	// Start with enough room for 1024 objects per frame, triple buffered
+	_instanceUniforms = std::make_shared<RingBuffer>(BufferType::Uniform, _instanceStride * 1024, 3);
+	_instanceUniforms->SetDebugName("Instance Uniforms");
+
+	// Workers for culling and draw command generation, leaves one core for the main thread
+	_workerPool = std::make_shared<ThreadPool>();
+
+	// Create the buffer that will feed per-instance attributes to instanced draws
+	static_assert(sizeof(InstanceAttributes) == InstanceAttributeStride, "InstanceAttributeDecl does not match InstanceAttributes");
+	_instanceBuffer = VertexBuffer::Create(BufferUsage::DynamicDraw);
+	_instanceBuffer->LoadData<InstanceAttributes>(nullptr, 1024);
+	_instanceBuffer->SetDebugName("Instance Attributes");
+
+	// Indirect commands for multi-draws are streamed every frame, since culling changes which objects are drawn
+	_indirectBuffer = std::make_shared<RingBuffer>(BufferType::DrawIndirect, static_cast<uint32_t>(sizeof(DrawElementsIndirectCommand) * 1024), 3);
+	_indirectBuffer->SetDebugName("Indirect Commands");
 }
 
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
@@ -216,3 +414,549 @@ void RenderLayer::SetRenderFlags(RenderFlags value) {
 RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
+
+const RenderLayer::RenderStats& RenderLayer::GetRenderStats() const {
+	return _renderStats;
+}
+
+void RenderLayer::SetFrustumCullingEnabled(bool value) {
+	_frustumCullingEnabled = value;
+}
+
+bool RenderLayer::IsFrustumCullingEnabled() const {
+	return _frustumCullingEnabled;
+}
+
+void RenderLayer::SetMultiDrawEnabled(bool value) {
+	if (value != _multiDrawEnabled) {
+		_multiDrawEnabled = value;
+		// Batches need to be rebuilt, so we'll rebuild the queue next frame
+		_rebuildRenderQueue = true;
+	}
+}
+
+bool RenderLayer::IsMultiDrawEnabled() const {
+	return _multiDrawEnabled;
+}
+
+void RenderLayer::SetMultithreadingEnabled(bool value) {
+	_multithreadingEnabled = value;
+}
+
+bool RenderLayer::IsMultithreadingEnabled() const {
+	return _multithreadingEnabled;
+}
+
+uint32_t RenderLayer::GetWorkerThreadCount() const {
+	return _workerPool != nullptr ? _workerPool->GetThreadCount() : 1;
+}
+
+void RenderLayer::_CullRenderQueue(const glm::mat4& viewProj) {
+	PROFILE_FUNCTION();
+	_cullResults.resize(_renderQueue.size());
+
+	if (!_frustumCullingEnabled) {
+		std::fill(_cullResults.begin(), _cullResults.end(), 1);
+		return;
+	}
+
+	// The spatial index has already been updated by Scene::PreRender, so one walk of the tree finds
+	// every object that could be visible without testing the rest one by one
+	Frustum frustum(viewProj);
+	const AABBTree& spatialIndex = Application::Get().CurrentScene()->GetSpatialIndex();
+	_proxyVisible.assign(spatialIndex.GetNodeCapacity(), 0);
+	spatialIndex.QueryFrustum(frustum, [&](int32_t proxy, void*) {
+		_proxyVisible[proxy] = 1;
+		return true;
+	});
+
+	// The tree tests fat boxes, so gather world space spheres for the entries it found and test those
+	// in bulk for a tighter result. Each slice only touches it's own range of the arrays, so slices can
+	// run on any thread
+	_cullSpheres.resize(_renderQueue.size());
+	auto cullSlice = [&](size_t begin, size_t end, size_t) {
+		for (size_t ix = begin; ix < end; ix++) {
+			RenderComponent::Sptr renderable = _renderQueue[ix].Component.lock();
+			VertexArrayObject::Sptr mesh = renderable != nullptr ? renderable->GetMesh() : nullptr;
+			int32_t proxy = renderable != nullptr ? renderable->GetGameObject()->GetSpatialProxy() : AABBTree::NullNode;
+
+			if (mesh == nullptr) {
+				// Won't be drawn anyways, make sure it's culled
+				_cullSpheres[ix] = glm::vec4(0.0f, 0.0f, 0.0f, -std::numeric_limits<float>::max());
+			} else if (!mesh->GetBoundingSphere().IsValid()) {
+				// We don't know how big the mesh is, so we can never cull it
+				_cullSpheres[ix] = glm::vec4(0.0f, 0.0f, 0.0f, std::numeric_limits<float>::max());
+			} else if (proxy != AABBTree::NullNode && !_proxyVisible[proxy]) {
+				// Rejected by the spatial index, no need to transform it's bounds
+				_cullSpheres[ix] = glm::vec4(0.0f, 0.0f, 0.0f, -std::numeric_limits<float>::max());
+			} else {
+				BoundingSphere sphere = mesh->GetBoundingSphere().Transform(renderable->GetGameObject()->GetTransform());
+				_cullSpheres[ix] = glm::vec4(sphere.Center, sphere.Radius);
+			}
+		}
+		frustum.CullSpheres(&_cullSpheres[begin], end - begin, &_cullResults[begin]);
+	};
+
+	if (_multithreadingEnabled && _renderQueue.size() > 0) {
+		_workerPool->ParallelFor(_renderQueue.size(), MIN_WORK_SLICE, cullSlice);
+	} else {
+		cullSlice(0, _renderQueue.size(), 0);
+	}
+}
+
+void RenderLayer::_GatherDrawCommands(size_t begin, size_t end, CommandPacketList& out) {
+	PROFILE_FUNCTION();
+	using namespace Gameplay;
+
+	for (size_t ix = begin; ix < end; ix++) {
+		RenderQueueEntry& entry = _renderQueue[ix];
+		RenderComponent::Sptr renderable = entry.Component.lock();
+
+		// Skip anything that's been destroyed or disabled since the queue was built
+		if (renderable == nullptr || !renderable->IsEnabled) {
+			continue;
+		}
+
+		// Early bail if mesh or material not set
+		if (renderable->GetMesh() == nullptr || renderable->GetMaterial() == nullptr) {
+			continue;
+		}
+
+		// Skip anything outside of the camera's view
+		if (!_cullResults[ix]) {
+			out.ObjectsCulled++;
+			continue;
+		}
+		out.ObjectsVisible++;
+
+		// Grab the game object so we can do some stuff with it
+		GameObject* object = renderable->GetGameObject();
+
+		// Instanced objects write into the instance buffer, and get merged into their neighbour's draw
+		if (entry.Batch >= 0) {
+			uint32_t version = object->GetTransformVersion();
+			if (entry.InstanceDirty || entry.TransformVersion != version) {
+				// Slots are unique to each entry, so slices never write to the same attributes
+				InstanceAttributes& attributes = _instanceAttributes[entry.InstanceSlot];
+				attributes.ModelMatrix = object->GetTransform();
+				attributes.NormalMatrix = glm::mat4(object->GetNormalMatrix());
+				GetPositionDequantization(renderable->GetMesh(), attributes.PositionScale, attributes.PositionOffset);
+				entry.TransformVersion = version;
+				entry.InstanceDirty = false;
+
+				// Merge neighbouring slots into a single upload
+				if (!out.Uploads.empty() && out.Uploads.back().x + out.Uploads.back().y == entry.InstanceSlot) {
+					out.Uploads.back().y++;
+				} else {
+					out.Uploads.push_back(glm::uvec2(entry.InstanceSlot, 1));
+				}
+				out.InstancesUploaded++;
+			}
+
+			bool multiDraw = _instanceBatches[entry.Batch].Pool != nullptr;
+
+			// Extend the previous draw if it's the same batch and the slots are contiguous
+			if (!out.Commands.empty()) {
+				DrawCommand& prev = out.Commands.back();
+				if (multiDraw && prev.Batch == entry.Batch) {
+					// Same mesh as the last indirect command and the next slot, so it can be another instance of that command
+					DrawElementsIndirectCommand& last = out.IndirectCommands.back();
+					if (last.FirstIndex == entry.MeshRange.FirstIndex && last.BaseInstance + last.InstanceCount == entry.InstanceSlot) {
+						last.InstanceCount++;
+					} else {
+						out.IndirectCommands.push_back({ entry.MeshRange.IndexCount, 1, entry.MeshRange.FirstIndex, entry.MeshRange.BaseVertex, entry.InstanceSlot });
+						prev.IndirectCount++;
+					}
+					prev.InstanceCount++;
+					continue;
+				}
+				if (!multiDraw && prev.Batch == entry.Batch && prev.BaseInstance + prev.InstanceCount == entry.InstanceSlot) {
+					prev.InstanceCount++;
+					continue;
+				}
+			}
+
+			DrawCommand command;
+			command.Renderable = renderable.get();
+			command.InstanceOffset = 0;
+			command.Batch = entry.Batch;
+			command.BaseInstance = entry.InstanceSlot;
+			command.InstanceCount = 1;
+			command.IndirectStart = 0;
+			command.IndirectCount = 0;
+			if (multiDraw) {
+				command.IndirectStart = static_cast<uint32_t>(out.IndirectCommands.size());
+				command.IndirectCount = 1;
+				out.IndirectCommands.push_back({ entry.MeshRange.IndexCount, 1, entry.MeshRange.FirstIndex, entry.MeshRange.BaseVertex, entry.InstanceSlot });
+			}
+			out.Commands.push_back(command);
+			continue;
+		}
+
+		DrawCommand command;
+		command.Renderable = renderable.get();
+		command.Batch = -1;
+		command.BaseInstance = 0;
+		command.InstanceCount = 0;
+		command.IndirectStart = 0;
+		command.IndirectCount = 0;
+
+		// Uniforms are written for all non-instanced draws at once, for now we just store the
+		// index of the draw's matrices
+		command.InstanceOffset = static_cast<uint32_t>(out.Models.size());
+		out.Models.push_back(object->GetTransform());
+		out.Normals.push_back(object->GetNormalMatrix());
+		PositionDequantization dequantization;
+		GetPositionDequantization(renderable->GetMesh(), dequantization.Scale, dequantization.Offset);
+		out.Dequantizations.push_back(dequantization);
+
+		out.Commands.push_back(command);
+	}
+}
+
+void RenderLayer::_MergePacketLists(size_t count) {
+	PROFILE_FUNCTION();
+	_drawCommands.clear();
+	_indirectCommands.clear();
+	_drawModels.clear();
+	_drawNormals.clear();
+	_drawDequantizations.clear();
+	_instanceUploads.clear();
+
+	for (size_t slice = 0; slice < count; slice++) {
+		const CommandPacketList& list = _packetLists[slice];
+		_renderStats.ObjectsVisible += list.ObjectsVisible;
+		_renderStats.ObjectsCulled += list.ObjectsCulled;
+		_renderStats.InstancesUploaded += list.InstancesUploaded;
+
+		// Indices in the list are relative to the slice, so offset them by everything merged before it
+		uint32_t indirectBase = static_cast<uint32_t>(_indirectCommands.size());
+		uint32_t modelBase = static_cast<uint32_t>(_drawModels.size());
+		_indirectCommands.insert(_indirectCommands.end(), list.IndirectCommands.begin(), list.IndirectCommands.end());
+		_drawModels.insert(_drawModels.end(), list.Models.begin(), list.Models.end());
+		_drawNormals.insert(_drawNormals.end(), list.Normals.begin(), list.Normals.end());
+		_drawDequantizations.insert(_drawDequantizations.end(), list.Dequantizations.begin(), list.Dequantizations.end());
+
+		for (const glm::uvec2& upload : list.Uploads) {
+			if (!_instanceUploads.empty() && _instanceUploads.back().x + _instanceUploads.back().y == upload.x) {
+				_instanceUploads.back().y += upload.y;
+			} else {
+				_instanceUploads.push_back(upload);
+			}
+		}
+
+		for (size_t ix = 0; ix < list.Commands.size(); ix++) {
+			DrawCommand command = list.Commands[ix];
+			if (command.Batch < 0) {
+				command.InstanceOffset += modelBase;
+			} else if (command.IndirectCount > 0) {
+				command.IndirectStart += indirectBase;
+			}
+
+			// The first draw in a slice may be a continuation of the last draw from the previous slice
+			if (ix == 0 && !_drawCommands.empty()) {
+				DrawCommand& prev = _drawCommands.back();
+				if (prev.Batch >= 0 && prev.Batch == command.Batch) {
+					// Multi-draw commands from both slices are already next to each other in _indirectCommands
+					if (command.IndirectCount > 0) {
+						prev.IndirectCount += command.IndirectCount;
+						prev.InstanceCount += command.InstanceCount;
+						continue;
+					}
+					if (prev.BaseInstance + prev.InstanceCount == command.BaseInstance) {
+						prev.InstanceCount += command.InstanceCount;
+						continue;
+					}
+				}
+			}
+
+			_drawCommands.push_back(command);
+		}
+	}
+}
+
+void RenderLayer::_UpdateRenderQueue() {
+	PROFILE_FUNCTION();
+	using namespace Gameplay;
+
+	Application& app = Application::Get();
+	Scene::Sptr scene = app.CurrentScene();
+
+	// Our IDs only have 16 bits in the key, once we run out we start over with a full rebuild
+	bool rebuild = _rebuildRenderQueue || _renderQueueScene.lock() != scene || _sortKeyIds.size() > 0xFFFF;
+	// A material's shader or a mesh resource's VAO changed, we don't know which entries used them
+	rebuild |= _renderQueueSharedVersion != RenderComponent::GetSharedStateVersion();
+
+	// Nothing has changed since our last update, we can keep using the queue as is
+	if (!rebuild && _renderQueueVersion == RenderComponent::GetRenderStateVersion()) {
+		return;
+	}
+
+	if (rebuild) {
+		_renderQueue.clear();
+		_sortKeyIds.clear();
+		_renderQueueScene = scene;
+		_renderQueueSharedVersion = RenderComponent::GetSharedStateVersion();
+		_rebuildRenderQueue = false;
+	}
+
+	// Drop entries for components that were destroyed or changed, changed ones will be re-inserted
+	// below. Erasing keeps the remaining entries in sorted order
+	auto removed = std::remove_if(_renderQueue.begin(), _renderQueue.end(), [](const RenderQueueEntry& entry) {
+		RenderComponent::Sptr renderable = entry.Component.lock();
+		return renderable == nullptr || renderable->GetStateVersion() != entry.StateVersion;
+	});
+	_renderQueue.erase(removed, _renderQueue.end());
+	size_t keptCount = _renderQueue.size();
+
+	// Anything that's been added or changed since our last update goes on the end of the queue
+	Material::Sptr defaultMat = scene->DefaultMaterial;
+	scene->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+		if (!rebuild && renderable->GetStateVersion() <= _renderQueueVersion) {
+			return;
+		}
+
+		// If we don't have a material, try getting the scene's fallback material
+		if (renderable->GetMaterial() == nullptr && defaultMat != nullptr) {
+			renderable->SetMaterial(defaultMat);
+		}
+
+		const Material::Sptr& material = renderable->GetMaterial();
+		if (renderable->GetMesh() == nullptr || material == nullptr) {
+			return;
+		}
+
+		// Key layout, from most to least significant: shader, root material, material, mesh (16 bits each)
+		// Keying on the root material keeps instances of the same material next to each other in the
+		// queue, while still being separate buckets for batching. Entries in the same mesh bucket are
+		// drawn together with instancing, so we don't sort them by depth
+		RenderQueueEntry entry;
+		entry.SortKey =
+			(_GetSortKeyId(material->GetShader().get()) << 48) |
+			(_GetSortKeyId(material->GetRoot()) << 32) |
+			(_GetSortKeyId(material.get()) << 16) |
+			_GetSortKeyId(renderable->GetMeshResource().get());
+		entry.Component = renderable;
+		entry.StateVersion = renderable->GetStateVersion();
+		entry.Batch = -1;
+		entry.InstanceSlot = 0;
+		entry.TransformVersion = 0;
+		entry.InstanceDirty = true;
+		entry.MeshRange = { 0, 0, 0 };
+		_renderQueue.push_back(entry);
+	}, true);
+
+	// Only the new entries need sorting, then they get merged in with the rest
+	auto byKey = [](const RenderQueueEntry& a, const RenderQueueEntry& b) {
+		return a.SortKey < b.SortKey;
+	};
+	std::sort(_renderQueue.begin() + keptCount, _renderQueue.end(), byKey);
+	std::inplace_merge(_renderQueue.begin(), _renderQueue.begin() + keptCount, _renderQueue.end(), byKey);
+
+	_BuildInstanceBatches();
+
+	// Grab the version after assigning default materials, so we don't update again next frame
+	_renderQueueVersion = RenderComponent::GetRenderStateVersion();
+}
+
+uint64_t RenderLayer::_GetSortKeyId(const void* resource) {
+	auto it = _sortKeyIds.find(resource);
+	if (it == _sortKeyIds.end()) {
+		it = _sortKeyIds.emplace(resource, static_cast<uint64_t>(_sortKeyIds.size()) & 0xFFFF).first;
+	}
+	return it->second;
+}
+
+void RenderLayer::_BuildInstanceBatches() {
+	_instanceBatches.clear();
+	uint32_t instanceCount = 0;
+
+	// Entries keep their instance slot when it doesn't change, so only moved slots get re-uploaded.
+	// Entries that weren't instanced before have nothing in their slot yet
+	for (RenderQueueEntry& entry : _renderQueue) {
+		if (entry.Batch < 0) {
+			entry.InstanceDirty = true;
+		}
+		entry.Batch = -1;
+	}
+
+	// Entries with the same shader and material have the same upper 48 bits in their key, and within
+	// those, entries with the same mesh have the same key. Either way they'll be next to each other
+	// in the queue
+	size_t materialStart = 0;
+	while (materialStart < _renderQueue.size()) {
+		size_t materialEnd = materialStart + 1;
+		while (materialEnd < _renderQueue.size() && (_renderQueue[materialEnd].SortKey >> 16) == (_renderQueue[materialStart].SortKey >> 16)) {
+			materialEnd++;
+		}
+
+		// If we can't draw the whole material bucket with one multi-draw, fall back to instancing each mesh
+		if (!(_multiDrawEnabled && _BuildMultiDrawBatch(materialStart, materialEnd, instanceCount))) {
+			size_t start = materialStart;
+			while (start < materialEnd) {
+				size_t end = start + 1;
+				while (end < materialEnd && _renderQueue[end].SortKey == _renderQueue[start].SortKey) {
+					end++;
+				}
+
+				RenderComponent::Sptr first = _renderQueue[start].Component.lock();
+				if (first != nullptr && end - start >= MIN_INSTANCE_BATCH_SIZE) {
+					InstanceBatch batch;
+					batch.Shader = _GetInstancedShader(first->GetMaterial()->GetShader());
+					batch.Vao = batch.Shader != nullptr ? _GetInstancedMesh(first->GetMesh()) : nullptr;
+					batch.Pool = nullptr;
+
+					// Only batch if the material's shader has an instanced version
+					if (batch.Vao != nullptr) {
+						for (size_t ix = start; ix < end; ix++) {
+							_AssignInstanceSlot(_renderQueue[ix], static_cast<int32_t>(_instanceBatches.size()), instanceCount++);
+						}
+						_instanceBatches.push_back(batch);
+					}
+				}
+
+				start = end;
+			}
+		}
+
+		materialStart = materialEnd;
+	}
+
+	// Meshes that no batch drew from this time have been destroyed or swapped out, so free their
+	// space in the pools. Pools left empty are dropped entirely
+	for (const StaticMeshPool::Sptr& pool : _meshPools) {
+		pool->RemoveUnused();
+	}
+	_meshPools.erase(std::remove_if(_meshPools.begin(), _meshPools.end(), [](const StaticMeshPool::Sptr& pool) {
+		return pool->GetMeshCount() == 0;
+	}), _meshPools.end());
+
+	// Pools re-create their VAOs when they grow, so grab the final ones
+	for (InstanceBatch& batch : _instanceBatches) {
+		if (batch.Pool != nullptr) {
+			batch.Vao = batch.Pool->GetVao();
+		}
+	}
+
+	// Make sure our instance buffer can fit everything, this keeps the same GL buffer
+	// so the instanced VAOs don't need to be updated
+	_instanceAttributes.resize(instanceCount);
+	if (instanceCount * sizeof(InstanceAttributes) > _instanceBuffer->GetTotalSize()) {
+		_instanceBuffer->LoadData<InstanceAttributes>(nullptr, instanceCount + instanceCount / 2);
+
+		// Re-specifying the buffer throws away it's contents, so everything needs to be uploaded again
+		for (RenderQueueEntry& entry : _renderQueue) {
+			entry.InstanceDirty = true;
+		}
+	}
+}
+
+void RenderLayer::_AssignInstanceSlot(RenderQueueEntry& entry, int32_t batch, uint32_t slot) {
+	if (entry.InstanceSlot != slot) {
+		entry.InstanceSlot = slot;
+		entry.InstanceDirty = true;
+	}
+	entry.Batch = batch;
+}
+
+bool RenderLayer::_BuildMultiDrawBatch(size_t start, size_t end, uint32_t& instanceCount) {
+	// A bucket with a single draw wouldn't save anything, and would just take up space in the pool
+	if (end - start < MIN_INSTANCE_BATCH_SIZE) {
+		return false;
+	}
+
+	RenderComponent::Sptr first = _renderQueue[start].Component.lock();
+	if (first == nullptr) {
+		return false;
+	}
+
+	// Multi-draws feed transforms through the instance buffer, so we need the instanced shader
+	const ShaderProgram::Sptr& shader = _GetInstancedShader(first->GetMaterial()->GetShader());
+	if (shader == nullptr) {
+		return false;
+	}
+
+	// Every mesh in the bucket needs to share a vertex layout, so they can live in the same pool
+	StaticMeshPool::Sptr pool = _GetMeshPool(first->GetMesh());
+	if (pool == nullptr) {
+		return false;
+	}
+	for (size_t ix = start + 1; ix < end; ix++) {
+		RenderComponent::Sptr renderable = _renderQueue[ix].Component.lock();
+		if (renderable != nullptr && !pool->IsCompatible(renderable->GetMesh())) {
+			return false;
+		}
+	}
+
+	int32_t batchIx = static_cast<int32_t>(_instanceBatches.size());
+	for (size_t ix = start; ix < end; ix++) {
+		RenderQueueEntry& entry = _renderQueue[ix];
+		RenderComponent::Sptr renderable = entry.Component.lock();
+		if (renderable == nullptr || !pool->GetOrAdd(renderable->GetMesh(), entry.MeshRange)) {
+			continue;
+		}
+		_AssignInstanceSlot(entry, batchIx, instanceCount++);
+	}
+
+	InstanceBatch batch;
+	batch.Shader = shader;
+	batch.Pool = pool;
+	batch.Vao = pool->GetVao();
+	_instanceBatches.push_back(batch);
+	return true;
+}
+
+StaticMeshPool::Sptr RenderLayer::_GetMeshPool(const VertexArrayObject::Sptr& mesh) {
+	if (!StaticMeshPool::CanPool(mesh)) {
+		return nullptr;
+	}
+
+	for (const StaticMeshPool::Sptr& pool : _meshPools) {
+		if (pool->IsCompatible(mesh)) {
+			return pool;
+		}
+	}
+
+	StaticMeshPool::Sptr pool = std::make_shared<StaticMeshPool>(mesh->GetVertexBuffers()[0]->GetAttributes(), _instanceBuffer, InstanceAttributeDecl);
+	_meshPools.push_back(pool);
+	return pool;
+}
+
+const ShaderProgram::Sptr& RenderLayer::_GetInstancedShader(const ShaderProgram::Sptr& shader) {
+	InstancedShaderEntry& entry = _instancedShaders[shader.get()];
+
+	// Re-create the variant if this is a new shader, or the old one was deleted and the address re-used
+	if (entry.Source.lock() != shader) {
+		entry.Source = shader;
+		entry.Variant = nullptr;
+
+		// Only shaders that take their transforms from the instance block can be instanced, and only if
+		// the INSTANCED variant actually stops using it. frame_uniforms.glsl leaves the block out when
+		// INSTANCED is defined, so if the variant still has it, the shader doesn't use those commons and
+		// every instance would be drawn with whatever transform was last bound
+		if (shader->FindUniformBlock(InstanceBlockName) != nullptr) {
+			ShaderProgram::Sptr variant = shader->CreateVariant({ { InstancedFeature, "1" } });
+			if (variant != nullptr && variant->FindUniformBlock(InstanceBlockName) == nullptr) {
+				variant->SetDebugName(shader->GetDebugName() + " (Instanced)");
+				entry.Variant = variant;
+			} else {
+				// Without a variant its buckets can't be instanced or multi-drawn, make sure that doesn't go unnoticed
+				LOG_WARN("Shader \"{}\" has no instanced variant, objects using it will be drawn one at a time", shader->GetDebugName());
+			}
+		}
+	}
+
+	return entry.Variant;
+}
+
+const VertexArrayObject::Sptr& RenderLayer::_GetInstancedMesh(const VertexArrayObject::Sptr& mesh) {
+	InstancedMeshEntry& entry = _instancedMeshes[mesh.get()];
+
+	if (entry.Source.lock() != mesh) {
+		entry.Source = mesh;
+		entry.Vao = mesh->Clone();
+		entry.Vao->AddVertexBuffer(_instanceBuffer, InstanceAttributeDecl, true);
+	}
+
+	return entry.Vao;
+}
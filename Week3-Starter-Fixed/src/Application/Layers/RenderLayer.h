@@ -2,6 +2,16 @@
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
 #include "Graphics/Buffers/UniformBuffer.h"
+#include "Graphics/Buffers/RingBuffer.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/StaticMeshPool.h"
+#include "Utils/ThreadPool.h"
+
+class RenderComponent;
+namespace Gameplay {
+	class Scene;
+}
 
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
@@ -42,6 +52,40 @@ public:
 		glm::mat4 u_Model;
 		// Normal Matrix for transforming normals
 		glm::mat4 u_NormalMatrix;
+		// Takes the mesh's stored positions back into mesh space, as a scale and offset
+		glm::vec4 u_PositionScale;
+		glm::vec4 u_PositionOffset;
+	};
+
+	// Statistics about the last frame that was rendered, lets us see how
+	// well the render queue is batching our state changes
+	struct RenderStats {
+		// The number of objects that were drawn
+		uint32_t DrawCalls;
+		// The number of times a shader was bound
+		uint32_t ShaderBinds;
+		// The number of shader binds skipped since the shader was already bound
+		uint32_t ShaderBindsAvoided;
+		// The number of times a material was applied
+		uint32_t MaterialBinds;
+		// The number of material applies skipped since the material was already applied
+		uint32_t MaterialBindsAvoided;
+		// The number of switches between instances of the same material, which only send their overrides
+		uint32_t MaterialInstanceSwitches;
+		// The number of draw calls that were instanced
+		uint32_t InstancedDraws;
+		// The number of objects drawn via instanced draws
+		uint32_t InstancesDrawn;
+		// The number of instances whose transforms were re-uploaded this frame
+		uint32_t InstancesUploaded;
+		// The number of glMultiDrawElementsIndirect calls
+		uint32_t MultiDraws;
+		// The number of indirect commands submitted by multi-draws
+		uint32_t IndirectCommands;
+		// The number of objects that passed frustum culling
+		uint32_t ObjectsVisible;
+		// The number of objects that were skipped by frustum culling
+		uint32_t ObjectsCulled;
 	};
 
 	RenderLayer();
@@ -61,6 +105,36 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Gets the render statistics for the most recently rendered frame
+	/// </summary>
+	const RenderStats& GetRenderStats() const;
+
+	/// <summary>
+	/// Sets whether objects outside of the camera's view should be skipped
+	/// </summary>
+	void SetFrustumCullingEnabled(bool value);
+	bool IsFrustumCullingEnabled() const;
+
+	/// <summary>
+	/// Sets whether static meshes that share a vertex layout and material should be packed into shared
+	/// buffers and submitted with a single glMultiDrawElementsIndirect per material
+	/// </summary>
+	void SetMultiDrawEnabled(bool value);
+	bool IsMultiDrawEnabled() const;
+
+	/// <summary>
+	/// Sets whether culling and draw command generation should be split across worker threads.
+	/// All GL calls are still made from the main thread
+	/// </summary>
+	void SetMultithreadingEnabled(bool value);
+	bool IsMultithreadingEnabled() const;
+
+	/// <summary>
+	/// Gets the number of threads used for draw command generation, including the main thread
+	/// </summary>
+	uint32_t GetWorkerThreadCount() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -77,6 +151,233 @@ protected:
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
+	// Instance level uniforms for every draw in a frame are written into this arena up front,
+	// and each draw binds it's own slice of it
 	const int INSTANCE_UBO_BINDING = 1;
-	UniformBuffer<InstanceLevelUniforms>::Sptr _instanceUniforms;
+	RingBuffer::Sptr _instanceUniforms;
+	// The distance in bytes between instance blocks, respecting GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+	uint32_t         _instanceStride;
+
+	// Per-instance vertex attributes for instanced draws, matches the layout
+	// in fragments/vs_common.glsl when INSTANCED is defined
+	struct InstanceAttributes {
+		glm::mat4 ModelMatrix;
+		// Only the upper 3x3 is used, but we pad to a mat4 for alignment
+		glm::mat4 NormalMatrix;
+		// Takes the mesh's stored positions back into mesh space, only xyz is used
+		glm::vec4 PositionScale;
+		glm::vec4 PositionOffset;
+	};
+
+	// Takes a mesh's stored positions back into mesh space, as a scale and offset
+	struct PositionDequantization {
+		glm::vec4 Scale;
+		glm::vec4 Offset;
+	};
+
+	// Runs of render components sharing a mesh and material smaller than this are
+	// drawn normally, since instancing them wouldn't save anything
+	const uint32_t MIN_INSTANCE_BATCH_SIZE = 2;
+
+	// A single entry in our render queue, sorted by key so that objects
+	// sharing a shader, material and mesh are drawn back to back
+	struct RenderQueueEntry {
+		uint64_t                       SortKey;
+		std::weak_ptr<RenderComponent> Component;
+		// The component's state version when the entry was made, the entry is re-inserted if it changes
+		uint32_t                       StateVersion;
+		// Index into _instanceBatches, or -1 if this entry is not instanced
+		int32_t                        Batch;
+		// The slot of this entry in the instance attribute buffer
+		uint32_t                       InstanceSlot;
+		// The transform version of the object when it's instance data was last uploaded
+		uint32_t                       TransformVersion;
+		// True if the instance data needs to be uploaded regardless of the transform version
+		bool                           InstanceDirty;
+		// Where the entry's mesh lives in the batch's mesh pool (multi-draw batches only)
+		StaticMeshPool::MeshRange      MeshRange;
+	};
+
+	// A group of queue entries that will be drawn using instancing
+	struct InstanceBatch {
+		// The instanced variant of the material's shader
+		ShaderProgram::Sptr     Shader;
+		// A copy of the mesh's VAO with our instance buffer attached, or the pool's VAO for multi-draw batches
+		VertexArrayObject::Sptr Vao;
+		// The pool holding every mesh in the batch, or nullptr if the batch is a single mesh
+		StaticMeshPool::Sptr    Pool;
+	};
+
+	// A draw that has passed all our checks, and has had it's instance data written
+	struct DrawCommand {
+		RenderComponent* Renderable;
+		// The offset of the draw's uniforms in the instance arena (non-instanced draws only)
+		uint32_t         InstanceOffset;
+		// The batch, first instance slot and number of instances (instanced draws only)
+		int32_t          Batch;
+		uint32_t         BaseInstance;
+		uint32_t         InstanceCount;
+		// The first command in _indirectCommands and the number of commands (multi-draws only)
+		uint32_t         IndirectStart;
+		uint32_t         IndirectCount;
+	};
+
+	// The draws generated from one slice of the render queue. Indices stored in the commands are
+	// relative to the list, and are offset when the lists are merged
+	struct CommandPacketList {
+		std::vector<DrawCommand>                 Commands;
+		std::vector<DrawElementsIndirectCommand> IndirectCommands;
+		std::vector<glm::mat4>                   Models;
+		std::vector<glm::mat3>                   Normals;
+		std::vector<PositionDequantization>      Dequantizations;
+		// Ranges of instance slots that need to be uploaded, as (first slot, count)
+		std::vector<glm::uvec2>                  Uploads;
+		uint32_t                                 ObjectsVisible;
+		uint32_t                                 ObjectsCulled;
+		uint32_t                                 InstancesUploaded;
+
+		void Clear() {
+			Commands.clear();
+			IndirectCommands.clear();
+			Models.clear();
+			Normals.clear();
+			Dequantizations.clear();
+			Uploads.clear();
+			ObjectsVisible = 0;
+			ObjectsCulled = 0;
+			InstancesUploaded = 0;
+		}
+	};
+
+	// Tracks variants and VAOs we've created for instancing, along with the resource they were made from
+	struct InstancedShaderEntry {
+		std::weak_ptr<ShaderProgram> Source;
+		ShaderProgram::Sptr          Variant;
+	};
+	struct InstancedMeshEntry {
+		std::weak_ptr<VertexArrayObject> Source;
+		VertexArrayObject::Sptr          Vao;
+	};
+
+	// The sorted list of things to draw, persists between frames
+	std::vector<RenderQueueEntry> _renderQueue;
+	// The draws for the current frame, kept around to avoid re-allocating every frame
+	std::vector<DrawCommand>      _drawCommands;
+	// The model matrices of this frame's non-instanced draws, packed so their MVPs can be calculated in one pass
+	std::vector<glm::mat4>        _drawModels;
+	// The normal matrices of this frame's non-instanced draws, parallel to _drawModels
+	std::vector<glm::mat3>        _drawNormals;
+	// The position dequantization of this frame's non-instanced draws, parallel to _drawModels
+	std::vector<PositionDequantization> _drawDequantizations;
+	// Ranges of the instance buffer that need to be uploaded this frame, as (first slot, count)
+	std::vector<glm::uvec2>       _instanceUploads;
+
+	// Slices of the render queue smaller than this aren't worth handing to another thread
+	const size_t MIN_WORK_SLICE = 256;
+	bool                          _multithreadingEnabled;
+	ThreadPool::Sptr              _workerPool;
+	// One list per slice of the render queue, kept around to avoid re-allocating every frame
+	std::vector<CommandPacketList> _packetLists;
+
+	// The instanced batches, built alongside the render queue
+	std::vector<InstanceBatch>    _instanceBatches;
+	// CPU side copy of our per-instance data
+	std::vector<InstanceAttributes> _instanceAttributes;
+	// Per-instance data for all instanced batches, indexed by RenderQueueEntry::InstanceSlot
+	VertexBuffer::Sptr            _instanceBuffer;
+	// Cache of instanced shader variants, keyed on the source shader
+	std::unordered_map<const ShaderProgram*, InstancedShaderEntry>     _instancedShaders;
+	// Cache of instanced VAOs, keyed on the source VAO
+	std::unordered_map<const VertexArrayObject*, InstancedMeshEntry>   _instancedMeshes;
+
+	bool                          _multiDrawEnabled;
+	// Shared buffers for static meshes, one per vertex layout
+	std::vector<StaticMeshPool::Sptr> _meshPools;
+	// The indirect commands for the current frame, copied into _indirectBuffer once all draws are gathered
+	std::vector<DrawElementsIndirectCommand> _indirectCommands;
+	RingBuffer::Sptr              _indirectBuffer;
+	// The render component state version that the queue was last updated against
+	uint32_t                      _renderQueueVersion;
+	// The shared resource version that the queue was last rebuilt against, see RenderComponent::MarkRenderStateChanged
+	uint32_t                      _renderQueueSharedVersion;
+	// The scene the queue was built from
+	std::weak_ptr<Gameplay::Scene> _renderQueueScene;
+	// True if the whole queue needs to be rebuilt next frame, instead of just the components that changed
+	bool                          _rebuildRenderQueue;
+	// Small IDs for the shaders, materials and meshes in our sort keys. These stay the same between
+	// updates, so that new entries can be merged into the queue without re-keying the rest
+	std::unordered_map<const void*, uint64_t> _sortKeyIds;
+	// Stats for the last frame
+	RenderStats                   _renderStats;
+
+	bool                          _frustumCullingEnabled;
+	// World space bounding spheres for each entry in the render queue, as (center, radius)
+	std::vector<glm::vec4>        _cullSpheres;
+	// The result of culling for each entry in the render queue, 1 if visible
+	std::vector<uint8_t>          _cullResults;
+	// Indexed by spatial index proxy ID, 1 if the proxy's bounds were in the frustum this frame
+	std::vector<uint8_t>          _proxyVisible;
+
+	/// <summary>
+	/// Brings the render queue up to date with render components that have been added, removed,
+	/// or had their mesh or material changed. Only those components are removed from or merged
+	/// into the queue, everything else keeps it's place
+	/// </summary>
+	void _UpdateRenderQueue();
+	/// <summary>
+	/// Gets the ID of a shader, material or mesh for use in sort keys, handing out a new one if
+	/// this is the first time we've seen it
+	/// </summary>
+	uint64_t _GetSortKeyId(const void* resource);
+	/// <summary>
+	/// Finds what's in view using the scene's spatial index, then tests the world space bounds of
+	/// those entries against the camera frustum, storing the results in _cullResults
+	/// </summary>
+	/// <param name="viewProj">The view projection to extract the frustum from</param>
+	void _CullRenderQueue(const glm::mat4& viewProj);
+	/// <summary>
+	/// Generates the draws for a range of the render queue, writing instance data for any instanced
+	/// entries that moved. Only reads shared state besides the entries and instance slots in the range,
+	/// so it's safe to run for different ranges at the same time
+	/// </summary>
+	/// <param name="begin">The index of the first entry to process</param>
+	/// <param name="end">The index one past the last entry to process</param>
+	/// <param name="out">The list to write the draws into</param>
+	void _GatherDrawCommands(size_t begin, size_t end, CommandPacketList& out);
+	/// <summary>
+	/// Stitches the first count packet lists back together into _drawCommands, in queue order, merging
+	/// draws that were split across slices
+	/// </summary>
+	void _MergePacketLists(size_t count);
+	/// <summary>
+	/// Splits the render queue into runs sharing a mesh and material, and sets up instancing for
+	/// runs that are large enough and have an instanced shader available
+	/// </summary>
+	void _BuildInstanceBatches();
+	/// <summary>
+	/// Puts a queue entry into a batch, marking it's instance data for upload if it's slot moved
+	/// </summary>
+	void _AssignInstanceSlot(RenderQueueEntry& entry, int32_t batch, uint32_t slot);
+	/// <summary>
+	/// Tries to turn a run of queue entries sharing a shader and material into a single multi-draw
+	/// batch, which requires the run to have more than one draw, and every mesh in the run to fit
+	/// into the same mesh pool
+	/// </summary>
+	/// <param name="start">The index of the first entry in the run</param>
+	/// <param name="end">The index one past the last entry in the run</param>
+	/// <param name="instanceCount">The number of instance slots handed out so far, will be updated</param>
+	/// <returns>True if the run was batched</returns>
+	bool _BuildMultiDrawBatch(size_t start, size_t end, uint32_t& instanceCount);
+	/// <summary>
+	/// Gets or creates the mesh pool that can store the given mesh, or nullptr if it cannot be pooled
+	/// </summary>
+	StaticMeshPool::Sptr _GetMeshPool(const VertexArrayObject::Sptr& mesh);
+	/// <summary>
+	/// Gets or creates the INSTANCED variant of a shader, or nullptr if the shader does not support instancing
+	/// </summary>
+	const ShaderProgram::Sptr& _GetInstancedShader(const ShaderProgram::Sptr& shader);
+	/// <summary>
+	/// Gets or creates a copy of the given VAO with our instance buffer attached
+	/// </summary>
+	const VertexArrayObject::Sptr& _GetInstancedMesh(const VertexArrayObject::Sptr& mesh);
 };
\ No newline at end of file
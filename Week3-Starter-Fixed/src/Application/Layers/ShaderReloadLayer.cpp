@@ -0,0 +1,53 @@
+#include "Application/Layers/ShaderReloadLayer.h"
+#include "Logging.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/ShaderPreprocessor.h"
+#include "Utils/JsonGlmHelpers.h"
+
+#include <chrono>
+
+ShaderReloadLayer::ShaderReloadLayer() :
+	ApplicationLayer(),
+	_watcher(nullptr)
+{
+	Name = "Shader Reload";
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate;
+}
+
+ShaderReloadLayer::~ShaderReloadLayer() = default;
+
+void ShaderReloadLayer::OnAppLoad(const nlohmann::json& config) {
+	const nlohmann::json& layerConfig = config.contains(Name) ? config[Name] : GetDefaultConfig();
+	if (!JsonGet(layerConfig, "enabled", true)) {
+		return;
+	}
+
+	_watcher = std::make_shared<FileWatcher>(JsonGet<std::string>(layerConfig, "watch_path", "shaders"), ".glsl");
+	if (!_watcher->IsWatching()) {
+		_watcher = nullptr;
+	}
+}
+
+void ShaderReloadLayer::OnUpdate() {
+	if (_watcher == nullptr) {
+		return;
+	}
+
+	for (const std::string& path : _watcher->Poll()) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		// Make sure the next read of the file comes from disk, even if the write landed within the file system's time resolution
+		ShaderPreprocessor::Invalidate(path);
+		int reloaded = ShaderProgram::ReloadDependents(path);
+
+		double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		LOG_INFO("\"{}\" changed, reloaded {} shader programs in {:.2f}ms", path, reloaded, elapsedMs);
+	}
+}
+
+nlohmann::json ShaderReloadLayer::GetDefaultConfig() {
+	return {
+		{ "enabled",    true },
+		{ "watch_path", "shaders" }
+	};
+}
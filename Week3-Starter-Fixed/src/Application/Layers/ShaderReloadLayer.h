@@ -0,0 +1,25 @@
+#pragma once
+#include "Application/ApplicationLayer.h"
+#include "Utils/FileWatcher.h"
+#include <json.hpp>
+
+/**
+ * Watches the shader folder while the application is running, and relinks any shader programs that use
+ * a file when it's saved. Programs are reloaded in place, so materials keep their shaders and settings
+ */
+class ShaderReloadLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(ShaderReloadLayer)
+
+	ShaderReloadLayer();
+	virtual ~ShaderReloadLayer();
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnUpdate() override;
+	virtual nlohmann::json GetDefaultConfig() override;
+
+protected:
+	FileWatcher::Sptr _watcher;
+};
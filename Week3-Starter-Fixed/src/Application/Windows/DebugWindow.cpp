@@ -2,6 +2,12 @@
 #include "Application/Application.h"
 #include "Application/ApplicationLayer.h"
 #include "Application/Layers/RenderLayer.h"
+#include "Graphics/GpuProfiler.h"
+#include "Graphics/GlStateTracker.h"
+#include "Graphics/StreamingVertices.h"
+#include "Graphics/GpuMemoryTracker.h"
+#include "Utils/Profiler.h"
+#include "Utils/Benchmark.h"
 
 DebugWindow::DebugWindow() :
 	IEditorWindow()
@@ -37,4 +43,134 @@ void DebugWindow::RenderMenuBar()
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	ImGui::Separator();
+
+	bool culling = renderLayer->IsFrustumCullingEnabled();
+	if (ImGui::Checkbox("Frustum Culling", &culling)) {
+		renderLayer->SetFrustumCullingEnabled(culling);
+	}
+
+	bool multiDraw = renderLayer->IsMultiDrawEnabled();
+	if (ImGui::Checkbox("Multi-Draw Indirect", &multiDraw)) {
+		renderLayer->SetMultiDrawEnabled(multiDraw);
+	}
+
+	bool multithreaded = renderLayer->IsMultithreadingEnabled();
+	if (ImGui::Checkbox("Multithreaded Rendering", &multithreaded)) {
+		renderLayer->SetMultithreadingEnabled(multithreaded);
+	}
+	ImGui::SameLine();
+	ImGui::Text("(%u threads)", renderLayer->GetWorkerThreadCount());
+
+	const RenderLayer::RenderStats& stats = renderLayer->GetRenderStats();
+	ImGui::Text("Visible: %u (%u culled)", stats.ObjectsVisible, stats.ObjectsCulled);
+	ImGui::Text("Draws: %u", stats.DrawCalls);
+	ImGui::Text("Shader Binds: %u (%u avoided)", stats.ShaderBinds, stats.ShaderBindsAvoided);
+	ImGui::Text("Material Binds: %u (%u avoided)", stats.MaterialBinds, stats.MaterialBindsAvoided);
+	ImGui::Text("Material Instance Switches: %u", stats.MaterialInstanceSwitches);
+	ImGui::Text("Instanced: %u draws, %u objects (%u uploaded)", stats.InstancedDraws, stats.InstancesDrawn, stats.InstancesUploaded);
+	ImGui::Text("Multi-Draws: %u (%u commands)", stats.MultiDraws, stats.IndirectCommands);
+
+	ImGui::Separator();
+
+	const AABBTree& spatialIndex = app.CurrentScene()->GetSpatialIndex();
+	ImGui::Text("BVH: %d objects, height %d", spatialIndex.GetProxyCount(), spatialIndex.GetHeight());
+	const std::vector<Benchmark::Entry>& benchmarks = Benchmark::GetAll();
+	for (size_t ix = 0; ix < benchmarks.size(); ix++) {
+		if (ix > 0) {
+			ImGui::SameLine();
+		}
+		if (ImGui::Button(("Run " + std::string(benchmarks[ix].Name) + " Benchmark").c_str())) {
+			Benchmark::Run(benchmarks[ix]);
+		}
+	}
+
+	ImGui::Separator();
+
+	bool cpuProfiling = CpuProfiler::IsEnabled();
+	if (ImGui::Checkbox("CPU Profiler", &cpuProfiling)) {
+		CpuProfiler::SetEnabled(cpuProfiling);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome Trace")) {
+		CpuProfiler::ExportChromeTrace("cpu_trace.json");
+	}
+	ImGui::Text("CPU frame: %.3f ms", CpuProfiler::GetLastFrameMs());
+
+	bool gpuProfiling = GpuProfiler::IsEnabled();
+	if (ImGui::Checkbox("GPU Profiler", &gpuProfiling)) {
+		GpuProfiler::SetEnabled(gpuProfiling);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export CSV")) {
+		GpuProfiler::ExportCsv("gpu_profile.csv");
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Export JSON")) {
+		GpuProfiler::ExportJson("gpu_profile.json");
+	}
+
+	const GpuProfiler::FrameResult* gpuFrame = GpuProfiler::GetLatestFrame();
+	if (gpuFrame != nullptr) {
+		// Plot the total GPU time of every frame we've kept
+		const std::deque<GpuProfiler::FrameResult>& history = GpuProfiler::GetHistory();
+		float frameTimes[GpuProfiler::HISTORY_SIZE];
+		int frameCount = 0;
+		for (const GpuProfiler::FrameResult& frame : history) {
+			frameTimes[frameCount++] = static_cast<float>(frame.TotalMs);
+		}
+		ImGui::PlotLines("##GpuFrameTimes", frameTimes, frameCount, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+		ImGui::Text("GPU frame %llu (%u dropped)", gpuFrame->FrameIndex, GpuProfiler::GetDroppedFrameCount());
+
+		for (const GpuProfiler::ScopeResult& scope : gpuFrame->Scopes) {
+			ImGui::Text("%*s%-24s %7.3f ms (avg %7.3f ms)", scope.Depth * 2, "", scope.Name.c_str(), scope.DurationMs, scope.AverageMs);
+		}
+	}
+
+	ImGui::Separator();
+
+	bool validateState = GlStateTracker::IsValidationEnabled();
+	if (ImGui::Checkbox("Validate GL State", &validateState)) {
+		GlStateTracker::SetValidationEnabled(validateState);
+	}
+	const GlStateTracker::FrameStats& stateStats = GlStateTracker::GetLastFrameStats();
+	ImGui::Text("GL state calls: %u issued, %u skipped (%u mismatched)", stateStats.GetTotalIssued(), stateStats.GetTotalSkipped(), stateStats.Mismatches);
+	for (int ix = 0; ix < GlStateTracker::CATEGORY_COUNT; ix++) {
+		ImGui::Text("  %-16s %5u issued %5u skipped", GlStateTracker::GetCategoryName(static_cast<GlStateTracker::Category>(ix)), stateStats.Issued[ix], stateStats.Skipped[ix]);
+	}
+
+	ImGui::Separator();
+
+	const StreamingVertices::FrameStats& streamStats = StreamingVertices::GetLastFrameStats();
+	ImGui::Text("Streamed vertices: %u / %u KB in %u allocations", streamStats.BytesUsed / 1024, StreamingVertices::GetBuffer()->GetRegionSize() / 1024, streamStats.Allocations);
+	ImGui::Text("  %u failed allocations, %u reallocations", streamStats.FailedAllocations, streamStats.Reallocations);
+
+	ImGui::Separator();
+
+	const double bytesPerMb = 1024.0 * 1024.0;
+	ImGui::Text("GPU memory: %.1f MB (peak %.1f MB)", GpuMemoryTracker::GetTotalBytes() / bytesPerMb, GpuMemoryTracker::GetPeakBytes() / bytesPerMb);
+	if (GpuMemoryTracker::IsOverBudget()) {
+		ImGui::SameLine();
+		ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "OVER BUDGET");
+	}
+	int budgetMb = static_cast<int>(GpuMemoryTracker::GetBudget() / (1024 * 1024));
+	if (ImGui::InputInt("Budget (MB, 0 for none)", &budgetMb, 64, 256)) {
+		GpuMemoryTracker::SetBudget(budgetMb > 0 ? (size_t)budgetMb * 1024 * 1024 : 0);
+	}
+	if (ImGui::Button("Reset Peaks")) {
+		GpuMemoryTracker::ResetPeaks();
+	}
+	for (int ix = 0; ix < GpuMemoryTracker::CATEGORY_COUNT; ix++) {
+		GpuMemoryTracker::Category category = static_cast<GpuMemoryTracker::Category>(ix);
+		const GpuMemoryTracker::CategoryStats& memoryStats = GpuMemoryTracker::GetCategoryStats(category);
+		ImGui::Text("  %-16s %8.2f MB (peak %8.2f MB) in %4u resources", GpuMemoryTracker::GetCategoryName(category), memoryStats.Bytes / bytesPerMb, memoryStats.PeakBytes / bytesPerMb, memoryStats.ResourceCount);
+	}
+	if (ImGui::TreeNode("Largest GPU Resources")) {
+		for (const IGraphicsResource* resource : GpuMemoryTracker::GetLargestResources(16)) {
+			const std::string& name = resource->GetDebugName();
+			ImGui::Text("%8.2f MB  %-16s %s", resource->GetGpuMemorySize() / bytesPerMb, GpuMemoryTracker::GetCategoryName(resource->GetGpuMemoryCategory()), name.empty() ? "<unnamed>" : name.c_str());
+		}
+		ImGui::TreePop();
+	}
 }
@@ -3,6 +3,9 @@
 #include "Application/Timing.h"
 #include "Application/Application.h"
 #include "Utils/ImGuiHelper.h"
+#include "Graphics/GlStateTracker.h"
+
+static constexpr UniformHandle GravityUniform("u_Gravity");
 
 ParticleSystem::ParticleSystem() :
 	IComponent(),
@@ -23,6 +26,8 @@ ParticleSystem::ParticleSystem() :
 ParticleSystem::~ParticleSystem()
 {
 	if (_hasInit) {
+		GlStateTracker::OnBufferDeleted(_particleBuffers[0]);
+		GlStateTracker::OnBufferDeleted(_particleBuffers[1]);
 		glDeleteBuffers(2, _particleBuffers);
 		glDeleteTransformFeedbacks(2, _feedbackBuffers);
 		glDeleteQueries(1, &_query);
@@ -51,15 +56,15 @@ void ParticleSystem::Update()
 
 		// Set up our first transform feedback buffer to write to the first buffer
 		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[0]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
+		GlStateTracker::BindBuffer(GL_ARRAY_BUFFER, _particleBuffers[0]);
 		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[0]);
+		GlStateTracker::BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[0]);
 
 		// Set up the second transform feedback buffer to write to the second buffer
 		glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[1]);
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
+		GlStateTracker::BindBuffer(GL_ARRAY_BUFFER, _particleBuffers[1]);
 		glBufferData(GL_ARRAY_BUFFER, dataSize, data, GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
+		GlStateTracker::BindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[1]);
 
 		// We create a query object to track the number of particles we're simulating
 		glGenQueries(1, &_query);
@@ -70,13 +75,13 @@ void ParticleSystem::Update()
 
 
 	// Disable rasterization, this is update only
-	glEnable(GL_RASTERIZER_DISCARD);
+	GlStateTracker::Enable(GL_RASTERIZER_DISCARD);
 
 	// Make sure no VAOs are bound
-	glBindVertexArray(0);
+	GlStateTracker::BindVertexArray(0);
 
 	// Bind the buffer and transform feedback
-	glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
+	GlStateTracker::BindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
 	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[_currentFeedbackBuffer]);
 
 	// Enable our attributes, aside from color since it doesn't impact simulation
@@ -96,7 +101,7 @@ void ParticleSystem::Update()
 
 	// Bind the update shader and send our relevant uniforms
 	_updateShader->Bind();
-	_updateShader->SetUniform("u_Gravity", _gravity);
+	_updateShader->SetUniform(GravityUniform, _gravity);
 
 	// Our particles are points that we're simulating
 	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _query);
@@ -134,7 +139,7 @@ void ParticleSystem::Update()
 	glDisableVertexAttribArray(5);
 
 	// Re-enable rasterization for later OpenGL calls
-	glDisable(GL_RASTERIZER_DISCARD);
+	GlStateTracker::Disable(GL_RASTERIZER_DISCARD);
 
 	_hasInit = true;
 
@@ -152,10 +157,10 @@ void ParticleSystem::Render()
 		_renderShader->Bind();
 
 		// Make sure no VAOs are bound
-		glBindVertexArray(0);
+		GlStateTracker::BindVertexArray(0);
 
 		// Bind the current feedback buffer as our drawing buffer
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
+		GlStateTracker::BindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]);
 
 		// Enable just position and color
 		glEnableVertexAttribArray(1);
@@ -7,17 +7,30 @@
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
 	_mesh(mesh), 
 	_material(material), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
-{ }
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_stateVersion(0)
+{
+	_MarkStateChanged();
+}
 
 RenderComponent::RenderComponent() : 
 	_mesh(nullptr), 
 	_material(nullptr), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>())
-{ }
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_stateVersion(0)
+{
+	_MarkStateChanged();
+}
+
+RenderComponent::~RenderComponent() {
+	_renderStateVersion++;
+}
 
 void RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
-	_mesh = mesh;
+	if (_mesh != mesh) {
+		_mesh = mesh;
+		_MarkStateChanged();
+	}
 }
 
 const Gameplay::MeshResource::Sptr& RenderComponent::GetMeshResource() const {
@@ -29,7 +42,32 @@ VertexArrayObject::Sptr RenderComponent::GetMesh() const {
 }
 
 void RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
-	_material = mat;
+	if (_material != mat) {
+		_material = mat;
+		_MarkStateChanged();
+	}
+}
+
+uint32_t RenderComponent::GetRenderStateVersion() {
+	return _renderStateVersion;
+}
+
+uint32_t RenderComponent::GetStateVersion() const {
+	return _stateVersion;
+}
+
+void RenderComponent::MarkRenderStateChanged() {
+	_sharedStateVersion++;
+	// Also bump the render state, so anything watching that (ex: the scene's spatial index) updates
+	_renderStateVersion++;
+}
+
+uint32_t RenderComponent::GetSharedStateVersion() {
+	return _sharedStateVersion;
+}
+
+void RenderComponent::_MarkStateChanged() {
+	_stateVersion = ++_renderStateVersion;
 }
 
 const Gameplay::Material::Sptr& RenderComponent::GetMaterial() const {
@@ -47,6 +85,7 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 	RenderComponent::Sptr result = std::make_shared<RenderComponent>();
 	result->_mesh = ResourceManager::Get<Gameplay::MeshResource>(Guid(data["mesh"].get<std::string>()));
 	result->_material = ResourceManager::Get<Gameplay::Material>(Guid(data["material"].get<std::string>()));
+	result->_MarkStateChanged();
 
 	return result;
 }
@@ -57,5 +96,7 @@ void RenderComponent::RenderImGui() {
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
-	ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material);
+	if (ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material)) {
+		_MarkStateChanged();
+	}
 }
@@ -15,6 +15,7 @@ public:
 
 	RenderComponent();
 	RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material);
+	virtual ~RenderComponent();
 
 	/// <summary>
 	/// Gets the mesh resource which contains the mesh and serialization info for
@@ -42,6 +43,29 @@ public:
 	/// <param name="mat">The material for this object</param>
 	void SetMaterial(const Gameplay::Material::Sptr& mat);
 
+	/// <summary>
+	/// Gets a counter that is incremented whenever any render component is created, destroyed,
+	/// or has it's mesh or material changed, and when MarkRenderStateChanged is called. The render
+	/// layer uses this to determine when it's render queue needs to be rebuilt and re-sorted
+	/// </summary>
+	static uint32_t GetRenderStateVersion();
+	/// <summary>
+	/// Gets the value of the render state version when this component was created or last had it's
+	/// mesh or material changed. Lets the render layer find just the components that need to be
+	/// re-inserted into it's queue
+	/// </summary>
+	uint32_t GetStateVersion() const;
+	/// <summary>
+	/// Call when a resource shared by render components changes what they draw, ex: a material's shader
+	/// or a mesh resource's VAO. Components don't know which resources they share, so this makes the
+	/// render layer rebuild it's whole queue, it shouldn't be called every frame
+	/// </summary>
+	static void MarkRenderStateChanged();
+	/// <summary>
+	/// Gets a counter that is incremented whenever MarkRenderStateChanged is called
+	/// </summary>
+	static uint32_t GetSharedStateVersion();
+
 	// Inherited from IComponent
 
 	virtual void RenderImGui() override;
@@ -57,4 +81,17 @@ protected:
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
+
+	// The render state version when this component last changed
+	uint32_t _stateVersion;
+
+	/// <summary>
+	/// Bumps the render state version, and marks this component as changed in that version
+	/// </summary>
+	void _MarkStateChanged();
+
+	// Bumped whenever the set of renderables or their mesh/material changes
+	inline static uint32_t _renderStateVersion = 0;
+	// Bumped whenever a shared material or mesh resource changes what renderables draw
+	inline static uint32_t _sharedStateVersion = 0;
 };
\ No newline at end of file
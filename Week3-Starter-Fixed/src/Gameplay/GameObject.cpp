@@ -14,6 +14,9 @@
 #include "Gameplay/Scene.h"
 
 namespace Gameplay {
+	// Scales smaller than this are treated as this when inverting transforms
+	static const float MIN_INVERTIBLE_SCALE = 1e-6f;
+
 	GameObject::GameObject() :
 		IResource(),
 		Name("Unknown"),
@@ -28,7 +31,11 @@ namespace Gameplay {
 		_isLocalTransformDirty(true),
 		_worldTransform(MAT4_IDENTITY),
 		_inverseWorldTransform(MAT4_IDENTITY),
+		_normalMatrix(MAT3_IDENTITY),
 		_isWorldTransformDirty(true),
+		_transformVersion(0),
+		_spatialProxy(-1),
+		_spatialVersion(0),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
@@ -37,7 +44,16 @@ namespace Gameplay {
 	{
 		if (_isLocalTransformDirty) {
 			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
+			// Since we know the transform is made of a translation, rotation and scale, we can invert each
+			// part individually instead of doing a full 4x4 inverse. The inspector lets axes be scaled to zero,
+			// which has no inverse at all, so we clamp tiny scales away from zero to keep the result finite
+			glm::vec3 safeScale = _scale;
+			for (int ix = 0; ix < 3; ix++) {
+				if (glm::abs(safeScale[ix]) < MIN_INVERTIBLE_SCALE) {
+					safeScale[ix] = safeScale[ix] < 0.0f ? -MIN_INVERTIBLE_SCALE : MIN_INVERTIBLE_SCALE;
+				}
+			}
+			_inverseLocalTransform = glm::scale(MAT4_IDENTITY, 1.0f / safeScale) * glm::mat4_cast(glm::conjugate(_rotation)) * glm::translate(MAT4_IDENTITY, -_position);
 			_isLocalTransformDirty = false;
 			_isWorldTransformDirty = true;
 
@@ -62,7 +78,8 @@ namespace Gameplay {
 			// If out parent exists, we apply our local transformation relative to the parent's world transformation
 			if (parent != nullptr) {
 				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
+				// Building the inverse from the parts keeps it finite even if something in the chain has a zero scale
+				_inverseWorldTransform = _inverseLocalTransform * parent->GetInverseTransform();
 			}
 
 			// If our parent is null, we can simply use the local transform as the world transform
@@ -70,7 +87,20 @@ namespace Gameplay {
 				_worldTransform = _localTransform;
 				_inverseWorldTransform = _inverseLocalTransform;
 			}
+
+			// The inverse is already on hand, so the normal matrix is just a transpose away
+			_normalMatrix = glm::transpose(glm::mat3(_inverseWorldTransform));
 			_isWorldTransformDirty = false;
+			_transformVersion++;
+
+			// Our children are relative to our world transform, so they need to update as well. This
+			// carries the change all the way down the hierarchy, not just to our direct children
+			for (const auto& childPtr : _children) {
+				GameObject::Sptr childSptr = childPtr;
+				if (childSptr != nullptr) {
+					childSptr->_isWorldTransformDirty = true;
+				}
+			}
 		}
 	}
 
@@ -157,6 +187,11 @@ namespace Gameplay {
 		return _inverseWorldTransform;
 	}
 
+	const glm::mat3& GameObject::GetNormalMatrix() const {
+		_RecalcWorldTransform();
+		return _normalMatrix;
+	}
+
 	const glm::mat4& GameObject::GetLocalTransform() const
 	{
 		_RecalcLocalTransform();
@@ -168,6 +203,15 @@ namespace Gameplay {
 		return _inverseLocalTransform;
 	}
 
+	uint32_t GameObject::GetTransformVersion() const {
+		_RecalcWorldTransform();
+		return _transformVersion;
+	}
+
+	int32_t GameObject::GetSpatialProxy() const {
+		return _spatialProxy;
+	}
+
 	void GameObject::RenderGUI() {
 		// Prune children
 		auto it = std::remove_if(_children.begin(), _children.end(), [](const WeakRef& child) { return !child.IsAlive(); });
@@ -288,6 +332,7 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			child->_isWorldTransformDirty = true;
 			_children.erase(it);
 			return true;
 		} else {
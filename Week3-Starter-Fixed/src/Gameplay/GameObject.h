@@ -220,10 +220,27 @@ namespace Gameplay {
 		/// This matrix transforms points from world space to local space
 		/// </summary>
 		const glm::mat4& GetInverseTransform() const;
+		/// <summary>
+		/// Gets or recalculates the matrix used to transform normals from local space to world
+		/// space, which is the transpose of the inverse of the world transform's upper 3x3
+		/// </summary>
+		const glm::mat3& GetNormalMatrix() const;
 
 		const glm::mat4& GetLocalTransform() const;
 		const glm::mat4& GetInverseLocalTransform() const;
 
+		/// <summary>
+		/// Gets a counter that is incremented every time the world transform is recalculated,
+		/// allowing other systems to cache data derived from the transform
+		/// </summary>
+		uint32_t GetTransformVersion() const;
+
+		/// <summary>
+		/// Gets the ID of this object's proxy in the scene's spatial index, or AABBTree::NullNode
+		/// if it has not been added yet. Valid until the next Scene::UpdateSpatialIndex
+		/// </summary>
+		int32_t GetSpatialProxy() const;
+
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
 		/// </summary>
@@ -351,7 +368,13 @@ namespace Gameplay {
 
 		mutable glm::mat4 _worldTransform;
 		mutable glm::mat4 _inverseWorldTransform;
+		mutable glm::mat3 _normalMatrix;
 		mutable bool _isWorldTransformDirty;
+		mutable uint32_t _transformVersion;
+
+		// Our leaf in the scene's spatial index, and the transform version it was last updated with
+		int32_t  _spatialProxy;
+		uint32_t _spatialVersion;
 
 		// For the hierarchy
 		WeakRef _parent;
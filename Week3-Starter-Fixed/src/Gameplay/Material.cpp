@@ -1,4 +1,5 @@
 #include "Gameplay/Material.h"
+#include "Gameplay/Components/RenderComponent.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Graphics/Textures/TextureCube.h"
@@ -7,26 +8,121 @@
 #include "Utils/ImGuiHelper.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture3D.h"
+#include "Graphics/Textures/Texture2DArray.h"
+
+#include <algorithm>
 
 namespace Gameplay {
+	/// <summary>
+	/// Finds the member of the shader's parameter block that a material parameter name refers to
+	/// </summary>
+	/// <param name="shader">The shader to search</param>
+	/// <param name="name">The name of the parameter, ex: u_Material.Shininess</param>
+	/// <param name="out">Will store the member's info if found</param>
+	/// <returns>True if the shader has a parameter block containing the member</returns>
+	static bool FindParamBlockMember(const ShaderProgram::Sptr& shader, const std::string& name, ShaderProgram::UniformInfo* out) {
+		if (shader == nullptr || name.compare(0, Material::PARAM_BLOCK_PREFIX.size(), Material::PARAM_BLOCK_PREFIX) != 0) {
+			return false;
+		}
+		const ShaderProgram::UniformBlockInfo* block = shader->FindUniformBlock(Material::PARAM_BLOCK_NAME);
+		if (block == nullptr) {
+			return false;
+		}
+
+		// Block members are named after the block, not the instance name
+		std::string memberName = Material::PARAM_BLOCK_NAME + "." + name.substr(Material::PARAM_BLOCK_PREFIX.size());
+		for (const ShaderProgram::UniformInfo& member : block->SubUniforms) {
+			if (member.Name == memberName) {
+				*out = member;
+				return true;
+			}
+		}
+		return false;
+	}
+
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_parent(nullptr),
+		_paramBuffer(nullptr),
+		_paramBinding(-1),
+		_paramsDirtyBegin(0),
+		_paramsDirtyEnd(0),
+		_paramsVersion(0),
+		_layoutVersion(0),
+		_parentParamsVersion(0),
+		_parentLayoutVersion(0),
+		_textureUniforms(),
+		_looseUniforms(),
+		_textureSlots(),
+		_uniformListsDirty(true),
+		_shaderReloadCount(shader != nullptr ? shader->GetReloadCount() : 0)
 	{
 		_PopulateUniforms();
 	}
 
+	Material::Material(const Material::Sptr& parent) :
+		IResource(),
+		_shader(nullptr),
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_parent(parent != nullptr && parent->_parent != nullptr ? parent->_parent : parent),
+		_paramBuffer(nullptr),
+		_paramBinding(-1),
+		_paramsDirtyBegin(0),
+		_paramsDirtyEnd(0),
+		_paramsVersion(0),
+		_layoutVersion(0),
+		_parentParamsVersion(0),
+		_parentLayoutVersion(0),
+		_textureUniforms(),
+		_looseUniforms(),
+		_textureSlots(),
+		_uniformListsDirty(true),
+		_shaderReloadCount(0)
+	{
+		LOG_ASSERT(parent != nullptr, "Material instances need a parent");
+		Name = parent->Name + " (Instance)";
+
+		// Flatten instances of instances, so that the parent is always a root material
+		if (parent->_parent != nullptr) {
+			_uniforms = parent->_uniforms;
+			_parentLayoutVersion = parent->_parentLayoutVersion;
+			_RebuildParamOverrides();
+		} else {
+			_parentLayoutVersion = _parent->_layoutVersion;
+		}
+	}
+
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_parent(nullptr),
+		_paramBuffer(nullptr),
+		_paramBinding(-1),
+		_paramsDirtyBegin(0),
+		_paramsDirtyEnd(0),
+		_paramsVersion(0),
+		_layoutVersion(0),
+		_parentParamsVersion(0),
+		_parentLayoutVersion(0),
+		_textureUniforms(),
+		_looseUniforms(),
+		_textureSlots(),
+		_uniformListsDirty(true),
+		_shaderReloadCount(0)
 	{ }
 
 	void Material::Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize)
 	{
-		// Try and find the matching uniform
-		UniformData& uniform = _GetUniform(name);
+		// Try and find the matching uniform, instances store the value as an override that starts out as a copy of the parent's value
+		UniformData* found = _parent != nullptr ? _GetOverride(name) : &_GetUniform(name);
+		if (found == nullptr) {
+			LOG_WARN("Failed to set parameter \"{}\" in material instance \"{}\", parent has no such parameter", name, Name);
+			return;
+		}
+		UniformData& uniform = *found;
 
 		// We have a uniform, let's see if we can update it
 		if (uniform.Location != -2) {
@@ -48,6 +144,10 @@ namespace Gameplay {
 				else {
 					memcpy(uniform.Value, value, ShaderDataTypeSize(type));
 				}
+
+				if (uniform.IsBlockMember()) {
+					_WriteParam(uniform);
+				}
 			}
 		}
 		// We couldn't find that uniform, log a warning
@@ -56,44 +156,238 @@ namespace Gameplay {
 		}
 	}
 
+	ITexture::Sptr Material::GetTexture(const std::string& name) const {
+		auto it = _uniforms.find(name);
+		if (it != _uniforms.end() && it->second.Location >= 0 && it->second.IsTextureResource()) {
+			return it->second.TextureAsset;
+		}
+		// Anything an instance doesn't override comes from the parent
+		if (_parent != nullptr && it == _uniforms.end()) {
+			return _parent->GetTexture(name);
+		}
+		return nullptr;
+	}
+
 	const ShaderProgram::Sptr& Material::GetShader() const {
-		return _shader;
+		return _parent != nullptr ? _parent->_shader : _shader;
+	}
+
+	void Material::SetShader(const ShaderProgram::Sptr& shader) {
+		if (_parent != nullptr) {
+			LOG_WARN("Cannot change the shader of material instance \"{}\", change the shader of \"{}\" instead", Name, _parent->Name);
+			return;
+		}
+		if (shader == _shader) {
+			return;
+		}
+
+		_shader = shader;
+		_SyncWithShader();
+
+		// Renderers using this material (or it's instances) are now in a different shader bucket
+		RenderComponent::MarkRenderStateChanged();
+	}
+
+	void Material::_SyncWithShader() {
+		std::unordered_map<std::string, UniformData> oldUniforms = std::move(_uniforms);
+		_uniforms.clear();
+		_textureUniforms.clear();
+		_looseUniforms.clear();
+		_uniformListsDirty = true;
+		_shaderReloadCount = _shader != nullptr ? _shader->GetReloadCount() : 0;
+
+		if (_shader == nullptr) {
+			_paramBuffer = nullptr;
+			return;
+		}
+		_PopulateUniforms();
+
+		// Carry over any values that still make sense for the new shader
+		for (auto& [name, old] : oldUniforms) {
+			if (old.Location < 0) {
+				continue;
+			}
+
+			UniformData& data = _GetUniform(name);
+			if (data.Location < 0 || data.Type != old.Type || data.ArraySize != old.ArraySize) {
+				continue;
+			}
+			data.CopyValue(old);
+		}
+	}
+
+	const Material::Sptr& Material::GetParent() const {
+		return _parent;
+	}
+
+	const Material* Material::GetRoot() const {
+		return _parent != nullptr ? _parent.get() : this;
+	}
+
+	bool Material::IsInstance() const {
+		return _parent != nullptr;
+	}
+
+	bool Material::IsOverridden(const std::string& name) const {
+		return _parent != nullptr && _uniforms.find(name) != _uniforms.end();
+	}
+
+	void Material::ClearOverride(const std::string& name) {
+		if (_parent == nullptr) {
+			return;
+		}
+		auto it = _uniforms.find(name);
+		if (it == _uniforms.end()) {
+			return;
+		}
+
+		bool wasBlockMember = it->second.IsBlockMember();
+		_uniforms.erase(it);
+		_uniformListsDirty = true;
+		if (wasBlockMember) {
+			_RebuildParamOverrides();
+		}
 	}
 
 	void Material::Apply() {
+		// Instances apply their parent, then send whatever they override on top
+		if (_parent != nullptr) {
+			_parent->Apply();
+			_Prepare();
+			_ApplyOverrides(_parent->_shader);
+			return;
+		}
+
 		if (_shader != nullptr) {
+			_Prepare();
+
 			// Skip the reserved # of texture slots
 			int textureSlot = 0;
 			
-			// Iterate over the uniforms map
-			for (auto&[name, data] : _uniforms) {
-				// The typecode is basically the underlying type of the uniform
-				// ex: float, matrix, texture, etc...
-				ShaderDataTypecode typeCode = GetShaderDataTypeCode(data.Type);
-
-				// If the uniform is a texture, we try and bind it, then move to the next slot
-				if (typeCode == ShaderDataTypecode::Texture) {
-					if (textureSlot >= MAX_TEXTURE_SLOTS) {
-						LOG_WARN("Ignoring material binding, exceeds allowed number of textures");
-					}
-					else {
-						ITexture::Sptr texture = data.TextureAsset;
-						if (texture != nullptr) {
-							texture->Bind(textureSlot);
-						}
-						else {
-							ITexture::Unbind(textureSlot);
-						}
-						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
-						textureSlot++;
-					}
+			// Bind all our textures, moving to the next slot for each one
+			for (UniformData* data : _textureUniforms) {
+				if (textureSlot >= MAX_TEXTURE_SLOTS) {
+					LOG_WARN("Ignoring material binding, exceeds allowed number of textures");
+					break;
+				}
+
+				ITexture::Sptr texture = data->TextureAsset;
+				if (texture != nullptr) {
+					texture->Bind(textureSlot);
 				}
-				// The uniform is a plain ol' value type, send it in
 				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+					ITexture::Unbind(textureSlot);
 				}
+				// Send the slot to the shader
+				_shader->SetUniform(data->Location, data->Type, &textureSlot);
+				textureSlot++;
 			}
+
+			// Uniforms that aren't in the parameter block are plain ol' value types, send them in
+			for (UniformData* data : _looseUniforms) {
+				_shader->SetUniform(data->Location, data->Type, data->ArraySize > 1 ? data->ArrayBlock : data->Value, data->ArraySize);
+			}
+
+			// The rest of the parameters only need to be uploaded if they've changed
+			if (_paramBuffer != nullptr) {
+				_UploadParams();
+				_paramBuffer->Bind(_paramBinding);
+			}
+		}
+	}
+
+	void Material::Apply(const ShaderProgram::Sptr& variant) {
+		// Same program, we can use the locations we already know about
+		if (variant == GetShader() || variant == nullptr) {
+			Apply();
+			return;
+		}
+
+		if (_parent != nullptr) {
+			_parent->Apply(variant);
+			_Prepare();
+			_ApplyOverrides(variant);
+			return;
+		}
+
+		_Prepare();
+
+		int textureSlot = 0;
+		ShaderProgram::UniformInfo info;
+		for (UniformData* data : _textureUniforms) {
+			if (textureSlot >= MAX_TEXTURE_SLOTS) {
+				break;
+			}
+
+			// Textures still consume a slot if the variant doesn't have them, so that slots match the base shader
+			if (data->TextureAsset != nullptr) {
+				data->TextureAsset->Bind(textureSlot);
+			} else {
+				ITexture::Unbind(textureSlot);
+			}
+			if (variant->FindUniform(data->Name, &info)) {
+				variant->SetUniform(info.Location, data->Type, &textureSlot);
+			}
+			textureSlot++;
+		}
+
+		// Uniforms that the variant doesn't have are skipped
+		for (UniformData* data : _looseUniforms) {
+			if (variant->FindUniform(data->Name, &info)) {
+				variant->SetUniform(info.Location, data->Type, data->ArraySize > 1 ? data->ArrayBlock : data->Value, data->ArraySize);
+			}
+		}
+
+		// Variants declare the same parameter block, so they can share our buffer
+		if (_paramBuffer != nullptr) {
+			_UploadParams();
+			_paramBuffer->Bind(_paramBinding);
+		}
+	}
+
+	void Material::ApplyOverrides(const Material::Sptr& previous, const ShaderProgram::Sptr& variant) {
+		Material* root = _parent != nullptr ? _parent.get() : this;
+		LOG_ASSERT(previous != nullptr && previous->GetRoot() == root, "Materials do not share a root material");
+		const ShaderProgram::Sptr& shader = variant != nullptr ? variant : root->_shader;
+
+		root->_Prepare();
+		_Prepare();
+		previous->_Prepare();
+
+		// Anything the previous instance overrode that we don't goes back to the root's value
+		if (previous->_parent != nullptr) {
+			for (size_t ix = 0; ix < previous->_textureUniforms.size(); ix++) {
+				if (IsOverridden(previous->_textureUniforms[ix]->Name)) {
+					continue;
+				}
+				int slot = previous->_textureSlots[ix];
+				const ITexture::Sptr& texture = root->_textureUniforms[slot]->TextureAsset;
+				if (texture != nullptr) {
+					texture->Bind(slot);
+				} else {
+					ITexture::Unbind(slot);
+				}
+			}
+			for (UniformData* data : previous->_looseUniforms) {
+				if (IsOverridden(data->Name)) {
+					continue;
+				}
+				auto it = root->_uniforms.find(data->Name);
+				if (it != root->_uniforms.end()) {
+					_SendUniform(it->second, shader);
+				}
+			}
+		}
+
+		if (_parent != nullptr) {
+			_ApplyOverrides(shader);
+		}
+
+		// Block members live in whole buffers, so we just need to switch back to the root's buffer
+		// if the previous instance had it's own and we don't
+		if (_paramBuffer == nullptr && previous->_paramBuffer != nullptr && root->_paramBuffer != nullptr) {
+			root->_UploadParams();
+			root->_paramBuffer->Bind(root->_paramBinding);
 		}
 	}
 
@@ -104,12 +398,51 @@ namespace Gameplay {
 
 		ImGuiHelper::ResourceDragSource(this, Name);
 
-		if (open) {
+		if (open && _parent != nullptr) {
+			ImGui::Text("Instance of: %s (%u overrides)", _parent->Name.c_str(), (uint32_t)_uniforms.size());
+
+			// Show the parent's parameters, editing one that we don't override yet creates an override
+			std::string cleared;
+			for (auto& [key, value] : _parent->_uniforms) {
+				if (value.Location < 0) {
+					continue;
+				}
+
+				auto it = _uniforms.find(key);
+				if (it != _uniforms.end()) {
+					if (it->second.RenderImGui() && it->second.IsBlockMember()) {
+						_WriteParam(it->second);
+					}
+					ImGui::PushID(key.c_str());
+					if (ImGui::SmallButton("Use parent value")) {
+						cleared = key;
+					}
+					ImGui::PopID();
+				} else {
+					UniformData copy = value;
+					if (copy.RenderImGui()) {
+						UniformData& data = _uniforms.emplace(key, std::move(copy)).first->second;
+						_uniformListsDirty = true;
+						if (data.IsBlockMember()) {
+							_WriteParam(data);
+						}
+					}
+				}
+			}
+			if (!cleared.empty()) {
+				ClearOverride(cleared);
+			}
+
+			ImGui::Separator();
+		}
+		else if (open) {
 			ImGui::Text("Shader: %s", _shader != nullptr ? _shader->GetDebugName().c_str() : "null");
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
-					value.RenderImGui();
+					if (value.RenderImGui() && value.IsBlockMember()) {
+						_WriteParam(value);
+					}
 				}
 			}
 
@@ -122,16 +455,51 @@ namespace Gameplay {
 
 	Material::Sptr Material::Clone() const
 	{
+		// Instances only need their overrides copied, the parent is shared
+		if (_parent != nullptr) {
+			Material::Sptr result = std::make_shared<Material>(_parent);
+			result->Name = Name;
+			result->_uniforms = _uniforms;
+			result->_parentLayoutVersion = _parentLayoutVersion;
+			result->_RebuildParamOverrides();
+			return result;
+		}
+
 		// hehe, neat lil' hack
 		return FromJson(ToJson());
 	}
 
 	Material::Sptr Material::FromJson(const nlohmann::json& data) {
+		// Instances are loaded on top of their parent, which only has to be loaded first
+		if (data.contains("parent") && data["parent"].is_string()) {
+			Material::Sptr parent = ResourceManager::Get<Material>(Guid(data["parent"].get<std::string>()));
+			if (parent == nullptr) {
+				LOG_ERROR("Failed to load parent of material instance \"{}\"", data["name"].get<std::string>());
+			} else {
+				Material::Sptr result = std::make_shared<Material>(parent);
+				result->OverrideGUID(Guid(data["guid"]));
+				result->Name = data["name"].get<std::string>();
+
+				if (data.contains("parameters") && data["parameters"].is_object()) {
+					for (auto& [key, value] : data["parameters"].items()) {
+						Material::UniformData uniform = Material::UniformData::FromJson(value, key, result->_parent->_shader);
+						// Skip anything the parent doesn't use, such as reserved textures
+						if (uniform.Location >= 0 && result->_parent->_GetUniform(key).Location >= 0) {
+							result->_uniforms[key] = uniform;
+						}
+					}
+				}
+				result->_RebuildParamOverrides();
+				return result;
+			}
+		}
+
 		// Load in basic material info like shader and name
 		Material::Sptr result = std::make_shared<Material>();
 		result->OverrideGUID(Guid(data["guid"]));
 		result->Name = data["name"].get<std::string>();
 		result->_shader = ResourceManager::Get<ShaderProgram>(Guid(data["shader"]));
+		result->_shaderReloadCount = result->_shader != nullptr ? result->_shader->GetReloadCount() : 0;
 		result->_PopulateUniforms();
 
 		// material specific parameters'
@@ -145,10 +513,26 @@ namespace Gameplay {
 				}
 			}
 		}
+		// The loaded values still need to be written to the parameter block
+		result->_uniformListsDirty = true;
 		return result;
 	}
 
 	nlohmann::json Material::ToJson() const { 
+		// Instances only store their parent and overrides
+		if (_parent != nullptr) {
+			nlohmann::json result = {
+				{ "guid", GetGUID().str() },
+				{ "name", Name },
+				{ "parent", _parent->GetGUID().str() },
+				{ "parameters", nlohmann::json::object() }
+			};
+			for (auto& [key, value] : _uniforms) {
+				result["parameters"][key] = value.ToJson();
+			}
+			return result;
+		}
+
 		nlohmann::json result ={
 			{ "guid", GetGUID().str() },
 			{ "name", Name },
@@ -180,18 +564,303 @@ namespace Gameplay {
 					data = UniformData(name, _shader);
 				}
 			} else {
-				data.Location = -1;
+				// May be a member of the parameter block
+				data = UniformData(name, _shader);
+				if (data.Location == -2) {
+					data.Location = -1;
+				}
 			}
+			_uniformListsDirty = true;
 		}
 		return data;
 	}
 
 	void Material::_PopulateUniforms()
 	{
+		_CreateParamBuffer();
+
 		const auto& uniforms = _shader->GetUniforms();
 		for (const auto& [key, value] : uniforms) {
 			_uniforms[key] = _GetUniform(key);
 		}
+
+		// Parameter block members aren't in the shader's uniform list, add them under the names materials use
+		const ShaderProgram::UniformBlockInfo* block = _shader->FindUniformBlock(PARAM_BLOCK_NAME);
+		if (block != nullptr) {
+			for (const ShaderProgram::UniformInfo& member : block->SubUniforms) {
+				_GetUniform(PARAM_BLOCK_PREFIX + member.Name.substr(PARAM_BLOCK_NAME.size() + 1));
+			}
+		}
+	}
+
+	void Material::_CreateParamBuffer()
+	{
+		_paramBuffer = nullptr;
+		_paramBinding = -1;
+		_paramsDirtyBegin = _paramsDirtyEnd = 0;
+		_layoutVersion++;
+
+		const ShaderProgram::UniformBlockInfo* block = _shader != nullptr ? _shader->FindUniformBlock(PARAM_BLOCK_NAME) : nullptr;
+		if (block != nullptr) {
+			_paramBuffer = std::make_shared<AbstractUniformBuffer>(block->SizeInBytes);
+			_paramBinding = block->CurrentBinding;
+			_MarkParamsDirty(0, _paramBuffer->GetSize());
+		}
+	}
+
+	void Material::_WriteParam(const UniformData& uniform)
+	{
+		// Instances get their own copy of the parent's block the first time they override one of it's members,
+		// which also writes this parameter
+		if (_paramBuffer == nullptr) {
+			if (_parent != nullptr) {
+				_CopyParentParams();
+			}
+			return;
+		}
+
+		ShaderDataTypecode typeCode = GetShaderDataTypeCode(uniform.Type);
+		uint32_t elemSize = ShaderDataTypeSize(uniform.Type);
+		const uint8_t* source = uniform.ArraySize > 1 ? (const uint8_t*)uniform.ArrayBlock : uniform.Value;
+		uint8_t* dest = _paramBuffer->GetRawData() + uniform.BlockOffset;
+		uint32_t end = uniform.BlockOffset;
+
+		// std140 pads array elements and matrix columns, so we copy them one at a time using the strides from the shader
+		size_t count = uniform.ArraySize > 1 ? uniform.ArraySize : 1;
+		for (size_t ix = 0; ix < count; ix++) {
+			const uint8_t* elemSource = source + elemSize * ix;
+			uint8_t* elemDest = dest + uniform.ArrayStride * ix;
+			LOG_ASSERT(elemDest + elemSize <= _paramBuffer->GetRawData() + _paramBuffer->GetSize(), "Parameter exceeds the bounds of the parameter block");
+
+			if (typeCode == ShaderDataTypecode::Matrix || typeCode == ShaderDataTypecode::MatrixD) {
+				uint32_t columns = ((uint32_t)uniform.Type & ShaderDataType_Size2Mask) >> 3;
+				uint32_t columnSize = elemSize / columns;
+				for (uint32_t c = 0; c < columns; c++) {
+					memcpy(elemDest + uniform.MatrixStride * c, elemSource + columnSize * c, columnSize);
+				}
+				end = (uint32_t)(elemDest - _paramBuffer->GetRawData()) + uniform.MatrixStride * (columns - 1) + columnSize;
+			}
+			// Bools are 4 bytes on the GPU
+			else if (typeCode == ShaderDataTypecode::Bool) {
+				for (uint32_t c = 0; c < elemSize; c++) {
+					uint32_t value = elemSource[c] ? 1 : 0;
+					memcpy(elemDest + sizeof(uint32_t) * c, &value, sizeof(uint32_t));
+				}
+				end = (uint32_t)(elemDest - _paramBuffer->GetRawData()) + sizeof(uint32_t) * elemSize;
+			}
+			else {
+				memcpy(elemDest, elemSource, elemSize);
+				end = (uint32_t)(elemDest - _paramBuffer->GetRawData()) + elemSize;
+			}
+		}
+
+		// Only the bytes we touched need to be uploaded
+		_MarkParamsDirty(uniform.BlockOffset, end);
+		_paramsVersion++;
+	}
+
+	void Material::_MarkParamsDirty(uint32_t begin, uint32_t end)
+	{
+		if (_paramsDirtyBegin >= _paramsDirtyEnd) {
+			_paramsDirtyBegin = begin;
+			_paramsDirtyEnd = end;
+		} else {
+			_paramsDirtyBegin = std::min(_paramsDirtyBegin, begin);
+			_paramsDirtyEnd = std::max(_paramsDirtyEnd, end);
+		}
+	}
+
+	void Material::_UploadParams()
+	{
+		if (_paramBuffer != nullptr && _paramsDirtyBegin < _paramsDirtyEnd) {
+			_paramBuffer->Update(_paramsDirtyBegin, _paramsDirtyEnd - _paramsDirtyBegin);
+			_paramsDirtyBegin = _paramsDirtyEnd = 0;
+		}
+	}
+
+	void Material::_RebuildUniformLists()
+	{
+		_textureUniforms.clear();
+		_looseUniforms.clear();
+		_textureSlots.clear();
+
+		// Instance overrides use the slots that the parent assigned to the textures
+		if (_parent != nullptr) {
+			for (auto& [name, data] : _uniforms) {
+				if (data.Location < 0 || data.IsBlockMember()) {
+					continue;
+				}
+
+				if (data.IsTextureResource()) {
+					const std::vector<UniformData*>& parentTextures = _parent->_textureUniforms;
+					for (int slot = 0; slot < (int)parentTextures.size() && slot < MAX_TEXTURE_SLOTS; slot++) {
+						if (parentTextures[slot]->Name == name) {
+							_textureUniforms.push_back(&data);
+							_textureSlots.push_back(slot);
+							break;
+						}
+					}
+				} else {
+					_looseUniforms.push_back(&data);
+				}
+			}
+			_uniformListsDirty = false;
+			return;
+		}
+
+		for (auto& [name, data] : _uniforms) {
+			// Skip uniforms the shader doesn't have, or that are reserved
+			if (data.Location < 0) {
+				continue;
+			}
+
+			if (data.IsBlockMember()) {
+				_WriteParam(data);
+			}
+			else if (data.IsTextureResource()) {
+				_textureUniforms.push_back(&data);
+			}
+			else {
+				_looseUniforms.push_back(&data);
+			}
+		}
+		_uniformListsDirty = false;
+		// Texture slots may have been re-assigned, instances will need to look them up again
+		_layoutVersion++;
+	}
+
+	void Material::_Prepare()
+	{
+		if (_parent != nullptr) {
+			_parent->_Prepare();
+			// If the parent was re-synced with it's shader, our copies of it's uniforms may be out of date
+			if (_parentLayoutVersion != _parent->_layoutVersion) {
+				_SyncWithParent();
+			}
+			// If the parent's parameter block changed, our copy of it needs to be updated
+			else if (_paramBuffer != nullptr && _parentParamsVersion != _parent->_paramsVersion) {
+				_CopyParentParams();
+			}
+		}
+		else if (_shader != nullptr && _shader->GetReloadCount() != _shaderReloadCount) {
+			// If the shader was reloaded, our locations and block offsets may have moved
+			_SyncWithShader();
+		}
+
+		if (_uniformListsDirty) {
+			_RebuildUniformLists();
+		}
+	}
+
+	Material::UniformData* Material::_GetOverride(const std::string& name)
+	{
+		auto it = _uniforms.find(name);
+		if (it != _uniforms.end()) {
+			return &it->second;
+		}
+
+		const UniformData& source = _parent->_GetUniform(name);
+		if (source.Location < 0) {
+			return nullptr;
+		}
+		_uniformListsDirty = true;
+		return &_uniforms.emplace(name, source).first->second;
+	}
+
+	void Material::_SyncWithParent()
+	{
+		std::unordered_map<std::string, UniformData> oldUniforms = std::move(_uniforms);
+		_uniforms.clear();
+		_uniformListsDirty = true;
+		_parentLayoutVersion = _parent->_layoutVersion;
+
+		// Keep any overrides that still match the parent's uniforms
+		for (auto& [name, old] : oldUniforms) {
+			auto it = _parent->_uniforms.find(name);
+			if (it == _parent->_uniforms.end() || it->second.Location < 0 || it->second.Type != old.Type || it->second.ArraySize != old.ArraySize) {
+				continue;
+			}
+			UniformData& data = _uniforms.emplace(name, it->second).first->second;
+			data.CopyValue(old);
+		}
+
+		_RebuildParamOverrides();
+	}
+
+	void Material::_CopyParentParams()
+	{
+		_parent->_Prepare();
+
+		const AbstractUniformBuffer::Sptr& source = _parent->_paramBuffer;
+		if (source == nullptr) {
+			_paramBuffer = nullptr;
+			return;
+		}
+
+		if (_paramBuffer == nullptr || _paramBuffer->GetSize() != source->GetSize()) {
+			_paramBuffer = std::make_shared<AbstractUniformBuffer>(source->GetSize());
+		}
+		_paramBinding = _parent->_paramBinding;
+		memcpy(_paramBuffer->GetRawData(), source->GetRawData(), source->GetSize());
+		_MarkParamsDirty(0, source->GetSize());
+		_parentParamsVersion = _parent->_paramsVersion;
+
+		// Our overrides go on top of the parent's values
+		for (auto& [name, data] : _uniforms) {
+			if (data.Location >= 0 && data.IsBlockMember()) {
+				_WriteParam(data);
+			}
+		}
+	}
+
+	void Material::_RebuildParamOverrides()
+	{
+		for (auto& [name, data] : _uniforms) {
+			if (data.Location >= 0 && data.IsBlockMember()) {
+				_CopyParentParams();
+				return;
+			}
+		}
+		// Nothing in the block is overridden, so we can go back to sharing the parent's buffer
+		_paramBuffer = nullptr;
+		_paramBinding = -1;
+		_paramsDirtyBegin = _paramsDirtyEnd = 0;
+	}
+
+	void Material::_ApplyOverrides(const ShaderProgram::Sptr& shader)
+	{
+		// The parent already pointed the samplers at these slots, we just need to bind our textures
+		for (size_t ix = 0; ix < _textureUniforms.size(); ix++) {
+			const ITexture::Sptr& texture = _textureUniforms[ix]->TextureAsset;
+			if (texture != nullptr) {
+				texture->Bind(_textureSlots[ix]);
+			} else {
+				ITexture::Unbind(_textureSlots[ix]);
+			}
+		}
+
+		for (UniformData* data : _looseUniforms) {
+			_SendUniform(*data, shader);
+		}
+
+		if (_paramBuffer != nullptr) {
+			_UploadParams();
+			_paramBuffer->Bind(_paramBinding);
+		}
+	}
+
+	void Material::_SendUniform(const UniformData& data, const ShaderProgram::Sptr& shader) const
+	{
+		const void* value = data.ArraySize > 1 ? data.ArrayBlock : data.Value;
+		// Our locations are for the root's shader, variants need to be matched by name
+		if (shader == GetShader()) {
+			shader->SetUniform(data.Location, data.Type, value, data.ArraySize);
+		} else {
+			ShaderProgram::UniformInfo info;
+			if (shader->FindUniform(data.Name, &info)) {
+				shader->SetUniform(info.Location, data.Type, value, data.ArraySize);
+			}
+		}
 	}
 
 	bool Material::UniformData::RenderImGui() {
@@ -403,7 +1072,16 @@ namespace Gameplay {
 	{
 		// We extract the uniform info from the shader to populate our info
 		ShaderProgram::UniformInfo uniform;
-		if (shader != nullptr && shader->FindUniform(uniformName, &uniform)) {
+		bool found = shader != nullptr && shader->FindUniform(uniformName, &uniform);
+		// Parameter block members use their offset as their location
+		if (!found && FindParamBlockMember(shader, uniformName, &uniform)) {
+			found = true;
+			BlockOffset = uniform.Location;
+			ArrayStride = uniform.ArrayStride;
+			MatrixStride = uniform.MatrixStride;
+		}
+
+		if (found) {
 			Name = uniformName;
 			Location = uniform.Location;
 			Type = uniform.Type;
@@ -424,6 +1102,10 @@ namespace Gameplay {
 		Location = other.Location;
 		ArraySize = other.ArraySize;
 		Type = other.Type;
+		BindingSlot = other.BindingSlot;
+		BlockOffset = other.BlockOffset;
+		ArrayStride = other.ArrayStride;
+		MatrixStride = other.MatrixStride;
 
 		if (GetShaderDataTypeCode(Type) == ShaderDataTypecode::Texture) {
 			TextureAsset = other.TextureAsset;
@@ -440,10 +1122,14 @@ namespace Gameplay {
 	Material::UniformData::UniformData(UniformData&& other) :
 		TextureAsset(nullptr) 
 	{
-		Name      = other.Name;
-		Location  = other.Location;
-		ArraySize = other.ArraySize;
-		Type      = other.Type;
+		Name         = other.Name;
+		Location     = other.Location;
+		ArraySize    = other.ArraySize;
+		Type         = other.Type;
+		BindingSlot  = other.BindingSlot;
+		BlockOffset  = other.BlockOffset;
+		ArrayStride  = other.ArrayStride;
+		MatrixStride = other.MatrixStride;
 
 		if (GetShaderDataTypeCode(Type) == ShaderDataTypecode::Texture) {
 			TextureAsset = other.TextureAsset;
@@ -458,6 +1144,17 @@ namespace Gameplay {
 		}
 	}
 
+	void Material::UniformData::CopyValue(const UniformData& other) {
+		LOG_ASSERT(Type == other.Type && ArraySize == other.ArraySize, "Uniforms do not have the same type");
+		if (IsTextureResource()) {
+			TextureAsset = other.TextureAsset;
+		} else if (ArraySize > 1) {
+			memcpy(ArrayBlock, other.ArrayBlock, ShaderDataTypeSize(Type) * ArraySize);
+		} else {
+			memcpy(Value, other.Value, ShaderDataTypeSize(Type));
+		}
+	}
+
 	Material::UniformData::~UniformData()
 	{
 		// Explicitly release the texture asset handle, since it's in a union
@@ -786,12 +1483,14 @@ namespace Gameplay {
 			case ShaderDataType::Tex3D_Uint:
 				result.TextureAsset = ResourceManager::Get<Texture3D>(Guid(blob["value"].get<std::string>()));
 				break;
+			case ShaderDataType::Tex2D_Array:
+				result.TextureAsset = ResourceManager::Get<Texture2DArray>(Guid(blob["value"].get<std::string>()));
+				break;
 			case ShaderDataType::Tex1D_Array:
 			case ShaderDataType::Tex1D_Shadow:
 			case ShaderDataType::Tex1D_ShadowArray:
 			case ShaderDataType::Tex2D_Rect:
 			case ShaderDataType::Tex2D_Rect_Shadow:
-			case ShaderDataType::Tex2D_Array:
 			case ShaderDataType::Tex2D_Shadow:
 			case ShaderDataType::Tex2D_ShadowArray:
 			case ShaderDataType::Tex2D_MultisampleArray:
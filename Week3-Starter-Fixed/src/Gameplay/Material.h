@@ -2,11 +2,17 @@
 #include <memory>
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/ITexture.h"
+#include "Graphics/Buffers/UniformBuffer.h"
 
 namespace Gameplay {
 	/// <summary>
 	/// Helper structure for material parameters to our shader
 	/// THIS IS VERY TEMPORARY
+	///
+	/// A material can also be an instance of another material. Instances use their parent's shader and
+	/// parameters, and only store the parameters that have been set on them (overrides). An instance
+	/// shares it's parent's parameter block until one of the block's members is overridden, at which
+	/// point it gets it's own copy of the block
 	/// </summary>
 	class Material : public IResource {
 	public:
@@ -19,6 +25,18 @@ namespace Gameplay {
 		/// </summary>
 		static const int MAX_TEXTURE_SLOTS = 14;
 
+		/// <summary>
+		/// If the shader declares a uniform block with this name, the material packs the block's members
+		/// into a UBO that is only uploaded when a parameter changes, instead of setting them one at a time.
+		/// Fragment shaders declare it as std140 at binding 3, with the same members as their u_Material
+		/// </summary>
+		inline static const std::string PARAM_BLOCK_NAME = "b_Material";
+		/// <summary>
+		/// Members of the parameter block are set under this prefix, so they keep the names they had as
+		/// members of the u_Material struct (ex: b_Material.Shininess is set as u_Material.Shininess)
+		/// </summary>
+		inline static const std::string PARAM_BLOCK_PREFIX = "u_Material.";
+
 		/// <summary>
 		/// A human readable name for the material
 		/// </summary>
@@ -33,6 +51,12 @@ namespace Gameplay {
 		/// </summary>
 		/// <param name="shader">The shader for the material</param>
 		Material(const ShaderProgram::Sptr& shader);
+		/// <summary>
+		/// Creates an instance of another material. If the parent is itself an instance, the new instance
+		/// starts with a copy of it's overrides and uses the parent's root material instead
+		/// </summary>
+		/// <param name="parent">The material to create an instance of</param>
+		Material(const Material::Sptr& parent);
 
 		/// <summary>
 		/// Sets a material parameter with the given name and type
@@ -55,16 +79,66 @@ namespace Gameplay {
 		/// <param name="arraySize">The array size in the event that the value is an array</param>
 		void Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize = 1ul);
 
+		/// <summary>
+		/// Gets the texture assigned to a texture parameter
+		/// </summary>
+		/// <param name="name">The name of the parameter, should match the uniform name</param>
+		/// <returns>The texture, or nullptr if the parameter is not set or is not a texture</returns>
+		ITexture::Sptr GetTexture(const std::string& name) const;
+
 		/// <summary>
 		/// Gets the shader that this material is using
 		/// </summary>
 		const ShaderProgram::Sptr& GetShader() const;
+		/// <summary>
+		/// Switches the material to a different shader, keeping the values of any parameters
+		/// that the new shader has with the same name and type
+		/// </summary>
+		/// <param name="shader">The shader for the material to use</param>
+		void SetShader(const ShaderProgram::Sptr& shader);
+
+		/// <summary>
+		/// Gets the material that this material is an instance of, or nullptr if it is not an instance
+		/// </summary>
+		const Material::Sptr& GetParent() const;
+		/// <summary>
+		/// Gets the material that this material gets it's shader and default parameters from,
+		/// which is the material itself if it is not an instance
+		/// </summary>
+		const Material* GetRoot() const;
+		/// <summary>
+		/// Returns true if this material is an instance of another material
+		/// </summary>
+		bool IsInstance() const;
+		/// <summary>
+		/// Returns true if this material is an instance that overrides the given parameter
+		/// </summary>
+		/// <param name="name">The name of the parameter, should match the uniform name</param>
+		bool IsOverridden(const std::string& name) const;
+		/// <summary>
+		/// Removes an instance's override for a parameter, so that it uses the parent's value again
+		/// </summary>
+		/// <param name="name">The name of the parameter, should match the uniform name</param>
+		void ClearOverride(const std::string& name);
 
 		/// <summary>
 		/// Handles applying this material's state to the OpenGL pipeline
-		/// Will bind the shader, update material uniforms, and bind textures
+		/// Will bind textures, update loose uniforms, and bind the parameter block
 		/// </summary>
 		virtual void Apply();
+		/// <summary>
+		/// Applies this material's state to a variant of it's shader (ex: an instanced version), 
+		/// matching uniforms by name since locations may differ between programs
+		/// </summary>
+		/// <param name="variant">The shader program to apply the material to</param>
+		void Apply(const ShaderProgram::Sptr& variant);
+		/// <summary>
+		/// Applies this material when the last material applied to the program shares it's root
+		/// material, by only sending the parameters that either material overrides
+		/// </summary>
+		/// <param name="previous">The material that was last applied, must have the same root material</param>
+		/// <param name="variant">The shader program to apply the material to, or nullptr for the material's shader</param>
+		void ApplyOverrides(const Material::Sptr& previous, const ShaderProgram::Sptr& variant = nullptr);
 
 		/// <summary>
 		/// Renders some UI controls for manipulating a material at runtime
@@ -108,6 +182,11 @@ namespace Gameplay {
 			// The size of the array, in elements
 			size_t         ArraySize;
 			int            BindingSlot;
+			// The offset and strides of the uniform in the parameter block, BlockOffset is -1 for
+			// uniforms that aren't in the block. Location matches BlockOffset for block members
+			int            BlockOffset = -1;
+			int            ArrayStride = 0;
+			int            MatrixStride = 0;
 
 			// The type of uniform
 			ShaderDataType Type = ShaderDataType::None;
@@ -118,6 +197,9 @@ namespace Gameplay {
 				TextureAsset(nullptr),
 				ArraySize(0),
 				BindingSlot(-1),
+				BlockOffset(-1),
+				ArrayStride(0),
+				MatrixStride(0),
 				Type(ShaderDataType::None) 
 			{ }
 			UniformData(const UniformData& other);
@@ -127,6 +209,11 @@ namespace Gameplay {
 			UniformData(const std::string& uniformName, const ShaderProgram::Sptr& shader);
 			~UniformData();
 
+			/// <summary>
+			/// Copies the value of another uniform with the same type and array size
+			/// </summary>
+			void CopyValue(const UniformData& other);
+
 			/// <summary>
 			/// Renders GUI for this uniform
 			/// </summary>
@@ -164,6 +251,13 @@ namespace Gameplay {
 			inline bool IsTextureResource() const {
 				return GetShaderDataTypeCode(Type) == ShaderDataTypecode::Texture;
 			}
+
+			/// <summary>
+			/// Returns true if the uniform is stored in the material's parameter block
+			/// </summary>
+			inline bool IsBlockMember() const {
+				return BlockOffset >= 0;
+			}
 		};
 	
 		/// <summary>
@@ -171,11 +265,95 @@ namespace Gameplay {
 		/// </summary>
 		ShaderProgram::Sptr    _shader;
 		/// <summary>
-		/// The uniforms that the material will be modifying
+		/// The uniforms that the material will be modifying. For instances, these are only the overrides
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
 
+		/// <summary>
+		/// The root material this material is an instance of, nullptr if it is not an instance
+		/// </summary>
+		Material::Sptr              _parent;
+
+		/// <summary>
+		/// Backing storage for the parameter block, nullptr if the shader does not have one, or if
+		/// this is an instance that doesn't override any of the block's members
+		/// </summary>
+		AbstractUniformBuffer::Sptr _paramBuffer;
+		int                         _paramBinding;
+		// The range of bytes in the parameter buffer that need to be uploaded, empty if begin >= end
+		uint32_t                    _paramsDirtyBegin;
+		uint32_t                    _paramsDirtyEnd;
+
+		// Bumped whenever the parameter block's contents change
+		uint32_t                    _paramsVersion;
+		// Bumped whenever our uniforms are looked up again or our texture slots are re-assigned
+		uint32_t                    _layoutVersion;
+		// The parent's versions when an instance last copied from it
+		uint32_t                    _parentParamsVersion;
+		uint32_t                    _parentLayoutVersion;
+
+		/// <summary>
+		/// The uniforms that Apply needs to send one at a time, so it doesn't need to walk the map.
+		/// Elements in an unordered_map don't move, so these stay valid until the map is changed
+		/// </summary>
+		std::vector<UniformData*>   _textureUniforms;
+		std::vector<UniformData*>   _looseUniforms;
+		// For instances, the parent's texture slot for each of the entries in _textureUniforms
+		std::vector<int>            _textureSlots;
+		bool                        _uniformListsDirty;
+
+		// The reload count of the shader when we last looked up it's uniforms
+		uint32_t                    _shaderReloadCount;
+
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
+		/// <summary>
+		/// Creates the parameter buffer if the shader has a parameter block
+		/// </summary>
+		void _CreateParamBuffer();
+		/// <summary>
+		/// Copies a block member's value into the parameter buffer using the std140 layout from the shader
+		/// </summary>
+		void _WriteParam(const UniformData& uniform);
+		void _MarkParamsDirty(uint32_t begin, uint32_t end);
+		/// <summary>
+		/// Uploads the dirty range of the parameter buffer
+		/// </summary>
+		void _UploadParams();
+		/// <summary>
+		/// Rebuilds the texture and loose uniform lists, and re-writes the whole parameter block
+		/// </summary>
+		void _RebuildUniformLists();
+		void _SyncWithShader();
+		/// <summary>
+		/// Makes sure our uniform lists and parameter block match the shader (or our parent) before applying
+		/// </summary>
+		void _Prepare();
+
+		/// <summary>
+		/// Gets an instance's override for a parameter, creating it from the parent's value if needed
+		/// </summary>
+		/// <returns>The override, or nullptr if the parent does not have the parameter</returns>
+		UniformData* _GetOverride(const std::string& name);
+		/// <summary>
+		/// Re-creates an instance's overrides from the parent's uniforms, keeping their values
+		/// </summary>
+		void _SyncWithParent();
+		/// <summary>
+		/// Copies the parent's parameter block into ours, and writes our block overrides on top
+		/// </summary>
+		void _CopyParentParams();
+		/// <summary>
+		/// Creates or releases an instance's parameter buffer depending on whether it overrides any block members
+		/// </summary>
+		void _RebuildParamOverrides();
+		/// <summary>
+		/// Sends an instance's overrides to the given program, and binds it's parameter block if it has one
+		/// </summary>
+		void _ApplyOverrides(const ShaderProgram::Sptr& shader);
+		/// <summary>
+		/// Sends a non-texture, non-block uniform to the given program
+		/// </summary>
+		void _SendUniform(const UniformData& data, const ShaderProgram::Sptr& shader) const;
 	};
 }
\ No newline at end of file
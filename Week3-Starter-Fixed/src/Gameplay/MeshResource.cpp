@@ -2,24 +2,27 @@
 #include <filesystem>
 
 #include "Utils/ObjLoader.h"
+#include "Gameplay/Components/RenderComponent.h"
 
 namespace Gameplay {
 	MeshResource::MeshResource() :
 		IResource(),
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
+		Packing(VertexPacking::None),
 		Mesh(nullptr),
 		BulletTriMesh(nullptr)
 	{ }
 
-	MeshResource::MeshResource(const std::string& filename) :
+	MeshResource::MeshResource(const std::string& filename, VertexPacking packing) :
 		IResource(),
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
+		Packing(packing),
 		Mesh(nullptr),
 		BulletTriMesh(nullptr)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		Mesh = ObjLoader::LoadFromFile(filename, true, packing);
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -36,12 +39,14 @@ namespace Gameplay {
 		} else {
 			result["filename"] = Filename.empty() ? "null" : Filename;
 		}
+		result["packing"] = ~Packing;
 		return result;
 	}
 
 	MeshResource::Sptr MeshResource::FromJson(const nlohmann::json & blob)
 	{
 		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->Packing = JsonParseEnum(VertexPacking, blob, "packing", VertexPacking::None);
 		if (blob.contains("params") && blob["params"].is_array()) {
 			std::vector<nlohmann::json> meshbuilderParams = blob["params"].get<std::vector<nlohmann::json>>();
 			MeshBuilder<VertexPosNormTexColTangents> mesh;
@@ -51,14 +56,14 @@ namespace Gameplay {
 				MeshFactory::AddParameterized(mesh, p);
 			}
 			MeshFactory::CalculateTBN(mesh);
-			result->Mesh = mesh.Bake();
+			result->Mesh = mesh.Bake(result->Packing);
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
 				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
+				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename, result->Packing);
 				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
+				result->Mesh = ObjLoader::LoadFromFile(result->Filename, true, result->Packing);
 				#endif
 
 			}
@@ -72,7 +77,10 @@ namespace Gameplay {
 			MeshFactory::AddParameterized(mesh, param);
 		}
 		MeshFactory::CalculateTBN(mesh);
-		Mesh = mesh.Bake();
+		Mesh = mesh.Bake(Packing);
+
+		// Renderers using this resource need new batches and bounds for the new VAO
+		RenderComponent::MarkRenderStateChanged();
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
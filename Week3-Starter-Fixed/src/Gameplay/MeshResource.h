@@ -1,6 +1,7 @@
 #pragma once
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexPacking.h"
 #include "Utils/MeshFactory.h"
 
 // bullet triangle mesh pre-declaration
@@ -22,7 +23,8 @@ namespace Gameplay {
 		/// Constructor for loading from file
 		/// </summary>
 		/// <param name="filename"></param>
-		MeshResource(const std::string& filename);
+		/// <param name="packing">How to store the mesh's vertices on the GPU</param>
+		MeshResource(const std::string& filename, VertexPacking packing = VertexPacking::None);
 
 		virtual ~MeshResource();
 
@@ -35,9 +37,16 @@ namespace Gameplay {
 		/// The mesh builder parameters if this mesh resource is created at runtime
 		/// </summary>
 		std::vector<MeshBuilderParam>   MeshBuilderParams;
+		/// <summary>
+		/// How the mesh's vertices are stored on the GPU, packing them trades some precision
+		/// for a much smaller vertex buffer
+		/// </summary>
+		VertexPacking                   Packing;
 
 		/// <summary>
-		/// The VAO for rendering this mesh in OpenGL
+		/// The VAO for rendering this mesh in OpenGL. If this is replaced after render components are
+		/// using the resource, call RenderComponent::MarkRenderStateChanged so they pick up the new mesh
+		/// (GenerateMesh does this for you)
 		/// </summary>
 		VertexArrayObject::Sptr         Mesh;
 
@@ -4,6 +4,7 @@
 #include "Gameplay/GameObject.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Components/RenderComponent.h"
+#include "Graphics/VertexPacking.h"
 
 #include "Utils/GlmBulletConversions.h"
 
@@ -90,7 +91,7 @@ namespace Gameplay::Physics {
 			if (vertBuff != nullptr) {
 				// Shorthand our buffers
 				IndexBuffer::Sptr indexBuff = vao->GetIndexBuffer();
-				VertexBuffer::Sptr vertexBuff = vertBuff->GetBuffer();
+				IBuffer::Sptr vertexBuff = vertBuff->GetBuffer();
 
 				// Create the bullet physics triangle mesh
 				_triMesh = new btTriangleMesh();
@@ -116,6 +117,9 @@ namespace Gameplay::Physics {
 				glGetNamedBufferSubData(vertexBuff->GetHandle(), 0, vertexBuff->GetTotalSize(), vertexStore);
 				_triMesh->preallocateVertices(vao->GetVertexCount());
 
+				// Quantized meshes store positions relative to their bounds, so we need to expand them back out
+				const glm::mat4& dequantization = vao->GetPositionDequantization();
+
 				// If our data is indexed, we use the index buffer to add our triangles
 				if (indexBuff != nullptr) {
 					// Allocate and read space for the indices
@@ -130,9 +134,9 @@ namespace Gameplay::Physics {
 						int i3 = getBufferIndex(indexBuff, indexStore, static_cast<int>(ix + 2));
 
 						// Find the positions for the indices
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i1) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i2) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + (posAttrib.Stride * i3) + posAttrib.Offset);
+						glm::vec3 p1 = VertexPacker::ReadPosition(vertexStore + (posAttrib.Stride * i1), posAttrib, dequantization);
+						glm::vec3 p2 = VertexPacker::ReadPosition(vertexStore + (posAttrib.Stride * i2), posAttrib, dequantization);
+						glm::vec3 p3 = VertexPacker::ReadPosition(vertexStore + (posAttrib.Stride * i3), posAttrib, dequantization);
 
 						// Add the triangle
 						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
@@ -146,9 +150,9 @@ namespace Gameplay::Physics {
 				else {
 					// Iterate over triangles, and add each to the mesh
 					for (size_t ix = 0; ix < vertexBuff->GetElementCount(); ix+=3) {
-						glm::vec3 p1 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 0) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p2 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 1) * posAttrib.Stride) + posAttrib.Offset);
-						glm::vec3 p3 = *reinterpret_cast<glm::vec3*>(vertexStore + ((ix + 2) * posAttrib.Stride) + posAttrib.Offset);
+						glm::vec3 p1 = VertexPacker::ReadPosition(vertexStore + ((ix + 0) * posAttrib.Stride), posAttrib, dequantization);
+						glm::vec3 p2 = VertexPacker::ReadPosition(vertexStore + ((ix + 1) * posAttrib.Stride), posAttrib, dequantization);
+						glm::vec3 p3 = VertexPacker::ReadPosition(vertexStore + ((ix + 2) * posAttrib.Stride), posAttrib, dequantization);
 						_triMesh->addTriangle(ToBt(p1), ToBt(p2), ToBt(p3));
 					}
 				}
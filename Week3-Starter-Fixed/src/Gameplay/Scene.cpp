@@ -6,21 +6,29 @@
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
+#include "Utils/Profiler.h"
 
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
+#include "Gameplay/Components/RenderComponent.h"
 
 #include "Graphics/DebugDraw.h"
 #include "Graphics/Textures/TextureCube.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/GlStateTracker.h"
 #include "Application/Application.h"
 
 namespace Gameplay {
+	static constexpr UniformHandle ClippedViewUniform("u_ClippedView");
+	static constexpr UniformHandle EnvironmentRotationUniform("u_EnvironmentRotation");
+
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_spatialIndex(AABBTree()),
+		_spatialRenderVersion(0),
 		Lights(std::vector<Light>()),
 		IsPlaying(false),
 		MainCamera(nullptr),
@@ -136,6 +144,7 @@ namespace Gameplay {
 	}
 
 	void Scene::Awake() {
+		PROFILE_FUNCTION();
 		// Not a huge fan of this, but we need to get window size to notify our camera
 		// of the current screen size
 		Application& app = Application::Get();
@@ -162,6 +171,7 @@ namespace Gameplay {
 	}
 
 	void Scene::DoPhysics(float dt) {
+		PROFILE_FUNCTION();
 		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
 			body->PhysicsPreStep(dt);
 		});
@@ -171,7 +181,10 @@ namespace Gameplay {
 
 		if (IsPlaying) {
 
-			_physicsWorld->stepSimulation(dt, 1);
+			{
+				PROFILE_ZONE("btDynamicsWorld::stepSimulation");
+				_physicsWorld->stepSimulation(dt, 1);
+			}
 
 			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
 				body->PhysicsPostStep(dt);
@@ -190,6 +203,7 @@ namespace Gameplay {
 	}
 
 	void Scene::Update(float dt) {
+		PROFILE_FUNCTION();
 		_FlushDeleteQueue();
 		if (IsPlaying) {
 			for (auto& obj : _objects) {
@@ -200,7 +214,99 @@ namespace Gameplay {
 	}
 
 	void Scene::PreRender() {
+		PROFILE_FUNCTION();
 		_lightingUbo->Bind(LIGHT_UBO_BINDING);
+		UpdateSpatialIndex();
+	}
+
+	// Gets the world space bounds of an object, using it's mesh if it has one, or it's position otherwise
+	static BoundingBox CalcWorldBounds(GameObject* object) {
+		const glm::mat4& transform = object->GetTransform();
+
+		RenderComponent::Sptr renderable = object->Get<RenderComponent>();
+		VertexArrayObject::Sptr mesh = renderable != nullptr ? renderable->GetMesh() : nullptr;
+		if (mesh != nullptr && mesh->GetBounds().IsValid()) {
+			return mesh->GetBounds().Transform(transform);
+		}
+
+		glm::vec3 position = glm::vec3(transform[3]);
+		return BoundingBox(position, position);
+	}
+
+	void Scene::UpdateSpatialIndex() {
+		PROFILE_FUNCTION();
+		// If meshes have been swapped out, any object's bounds may have changed
+		bool renderStateChanged = _spatialRenderVersion != RenderComponent::GetRenderStateVersion();
+		_spatialRenderVersion = RenderComponent::GetRenderStateVersion();
+
+		// Walk the hierarchy from the roots down, so that parents are always resolved before their
+		// children. Visiting in list order would leave a child listed before it's moved parent dirty
+		// until someone else asked for it's transform
+		for (const auto& object : _objects) {
+			if (object->GetParent() == nullptr) {
+				_UpdateSpatialProxy(object.get(), renderStateChanged);
+			}
+		}
+	}
+
+	void Scene::_UpdateSpatialProxy(GameObject* object, bool renderStateChanged) {
+		// Grabbing the transform will recalculate it if it's dirty, bumping the version
+		object->GetTransform();
+		uint32_t version = object->GetTransformVersion();
+
+		if (object->_spatialProxy == AABBTree::NullNode) {
+			object->_spatialProxy = _spatialIndex.CreateProxy(CalcWorldBounds(object), object);
+		} else if (renderStateChanged || object->_spatialVersion != version) {
+			_spatialIndex.MoveProxy(object->_spatialProxy, CalcWorldBounds(object));
+		}
+		object->_spatialVersion = version;
+
+		for (const auto& childPtr : object->GetChildren()) {
+			GameObject::Sptr child = childPtr;
+			if (child != nullptr) {
+				_UpdateSpatialProxy(child.get(), renderStateChanged);
+			}
+		}
+	}
+
+	void Scene::QueryBox(const BoundingBox& box, std::vector<GameObject::Sptr>& results) const {
+		_spatialIndex.QueryBox(box, [&](int32_t, void* userData) {
+			results.push_back(reinterpret_cast<GameObject*>(userData)->SelfRef());
+			return true;
+		});
+	}
+
+	void Scene::QuerySphere(const BoundingSphere& sphere, std::vector<GameObject::Sptr>& results) const {
+		_spatialIndex.QuerySphere(sphere, [&](int32_t, void* userData) {
+			results.push_back(reinterpret_cast<GameObject*>(userData)->SelfRef());
+			return true;
+		});
+	}
+
+	void Scene::QueryFrustum(const Frustum& frustum, std::vector<GameObject::Sptr>& results) const {
+		_spatialIndex.QueryFrustum(frustum, [&](int32_t, void* userData) {
+			results.push_back(reinterpret_cast<GameObject*>(userData)->SelfRef());
+			return true;
+		});
+	}
+
+	GameObject::Sptr Scene::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance /*= nullptr*/) const {
+		GameObject* closest = nullptr;
+		float closestDistance = maxDistance;
+
+		_spatialIndex.RayCast(origin, direction, maxDistance, [&](int32_t, void* userData, float distance) {
+			if (distance < closestDistance || closest == nullptr) {
+				closest = reinterpret_cast<GameObject*>(userData);
+				closestDistance = distance;
+			}
+			// Only look for hits that are closer than our current one
+			return closestDistance;
+		});
+
+		if (outDistance != nullptr && closest != nullptr) {
+			*outDistance = closestDistance;
+		}
+		return closest != nullptr ? closest->SelfRef() : nullptr;
 	}
 
 	void Scene::RenderGUI()
@@ -251,6 +357,7 @@ namespace Gameplay {
 
 	Scene::Sptr Scene::FromJson(const nlohmann::json& data)
 	{
+		PROFILE_FUNCTION();
 
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
@@ -343,6 +450,7 @@ namespace Gameplay {
 
 	Scene::Sptr Scene::Load(const std::string& path)
 	{
+		PROFILE_FUNCTION();
 		LOG_INFO("Loading scene from \"{}\"", path);
 		std::string content = FileHelpers::ReadFile(path);
 		nlohmann::json blob = nlohmann::json::parse(content);
@@ -394,6 +502,10 @@ namespace Gameplay {
 			if (weakPtr.expired()) continue;
 			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
 			if (it != _objects.end()) {
+				if ((*it)->_spatialProxy != AABBTree::NullNode) {
+					_spatialIndex.DestroyProxy((*it)->_spatialProxy);
+					(*it)->_spatialProxy = AABBTree::NullNode;
+				}
 				_objects.erase(it);
 			}
 		}
@@ -423,21 +535,21 @@ namespace Gameplay {
 			_skyboxTexture != nullptr &&
 			MainCamera != nullptr) {
 			
-			glDepthMask(false);
-			glDisable(GL_CULL_FACE);
-			glDepthFunc(GL_LEQUAL); 
+			GlStateTracker::DepthMask(false);
+			GlStateTracker::Disable(GL_CULL_FACE);
+			GlStateTracker::DepthFunc(GL_LEQUAL);
 
 			_skyboxShader->Bind();
-			_skyboxShader->SetUniformMatrix("u_ClippedView", MainCamera->GetProjection() * glm::mat4(glm::mat3(MainCamera->GetView())));
-			_skyboxShader->SetUniformMatrix("u_EnvironmentRotation", _skyboxRotation);
+			_skyboxShader->SetUniformMatrix(ClippedViewUniform, MainCamera->GetProjection() * glm::mat4(glm::mat3(MainCamera->GetView())));
+			_skyboxShader->SetUniformMatrix(EnvironmentRotationUniform, _skyboxRotation);
 			_skyboxTexture->Bind(0);
 			_skyboxMesh->Mesh->Draw();
 
-			glDepthFunc(GL_LESS);
-			glEnable(GL_CULL_FACE);
-			glDepthMask(true);
+			GlStateTracker::DepthFunc(GL_LESS);
+			GlStateTracker::Enable(GL_CULL_FACE);
+			GlStateTracker::DepthMask(true);
 
 		}
 	}
 
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -11,6 +11,8 @@
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/Textures/Texture3D.h"
 
+#include "Utils/AABBTree.h"
+
 struct GLFWwindow;
 
 class TextureCube;
@@ -158,6 +160,51 @@ namespace Gameplay {
 		/// </summary>
 		void RenderGUI();
 
+		/// <summary>
+		/// Brings the spatial index up to date with objects that have been added, moved, or had their
+		/// meshes changed. Only objects whose transforms changed are touched in the tree
+		/// 
+		/// Every object's world transform is resolved (parents before children) as part of this, so
+		/// afterwards transforms can be read from other threads until something moves again
+		/// 
+		/// This is called from PreRender, call it manually if queries need to see changes made
+		/// earlier in the same frame
+		/// </summary>
+		void UpdateSpatialIndex();
+		/// <summary>
+		/// Finds all objects whose bounds overlap the given box. Note that results are found using
+		/// slightly expanded bounds, so objects just outside the box may be included
+		/// </summary>
+		/// <param name="box">The world space box to search</param>
+		/// <param name="results">The list to append the objects to</param>
+		void QueryBox(const BoundingBox& box, std::vector<GameObject::Sptr>& results) const;
+		/// <summary>
+		/// Finds all objects whose bounds overlap the given sphere, see QueryBox
+		/// </summary>
+		/// <param name="sphere">The world space sphere to search</param>
+		/// <param name="results">The list to append the objects to</param>
+		void QuerySphere(const BoundingSphere& sphere, std::vector<GameObject::Sptr>& results) const;
+		/// <summary>
+		/// Finds all objects whose bounds are at least partially inside the given frustum, see QueryBox
+		/// </summary>
+		/// <param name="frustum">The frustum to search, ex: Frustum(camera->GetViewProjection())</param>
+		/// <param name="results">The list to append the objects to</param>
+		void QueryFrustum(const Frustum& frustum, std::vector<GameObject::Sptr>& results) const;
+		/// <summary>
+		/// Finds the closest object whose bounds are hit by the given ray
+		/// </summary>
+		/// <param name="origin">The start point of the ray, in world space</param>
+		/// <param name="direction">The normalized direction of the ray</param>
+		/// <param name="maxDistance">The maximum distance to search along the ray</param>
+		/// <param name="outDistance">If not null, receives the distance along the ray to the hit</param>
+		/// <returns>The closest object, or nullptr if nothing was hit</returns>
+		GameObject::Sptr Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, float* outDistance = nullptr) const;
+		/// <summary>
+		/// Gets the bounding volume hierarchy that stores all objects in the scene, user
+		/// data for each proxy is the GameObject*
+		/// </summary>
+		const AABBTree& GetSpatialIndex() const { return _spatialIndex; }
+
 		/// <summary>
 		/// Handles setting the shader uniforms for our light structure in our array of lights
 		/// </summary>
@@ -243,6 +290,11 @@ namespace Gameplay {
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Dynamic AABB tree of all our objects, used for spatial queries
+		AABBTree                 _spatialIndex;
+		// The RenderComponent state version the spatial index was last updated with
+		uint32_t                 _spatialRenderVersion;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -295,5 +347,13 @@ namespace Gameplay {
 		void _CleanupPhysics();
 
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Resolves an object's world transform and updates it's spatial proxy, then does the same for
+		/// all of it's children
+		/// </summary>
+		/// <param name="object">The object to update</param>
+		/// <param name="renderStateChanged">True if every proxy should be refreshed, since meshes may have changed</param>
+		void _UpdateSpatialProxy(GameObject* object, bool renderStateChanged);
 	};
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "IBuffer.h"
 #include "Logging.h"
+#include "Graphics/GlStateTracker.h"
 
 IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 	IGraphicsResource(),
@@ -9,6 +10,7 @@ IBuffer::IBuffer(BufferType type, BufferUsage usage) :
 {
 	_type = type;
 	_usage = usage;
+	_gpuMemoryCategory = type == BufferType::Uniform ? GpuMemoryTracker::Category::UniformBuffer : GpuMemoryTracker::Category::Mesh;
 	glCreateBuffers(1, &_rendererId);
 }
 
@@ -18,6 +20,7 @@ GlResourceType IBuffer::GetResourceClass() const {
 
 IBuffer::~IBuffer() {
 	if (_rendererId != 0) {
+		GlStateTracker::OnBufferDeleted(_rendererId);
 		glDeleteBuffers(1, &_rendererId);
 		_rendererId = 0;
 	}
@@ -30,6 +33,7 @@ void IBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementC
 	_elementCount = elementCount;
 	_elementSize = elementSize;
 	_size = elementCount * elementSize;
+	_SetGpuMemorySize(_size);
 }
 
 void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize /*= true*/)
@@ -43,6 +47,7 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 			_elementCount = elementCount;
 			_elementSize = elementSize;
 			_size = elementCount * elementSize;
+			_SetGpuMemorySize(_size);
 		} else {
 			LOG_ASSERT(false, "Attempting to write beyond the end of the buffer!");
 		}
@@ -50,6 +55,7 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 		if (_size == 0) {
 			glNamedBufferData(_rendererId, (GLsizeiptr)elementSize * elementCount, data, (GLenum)_usage);
 			_size = elementCount * elementSize;
+			_SetGpuMemorySize(_size);
 		} else {
 			glNamedBufferSubData(_rendererId, 0, (GLsizeiptr)elementSize * elementCount, data);
 		}
@@ -59,6 +65,11 @@ void IBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elemen
 	}
 }
 
+void IBuffer::UpdateSubData(const void* data, uint32_t offset, uint32_t size) {
+	LOG_ASSERT(offset + size <= _size, "Attempting to write beyond the end of the buffer!");
+	glNamedBufferSubData(_rendererId, offset, size, data);
+}
+
 void* IBuffer::Map(BufferMapMode mode) {
 	return glMapNamedBufferRange(_rendererId, 0, _size, *mode);
 }
@@ -68,18 +79,18 @@ void IBuffer::Unmap() {
 }
 
 void IBuffer::Bind() const {
-	glBindBuffer((GLenum)_type, _rendererId);
+	GlStateTracker::BindBuffer((GLenum)_type, _rendererId);
 }
 
 void IBuffer::Bind(uint32_t slot) const
 {
-	glBindBufferBase((GLenum)_type, slot, _rendererId);
+	GlStateTracker::BindBufferBase((GLenum)_type, slot, _rendererId);
 }
 
 void IBuffer::UnBind(BufferType type) {
-	glBindBuffer((GLenum)type, 0);
+	GlStateTracker::BindBuffer((GLenum)type, 0);
 }
 
 void IBuffer::UnBind(BufferType type, uint32_t slot) {
-	glBindBufferBase((GLenum)type, slot, 0);
+	GlStateTracker::BindBufferBase((GLenum)type, slot, 0);
 }
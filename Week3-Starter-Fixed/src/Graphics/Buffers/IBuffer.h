@@ -52,6 +52,14 @@ public:
 	/// <param name="allowResize">True if resizing the buffer is allowed, otherwise an assertion is thrown for oversized writes</param>
 	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true);
 
+	/// <summary>
+	/// Updates a sub-range of the buffer without resizing it, using glNamedBufferSubData
+	/// </summary>
+	/// <param name="data">The data to copy into the buffer</param>
+	/// <param name="offset">The offset from the start of the buffer to write to, in bytes</param>
+	/// <param name="size">The number of bytes to write</param>
+	void UpdateSubData(const void* data, uint32_t offset, uint32_t size);
+
 	/// <summary>
 	/// Loads an array of data into this buffer, using the bindless method glNamedBufferData
 	/// </summary>
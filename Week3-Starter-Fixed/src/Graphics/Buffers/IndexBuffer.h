@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <stdexcept>
 #include <memory>
+#include <vector>
+#include <algorithm>
 #include <EnumToString.h>
 
 #include "Graphics/GlEnums.h"
@@ -52,6 +54,37 @@ public:
 	template <typename T>
 	void LoadData(const T* data, uint32_t count) { throw std::runtime_error("Must be one of uint8_t, uint16_t or uint32_t"); } // Note, see template specializations below
 
+	/// <summary>
+	/// Loads 32 bit indices into this index buffer, storing them as 16 bit indices if every index fits.
+	/// Most of our meshes have well under 65536 vertices, so this halves the size of their indices
+	/// </summary>
+	/// <param name="data">A pointer to the start of the array</param>
+	/// <param name="count">The number of elements in the array to upload</param>
+	void LoadDataNarrowed(const uint32_t* data, uint32_t count); // Note, defined after the template specializations below
+
+	/// <summary>
+	/// Checks whether a set of 32 bit indices can be stored as 16 bit indices. We never go down to
+	/// 8 bit indices, since most hardware has to convert those on the fly
+	/// </summary>
+	/// <param name="data">A pointer to the start of the array</param>
+	/// <param name="count">The number of elements in the array</param>
+	static inline bool CanNarrow(const uint32_t* data, uint32_t count) {
+		return count > 0 && *std::max_element(data, data + count) <= UINT16_MAX;
+	}
+
+	/// <summary>
+	/// Converts a set of 32 bit indices into 16 bit indices, check CanNarrow first
+	/// </summary>
+	/// <param name="data">A pointer to the start of the array</param>
+	/// <param name="count">The number of elements in the array</param>
+	static inline std::vector<uint16_t> Narrow(const uint32_t* data, uint32_t count) {
+		std::vector<uint16_t> result(count);
+		for (uint32_t ix = 0; ix < count; ix++) {
+			result[ix] = static_cast<uint16_t>(data[ix]);
+		}
+		return result;
+	}
+
 	/// <summary>
 	/// Gets the underlying index type for this buffer (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT, GL_UNSIGNED_INT)
 	/// </summary>
@@ -85,3 +118,12 @@ inline void IndexBuffer::LoadData<uint32_t>(const uint32_t* data, uint32_t count
 	IBuffer::LoadData<uint32_t>(data, count);
 	_elementType = IndexType::UInt;
 }
+
+inline void IndexBuffer::LoadDataNarrowed(const uint32_t* data, uint32_t count) {
+	if (CanNarrow(data, count)) {
+		std::vector<uint16_t> narrowed = Narrow(data, count);
+		LoadData(narrowed.data(), count);
+	} else {
+		LoadData(data, count);
+	}
+}
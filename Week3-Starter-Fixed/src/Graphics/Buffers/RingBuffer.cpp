@@ -0,0 +1,152 @@
+#include "RingBuffer.h"
+#include "Logging.h"
+#include "Graphics/GlStateTracker.h"
+#include <algorithm>
+
+RingBuffer::RingBuffer(BufferType type, uint32_t regionSize, uint32_t regionCount /*= 3*/) :
+	IBuffer(type, BufferUsage::StreamDraw),
+	_mappedData(nullptr),
+	_fences(regionCount, nullptr),
+	_regionSize(regionSize),
+	_regionCount(regionCount),
+	_currentRegion(0),
+	_regionOffset(0)
+{
+	LOG_ASSERT(regionCount > 0, "Ring buffer must have at least one region");
+	_gpuMemoryCategory = GpuMemoryTracker::Category::Streaming;
+	_AllocateStorage();
+}
+
+RingBuffer::~RingBuffer() {
+	_ReleaseStorage();
+}
+
+void RingBuffer::Reserve(uint32_t regionSize) {
+	if (regionSize <= _regionSize) {
+		return;
+	}
+
+	// Grow by at least 50% so we don't re-create the buffer every frame while a scene grows
+	uint32_t newSize = std::max(regionSize, _regionSize + _regionSize / 2);
+	// Keep regions a multiple of 256 bytes, so that offsets aligned within a region stay aligned in the buffer
+	newSize = ((newSize + 255) / 256) * 256;
+	LOG_INFO("Expanding ring buffer regions from {} bytes to {} bytes", _regionSize, newSize);
+
+	// Immutable storage can't be resized, so we need a brand new buffer
+	_ReleaseStorage();
+	GlStateTracker::OnBufferDeleted(_rendererId);
+	glDeleteBuffers(1, &_rendererId);
+	glCreateBuffers(1, &_rendererId);
+	if (!_debugName.empty()) {
+		SetDebugName(_debugName);
+	}
+
+	_regionSize = newSize;
+	_AllocateStorage();
+}
+
+void RingBuffer::BeginFrame() {
+	_currentRegion = (_currentRegion + 1) % _regionCount;
+	_regionOffset = 0;
+	_WaitForRegion(_currentRegion);
+}
+
+void RingBuffer::EndFrame() {
+	if (_fences[_currentRegion] != nullptr) {
+		glDeleteSync(_fences[_currentRegion]);
+	}
+	_fences[_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void* RingBuffer::Allocate(uint32_t size, uint32_t alignment, uint32_t& outOffset) {
+	// Round the write head up to the next multiple of alignment
+	uint32_t offset = alignment > 1 ? ((_regionOffset + alignment - 1) / alignment) * alignment : _regionOffset;
+	if (offset + size > _regionSize) {
+		return nullptr;
+	}
+
+	_regionOffset = offset + size;
+	outOffset = _currentRegion * _regionSize + offset;
+	return _mappedData + outOffset;
+}
+
+void* RingBuffer::AllocateElements(uint32_t elementSize, uint32_t count, uint32_t& outFirstElement) {
+	// Regions aren't a multiple of every element size, so we need to align from the start of the buffer
+	uint32_t regionStart = _currentRegion * _regionSize;
+	uint32_t offset = ((regionStart + _regionOffset + elementSize - 1) / elementSize) * elementSize;
+	uint32_t size = elementSize * count;
+	if (offset + size > regionStart + _regionSize) {
+		return nullptr;
+	}
+
+	_regionOffset = offset + size - regionStart;
+	outFirstElement = offset / elementSize;
+	return _mappedData + offset;
+}
+
+bool RingBuffer::Trim(uint32_t offset, uint32_t size, uint32_t usedSize) {
+	// Only the block at the write head can be shrunk, anything before it may have been followed by other blocks
+	if (usedSize > size || offset + size != _currentRegion * _regionSize + _regionOffset) {
+		return false;
+	}
+	_regionOffset -= size - usedSize;
+	return true;
+}
+
+void RingBuffer::BindRange(uint32_t slot, uint32_t offset, uint32_t size) const {
+	GlStateTracker::BindBufferRange((GLenum)_type, slot, _rendererId, offset, size);
+}
+
+void RingBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
+	UpdateData(data, elementSize, elementCount, false);
+}
+
+void RingBuffer::UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize /*= true*/) {
+	uint32_t size = elementSize * elementCount;
+	if (allowResize) {
+		Reserve(size);
+	}
+	LOG_ASSERT(size <= _regionSize, "Attempting to write beyond the end of the ring buffer region!");
+
+	memcpy(_mappedData + _currentRegion * _regionSize, data, size);
+	_regionOffset = size;
+	_elementSize = elementSize;
+	_elementCount = elementCount;
+}
+
+void RingBuffer::_AllocateStorage() {
+	_size = _regionSize * _regionCount;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glNamedBufferStorage(_rendererId, _size, nullptr, flags);
+	_SetGpuMemorySize(_size);
+	_mappedData = reinterpret_cast<uint8_t*>(glMapNamedBufferRange(_rendererId, 0, _size, flags));
+	LOG_ASSERT(_mappedData != nullptr, "Failed to persistently map ring buffer");
+
+	_currentRegion = 0;
+	_regionOffset = 0;
+}
+
+void RingBuffer::_ReleaseStorage() {
+	for (uint32_t ix = 0; ix < _regionCount; ix++) {
+		_WaitForRegion(ix);
+	}
+	if (_mappedData != nullptr && _rendererId != 0) {
+		glUnmapNamedBuffer(_rendererId);
+	}
+	_mappedData = nullptr;
+}
+
+void RingBuffer::_WaitForRegion(uint32_t region) {
+	GLsync& fence = _fences[region];
+	if (fence != nullptr) {
+		// Spin until the GPU has signaled the fence, flushing the first time so it's guaranteed to signal
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		GLenum result = glClientWaitSync(fence, waitFlags, 0);
+		while (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED && result != GL_WAIT_FAILED) {
+			result = glClientWaitSync(fence, 0, 1000000); // 1ms
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
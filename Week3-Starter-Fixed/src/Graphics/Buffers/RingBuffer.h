@@ -0,0 +1,108 @@
+#pragma once
+#include "IBuffer.h"
+#include <vector>
+
+/// <summary>
+/// A persistently mapped buffer that is split into a number of regions (one per frame in flight).
+/// Each frame the CPU writes into the next region, while the GPU is free to read from the
+/// previous ones. Fences are used to make sure we never write into a region the GPU is still
+/// reading from.
+/// 
+/// Data is written directly into the mapped pointer, then bound using glBindBufferRange
+/// </summary>
+/// <see>https://www.khronos.org/opengl/wiki/Buffer_Object_Streaming#Persistent_mapped_streaming</see>
+class RingBuffer : public IBuffer {
+public:
+	DEFINE_RESOURCE(RingBuffer);
+
+	/// <summary>
+	/// Creates a new ring buffer with the given type and region layout
+	/// </summary>
+	/// <param name="type">The type of buffer (uniform, vertex, etc...)</param>
+	/// <param name="regionSize">The size of a single region, in bytes</param>
+	/// <param name="regionCount">The number of regions to cycle between, default is triple buffered</param>
+	RingBuffer(BufferType type, uint32_t regionSize, uint32_t regionCount = 3);
+	virtual ~RingBuffer();
+
+	/// <summary>
+	/// Makes sure that every region can fit at least the given number of bytes. If the buffer needs
+	/// to grow, this will wait for the GPU to finish with all regions and re-create the storage
+	/// </summary>
+	/// <param name="regionSize">The minimum size of a region in bytes</param>
+	void Reserve(uint32_t regionSize);
+
+	/// <summary>
+	/// Advances to the next region in the ring, waiting on the GPU if it is still using it
+	/// </summary>
+	void BeginFrame();
+	/// <summary>
+	/// Inserts a fence after all commands that use the current region, should be called
+	/// after the last draw call that reads from this frame's data
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Allocates a block of memory within the current region
+	/// </summary>
+	/// <param name="size">The size of the block in bytes</param>
+	/// <param name="alignment">The alignment of the block in bytes (ex: GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)</param>
+	/// <param name="outOffset">Will store the offset of the block from the start of the buffer</param>
+	/// <returns>A pointer to the start of the block, or nullptr if the region is full</returns>
+	void* Allocate(uint32_t size, uint32_t alignment, uint32_t& outOffset);
+	/// <summary>
+	/// Allocates a run of elements within the current region. The block is aligned to the element size from
+	/// the start of the buffer rather than the region, so the returned index can be used as the first vertex
+	/// of a draw call
+	/// </summary>
+	/// <param name="elementSize">The size of a single element in bytes</param>
+	/// <param name="count">The number of elements to allocate</param>
+	/// <param name="outFirstElement">Will store the index of the first element from the start of the buffer</param>
+	/// <returns>A pointer to the first element, or nullptr if the region is full</returns>
+	void* AllocateElements(uint32_t elementSize, uint32_t count, uint32_t& outFirstElement);
+	/// <summary>
+	/// Gives back the unused end of the most recent allocation, so that it can be handed out again
+	/// </summary>
+	/// <param name="offset">The offset of the allocation from the start of the buffer</param>
+	/// <param name="size">The size of the allocation in bytes</param>
+	/// <param name="usedSize">The number of bytes at the start of the allocation that are still needed</param>
+	/// <returns>True if the allocation was the most recent one, and was trimmed</returns>
+	bool Trim(uint32_t offset, uint32_t size, uint32_t usedSize);
+
+	/// <summary>
+	/// Binds a range of this buffer to an indexed binding slot
+	/// </summary>
+	/// <param name="slot">The binding slot to bind to</param>
+	/// <param name="offset">The offset in bytes from the start of the buffer, as returned by Allocate</param>
+	/// <param name="size">The size of the range in bytes</param>
+	void BindRange(uint32_t slot, uint32_t offset, uint32_t size) const;
+
+	/// <summary>
+	/// Gets the size of a single region in bytes
+	/// </summary>
+	uint32_t GetRegionSize() const { return _regionSize; }
+	/// <summary>
+	/// Gets the number of regions that this buffer cycles through
+	/// </summary>
+	uint32_t GetRegionCount() const { return _regionCount; }
+
+	// Inherited from IBuffer, ring buffers use immutable storage so these will
+	// only write into the current region
+
+	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
+	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true) override;
+
+protected:
+	uint8_t*            _mappedData;    // The persistently mapped pointer to the start of the buffer
+	std::vector<GLsync> _fences;        // One fence per region, null if the region is not in use
+	uint32_t            _regionSize;    // The size of each region in bytes
+	uint32_t            _regionCount;   // The number of regions in the ring
+	uint32_t            _currentRegion; // The index of the region we are currently writing to
+	uint32_t            _regionOffset;  // The write head within the current region
+
+	// Creates the storage for the buffer and maps it
+	void _AllocateStorage();
+	// Unmaps and releases the storage for the buffer, waiting on any in-flight regions
+	void _ReleaseStorage();
+	// Blocks until the GPU has finished with the given region
+	void _WaitForRegion(uint32_t region);
+};
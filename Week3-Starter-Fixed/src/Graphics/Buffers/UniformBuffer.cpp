@@ -1,5 +1,6 @@
 #include "UniformBuffer.h"
 #include "Logging.h"
+#include "Graphics/GlStateTracker.h"
 
 AbstractUniformBuffer::~AbstractUniformBuffer() {
 	delete[] _rawData;
@@ -13,6 +14,7 @@ AbstractUniformBuffer::AbstractUniformBuffer(uint32_t sizeInBytes, BufferUsage u
 	_size = sizeInBytes;
 	memset(_rawData, 0, sizeInBytes);
 	glNamedBufferData(_rendererId, _size, _rawData, (GLenum)_usage);
+	_SetGpuMemorySize(_size);
 }
 
 void AbstractUniformBuffer::LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) {
@@ -24,12 +26,21 @@ void AbstractUniformBuffer::LoadData(const void* data, uint32_t elementSize, uin
 	glNamedBufferSubData(_rendererId, 0, dataSize, _rawData);
 }
 
+void AbstractUniformBuffer::Update() {
+	glNamedBufferSubData(_rendererId, 0, _size, _rawData);
+}
+
+void AbstractUniformBuffer::Update(uint32_t offset, uint32_t size) {
+	LOG_ASSERT(offset + size <= _size, "Update exceeds the bounds of this UBO");
+	glNamedBufferSubData(_rendererId, offset, size, _rawData + offset);
+}
+
 void AbstractUniformBuffer::Bind() const {
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, _rendererId);
+	GlStateTracker::BindBufferBase(GL_UNIFORM_BUFFER, 0, _rendererId);
 }
 
 void AbstractUniformBuffer::Bind(int slot) const
 {
-	glBindBufferBase(GL_UNIFORM_BUFFER, slot, _rendererId);
+	GlStateTracker::BindBufferBase(GL_UNIFORM_BUFFER, slot, _rendererId);
 }
 
@@ -29,6 +29,26 @@ public :
 	/// <param name="elementCount">The numbder of elements to upload</param>
 	virtual void LoadData(const void* data, uint32_t elementSize, uint32_t elementCount) override;
 
+	/// <summary>
+	/// Gets the CPU side copy of the buffer's contents, call Update to upload changes
+	/// </summary>
+	uint8_t* GetRawData() { return _rawData; }
+	/// <summary>
+	/// Gets the size of the buffer in bytes
+	/// </summary>
+	uint32_t GetSize() const { return _size; }
+	/// <summary>
+	/// Notifies OpenGL that the data has been updated and requires
+	/// a resync with the GL side buffer
+	/// </summary>
+	void Update();
+	/// <summary>
+	/// Uploads only part of the CPU side copy, for when we know which bytes have changed
+	/// </summary>
+	/// <param name="offset">The offset of the first changed byte</param>
+	/// <param name="size">The number of bytes to upload</param>
+	void Update(uint32_t offset, uint32_t size);
+
 	/// <summary>
 	/// Uniform buffers behave a bit differently than other buffer types,
 	/// so we need to have a custom bind command, by default will bind to
@@ -101,12 +121,4 @@ public:
 		*((Structure*)_rawData) = data;
 		Update();
 	}
-
-	/// <summary>
-	/// Notifies OpenGL that the data has been updated and requires
-	/// a resync with the GL side buffer
-	/// </summary>
-	void Update() {
-		glNamedBufferSubData(_rendererId, 0, sizeof(Structure), _rawData);
-	}
 };
@@ -1,21 +1,19 @@
 #include "Graphics/DebugDraw.h"
+#include "Graphics/GlStateTracker.h"
+#include "Graphics/StreamingVertices.h"
+
+static constexpr UniformHandle MvpUniform("u_MVP");
 
 DebugDrawer::DebugDrawer() :
 	_colorStack(std::stack<glm::vec3>()),
 	_transformStack(std::stack<glm::mat4>()),
 	_viewProjection(glm::mat4(1.0f)),
-	_lineOffset(0),
-	_triangleOffset(0)
+	_lines(),
+	_tris()
 {
-	_linesVBO = VertexBuffer::Create(BufferUsage::DynamicDraw);
-	_linesVBO->LoadData<VertexPosCol>(nullptr, LINE_BATCH_SIZE * 2);
-	_linesVAO = VertexArrayObject::Create();
-	_linesVAO->AddVertexBuffer(_linesVBO, VertexPosCol::V_DECL);
-
-	_trisVBO = VertexBuffer::Create(BufferUsage::DynamicDraw);
-	_trisVBO->LoadData<VertexPosCol>(nullptr, TRI_BATCH_SIZE * 3);
-	_trisVAO = VertexArrayObject::Create();
-	_trisVAO->AddVertexBuffer(_trisVBO, VertexPosCol::V_DECL);
+	_vao = VertexArrayObject::Create();
+	_vertexBinding = _vao->AddVertexBuffer(StreamingVertices::GetBuffer(), VertexPosCol::V_DECL);
+	_bufferVersion = StreamingVertices::GetBufferVersion();
 
 	_colorStack.push(glm::vec3(1.0f));
 	_transformStack.push(glm::mat4(1.0f));
@@ -54,34 +52,20 @@ void DebugDrawer::DrawLine(const glm::vec3& p1, const glm::vec3& p2, const glm::
 
 void DebugDrawer::DrawLine(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& color1, const glm::vec3& color2)
 {
-	_lineBuffer[_lineOffset + 0].Color = glm::vec4(color1, 1.0f);
-	_lineBuffer[_lineOffset + 0].Position = p1;
-	_lineBuffer[_lineOffset + 1].Color = glm::vec4(color2, 1.0f);
-	_lineBuffer[_lineOffset + 1].Position = p2;
-
-	_lineOffset += 2;
-	if (_lineOffset >= LINE_BATCH_SIZE) {
-		FlushLines();
+	VertexPosCol* verts = _Reserve(_lines, 2, LINE_BATCH_SIZE * 2, DrawMode::LineList);
+	if (verts == nullptr) {
+		return;
 	}
+
+	verts[0].Color = glm::vec4(color1, 1.0f);
+	verts[0].Position = p1;
+	verts[1].Color = glm::vec4(color2, 1.0f);
+	verts[1].Position = p2;
 }
 
 void DebugDrawer::FlushLines()
 {
-	if (_lineOffset > 0) {
-		__Shader->Bind();
-		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
-		int restorePoint = 0;
-		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
-		VertexArrayObject::Unbind();
-		_linesVBO->LoadData<VertexPosCol>(_lineBuffer, LINE_BATCH_SIZE * 2);
-		_linesVAO->Bind();
-		_linesVAO->Draw(DrawMode::LineList);
-		_linesVAO->Unbind();
-		_lineOffset = 0;
-		if (restorePoint != 0) {
-			glBindVertexArray(restorePoint);
-		}
-	}
+	_Flush(_lines, DrawMode::LineList);
 }
 
 void DebugDrawer::DrawTri(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3) {
@@ -95,36 +79,75 @@ void DebugDrawer::DrawTri(const glm::vec3& p1, const glm::vec3& p2, const glm::v
 
 void DebugDrawer::DrawTri(const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, const glm::vec3& c1, const glm::vec3& c2, const glm::vec3& c3)
 {
-	_triBuffer[_triangleOffset + 0].Color = glm::vec4(c1, 1.0f);
-	_triBuffer[_triangleOffset + 0].Position = p1;
-	_triBuffer[_triangleOffset + 1].Color = glm::vec4(c2, 1.0f);
-	_triBuffer[_triangleOffset + 1].Position = p2;
-	_triBuffer[_triangleOffset + 2].Color = glm::vec4(c3, 1.0f);
-	_triBuffer[_triangleOffset + 2].Position = p3;
-
-	_triangleOffset += 3;
-	if (_triangleOffset >= TRI_BATCH_SIZE) {
-		FlushTris();
+	VertexPosCol* verts = _Reserve(_tris, 3, TRI_BATCH_SIZE * 3, DrawMode::TriangleList);
+	if (verts == nullptr) {
+		return;
 	}
+
+	verts[0].Color = glm::vec4(c1, 1.0f);
+	verts[0].Position = p1;
+	verts[1].Color = glm::vec4(c2, 1.0f);
+	verts[1].Position = p2;
+	verts[2].Color = glm::vec4(c3, 1.0f);
+	verts[2].Position = p3;
 }
 
 void DebugDrawer::FlushTris()
 {
-	if (_triangleOffset > 0) {
+	_Flush(_tris, DrawMode::TriangleList);
+}
+
+VertexPosCol* DebugDrawer::_Reserve(StreamBatch& batch, uint32_t count, uint32_t capacity, DrawMode mode)
+{
+	// If the ring was re-created, the batch points at memory that's no longer mapped
+	if (batch.Vertices != nullptr && batch.Version != StreamingVertices::GetBufferVersion()) {
+		batch = StreamBatch();
+	}
+	if (batch.Vertices != nullptr && batch.Count + count > batch.Capacity) {
+		_Flush(batch, mode);
+	}
+	if (batch.Vertices == nullptr) {
+		batch.Vertices = StreamingVertices::Allocate<VertexPosCol>(capacity, batch.FirstVertex);
+		if (batch.Vertices == nullptr) {
+			return nullptr;
+		}
+		batch.Count = 0;
+		batch.Capacity = capacity;
+		batch.Version = StreamingVertices::GetBufferVersion();
+	}
+
+	VertexPosCol* result = batch.Vertices + batch.Count;
+	batch.Count += count;
+	return result;
+}
+
+void DebugDrawer::_Flush(StreamBatch& batch, DrawMode mode)
+{
+	if (batch.Vertices == nullptr || batch.Version != StreamingVertices::GetBufferVersion()) {
+		batch = StreamBatch();
+		return;
+	}
+
+	if (batch.Count > 0) {
+		// The ring gets re-created when it grows, in which case our VAO needs to point at the new one
+		if (_bufferVersion != StreamingVertices::GetBufferVersion()) {
+			_vao->ReplaceVertexBuffer(_vertexBinding, StreamingVertices::GetBuffer());
+			_bufferVersion = StreamingVertices::GetBufferVersion();
+		}
+
 		__Shader->Bind();
-		__Shader->SetUniformMatrix("u_MVP", _viewProjection * _transformStack.top());
+		__Shader->SetUniformMatrix(MvpUniform, _viewProjection * _transformStack.top());
 		int restorePoint = 0;
 		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &restorePoint);
-		VertexArrayObject::Unbind();
-		_trisVBO->LoadData<VertexPosCol>(_triBuffer, TRI_BATCH_SIZE * 3);
-		_trisVAO->Bind();
-		_trisVAO->Draw(DrawMode::LineList);
-		_trisVAO->Unbind();
-		_triangleOffset = 0;
+		_vao->DrawRange(batch.FirstVertex, batch.Count, mode);
 		if (restorePoint != 0) {
-			glBindVertexArray(restorePoint);
+			GlStateTracker::BindVertexArray(restorePoint);
 		}
 	}
+
+	// Anything we didn't write can go back to the ring
+	StreamingVertices::Trim(sizeof(VertexPosCol), batch.FirstVertex, batch.Capacity, batch.Count);
+	batch = StreamBatch();
 }
 
 void DebugDrawer::FlushAll()
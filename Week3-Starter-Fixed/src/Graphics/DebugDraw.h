@@ -9,12 +9,15 @@
 /// 
 /// Includes a stack for transformations and color, to ease implementation of complex
 /// debuggers
+///
+/// Vertices are written directly into the streaming vertex ring (see StreamingVertices.h)
 /// </summary>
 class DebugDrawer
 {
 public:
-	inline static const size_t LINE_BATCH_SIZE = 8192;
-	inline static const size_t TRI_BATCH_SIZE = 4096;
+	// The most lines and triangles that will be drawn in a single draw call
+	inline static const size_t LINE_BATCH_SIZE = 1024;
+	inline static const size_t TRI_BATCH_SIZE = 512;
 
 	// Delete copy and mode
 
@@ -128,20 +131,41 @@ public:
 protected:
 	DebugDrawer();
 
+	/// <summary>
+	/// A block of vertices in the streaming ring that we're filling, and will draw in one go
+	/// </summary>
+	struct StreamBatch {
+		VertexPosCol* Vertices    = nullptr;
+		uint32_t      FirstVertex = 0;
+		uint32_t      Count       = 0;
+		uint32_t      Capacity    = 0;
+		// The version of the streaming buffer that Vertices points into
+		uint32_t      Version     = 0;
+	};
+
 	std::stack<glm::vec3> _colorStack;
 	std::stack<glm::mat4> _transformStack;
 	glm::mat4    _viewProjection;
 	glm::mat4    _worldMatrix;
 
-	size_t       _lineOffset;
-	VertexPosCol _lineBuffer[LINE_BATCH_SIZE * 2];
-	size_t       _triangleOffset;
-	VertexPosCol _triBuffer[TRI_BATCH_SIZE * 3];
+	StreamBatch  _lines;
+	StreamBatch  _tris;
+
+	// Lines and triangles share a VAO, since they use the same vertex format and buffer
+	VertexArrayObject::Sptr _vao;
+	VertexArrayObject::VertexBufferBinding* _vertexBinding;
+	uint32_t     _bufferVersion;
 
-	VertexBuffer::Sptr _linesVBO;
-	VertexArrayObject::Sptr _linesVAO;
-	VertexBuffer::Sptr _trisVBO;
-	VertexArrayObject::Sptr _trisVAO;
+	/// <summary>
+	/// Gets space for the next few vertices in a batch, drawing the batch and starting
+	/// a new one if it is full
+	/// </summary>
+	/// <returns>A pointer to the vertices to write, or nullptr if the streaming ring is out of room</returns>
+	VertexPosCol* _Reserve(StreamBatch& batch, uint32_t count, uint32_t capacity, DrawMode mode);
+	/// <summary>
+	/// Draws everything in a batch, and hands back any space it did not use
+	/// </summary>
+	void _Flush(StreamBatch& batch, DrawMode mode);
 
 	inline static DebugDrawer* __Instance = nullptr;
 	inline static ShaderProgram::Sptr __Shader = nullptr;
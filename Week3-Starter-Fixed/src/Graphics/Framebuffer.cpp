@@ -2,6 +2,7 @@
 
 #include "Graphics/RenderBuffer.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Graphics/GlStateTracker.h"
 
 int Framebuffer::__MAX_SAMPLES = -1;
 
@@ -45,6 +46,7 @@ Framebuffer::Framebuffer(const FramebufferDescriptor& description) :
 
 Framebuffer::~Framebuffer() {
 	LOG_INFO("Deleting frame buffer with ID: {}", _rendererId);
+	GlStateTracker::OnFramebufferDeleted(_rendererId);
 	glDeleteFramebuffers(1, &_rendererId);
 }
 
@@ -162,6 +164,7 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 
 		// Create image and store in the buffer
 		Texture2D::Sptr image = std::make_shared<Texture2D>(descriptor);
+		image->SetGpuMemoryCategory(GpuMemoryTracker::Category::RenderTarget);
 		buffer.Resource = image;
 
 		// Attach texture to the framebuffer
@@ -224,7 +227,7 @@ bool Framebuffer::BindAttachment(RenderTargetAttachment attachment, int slot) co
 
 void Framebuffer::Bind(FramebufferBinding bindMode /*= FramebufferBinding::Draw*/) const {
 	_currentBinding = bindMode;
-	glBindFramebuffer(*bindMode, _rendererId);
+	GlStateTracker::BindFramebuffer(*bindMode, _rendererId);
 }
 
 void Framebuffer::Unbind() {
@@ -233,8 +236,8 @@ void Framebuffer::Unbind() {
 		// If this framebuffer is multisampled, and we want unsampled, we need to do a bunch of blits
 		if (_description.SampleCount > 1 && _description.GenerateUnsampled) {
 			// Bind this buffer as the read, and the unsampled as the write
-			glBindFramebuffer(GL_READ_FRAMEBUFFER, _rendererId);
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _unsampledFramebuffer->GetHandle());
+			GlStateTracker::BindFramebuffer(GL_READ_FRAMEBUFFER, _rendererId);
+			GlStateTracker::BindFramebuffer(GL_DRAW_FRAMEBUFFER, _unsampledFramebuffer->GetHandle());
 
 			// Figure out bounds of the framebuffer
 			glm::ivec4 bounds ={ 0, 0, _description.Width, _description.Height };
@@ -253,20 +256,20 @@ void Framebuffer::Unbind() {
 			}
 
 			// Unbind both buffers
-			glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+			GlStateTracker::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+			GlStateTracker::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 		}
 
 		// Unbind the framebuffer and clear our binding
-		glBindFramebuffer(*_currentBinding, 0);
+		GlStateTracker::BindFramebuffer(*_currentBinding, 0);
 		_currentBinding = FramebufferBinding::None;
 	}
 }
 
 void Framebuffer::Blit(const Sptr& source, const Sptr& dest, BufferFlags flags /*= BufferFlags::All*/, MagFilter filter /*= MagFilter::Linear*/) {
 	// Bind this buffer as the read, and the unsampled as the write
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, source ? source->GetHandle() : 0);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dest ? dest->GetHandle() : 0);
+	GlStateTracker::BindFramebuffer(GL_READ_FRAMEBUFFER, source ? source->GetHandle() : 0);
+	GlStateTracker::BindFramebuffer(GL_DRAW_FRAMEBUFFER, dest ? dest->GetHandle() : 0);
 
 	// Figure out bounds of the framebuffers
 	glm::ivec4 srcBounds; 
@@ -291,8 +294,8 @@ void Framebuffer::Blit(const Sptr& source, const Sptr& dest, BufferFlags flags /
 	Blit(srcBounds, dstBounds, flags, filter);
 
 	// Unbind both buffers
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	GlStateTracker::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	GlStateTracker::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 }
 
 void Framebuffer::Blit(const glm::ivec4& srcBounds, const glm::ivec4& dstBounds, BufferFlags flags /*= BufferFlags::All*/, MagFilter filter /*= MagFilter::Linear*/) {
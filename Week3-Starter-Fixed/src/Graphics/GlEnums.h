@@ -29,7 +29,8 @@ ENUM(TextureType, GLenum,
 	_2D            = GL_TEXTURE_2D,
 	_3D            = GL_TEXTURE_3D,
 	Cubemap        = GL_TEXTURE_CUBE_MAP,
-	_2DMultisample = GL_TEXTURE_2D_MULTISAMPLE
+	_2DMultisample = GL_TEXTURE_2D_MULTISAMPLE,
+	_2DArray       = GL_TEXTURE_2D_ARRAY
 )
 
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
@@ -747,7 +748,8 @@ ENUM(BlendEquation, uint32_t,
 ENUM(BufferType, GLenum,
 	Vertex  = GL_ARRAY_BUFFER,
 	Index   = GL_ELEMENT_ARRAY_BUFFER,
-	Uniform = GL_UNIFORM_BUFFER
+	Uniform = GL_UNIFORM_BUFFER,
+	DrawIndirect = GL_DRAW_INDIRECT_BUFFER
 )
 
 /// <summary>
@@ -811,6 +813,9 @@ ENUM(AttributeType, GLenum,
 	 UInt    = GL_UNSIGNED_INT,
 	 Float   = GL_FLOAT,
 	 Double  = GL_DOUBLE,
+	 HalfFloat = GL_HALF_FLOAT,
+	 // Three signed 10 bit components and a 2 bit component packed into 32 bits, must have a size of 4
+	 Int_2_10_10_10_Rev = GL_INT_2_10_10_10_REV,
 	 Unknown = GL_NONE
 )
 
@@ -874,6 +879,36 @@ ENUM(RenderTargetType, uint32_t,
 	 Stencil16    = GL_STENCIL_INDEX16
 )
 
+/**
+ * Gets an estimate of the number of bytes a single texel of a sized internal format occupies in GPU
+ * memory. Drivers usually pad 3 channel formats out to 4 channels, so we do the same
+ * @param format The internal format, as an InternalFormat or RenderTargetType
+ * @returns The size of a single texel in bytes, or 4 if the format is not known
+ */
+constexpr size_t GetInternalFormatTexelSize(GLenum format) {
+	switch (format) {
+		case GL_R8:
+		case GL_STENCIL_INDEX4:
+		case GL_STENCIL_INDEX8:
+			return 1;
+		case GL_R16:
+		case GL_RG8:
+		case GL_DEPTH_COMPONENT16:
+		case GL_STENCIL_INDEX16:
+			return 2;
+		case GL_RGB16:
+		case GL_RGBA16:
+		case GL_RGB16F:
+		case GL_RGBA16F:
+			return 8;
+		case GL_RGB32F:
+		case GL_RGBA32F:
+			return 16;
+		default:
+			return 4;
+	}
+}
+
 /**
  * Enumerates the possible options for the glBindFramebuffer command
  */
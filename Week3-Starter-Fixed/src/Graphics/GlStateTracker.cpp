@@ -0,0 +1,485 @@
+#include "Graphics/GlStateTracker.h"
+#include "Logging.h"
+
+#include <iterator>
+
+bool GlStateTracker::_validate = false;
+GlStateTracker::FrameStats GlStateTracker::_currentFrame;
+GlStateTracker::FrameStats GlStateTracker::_lastFrame;
+
+std::unordered_map<GLenum, bool> GlStateTracker::_capabilities;
+int8_t GlStateTracker::_depthMask = -1;
+uint32_t GlStateTracker::_depthFunc = GlStateTracker::UNKNOWN;
+uint32_t GlStateTracker::_cullFace = GlStateTracker::UNKNOWN;
+uint32_t GlStateTracker::_blendFunc[4] = { GlStateTracker::UNKNOWN, GlStateTracker::UNKNOWN, GlStateTracker::UNKNOWN, GlStateTracker::UNKNOWN };
+uint32_t GlStateTracker::_blendEquation[2] = { GlStateTracker::UNKNOWN, GlStateTracker::UNKNOWN };
+bool GlStateTracker::_viewportKnown = false;
+int GlStateTracker::_viewport[4] = { 0, 0, 0, 0 };
+
+uint32_t GlStateTracker::_program = GlStateTracker::UNKNOWN;
+uint32_t GlStateTracker::_vertexArray = GlStateTracker::UNKNOWN;
+std::unordered_map<GLenum, uint32_t> GlStateTracker::_buffers;
+std::unordered_map<uint64_t, GlStateTracker::IndexedBinding> GlStateTracker::_indexedBuffers;
+std::vector<uint32_t> GlStateTracker::_textureUnits;
+uint32_t GlStateTracker::_readFramebuffer = GlStateTracker::UNKNOWN;
+uint32_t GlStateTracker::_drawFramebuffer = GlStateTracker::UNKNOWN;
+
+static inline uint64_t IndexedKey(GLenum target, uint32_t slot) {
+	return (static_cast<uint64_t>(target) << 32) | slot;
+}
+
+uint32_t GlStateTracker::FrameStats::GetTotalIssued() const {
+	uint32_t result = 0;
+	for (int ix = 0; ix < CATEGORY_COUNT; ix++) {
+		result += Issued[ix];
+	}
+	return result;
+}
+
+uint32_t GlStateTracker::FrameStats::GetTotalSkipped() const {
+	uint32_t result = 0;
+	for (int ix = 0; ix < CATEGORY_COUNT; ix++) {
+		result += Skipped[ix];
+	}
+	return result;
+}
+
+const char* GlStateTracker::GetCategoryName(Category category) {
+	switch (category) {
+		case Category::Capability:  return "Capabilities";
+		case Category::Raster:      return "Raster state";
+		case Category::Program:     return "Programs";
+		case Category::VertexArray: return "Vertex arrays";
+		case Category::Buffer:      return "Buffers";
+		case Category::Texture:     return "Textures";
+		case Category::Framebuffer: return "Framebuffers";
+		default:                    return "Unknown";
+	}
+}
+
+void GlStateTracker::Enable(GLenum capability) {
+	SetEnabled(capability, true);
+}
+
+void GlStateTracker::Disable(GLenum capability) {
+	SetEnabled(capability, false);
+}
+
+void GlStateTracker::SetEnabled(GLenum capability, bool enabled) {
+	auto it = _capabilities.find(capability);
+	if (it != _capabilities.end() && it->second == enabled &&
+		_Skip(Category::Capability, !_validate || (glIsEnabled(capability) == GL_TRUE) == enabled, "capability")) {
+		return;
+	}
+	_Issue(Category::Capability);
+	if (enabled) {
+		glEnable(capability);
+	} else {
+		glDisable(capability);
+	}
+	_capabilities[capability] = enabled;
+}
+
+void GlStateTracker::DepthMask(bool enabled) {
+	if (_depthMask == static_cast<int8_t>(enabled) &&
+		_Skip(Category::Raster, !_validate || (_GetInteger(GL_DEPTH_WRITEMASK) != 0) == enabled, "depth mask")) {
+		return;
+	}
+	_Issue(Category::Raster);
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	_depthMask = static_cast<int8_t>(enabled);
+}
+
+void GlStateTracker::DepthFunc(GLenum func) {
+	if (_depthFunc == func &&
+		_Skip(Category::Raster, !_validate || _GetInteger(GL_DEPTH_FUNC) == static_cast<GLint>(func), "depth func")) {
+		return;
+	}
+	_Issue(Category::Raster);
+	glDepthFunc(func);
+	_depthFunc = func;
+}
+
+void GlStateTracker::CullFace(GLenum face) {
+	if (_cullFace == face &&
+		_Skip(Category::Raster, !_validate || _GetInteger(GL_CULL_FACE_MODE) == static_cast<GLint>(face), "cull face")) {
+		return;
+	}
+	_Issue(Category::Raster);
+	glCullFace(face);
+	_cullFace = face;
+}
+
+void GlStateTracker::BlendFunc(GLenum src, GLenum dst) {
+	BlendFuncSeparate(src, dst, src, dst);
+}
+
+void GlStateTracker::BlendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha) {
+	if (_blendFunc[0] == srcRgb && _blendFunc[1] == dstRgb && _blendFunc[2] == srcAlpha && _blendFunc[3] == dstAlpha &&
+		_Skip(Category::Raster, !_validate || (
+			_GetInteger(GL_BLEND_SRC_RGB) == static_cast<GLint>(srcRgb) && _GetInteger(GL_BLEND_DST_RGB) == static_cast<GLint>(dstRgb) &&
+			_GetInteger(GL_BLEND_SRC_ALPHA) == static_cast<GLint>(srcAlpha) && _GetInteger(GL_BLEND_DST_ALPHA) == static_cast<GLint>(dstAlpha)), "blend func")) {
+		return;
+	}
+	_Issue(Category::Raster);
+	glBlendFuncSeparate(srcRgb, dstRgb, srcAlpha, dstAlpha);
+	_blendFunc[0] = srcRgb;
+	_blendFunc[1] = dstRgb;
+	_blendFunc[2] = srcAlpha;
+	_blendFunc[3] = dstAlpha;
+}
+
+void GlStateTracker::BlendEquationSeparate(GLenum rgb, GLenum alpha) {
+	if (_blendEquation[0] == rgb && _blendEquation[1] == alpha &&
+		_Skip(Category::Raster, !_validate || (
+			_GetInteger(GL_BLEND_EQUATION_RGB) == static_cast<GLint>(rgb) && _GetInteger(GL_BLEND_EQUATION_ALPHA) == static_cast<GLint>(alpha)), "blend equation")) {
+		return;
+	}
+	_Issue(Category::Raster);
+	glBlendEquationSeparate(rgb, alpha);
+	_blendEquation[0] = rgb;
+	_blendEquation[1] = alpha;
+}
+
+void GlStateTracker::Viewport(int x, int y, int width, int height) {
+	if (_viewportKnown && _viewport[0] == x && _viewport[1] == y && _viewport[2] == width && _viewport[3] == height) {
+		GLint actual[4] = { 0, 0, 0, 0 };
+		if (_validate) {
+			glGetIntegerv(GL_VIEWPORT, actual);
+		}
+		if (_Skip(Category::Raster, !_validate || (actual[0] == x && actual[1] == y && actual[2] == width && actual[3] == height), "viewport")) {
+			return;
+		}
+	}
+	_Issue(Category::Raster);
+	glViewport(x, y, width, height);
+	_viewport[0] = x;
+	_viewport[1] = y;
+	_viewport[2] = width;
+	_viewport[3] = height;
+	_viewportKnown = true;
+}
+
+void GlStateTracker::UseProgram(uint32_t program) {
+	if (_program == program &&
+		_Skip(Category::Program, !_validate || _GetInteger(GL_CURRENT_PROGRAM) == static_cast<GLint>(program), "program")) {
+		return;
+	}
+	_Issue(Category::Program);
+	glUseProgram(program);
+	_program = program;
+}
+
+void GlStateTracker::BindVertexArray(uint32_t vao) {
+	if (_vertexArray == vao &&
+		_Skip(Category::VertexArray, !_validate || _GetInteger(GL_VERTEX_ARRAY_BINDING) == static_cast<GLint>(vao), "vertex array")) {
+		return;
+	}
+	_Issue(Category::VertexArray);
+	glBindVertexArray(vao);
+	_vertexArray = vao;
+	_buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+}
+
+void GlStateTracker::BindBuffer(GLenum target, uint32_t buffer) {
+	auto it = _buffers.find(target);
+	if (it != _buffers.end() && it->second == buffer &&
+		_Skip(Category::Buffer, !_validate || _DriverBufferMatches(target, buffer), "buffer")) {
+		return;
+	}
+	_Issue(Category::Buffer);
+	glBindBuffer(target, buffer);
+	_buffers[target] = buffer;
+}
+
+void GlStateTracker::BindBufferBase(GLenum target, uint32_t slot, uint32_t buffer) {
+	BindBufferRange(target, slot, buffer, 0, 0);
+}
+
+void GlStateTracker::BindBufferRange(GLenum target, uint32_t slot, uint32_t buffer, size_t offset, size_t size) {
+	bool tracked = _IsIndexedContextState(target);
+	if (tracked) {
+		auto it = _indexedBuffers.find(IndexedKey(target, slot));
+		if (it != _indexedBuffers.end() && it->second.Buffer == buffer && it->second.Offset == offset && it->second.Size == size &&
+			_Skip(Category::Buffer, !_validate || _DriverIndexedBufferMatches(target, slot, buffer), "indexed buffer")) {
+			return;
+		}
+	}
+	_Issue(Category::Buffer);
+	if (size == 0) {
+		glBindBufferBase(target, slot, buffer);
+	} else {
+		glBindBufferRange(target, slot, buffer, offset, size);
+	}
+	_buffers[target] = buffer;
+	if (tracked) {
+		_indexedBuffers[IndexedKey(target, slot)] = { buffer, offset, size };
+	}
+}
+
+void GlStateTracker::BindTextureUnit(uint32_t slot, uint32_t texture) {
+	if (slot < _textureUnits.size() && _textureUnits[slot] == texture &&
+		_Skip(Category::Texture, !_validate || _DriverTextureMatches(slot, texture), "texture")) {
+		return;
+	}
+	_Issue(Category::Texture);
+	glBindTextureUnit(slot, texture);
+	if (slot >= _textureUnits.size()) {
+		_textureUnits.resize(slot + 1, UNKNOWN);
+	}
+	_textureUnits[slot] = texture;
+}
+
+void GlStateTracker::BindFramebuffer(GLenum target, uint32_t framebuffer) {
+	bool read = target == GL_READ_FRAMEBUFFER || target == GL_FRAMEBUFFER;
+	bool draw = target == GL_DRAW_FRAMEBUFFER || target == GL_FRAMEBUFFER;
+	if ((!read || _readFramebuffer == framebuffer) && (!draw || _drawFramebuffer == framebuffer) &&
+		_Skip(Category::Framebuffer, !_validate || (
+			(!read || _GetInteger(GL_READ_FRAMEBUFFER_BINDING) == static_cast<GLint>(framebuffer)) &&
+			(!draw || _GetInteger(GL_DRAW_FRAMEBUFFER_BINDING) == static_cast<GLint>(framebuffer))), "framebuffer")) {
+		return;
+	}
+	_Issue(Category::Framebuffer);
+	glBindFramebuffer(target, framebuffer);
+	if (read) {
+		_readFramebuffer = framebuffer;
+	}
+	if (draw) {
+		_drawFramebuffer = framebuffer;
+	}
+}
+
+void GlStateTracker::OnProgramDeleted(uint32_t program) {
+	if (_program == program) {
+		_program = UNKNOWN;
+	}
+}
+
+void GlStateTracker::OnVertexArrayDeleted(uint32_t vao) {
+	if (_vertexArray == vao) {
+		_vertexArray = UNKNOWN;
+		_buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+	}
+}
+
+void GlStateTracker::OnBufferDeleted(uint32_t buffer) {
+	for (auto it = _buffers.begin(); it != _buffers.end();) {
+		it = it->second == buffer ? _buffers.erase(it) : std::next(it);
+	}
+	for (auto it = _indexedBuffers.begin(); it != _indexedBuffers.end();) {
+		it = it->second.Buffer == buffer ? _indexedBuffers.erase(it) : std::next(it);
+	}
+}
+
+void GlStateTracker::OnTextureDeleted(uint32_t texture) {
+	for (uint32_t& unit : _textureUnits) {
+		if (unit == texture) {
+			unit = UNKNOWN;
+		}
+	}
+}
+
+void GlStateTracker::OnFramebufferDeleted(uint32_t framebuffer) {
+	if (_readFramebuffer == framebuffer) {
+		_readFramebuffer = UNKNOWN;
+	}
+	if (_drawFramebuffer == framebuffer) {
+		_drawFramebuffer = UNKNOWN;
+	}
+}
+
+void GlStateTracker::Invalidate() {
+	_capabilities.clear();
+	_depthMask = -1;
+	_depthFunc = UNKNOWN;
+	_cullFace = UNKNOWN;
+	for (uint32_t& value : _blendFunc) {
+		value = UNKNOWN;
+	}
+	_blendEquation[0] = UNKNOWN;
+	_blendEquation[1] = UNKNOWN;
+	_viewportKnown = false;
+
+	_program = UNKNOWN;
+	_vertexArray = UNKNOWN;
+	_buffers.clear();
+	_indexedBuffers.clear();
+	_textureUnits.clear();
+	_readFramebuffer = UNKNOWN;
+	_drawFramebuffer = UNKNOWN;
+}
+
+void GlStateTracker::SetValidationEnabled(bool value) {
+	_validate = value;
+}
+
+bool GlStateTracker::IsValidationEnabled() {
+	return _validate;
+}
+
+uint32_t GlStateTracker::Validate() {
+	uint32_t mismatches = 0;
+	auto report = [&](const char* name, bool matches) {
+		if (!matches) {
+			LOG_WARN("GL state cache is out of sync for {}, something is bypassing the state tracker", name);
+			mismatches++;
+		}
+		return matches;
+	};
+
+	for (auto it = _capabilities.begin(); it != _capabilities.end();) {
+		bool matches = report("capability", (glIsEnabled(it->first) == GL_TRUE) == it->second);
+		it = matches ? std::next(it) : _capabilities.erase(it);
+	}
+	if (_depthMask != -1 && !report("depth mask", (_GetInteger(GL_DEPTH_WRITEMASK) != 0) == (_depthMask != 0))) {
+		_depthMask = -1;
+	}
+	if (_depthFunc != UNKNOWN && !report("depth func", _GetInteger(GL_DEPTH_FUNC) == static_cast<GLint>(_depthFunc))) {
+		_depthFunc = UNKNOWN;
+	}
+	if (_cullFace != UNKNOWN && !report("cull face", _GetInteger(GL_CULL_FACE_MODE) == static_cast<GLint>(_cullFace))) {
+		_cullFace = UNKNOWN;
+	}
+	if (_blendFunc[0] != UNKNOWN && !report("blend func",
+		_GetInteger(GL_BLEND_SRC_RGB) == static_cast<GLint>(_blendFunc[0]) && _GetInteger(GL_BLEND_DST_RGB) == static_cast<GLint>(_blendFunc[1]) &&
+		_GetInteger(GL_BLEND_SRC_ALPHA) == static_cast<GLint>(_blendFunc[2]) && _GetInteger(GL_BLEND_DST_ALPHA) == static_cast<GLint>(_blendFunc[3]))) {
+		_blendFunc[0] = UNKNOWN;
+	}
+	if (_blendEquation[0] != UNKNOWN && !report("blend equation",
+		_GetInteger(GL_BLEND_EQUATION_RGB) == static_cast<GLint>(_blendEquation[0]) && _GetInteger(GL_BLEND_EQUATION_ALPHA) == static_cast<GLint>(_blendEquation[1]))) {
+		_blendEquation[0] = UNKNOWN;
+	}
+	if (_viewportKnown) {
+		GLint actual[4];
+		glGetIntegerv(GL_VIEWPORT, actual);
+		_viewportKnown = report("viewport", actual[0] == _viewport[0] && actual[1] == _viewport[1] && actual[2] == _viewport[2] && actual[3] == _viewport[3]);
+	}
+
+	if (_program != UNKNOWN && !report("program", _GetInteger(GL_CURRENT_PROGRAM) == static_cast<GLint>(_program))) {
+		_program = UNKNOWN;
+	}
+	if (_vertexArray != UNKNOWN && !report("vertex array", _GetInteger(GL_VERTEX_ARRAY_BINDING) == static_cast<GLint>(_vertexArray))) {
+		_vertexArray = UNKNOWN;
+	}
+	for (auto it = _buffers.begin(); it != _buffers.end();) {
+		bool matches = report("buffer", _DriverBufferMatches(it->first, it->second));
+		it = matches ? std::next(it) : _buffers.erase(it);
+	}
+	for (auto it = _indexedBuffers.begin(); it != _indexedBuffers.end();) {
+		bool matches = report("indexed buffer", _DriverIndexedBufferMatches(static_cast<GLenum>(it->first >> 32), static_cast<uint32_t>(it->first), it->second.Buffer));
+		it = matches ? std::next(it) : _indexedBuffers.erase(it);
+	}
+	for (uint32_t slot = 0; slot < _textureUnits.size(); slot++) {
+		if (_textureUnits[slot] != UNKNOWN && !report("texture", _DriverTextureMatches(slot, _textureUnits[slot]))) {
+			_textureUnits[slot] = UNKNOWN;
+		}
+	}
+	if (_readFramebuffer != UNKNOWN && !report("read framebuffer", _GetInteger(GL_READ_FRAMEBUFFER_BINDING) == static_cast<GLint>(_readFramebuffer))) {
+		_readFramebuffer = UNKNOWN;
+	}
+	if (_drawFramebuffer != UNKNOWN && !report("draw framebuffer", _GetInteger(GL_DRAW_FRAMEBUFFER_BINDING) == static_cast<GLint>(_drawFramebuffer))) {
+		_drawFramebuffer = UNKNOWN;
+	}
+
+	_currentFrame.Mismatches += mismatches;
+	return mismatches;
+}
+
+void GlStateTracker::EndFrame() {
+	if (_validate) {
+		Validate();
+	}
+	_lastFrame = _currentFrame;
+	_currentFrame = FrameStats();
+}
+
+const GlStateTracker::FrameStats& GlStateTracker::GetLastFrameStats() {
+	return _lastFrame;
+}
+
+void GlStateTracker::_Issue(Category category) {
+	_currentFrame.Issued[static_cast<int>(category)]++;
+}
+
+bool GlStateTracker::_Skip(Category category, bool matchesDriver, const char* name) {
+	if (!matchesDriver) {
+		LOG_WARN("GL state cache is out of sync for {}, something is bypassing the state tracker", name);
+		_currentFrame.Mismatches++;
+		return false;
+	}
+	_currentFrame.Skipped[static_cast<int>(category)]++;
+	return true;
+}
+
+GLint GlStateTracker::_GetInteger(GLenum name) {
+	GLint result = 0;
+	glGetIntegerv(name, &result);
+	return result;
+}
+
+GLenum GlStateTracker::_GetBindingQuery(GLenum target) {
+	switch (target) {
+		case GL_ARRAY_BUFFER:              return GL_ARRAY_BUFFER_BINDING;
+		case GL_ELEMENT_ARRAY_BUFFER:      return GL_ELEMENT_ARRAY_BUFFER_BINDING;
+		case GL_UNIFORM_BUFFER:            return GL_UNIFORM_BUFFER_BINDING;
+		case GL_SHADER_STORAGE_BUFFER:     return GL_SHADER_STORAGE_BUFFER_BINDING;
+		case GL_ATOMIC_COUNTER_BUFFER:     return GL_ATOMIC_COUNTER_BUFFER_BINDING;
+		case GL_TRANSFORM_FEEDBACK_BUFFER: return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
+		case GL_DRAW_INDIRECT_BUFFER:      return GL_DRAW_INDIRECT_BUFFER_BINDING;
+		case GL_DISPATCH_INDIRECT_BUFFER:  return GL_DISPATCH_INDIRECT_BUFFER_BINDING;
+		case GL_COPY_READ_BUFFER:          return GL_COPY_READ_BUFFER_BINDING;
+		case GL_COPY_WRITE_BUFFER:         return GL_COPY_WRITE_BUFFER_BINDING;
+		case GL_PIXEL_PACK_BUFFER:         return GL_PIXEL_PACK_BUFFER_BINDING;
+		case GL_PIXEL_UNPACK_BUFFER:       return GL_PIXEL_UNPACK_BUFFER_BINDING;
+		case GL_TEXTURE_BUFFER:            return GL_TEXTURE_BUFFER_BINDING;
+		default:                           return GL_NONE;
+	}
+}
+
+bool GlStateTracker::_DriverBufferMatches(GLenum target, uint32_t buffer) {
+	GLenum query = _GetBindingQuery(target);
+	// Targets we don't know how to query are trusted
+	return query == GL_NONE || _GetInteger(query) == static_cast<GLint>(buffer);
+}
+
+bool GlStateTracker::_DriverIndexedBufferMatches(GLenum target, uint32_t slot, uint32_t buffer) {
+	GLint result = 0;
+	glGetIntegeri_v(_GetBindingQuery(target), slot, &result);
+	return result == static_cast<GLint>(buffer);
+}
+
+bool GlStateTracker::_DriverTextureMatches(uint32_t slot, uint32_t texture) {
+	// Unbinding clears every target on the unit, which would take a query per target to check, so we trust it
+	if (texture == 0) {
+		return true;
+	}
+
+	// Texture bindings can only be queried per target on the active unit, so we need to know what kind of texture it is
+	GLint target = 0;
+	glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+	GLenum query = GL_NONE;
+	switch (target) {
+		case GL_TEXTURE_1D:                   query = GL_TEXTURE_BINDING_1D; break;
+		case GL_TEXTURE_2D:                   query = GL_TEXTURE_BINDING_2D; break;
+		case GL_TEXTURE_3D:                   query = GL_TEXTURE_BINDING_3D; break;
+		case GL_TEXTURE_1D_ARRAY:             query = GL_TEXTURE_BINDING_1D_ARRAY; break;
+		case GL_TEXTURE_2D_ARRAY:             query = GL_TEXTURE_BINDING_2D_ARRAY; break;
+		case GL_TEXTURE_CUBE_MAP:             query = GL_TEXTURE_BINDING_CUBE_MAP; break;
+		case GL_TEXTURE_CUBE_MAP_ARRAY:       query = GL_TEXTURE_BINDING_CUBE_MAP_ARRAY; break;
+		case GL_TEXTURE_2D_MULTISAMPLE:       query = GL_TEXTURE_BINDING_2D_MULTISAMPLE; break;
+		case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: query = GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY; break;
+		case GL_TEXTURE_RECTANGLE:            query = GL_TEXTURE_BINDING_RECTANGLE; break;
+		case GL_TEXTURE_BUFFER:               query = GL_TEXTURE_BINDING_BUFFER; break;
+		default: return true;
+	}
+
+	GLint activeUnit = _GetInteger(GL_ACTIVE_TEXTURE);
+	glActiveTexture(GL_TEXTURE0 + slot);
+	GLint bound = _GetInteger(query);
+	glActiveTexture(activeUnit);
+	return bound == static_cast<GLint>(texture);
+}
+
+bool GlStateTracker::_IsIndexedContextState(GLenum target) {
+	return target == GL_UNIFORM_BUFFER || target == GL_SHADER_STORAGE_BUFFER || target == GL_ATOMIC_COUNTER_BUFFER;
+}
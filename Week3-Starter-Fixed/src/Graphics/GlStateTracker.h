@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+#include "glad/glad.h"
+
+/// <summary>
+/// Shadows the bits of OpenGL state that our wrappers touch, so that binds and toggles that would
+/// not change anything never reach the driver
+///
+/// Every wrapper class goes through here instead of calling GL directly. State starts out unknown,
+/// and unknown state is always sent to the driver, so anything that talks to GL behind our back
+/// (ImGui, for instance) only needs to be followed by a call to Invalidate
+///
+/// With validation enabled, every call we'd skip is first checked against glGet, and any mismatch
+/// is logged and sent to the driver anyway. This is slow, and is only meant for tracking down code
+/// that bypasses the tracker
+/// </summary>
+class GlStateTracker {
+public:
+	GlStateTracker() = delete;
+
+	/// <summary>
+	/// The groups of calls that are counted separately in the frame stats
+	/// </summary>
+	enum class Category {
+		Capability = 0,
+		Raster,
+		Program,
+		VertexArray,
+		Buffer,
+		Texture,
+		Framebuffer,
+		Count
+	};
+	static const int CATEGORY_COUNT = static_cast<int>(Category::Count);
+
+	/// <summary>
+	/// The number of calls that were sent to the driver and skipped during a frame
+	/// </summary>
+	struct FrameStats {
+		uint32_t Issued[CATEGORY_COUNT]  = { 0 };
+		uint32_t Skipped[CATEGORY_COUNT] = { 0 };
+		// The number of times validation found the cache disagreeing with the driver
+		uint32_t Mismatches = 0;
+
+		uint32_t GetTotalIssued() const;
+		uint32_t GetTotalSkipped() const;
+	};
+
+	/// <summary>
+	/// Gets a display name for a category
+	/// </summary>
+	static const char* GetCategoryName(Category category);
+
+	static void Enable(GLenum capability);
+	static void Disable(GLenum capability);
+	static void SetEnabled(GLenum capability, bool enabled);
+
+	static void DepthMask(bool enabled);
+	static void DepthFunc(GLenum func);
+	static void CullFace(GLenum face);
+	static void BlendFunc(GLenum src, GLenum dst);
+	static void BlendFuncSeparate(GLenum srcRgb, GLenum dstRgb, GLenum srcAlpha, GLenum dstAlpha);
+	static void BlendEquationSeparate(GLenum rgb, GLenum alpha);
+	static void Viewport(int x, int y, int width, int height);
+
+	static void UseProgram(uint32_t program);
+	/// <summary>
+	/// Binds a vertex array. Since the index buffer binding belongs to the VAO, this also
+	/// forgets which index buffer is bound
+	/// </summary>
+	static void BindVertexArray(uint32_t vao);
+	static void BindBuffer(GLenum target, uint32_t buffer);
+	/// <summary>
+	/// Binds a buffer to an indexed binding point, which also replaces the generic binding for the target
+	/// </summary>
+	static void BindBufferBase(GLenum target, uint32_t slot, uint32_t buffer);
+	static void BindBufferRange(GLenum target, uint32_t slot, uint32_t buffer, size_t offset, size_t size);
+	static void BindTextureUnit(uint32_t slot, uint32_t texture);
+	/// <summary>
+	/// Binds a framebuffer, GL_FRAMEBUFFER binds both the read and draw targets
+	/// </summary>
+	static void BindFramebuffer(GLenum target, uint32_t framebuffer);
+
+	// Deleting an object unbinds it, and the name may be handed out again, so we need to forget about it
+	static void OnProgramDeleted(uint32_t program);
+	static void OnVertexArrayDeleted(uint32_t vao);
+	static void OnBufferDeleted(uint32_t buffer);
+	static void OnTextureDeleted(uint32_t texture);
+	static void OnFramebufferDeleted(uint32_t framebuffer);
+
+	/// <summary>
+	/// Forgets all cached state, should be called after anything modifies GL state without going through the tracker
+	/// </summary>
+	static void Invalidate();
+
+	/// <summary>
+	/// Enables or disables checking the cache against the driver before skipping calls
+	/// </summary>
+	static void SetValidationEnabled(bool value);
+	static bool IsValidationEnabled();
+	/// <summary>
+	/// Checks every cached value against the driver, logging and forgetting any that disagree
+	/// </summary>
+	/// <returns>The number of cached values that did not match</returns>
+	static uint32_t Validate();
+
+	/// <summary>
+	/// Stores the current frame's stats and starts counting a new frame. When validation is
+	/// enabled, also validates the entire cache first
+	/// </summary>
+	static void EndFrame();
+	/// <summary>
+	/// Gets the stats for the most recently completed frame
+	/// </summary>
+	static const FrameStats& GetLastFrameStats();
+
+protected:
+	// Marks a cached handle or enum that we don't know the value of
+	static const uint32_t UNKNOWN = 0xFFFFFFFF;
+
+	struct IndexedBinding {
+		uint32_t Buffer;
+		size_t   Offset;
+		// 0 if the whole buffer is bound
+		size_t   Size;
+	};
+
+	static bool       _validate;
+	static FrameStats _currentFrame;
+	static FrameStats _lastFrame;
+
+	// Enabled capabilities, capabilities that aren't in the map are unknown
+	static std::unordered_map<GLenum, bool> _capabilities;
+	static int8_t   _depthMask;
+	static uint32_t _depthFunc;
+	static uint32_t _cullFace;
+	static uint32_t _blendFunc[4];
+	static uint32_t _blendEquation[2];
+	static bool     _viewportKnown;
+	static int      _viewport[4];
+
+	static uint32_t _program;
+	static uint32_t _vertexArray;
+	static std::unordered_map<GLenum, uint32_t> _buffers;
+	// Keyed on the target in the upper 32 bits and the slot in the lower
+	static std::unordered_map<uint64_t, IndexedBinding> _indexedBuffers;
+	static std::vector<uint32_t> _textureUnits;
+	static uint32_t _readFramebuffer;
+	static uint32_t _drawFramebuffer;
+
+	static void _Issue(Category category);
+	// Counts a call that matched the cache. If the driver disagreed during validation, logs it and returns false
+	// so the caller sends the call anyway
+	static bool _Skip(Category category, bool matchesDriver, const char* name);
+
+	static GLint _GetInteger(GLenum name);
+	static GLenum _GetBindingQuery(GLenum target);
+	static bool _DriverBufferMatches(GLenum target, uint32_t buffer);
+	static bool _DriverIndexedBufferMatches(GLenum target, uint32_t slot, uint32_t buffer);
+	static bool _DriverTextureMatches(uint32_t slot, uint32_t texture);
+	// Only the uniform, storage and atomic counter indexed bindings are context state, the rest belong to other objects
+	static bool _IsIndexedContextState(GLenum target);
+};
@@ -0,0 +1,100 @@
+#include "Graphics/GpuMemoryTracker.h"
+#include "Graphics/IGraphicsResource.h"
+#include "Logging.h"
+#include <algorithm>
+
+GpuMemoryTracker::CategoryStats GpuMemoryTracker::_categories[GpuMemoryTracker::CATEGORY_COUNT];
+size_t GpuMemoryTracker::_totalBytes = 0;
+size_t GpuMemoryTracker::_peakBytes = 0;
+size_t GpuMemoryTracker::_budget = (size_t)GpuMemoryTracker::DEFAULT_BUDGET_MB * 1024 * 1024;
+bool GpuMemoryTracker::_overBudget = false;
+std::unordered_set<const IGraphicsResource*> GpuMemoryTracker::_resources;
+
+const char* GpuMemoryTracker::GetCategoryName(Category category) {
+	switch (category) {
+		case Category::Mesh:          return "Mesh";
+		case Category::Texture:       return "Texture";
+		case Category::RenderTarget:  return "Render Target";
+		case Category::UniformBuffer: return "Uniform Buffer";
+		case Category::Streaming:     return "Streaming";
+		case Category::Other:         return "Other";
+		default:                      return "Unknown";
+	}
+}
+
+void GpuMemoryTracker::OnResourceChanged(const IGraphicsResource* resource, Category oldCategory, size_t oldBytes, Category newCategory, size_t newBytes) {
+	if (oldBytes > 0) {
+		CategoryStats& stats = _categories[static_cast<int>(oldCategory)];
+		stats.Bytes -= oldBytes;
+		stats.ResourceCount--;
+		_totalBytes -= oldBytes;
+	}
+
+	if (newBytes > 0) {
+		CategoryStats& stats = _categories[static_cast<int>(newCategory)];
+		stats.Bytes += newBytes;
+		stats.ResourceCount++;
+		stats.PeakBytes = std::max(stats.PeakBytes, stats.Bytes);
+		_totalBytes += newBytes;
+		_peakBytes = std::max(_peakBytes, _totalBytes);
+		_resources.insert(resource);
+	} else {
+		_resources.erase(resource);
+	}
+
+	_CheckBudget();
+}
+
+size_t GpuMemoryTracker::GetTotalBytes() {
+	return _totalBytes;
+}
+
+size_t GpuMemoryTracker::GetPeakBytes() {
+	return _peakBytes;
+}
+
+const GpuMemoryTracker::CategoryStats& GpuMemoryTracker::GetCategoryStats(Category category) {
+	return _categories[static_cast<int>(category)];
+}
+
+void GpuMemoryTracker::ResetPeaks() {
+	for (int ix = 0; ix < CATEGORY_COUNT; ix++) {
+		_categories[ix].PeakBytes = _categories[ix].Bytes;
+	}
+	_peakBytes = _totalBytes;
+}
+
+void GpuMemoryTracker::SetBudget(size_t bytes) {
+	_budget = bytes;
+	_overBudget = false;
+	_CheckBudget();
+}
+
+size_t GpuMemoryTracker::GetBudget() {
+	return _budget;
+}
+
+bool GpuMemoryTracker::IsOverBudget() {
+	return _budget > 0 && _totalBytes > _budget;
+}
+
+std::vector<const IGraphicsResource*> GpuMemoryTracker::GetLargestResources(size_t count) {
+	std::vector<const IGraphicsResource*> result(_resources.begin(), _resources.end());
+	count = std::min(count, result.size());
+	std::partial_sort(result.begin(), result.begin() + count, result.end(), [](const IGraphicsResource* a, const IGraphicsResource* b) {
+		return a->GetGpuMemorySize() > b->GetGpuMemorySize();
+	});
+	result.resize(count);
+	return result;
+}
+
+void GpuMemoryTracker::_CheckBudget() {
+	bool overBudget = IsOverBudget();
+	if (overBudget && !_overBudget) {
+		LOG_WARN("GPU memory budget exceeded, {:.1f} MB allocated with a budget of {:.1f} MB", _totalBytes / (1024.0 * 1024.0), _budget / (1024.0 * 1024.0));
+		for (int ix = 0; ix < CATEGORY_COUNT; ix++) {
+			LOG_WARN("\t{:<16} {:.1f} MB in {} resources", GetCategoryName(static_cast<Category>(ix)), _categories[ix].Bytes / (1024.0 * 1024.0), _categories[ix].ResourceCount);
+		}
+	}
+	_overBudget = overBudget;
+}
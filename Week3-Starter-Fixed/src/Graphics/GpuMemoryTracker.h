@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_set>
+
+class IGraphicsResource;
+
+/// <summary>
+/// Keeps a running total of the GPU memory allocated by our graphics resources
+///
+/// Every IGraphicsResource reports the size of the storage it allocates, along with a category,
+/// so we can see where our memory is going and what to trim. Sizes are estimates based on the
+/// formats we request, the driver may pad or compress things differently
+///
+/// A budget can be set, and a warning will be logged whenever the total goes over it
+/// </summary>
+class GpuMemoryTracker {
+public:
+	GpuMemoryTracker() = delete;
+
+	/// <summary>
+	/// The groups that memory is counted under
+	/// </summary>
+	enum class Category {
+		Mesh = 0,
+		Texture,
+		RenderTarget,
+		UniformBuffer,
+		Streaming,
+		Other,
+		Count
+	};
+	static const int CATEGORY_COUNT = static_cast<int>(Category::Count);
+
+	/// <summary>
+	/// The default budget, in megabytes
+	/// </summary>
+	static constexpr uint32_t DEFAULT_BUDGET_MB = 1024;
+
+	struct CategoryStats {
+		size_t   Bytes         = 0;
+		// The most bytes that have been allocated at once since the peaks were last reset
+		size_t   PeakBytes     = 0;
+		uint32_t ResourceCount = 0;
+	};
+
+	/// <summary>
+	/// Gets a display name for a category
+	/// </summary>
+	static const char* GetCategoryName(Category category);
+
+	/// <summary>
+	/// Updates the memory counted for a resource, should only be called by IGraphicsResource
+	/// </summary>
+	/// <param name="resource">The resource that changed</param>
+	/// <param name="oldCategory">The category the resource was counted under</param>
+	/// <param name="oldBytes">The number of bytes the resource was counted as</param>
+	/// <param name="newCategory">The category to count the resource under</param>
+	/// <param name="newBytes">The number of bytes the resource now occupies</param>
+	static void OnResourceChanged(const IGraphicsResource* resource, Category oldCategory, size_t oldBytes, Category newCategory, size_t newBytes);
+
+	/// <summary>
+	/// Gets the number of bytes currently allocated across all categories
+	/// </summary>
+	static size_t GetTotalBytes();
+	/// <summary>
+	/// Gets the most bytes that have been allocated at once since the peaks were last reset
+	/// </summary>
+	static size_t GetPeakBytes();
+	/// <summary>
+	/// Gets the totals for a single category
+	/// </summary>
+	static const CategoryStats& GetCategoryStats(Category category);
+	/// <summary>
+	/// Resets the high-water marks to the current totals
+	/// </summary>
+	static void ResetPeaks();
+
+	/// <summary>
+	/// Sets the number of bytes we expect to stay within, or 0 to disable the budget
+	/// </summary>
+	static void SetBudget(size_t bytes);
+	static size_t GetBudget();
+	static bool IsOverBudget();
+
+	/// <summary>
+	/// Gets the resources that are using the most memory, largest first
+	/// </summary>
+	/// <param name="count">The maximum number of resources to return</param>
+	static std::vector<const IGraphicsResource*> GetLargestResources(size_t count);
+
+protected:
+	static CategoryStats _categories[CATEGORY_COUNT];
+	static size_t _totalBytes;
+	static size_t _peakBytes;
+	static size_t _budget;
+	static bool   _overBudget;
+	// Every resource that currently has memory counted
+	static std::unordered_set<const IGraphicsResource*> _resources;
+
+	// Logs a warning the first time we go over the budget, and re-arms once we're back under it
+	static void _CheckBudget();
+};
@@ -0,0 +1,221 @@
+#include "Graphics/GpuProfiler.h"
+#include "Logging.h"
+#include "Utils/FileHelpers.h"
+
+#include <glad/glad.h>
+#include <json.hpp>
+#include <sstream>
+
+bool GpuProfiler::_enabled = true;
+bool GpuProfiler::_inFrame = false;
+int GpuProfiler::_currentSlot = 0;
+uint64_t GpuProfiler::_frameIndex = 0;
+uint32_t GpuProfiler::_droppedFrames = 0;
+GpuProfiler::FrameSlot GpuProfiler::_slots[GpuProfiler::FRAME_LATENCY];
+std::vector<size_t> GpuProfiler::_scopeStack;
+std::deque<GpuProfiler::FrameResult> GpuProfiler::_history;
+std::unordered_map<std::string, double> GpuProfiler::_averages;
+
+void GpuProfiler::SetEnabled(bool value) {
+	_enabled = value;
+}
+
+bool GpuProfiler::IsEnabled() {
+	return _enabled;
+}
+
+void GpuProfiler::BeginFrame() {
+	LOG_ASSERT(!_inFrame, "BeginFrame called twice without an EndFrame");
+
+	_inFrame = _enabled;
+	if (!_inFrame) {
+		return;
+	}
+
+	// Move to the oldest slot, it's results should be ready by now
+	_currentSlot = (_currentSlot + 1) % FRAME_LATENCY;
+	FrameSlot& slot = _slots[_currentSlot];
+	if (slot.Pending) {
+		_ResolveSlot(slot);
+	}
+
+	slot.QueriesUsed = 0;
+	slot.Scopes.clear();
+	slot.FrameIndex = _frameIndex++;
+	_scopeStack.clear();
+
+	PushScope("Frame");
+}
+
+void GpuProfiler::EndFrame() {
+	if (!_inFrame) {
+		return;
+	}
+
+	if (_scopeStack.size() != 1) {
+		LOG_WARN("Mismatched GPU profiler scopes, {} scopes still open at end of frame", _scopeStack.size() - 1);
+	}
+	while (!_scopeStack.empty()) {
+		PopScope();
+	}
+
+	_slots[_currentSlot].Pending = true;
+	_inFrame = false;
+}
+
+void GpuProfiler::PushScope(const std::string& name) {
+	if (!_inFrame) {
+		return;
+	}
+
+	FrameSlot& slot = _slots[_currentSlot];
+	_scopeStack.push_back(slot.Scopes.size());
+
+	PendingScope scope;
+	scope.Name = name;
+	scope.Depth = static_cast<int>(_scopeStack.size()) - 1;
+	scope.StartQuery = _RecordTimestamp(slot);
+	scope.EndQuery = scope.StartQuery;
+	slot.Scopes.push_back(scope);
+}
+
+void GpuProfiler::PopScope() {
+	if (!_inFrame || _scopeStack.empty()) {
+		return;
+	}
+
+	FrameSlot& slot = _slots[_currentSlot];
+	slot.Scopes[_scopeStack.back()].EndQuery = _RecordTimestamp(slot);
+	_scopeStack.pop_back();
+}
+
+const GpuProfiler::FrameResult* GpuProfiler::GetLatestFrame() {
+	return _history.empty() ? nullptr : &_history.back();
+}
+
+const std::deque<GpuProfiler::FrameResult>& GpuProfiler::GetHistory() {
+	return _history;
+}
+
+uint32_t GpuProfiler::GetDroppedFrameCount() {
+	return _droppedFrames;
+}
+
+void GpuProfiler::ExportCsv(const std::string& path) {
+	std::stringstream stream;
+	stream << "frame,scope,depth,start_ms,duration_ms\n";
+	for (const FrameResult& frame : _history) {
+		for (const ScopeResult& scope : frame.Scopes) {
+			stream << frame.FrameIndex << ",\"" << scope.Name << "\"," << scope.Depth << "," << scope.StartMs << "," << scope.DurationMs << "\n";
+		}
+	}
+	FileHelpers::WriteContentsToFile(path, stream.str());
+	LOG_INFO("Exported {} GPU profiler frames to {}", _history.size(), path);
+}
+
+void GpuProfiler::ExportJson(const std::string& path) {
+	nlohmann::json frames = nlohmann::json::array();
+	for (const FrameResult& frame : _history) {
+		nlohmann::json scopes = nlohmann::json::array();
+		for (const ScopeResult& scope : frame.Scopes) {
+			scopes.push_back({
+				{ "name", scope.Name },
+				{ "depth", scope.Depth },
+				{ "start_ms", scope.StartMs },
+				{ "duration_ms", scope.DurationMs }
+			});
+		}
+		frames.push_back({
+			{ "frame", frame.FrameIndex },
+			{ "total_ms", frame.TotalMs },
+			{ "scopes", scopes }
+		});
+	}
+	FileHelpers::WriteContentsToFile(path, frames.dump(1, '\t'));
+	LOG_INFO("Exported {} GPU profiler frames to {}", _history.size(), path);
+}
+
+void GpuProfiler::Uninitialize() {
+	for (FrameSlot& slot : _slots) {
+		if (!slot.Queries.empty()) {
+			glDeleteQueries(static_cast<GLsizei>(slot.Queries.size()), slot.Queries.data());
+		}
+		slot = FrameSlot();
+	}
+	_scopeStack.clear();
+	_history.clear();
+	_averages.clear();
+	_inFrame = false;
+}
+
+uint32_t GpuProfiler::_RecordTimestamp(FrameSlot& slot) {
+	// Queries are kept around between frames, we only need new ones when a frame has more scopes than before
+	if (slot.QueriesUsed == slot.Queries.size()) {
+		GLuint query = 0;
+		glCreateQueries(GL_TIMESTAMP, 1, &query);
+		slot.Queries.push_back(query);
+	}
+
+	uint32_t index = slot.QueriesUsed++;
+	glQueryCounter(slot.Queries[index], GL_TIMESTAMP);
+	return index;
+}
+
+void GpuProfiler::_ResolveSlot(FrameSlot& slot) {
+	slot.Pending = false;
+	if (slot.QueriesUsed == 0) {
+		return;
+	}
+
+	// Timestamps complete in order, so if the last one is available the rest are too. If it's not,
+	// we'd rather lose the frame than wait for the GPU
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(slot.Queries[slot.QueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == GL_FALSE) {
+		_droppedFrames++;
+		return;
+	}
+
+	static std::vector<GLuint64> timestamps;
+	timestamps.resize(slot.QueriesUsed);
+	for (uint32_t ix = 0; ix < slot.QueriesUsed; ix++) {
+		glGetQueryObjectui64v(slot.Queries[ix], GL_QUERY_RESULT, &timestamps[ix]);
+	}
+
+	// Re-use the oldest frame's storage once the history is full
+	FrameResult result;
+	if (_history.size() >= HISTORY_SIZE) {
+		result = std::move(_history.front());
+		_history.pop_front();
+	}
+	result.FrameIndex = slot.FrameIndex;
+	result.Scopes.clear();
+
+	const GLuint64 frameStart = timestamps[slot.Scopes[0].StartQuery];
+	std::vector<std::string> path;
+	for (const PendingScope& scope : slot.Scopes) {
+		// Build the key for the running average from the scope's parents
+		path.resize(scope.Depth);
+		std::string key = path.empty() ? scope.Name : path.back() + "/" + scope.Name;
+		path.push_back(key);
+
+		ScopeResult scopeResult;
+		scopeResult.Name = scope.Name;
+		scopeResult.Depth = scope.Depth;
+		scopeResult.StartMs = (timestamps[scope.StartQuery] - frameStart) / 1000000.0;
+		scopeResult.DurationMs = (timestamps[scope.EndQuery] - timestamps[scope.StartQuery]) / 1000000.0;
+
+		auto it = _averages.find(key);
+		if (it == _averages.end()) {
+			it = _averages.emplace(key, scopeResult.DurationMs).first;
+		} else {
+			it->second = it->second * 0.95 + scopeResult.DurationMs * 0.05;
+		}
+		scopeResult.AverageMs = it->second;
+
+		result.Scopes.push_back(scopeResult);
+	}
+	result.TotalMs = result.Scopes[0].DurationMs;
+
+	_history.push_back(std::move(result));
+}
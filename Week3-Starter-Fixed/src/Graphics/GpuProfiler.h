@@ -0,0 +1,160 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Measures how long sections of a frame take on the GPU using timestamp queries
+///
+/// Scopes can be nested, and are pushed and popped on the main thread alongside the GL
+/// calls they are measuring. Queries are spread over FRAME_LATENCY frames, and a frame's results
+/// are only read once the GPU is FRAME_LATENCY frames past it, so the profiler never waits on
+/// the GPU. If a frame's results are still not ready by then, the frame is dropped
+/// </summary>
+class GpuProfiler {
+public:
+	GpuProfiler() = delete;
+
+	/// <summary>
+	/// The number of frames that can be in flight before we read their results
+	/// </summary>
+	static const int FRAME_LATENCY = 4;
+	/// <summary>
+	/// The number of resolved frames that are kept for the live view and exporting
+	/// </summary>
+	static const size_t HISTORY_SIZE = 256;
+
+	/// <summary>
+	/// The timing of a single scope within a resolved frame
+	/// </summary>
+	struct ScopeResult {
+		std::string Name;
+		// The nesting depth of the scope, 0 for the frame itself
+		int         Depth;
+		// The time from the start of the frame to the start of the scope, in milliseconds
+		double      StartMs;
+		// The time the GPU spent between the start and end of the scope, in milliseconds
+		double      DurationMs;
+		// A running average of DurationMs for scopes with the same name and parents
+		double      AverageMs;
+	};
+
+	/// <summary>
+	/// The timings for all scopes in a frame, in the order they were pushed
+	/// </summary>
+	struct FrameResult {
+		uint64_t                 FrameIndex;
+		double                   TotalMs;
+		std::vector<ScopeResult> Scopes;
+	};
+
+	/// <summary>
+	/// Enables or disables the profiler, takes effect at the start of the next frame
+	/// </summary>
+	static void SetEnabled(bool value);
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Starts a new frame, reading back the results of the frame that last used this frame's queries.
+	/// Pushes a root scope covering the whole frame
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Pops the frame's root scope, after which no more scopes can be pushed until the next BeginFrame
+	/// </summary>
+	static void EndFrame();
+
+	/// <summary>
+	/// Records the start of a named scope, must be matched by a call to PopScope
+	/// </summary>
+	/// <param name="name">The name of the scope, shown in the live view and exports</param>
+	static void PushScope(const std::string& name);
+	/// <summary>
+	/// Records the end of the most recently pushed scope
+	/// </summary>
+	static void PopScope();
+
+	/// <summary>
+	/// Gets the most recently resolved frame, or nullptr if no frames have been resolved yet
+	/// </summary>
+	static const FrameResult* GetLatestFrame();
+	/// <summary>
+	/// Gets the resolved frames that have been kept, oldest first
+	/// </summary>
+	static const std::deque<FrameResult>& GetHistory();
+	/// <summary>
+	/// Gets the number of frames whose results were not ready in time and were skipped
+	/// </summary>
+	static uint32_t GetDroppedFrameCount();
+
+	/// <summary>
+	/// Writes every scope in the history to a CSV file, one row per scope
+	/// </summary>
+	/// <param name="path">The path of the file to write</param>
+	static void ExportCsv(const std::string& path);
+	/// <summary>
+	/// Writes the history to a JSON file, as an array of frames that each contain their scopes
+	/// </summary>
+	/// <param name="path">The path of the file to write</param>
+	static void ExportJson(const std::string& path);
+
+	/// <summary>
+	/// Deletes all queries and clears the history, must be called while the GL context is still alive
+	/// </summary>
+	static void Uninitialize();
+
+protected:
+	// A scope that has been recorded but not read back yet
+	struct PendingScope {
+		std::string Name;
+		int         Depth;
+		uint32_t    StartQuery;
+		uint32_t    EndQuery;
+	};
+
+	// The queries and scopes for one frame in flight
+	struct FrameSlot {
+		std::vector<uint32_t>     Queries;
+		uint32_t                  QueriesUsed = 0;
+		std::vector<PendingScope> Scopes;
+		uint64_t                  FrameIndex = 0;
+		// True if the frame was ended and is waiting to be read back
+		bool                      Pending = false;
+	};
+
+	static bool      _enabled;
+	static bool      _inFrame;
+	static int       _currentSlot;
+	static uint64_t  _frameIndex;
+	static uint32_t  _droppedFrames;
+	static FrameSlot _slots[FRAME_LATENCY];
+	// Indices into the current slot's scopes for every scope that has been pushed but not popped
+	static std::vector<size_t> _scopeStack;
+
+	static std::deque<FrameResult> _history;
+	// Running averages, keyed on the scope names from the root down joined with /
+	static std::unordered_map<std::string, double> _averages;
+
+	static uint32_t _RecordTimestamp(FrameSlot& slot);
+	static void _ResolveSlot(FrameSlot& slot);
+};
+
+/// <summary>
+/// Pushes a GPU profiler scope for the lifetime of the object
+/// </summary>
+class GpuProfileScope {
+public:
+	NO_COPY(GpuProfileScope);
+	NO_MOVE(GpuProfileScope);
+
+	GpuProfileScope(const std::string& name) { GpuProfiler::PushScope(name); }
+	~GpuProfileScope() { GpuProfiler::PopScope(); }
+};
+
+/// <summary>
+/// Measures the GPU time of the rest of the enclosing block under the given name
+/// </summary>
+#define GPU_PROFILE_SCOPE(name) GpuProfileScope MACRO_CONCAT(__gpuProfileScope, __LINE__)(name)
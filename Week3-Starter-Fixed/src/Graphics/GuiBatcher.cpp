@@ -2,19 +2,21 @@
 #include <GLM/gtc/matrix_transform.hpp>
 #include <GLM/gtc/matrix_inverse.hpp>
 #include "Utils/ResourceManager/ResourceManager.h"
+#include "Graphics/StreamingVertices.h"
 #include <locale>
 #include <codecvt>
 
 
-std::unordered_map<Texture2D*, GuiBatcher::MeshData> GuiBatcher::_meshBuilders;
+std::unordered_map<Texture2D*, GuiBatcher::QuadBatch> GuiBatcher::_batches;
 
 VertexArrayObject::Sptr GuiBatcher::__vao = nullptr;
+VertexArrayObject::VertexBufferBinding* GuiBatcher::__vertexBinding = nullptr;
+uint32_t GuiBatcher::__bufferVersion = 0;
 IndexBuffer::Sptr GuiBatcher::__ibo = nullptr;
 
 Texture2D::Sptr GuiBatcher::__defaultUITexture = nullptr;
 int GuiBatcher::__defaultEdgeRadius = 0;
 
-VertexBuffer::Sptr GuiBatcher::__vbo = nullptr;
 ShaderProgram::Sptr GuiBatcher::__shader = nullptr;
 ShaderProgram::Sptr GuiBatcher::__fontShader = nullptr;
 glm::ivec2 GuiBatcher::__windowSize = {0, 0};
@@ -31,10 +33,10 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 	verts[2].Position = __model * glm::vec3(max.x, max.y, 1.0f);
 	verts[3].Position = __model * glm::vec3(max.x, min.y, 1.0f);
 		
-	// Grab mesh info for the texture batch
-	MeshData& mesh = _meshBuilders[tex.get()];
+	// Grab the batch for the texture
+	QuadBatch& batch = _batches[tex.get()];
 	// We can use the vertex count for depth, so that things drawn later have a bit of spacing
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+	float depth = (batch.QuadCount * 4) / 1000.0f;
 
 	// Copy in all color and set depth 
 	for (int ix = 0; ix < 4; ix++) {
@@ -48,10 +50,14 @@ void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm:
 	verts[2].UV = glm::vec2(uvMax.x, uvMin.y);
 	verts[3].UV = glm::vec2(uvMax.x, uvMax.y);
 
-	// Add vertices and indices to range
-	uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 1);
-	mesh.Builder.AddIndexTri(ix + 0, ix + 3, ix + 2);
+	// Quads are indexed as (0, 1, 2), (0, 2, 3), so we write the corners in reverse to keep our winding
+	VertexPosColTex* out = __ReserveQuad(tex.get(), batch);
+	if (out != nullptr) {
+		out[0] = verts[0];
+		out[1] = verts[3];
+		out[2] = verts[2];
+		out[3] = verts[1];
+	}
 }
 
 void GuiBatcher::PushRect(const glm::vec2& min, const glm::vec2& max, const glm::vec4& color, const Texture2D::Sptr& tex, int edgeRadius)
@@ -110,9 +116,9 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 	// Gets the texture used to render the font
 	Texture2D::Sptr atlas = font->GetAtlas();
 
-	// Grab the mesh builder and make sure it's a texture batch
-	MeshData& mesh = _meshBuilders[atlas.get()];
-	mesh.IsFont = true;
+	// Grab the batch for the atlas and make sure it's a font batch
+	QuadBatch& batch = _batches[atlas.get()];
+	batch.IsFont = true;
 
 	// Allocate some space for the vertices
 	VertexPosColTex verts[4];
@@ -121,7 +127,7 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 	verts[2].Color = color;
 	verts[3].Color = color;
 
-	float depth = mesh.Builder.GetVertexCount() / 1000.0f;
+	float depth = (batch.QuadCount * 4) / 1000.0f;
 
 	// Iterate over all characters in string
 	for (int i = 0; i < length; i++) {
@@ -156,9 +162,10 @@ void GuiBatcher::RenderText(const std::wstring& text, const Font::Sptr& font, co
 
 			verts[0].Position.z = verts[1].Position.z = verts[2].Position.z = verts[3].Position.z = depth;
 
-			uint32_t ix = mesh.Builder.AddVertexRange(verts, 4);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 1, ix + 2);
-			mesh.Builder.AddIndexTri(ix + 0, ix + 2, ix + 3);
+			VertexPosColTex* out = __ReserveQuad(atlas.get(), batch);
+			if (out != nullptr) {
+				memcpy(out, verts, sizeof(verts));
+			}
 
 			// Advance the offset based on the size of the glyph
 			offset.x = glyph.OffsetX;
@@ -186,29 +193,76 @@ void GuiBatcher::Flush()
 {
 	__StaticInit();
 
-	// Iterate over each texture and it's mesh
-	for (auto&[key, value] : _meshBuilders) {
-		Texture2D* tex = key;
-		// If the texture exists and the mesh has data
-		if (tex != nullptr && value.Builder.GetIndexCount() > 0) {
-			// Update the VAO and it's buffers
-			__vao->Bind();
-			__vbo->UpdateData(value.Builder.GetVertexDataPtr(), sizeof(VertexPosColTex), value.Builder.GetVertexCount(), true);
-			__ibo->UpdateData(value.Builder.GetIndexDataPtr(), sizeof(uint32_t), value.Builder.GetIndexCount(), true);
+	// Iterate over each texture and it's batch
+	for (auto&[key, value] : _batches) {
+		__DrawBatch(key, value);
+	}
+}
+
+VertexPosColTex* GuiBatcher::__ReserveQuad(Texture2D* tex, QuadBatch& batch)
+{
+	// If the ring was re-created, the batch points at memory that's no longer mapped
+	if (batch.Vertices != nullptr && batch.Version != StreamingVertices::GetBufferVersion()) {
+		batch.Vertices = nullptr;
+		batch.QuadCount = 0;
+	}
+
+	// Draw a full batch and start a bigger one, so that steady state frames only need one batch per texture
+	if (batch.Vertices != nullptr && batch.QuadCount >= batch.QuadCapacity) {
+		__DrawBatch(tex, batch);
+		batch.QuadCapacity = glm::min(batch.QuadCapacity * 2, QUAD_BATCH_SIZE);
+	}
+
+	if (batch.Vertices == nullptr) {
+		if (batch.QuadCapacity == 0) {
+			batch.QuadCapacity = MIN_QUAD_BATCH_SIZE;
+		}
+		batch.Vertices = StreamingVertices::Allocate<VertexPosColTex>(batch.QuadCapacity * 4, batch.FirstVertex);
+		if (batch.Vertices == nullptr) {
+			return nullptr;
+		}
+		batch.QuadCount = 0;
+		batch.Version = StreamingVertices::GetBufferVersion();
+	}
+
+	VertexPosColTex* result = batch.Vertices + batch.QuadCount * 4;
+	batch.QuadCount++;
+	return result;
+}
+
+void GuiBatcher::__DrawBatch(Texture2D* tex, QuadBatch& batch)
+{
+	if (batch.Vertices == nullptr) {
+		return;
+	}
+
+	if (batch.Version == StreamingVertices::GetBufferVersion()) {
+		// If the texture exists and the batch has data
+		if (tex != nullptr && batch.QuadCount > 0) {
+			__StaticInit();
+
+			// The ring gets re-created when it grows, in which case our VAO needs to point at the new one
+			if (__bufferVersion != StreamingVertices::GetBufferVersion()) {
+				__vao->ReplaceVertexBuffer(__vertexBinding, StreamingVertices::GetBuffer());
+				__bufferVersion = StreamingVertices::GetBufferVersion();
+			}
 
 			// Bind texture, send uniforms to shader
 			tex->Bind(0);
-			ShaderProgram::Sptr shader = value.IsFont ? __fontShader : __shader;
+			ShaderProgram::Sptr shader = batch.IsFont ? __fontShader : __shader;
 			shader->Bind();
 			shader->SetUniformMatrix(0, &__projection, 1, false);
 
-			// Draw geometry
-			__vao->Draw();
-
-			// Clear mesh
-			value.Builder.Reset();
+			// Draw geometry, the shared quad indices are offset to the start of the batch
+			__vao->DrawRange(batch.FirstVertex, batch.QuadCount * 6);
 		}
+
+		// Anything we didn't write can go back to the ring
+		StreamingVertices::Trim(sizeof(VertexPosColTex), batch.FirstVertex, batch.QuadCapacity * 4, batch.QuadCount * 4);
 	}
+
+	batch.Vertices = nullptr;
+	batch.QuadCount = 0;
 }
 
 void GuiBatcher::PushModelTransform(const glm::mat3& transform) {
@@ -298,11 +352,23 @@ void GuiBatcher::__StaticInit()
 
 		__fontShader->Link();
 
-		__vbo = VertexBuffer::Create(BufferUsage::DynamicDraw);
-		__ibo = IndexBuffer::Create(BufferUsage::DynamicDraw, IndexType::UInt);
+		// Every batch is a list of quads, so they can all share the same indices
+		std::vector<uint16_t> indices(QUAD_BATCH_SIZE * 6);
+		for (uint32_t ix = 0; ix < QUAD_BATCH_SIZE; ix++) {
+			uint16_t base = static_cast<uint16_t>(ix * 4);
+			indices[ix * 6 + 0] = base + 0;
+			indices[ix * 6 + 1] = base + 1;
+			indices[ix * 6 + 2] = base + 2;
+			indices[ix * 6 + 3] = base + 0;
+			indices[ix * 6 + 4] = base + 2;
+			indices[ix * 6 + 5] = base + 3;
+		}
+		__ibo = IndexBuffer::Create(BufferUsage::StaticDraw, IndexType::UShort);
+		__ibo->LoadData(indices.data(), static_cast<uint32_t>(indices.size()));
 
 		__vao = VertexArrayObject::Create();
-		__vao->AddVertexBuffer(__vbo, VertexPosColTex::V_DECL);
+		__vertexBinding = __vao->AddVertexBuffer(StreamingVertices::GetBuffer(), VertexPosColTex::V_DECL);
+		__bufferVersion = StreamingVertices::GetBufferVersion();
 		__vao->SetIndexBuffer(__ibo);
 
 		// Generate a simple white texture with a black border
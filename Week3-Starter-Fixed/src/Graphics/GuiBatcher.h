@@ -7,15 +7,28 @@
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
 #include "Graphics/Font.h"
-#include "Utils/MeshBuilder.h"
 #include <unordered_map>
 
 	/// <summary>
 	/// The GUI Batcher class provides utilities for drawing rectangles and
 	/// fonts to the screen in a 2D fashion
+	///
+	/// Quads are written directly into the streaming vertex ring (see StreamingVertices.h),
+	/// with one batch per texture
 	/// </summary>
 	class GuiBatcher {
 	public:
+		/// <summary>
+		/// The number of quads a texture's batch starts with, batches that fill up will
+		/// double in size each time up to QUAD_BATCH_SIZE
+		/// </summary>
+		static const uint32_t MIN_QUAD_BATCH_SIZE = 64;
+		/// <summary>
+		/// The most quads that will be drawn in a single draw call, must keep the vertex
+		/// count within 16 bit indices
+		/// </summary>
+		static const uint32_t QUAD_BATCH_SIZE = 4096;
+
 		/// <summary>
 		/// Adds a rectangle to the GUI batch, with a given border radius in pixels.
 		/// This can be used with textures to create rounded borders
@@ -118,9 +131,16 @@
 			glm::ivec2 Max;
 		};
 
-		struct MeshData {
-			MeshBuilder<VertexPosColTex> Builder;
-			bool IsFont;
+		struct QuadBatch {
+			// The quads we're writing, in the streaming ring
+			VertexPosColTex* Vertices     = nullptr;
+			uint32_t         FirstVertex  = 0;
+			uint32_t         QuadCount    = 0;
+			// The number of quads to allocate, this is kept between frames
+			uint32_t         QuadCapacity = 0;
+			// The version of the streaming buffer that Vertices points into
+			uint32_t         Version      = 0;
+			bool             IsFont       = false;
 		};
 
 		static glm::ivec2 __windowSize;
@@ -130,13 +150,23 @@
 		static std::vector<IRect> __scissorRects;
 		static ShaderProgram::Sptr __shader;
 		static ShaderProgram::Sptr __fontShader;
-		static std::unordered_map<Texture2D*, MeshData> _meshBuilders;
+		static std::unordered_map<Texture2D*, QuadBatch> _batches;
 		static VertexArrayObject::Sptr __vao;
-		static VertexBuffer::Sptr __vbo;
+		static VertexArrayObject::VertexBufferBinding* __vertexBinding;
+		static uint32_t __bufferVersion;
 		static IndexBuffer::Sptr __ibo;
 
 		static Texture2D::Sptr __defaultUITexture;
 		static int __defaultEdgeRadius;
 
 		static void __StaticInit();
+		/// <summary>
+		/// Gets space for the next quad in a batch, drawing the batch and starting a new one if it is full
+		/// </summary>
+		/// <returns>A pointer to the 4 vertices to write, or nullptr if the streaming ring is out of room</returns>
+		static VertexPosColTex* __ReserveQuad(Texture2D* tex, QuadBatch& batch);
+		/// <summary>
+		/// Draws all the quads in a batch, and hands back any space it did not use
+		/// </summary>
+		static void __DrawBatch(Texture2D* tex, QuadBatch& batch);
 	};
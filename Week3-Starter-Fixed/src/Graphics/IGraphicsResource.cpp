@@ -2,9 +2,15 @@
 
 IGraphicsResource::IGraphicsResource() :
 	_debugName(""),
-	_rendererId(0)
+	_rendererId(0),
+	_gpuMemorySize(0),
+	_gpuMemoryCategory(GpuMemoryTracker::Category::Other)
 { }
 
+IGraphicsResource::~IGraphicsResource() {
+	_SetGpuMemorySize(0);
+}
+
 void IGraphicsResource::SetDebugName(const std::string& name)
 {
 	_debugName = name;
@@ -22,6 +28,21 @@ uint32_t IGraphicsResource::GetHandle() const {
 	return _rendererId;
 }
 
+size_t IGraphicsResource::GetGpuMemorySize() const {
+	return _gpuMemorySize;
+}
+
+GpuMemoryTracker::Category IGraphicsResource::GetGpuMemoryCategory() const {
+	return _gpuMemoryCategory;
+}
+
+void IGraphicsResource::SetGpuMemoryCategory(GpuMemoryTracker::Category category) {
+	if (category != _gpuMemoryCategory) {
+		GpuMemoryTracker::OnResourceChanged(this, _gpuMemoryCategory, _gpuMemorySize, category, _gpuMemorySize);
+		_gpuMemoryCategory = category;
+	}
+}
+
 void IGraphicsResource::_SetRenderId(uint32_t renderId)
 {
 	_rendererId = renderId;
@@ -31,3 +52,11 @@ void IGraphicsResource::_SetRenderId(uint32_t renderId)
 		glObjectLabel(*type, _rendererId, _debugName.size(), _debugName.c_str());
 	}
 }
+
+void IGraphicsResource::_SetGpuMemorySize(size_t bytes)
+{
+	if (bytes != _gpuMemorySize) {
+		GpuMemoryTracker::OnResourceChanged(this, _gpuMemoryCategory, _gpuMemorySize, _gpuMemoryCategory, bytes);
+		_gpuMemorySize = bytes;
+	}
+}
@@ -7,6 +7,7 @@
 
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/Macros.h"
+#include "Graphics/GpuMemoryTracker.h"
 
 /**
  * Enumerates all OpenGL resource types, as can be passed into glObjectLabel and other 
@@ -35,7 +36,7 @@ public:
 	// For pointers and deletion of move and copy
 	DEFINE_RESOURCE(IGraphicsResource)
 
-	virtual ~IGraphicsResource() = default;
+	virtual ~IGraphicsResource();
 
 	/**
 	 * Should be overridden in derived classes to return a resource type identifier
@@ -58,6 +59,21 @@ public:
 	 */
 	virtual uint32_t GetHandle() const;
 
+	/**
+	 * Gets the number of bytes of GPU memory this resource has allocated, as reported to the GpuMemoryTracker
+	 */
+	size_t GetGpuMemorySize() const;
+	/**
+	 * Gets the category this resource's memory is counted under
+	 */
+	GpuMemoryTracker::Category GetGpuMemoryCategory() const;
+	/**
+	 * Sets the category this resource's memory is counted under, for instance when a texture
+	 * is used as a render target
+	 * @param category The category to count this resource under
+	 */
+	void SetGpuMemoryCategory(GpuMemoryTracker::Category category);
+
 protected:
 	IGraphicsResource();
 	
@@ -66,7 +82,14 @@ protected:
 	 * is accurate. Should be used instead of setting _rendererId directly
 	 */
 	void _SetRenderId(uint32_t renderId);
+	/**
+	 * Updates the number of bytes of GPU memory this resource occupies, should be called
+	 * whenever storage is allocated, resized or released
+	 */
+	void _SetGpuMemorySize(size_t bytes);
 
 	std::string _debugName;
 	uint32_t    _rendererId;
+	size_t      _gpuMemorySize;
+	GpuMemoryTracker::Category _gpuMemoryCategory;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <EnumToString.h>
 #include "glad/glad.h"
 #include "Graphics/GlEnums.h"
+#include "Graphics/GlStateTracker.h"
 
 /**
  * Represents the state of the OpenGL blend function 
@@ -41,12 +42,12 @@ struct BlendState {
 	 */
 	inline void Apply() {
 		if (BlendEnabled) {
-			glEnable(GL_BLEND);
-			glBlendFuncSeparate(*SrcRgb, *DstRgb, *SrcAlpha, *DstAlpha);
-			glBlendEquationSeparate(*RgbBlendFunc, *AlphaBlendFunc);
+			GlStateTracker::Enable(GL_BLEND);
+			GlStateTracker::BlendFuncSeparate(*SrcRgb, *DstRgb, *SrcAlpha, *DstAlpha);
+			GlStateTracker::BlendEquationSeparate(*RgbBlendFunc, *AlphaBlendFunc);
 		}
 		else  {
-			glDisable(GL_BLEND);
+			GlStateTracker::Disable(GL_BLEND);
 		}
 	}
 };
@@ -92,10 +93,10 @@ struct RasterizerState {
 		glPolygonMode(GL_FRONT, *FrontFaceFill);
 		glPolygonMode(GL_BACK, *BackFaceFill);
 		if (CullMode != CullMode::None) {
-			glEnable(GL_CULL_FACE);
-			glCullFace(*CullMode);
+			GlStateTracker::Enable(GL_CULL_FACE);
+			GlStateTracker::CullFace(*CullMode);
 		} else {
-			glDisable(GL_CULL_FACE);
+			GlStateTracker::Disable(GL_CULL_FACE);
 		}
 	}
 };
\ No newline at end of file
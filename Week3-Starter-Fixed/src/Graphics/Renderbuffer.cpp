@@ -4,6 +4,7 @@ Renderbuffer::Renderbuffer(const RenderbufferDescription& description) :
 	IGraphicsResource(),
 	_description(description)
 {
+	_gpuMemoryCategory = GpuMemoryTracker::Category::RenderTarget;
 	glCreateRenderbuffers(1, &_rendererId);
 
 	if (_description.MultisampleCount > 1) {
@@ -12,6 +13,9 @@ Renderbuffer::Renderbuffer(const RenderbufferDescription& description) :
 	else {
 		glNamedRenderbufferStorage(_rendererId, *_description.Format, _description.Width, _description.Height);
 	}
+
+	size_t samples = _description.MultisampleCount > 1 ? _description.MultisampleCount : 1;
+	_SetGpuMemorySize(GetInternalFormatTexelSize(*_description.Format) * _description.Width * _description.Height * samples);
 }
 
 Renderbuffer::~Renderbuffer() {
@@ -0,0 +1,198 @@
+#include "Graphics/ShaderBinaryCache.h"
+#include "Logging.h"
+#include "Utils/Fnv1a.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+bool ShaderBinaryCache::_enabled = false;
+std::string ShaderBinaryCache::_directory = "";
+std::string ShaderBinaryCache::_driverId = "";
+uint32_t ShaderBinaryCache::_hits = 0;
+uint32_t ShaderBinaryCache::_misses = 0;
+uint32_t ShaderBinaryCache::_rejected = 0;
+double ShaderBinaryCache::_savedMs = 0.0;
+
+// Bump this whenever the file layout or the introspection format changes
+static const uint32_t CacheMagic   = 0x43425053; // "SPBC"
+static const uint32_t CacheVersion = 1;
+
+// Stored at the start of every cache file
+struct CacheFileHeader {
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t Key;
+	uint32_t BinaryFormat;
+	uint32_t BinarySize;
+	uint32_t IntrospectionSize;
+	float    CompileMs;
+};
+
+static uint64_t HashString(const std::string& value, uint64_t hash) {
+	// Include the length so that "ab" + "c" doesn't hash the same as "a" + "bc"
+	uint64_t length = value.size();
+	hash = Fnv1a::HashBytes(&length, sizeof(uint64_t), hash);
+	return Fnv1a::Hash(value, hash);
+}
+
+void ShaderBinaryCache::Init(const std::string& directory, bool enabled) {
+	_directory = directory;
+	_enabled = enabled;
+
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	if (numFormats == 0) {
+		LOG_INFO("Driver does not support program binaries, shader cache disabled");
+		_enabled = false;
+	}
+
+	const char* vendor   = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+	const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	const char* version  = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	_driverId = std::string(vendor ? vendor : "") + "|" + (renderer ? renderer : "") + "|" + (version ? version : "");
+
+	if (_enabled) {
+		std::error_code error;
+		std::filesystem::create_directories(_directory, error);
+		if (error) {
+			LOG_WARN("Failed to create shader cache directory \"{}\", shader cache disabled", _directory);
+			_enabled = false;
+		}
+	}
+}
+
+bool ShaderBinaryCache::IsEnabled() {
+	return _enabled;
+}
+
+uint64_t ShaderBinaryCache::ComputeKey(const std::unordered_map<ShaderPartType, std::string>& sources, const std::vector<std::string>& varyings, bool interleaved) {
+	uint64_t hash = Fnv1a::OFFSET_BASIS;
+	hash = HashString(_driverId, hash);
+
+	// The map has no fixed order, so we sort by stage to keep the key stable
+	std::vector<ShaderPartType> stages;
+	stages.reserve(sources.size());
+	for (const auto& [type, source] : sources) {
+		stages.push_back(type);
+	}
+	std::sort(stages.begin(), stages.end());
+
+	for (ShaderPartType type : stages) {
+		GLenum stage = *type;
+		hash = Fnv1a::HashBytes(&stage, sizeof(GLenum), hash);
+		hash = HashString(sources.at(type), hash);
+	}
+
+	for (const std::string& varying : varyings) {
+		hash = HashString(varying, hash);
+	}
+	uint8_t mode = interleaved ? 1 : 0;
+	return Fnv1a::HashBytes(&mode, 1, hash);
+}
+
+bool ShaderBinaryCache::TryLoad(uint64_t key, uint32_t program, nlohmann::json& outIntrospection) {
+	if (!_enabled) {
+		return false;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::string path = _GetPath(key);
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		_misses++;
+		return false;
+	}
+
+	CacheFileHeader header;
+	file.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader));
+	bool valid = file.good() && header.Magic == CacheMagic && header.Version == CacheVersion && header.Key == key;
+
+	std::vector<char> binary;
+	std::string introspection;
+	if (valid) {
+		binary.resize(header.BinarySize);
+		introspection.resize(header.IntrospectionSize);
+		file.read(binary.data(), header.BinarySize);
+		file.read(&introspection[0], header.IntrospectionSize);
+		valid = file.good();
+	}
+	file.close();
+
+	// Let the driver decide if it still likes the binary, it may have been updated since we stored it
+	GLint status = GL_FALSE;
+	if (valid) {
+		glProgramBinary(program, header.BinaryFormat, binary.data(), header.BinarySize);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+	}
+
+	if (status == GL_FALSE) {
+		LOG_INFO("Discarding rejected program binary \"{}\"", path);
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		_rejected++;
+		_misses++;
+		return false;
+	}
+
+	outIntrospection = nlohmann::json::parse(introspection);
+
+	double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	_savedMs += header.CompileMs - loadMs;
+	_hits++;
+	return true;
+}
+
+void ShaderBinaryCache::Store(uint64_t key, uint32_t program, const nlohmann::json& introspection, double compileMs) {
+	if (!_enabled) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	std::string introspectionText = introspection.dump();
+
+	CacheFileHeader header;
+	header.Magic = CacheMagic;
+	header.Version = CacheVersion;
+	header.Key = key;
+	header.BinaryFormat = format;
+	header.BinarySize = static_cast<uint32_t>(length);
+	header.IntrospectionSize = static_cast<uint32_t>(introspectionText.size());
+	header.CompileMs = static_cast<float>(compileMs);
+
+	std::ofstream file(_GetPath(key), std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		LOG_WARN("Failed to write program binary to \"{}\"", _GetPath(key));
+		return;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+	file.write(binary.data(), header.BinarySize);
+	file.write(introspectionText.data(), header.IntrospectionSize);
+}
+
+void ShaderBinaryCache::LogStats() {
+	if (!_enabled) {
+		return;
+	}
+	uint32_t total = _hits + _misses;
+	float hitRate = total > 0 ? (_hits * 100.0f) / total : 0.0f;
+	LOG_INFO("Shader cache: {}/{} programs loaded from cache ({:.1f}%), {} rejected, saved ~{:.1f}ms", _hits, total, hitRate, _rejected, _savedMs);
+}
+
+std::string ShaderBinaryCache::_GetPath(uint64_t key) {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+	return (std::filesystem::path(_directory) / name).string();
+}
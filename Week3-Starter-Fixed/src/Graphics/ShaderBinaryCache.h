@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <json.hpp>
+
+#include "Graphics/GlEnums.h"
+
+/// <summary>
+/// Stores linked shader program binaries on disk, so that programs with the same source can skip
+/// compiling and linking on the next run
+///
+/// Binaries are keyed on a hash of every stage's fully resolved source, the transform feedback
+/// varyings, and the driver's vendor, renderer and version strings, since binaries are only valid
+/// for the driver that produced them. The program's introspection results are stored alongside the
+/// binary, so a cache hit does not need to query the program either. If the driver rejects a binary
+/// it is deleted, and the program is compiled from source as normal
+/// </summary>
+class ShaderBinaryCache {
+public:
+	ShaderBinaryCache() = delete;
+
+	/// <summary>
+	/// Sets up the cache, must be called after the GL context has been created. The cache is
+	/// disabled if the driver does not support any program binary formats
+	/// </summary>
+	/// <param name="directory">The directory to store binaries in, created if it does not exist</param>
+	/// <param name="enabled">False to always compile from source</param>
+	static void Init(const std::string& directory, bool enabled = true);
+
+	/// <summary>
+	/// Returns true if programs should be looked up in and stored to the cache
+	/// </summary>
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Computes the cache key for a program
+	/// </summary>
+	/// <param name="sources">The resolved source for each stage of the program</param>
+	/// <param name="varyings">The transform feedback varyings registered on the program</param>
+	/// <param name="interleaved">True if the varyings are interleaved</param>
+	static uint64_t ComputeKey(const std::unordered_map<ShaderPartType, std::string>& sources, const std::vector<std::string>& varyings, bool interleaved);
+
+	/// <summary>
+	/// Tries to load a program from the cache
+	/// </summary>
+	/// <param name="key">The key from ComputeKey</param>
+	/// <param name="program">The program to load the binary into</param>
+	/// <param name="outIntrospection">Will store the introspection results that were cached with the program</param>
+	/// <returns>True if the binary was found and accepted by the driver, and the program is linked</returns>
+	static bool TryLoad(uint64_t key, uint32_t program, nlohmann::json& outIntrospection);
+
+	/// <summary>
+	/// Stores a successfully linked program in the cache. The program should have been linked with
+	/// GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	/// </summary>
+	/// <param name="key">The key from ComputeKey</param>
+	/// <param name="program">The linked program</param>
+	/// <param name="introspection">The program's introspection results</param>
+	/// <param name="compileMs">How long it took to compile and link the program from source, in milliseconds</param>
+	static void Store(uint64_t key, uint32_t program, const nlohmann::json& introspection, double compileMs);
+
+	/// <summary>
+	/// Logs the hit rate of the cache, and roughly how much time it saved
+	/// </summary>
+	static void LogStats();
+
+protected:
+	static bool        _enabled;
+	static std::string _directory;
+	// The vendor, renderer and version strings for the current driver
+	static std::string _driverId;
+
+	static uint32_t    _hits;
+	static uint32_t    _misses;
+	static uint32_t    _rejected;
+	// The compile times stored with every binary we've loaded, minus the time it took to load them
+	static double      _savedMs;
+
+	static std::string _GetPath(uint64_t key);
+};
@@ -0,0 +1,153 @@
+#include "Graphics/ShaderPreprocessor.h"
+#include "Logging.h"
+
+#include "Utils/FileHelpers.h"
+#include "Utils/StringUtils.h"
+
+std::unordered_map<std::string, ShaderPreprocessor::CachedFile> ShaderPreprocessor::_files;
+
+ShaderPreprocessor::Result ShaderPreprocessor::Process(const std::string& filename) {
+	Result result;
+	std::unordered_set<std::string> included;
+	_Append(std::filesystem::path(filename).lexically_normal().string(), result, included);
+	return result;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetIncludes(const std::string& filename) {
+	std::vector<std::string> result;
+	auto it = _files.find(filename);
+	if (it != _files.end()) {
+		for (const Segment& segment : it->second.Segments) {
+			if (!segment.Include.empty()) {
+				result.push_back(segment.Include);
+			}
+		}
+	}
+	return result;
+}
+
+std::vector<std::string> ShaderPreprocessor::GetIncludedBy(const std::string& filename) {
+	// Walk the include edges backwards until we stop finding new files
+	std::vector<std::string> result;
+	std::unordered_set<std::string> visited = { filename };
+	std::vector<std::string> open = { filename };
+	while (!open.empty()) {
+		std::string current = open.back();
+		open.pop_back();
+		for (const auto& [path, file] : _files) {
+			if (visited.count(path) != 0) {
+				continue;
+			}
+			for (const Segment& segment : file.Segments) {
+				if (segment.Include == current) {
+					visited.insert(path);
+					open.push_back(path);
+					result.push_back(path);
+					break;
+				}
+			}
+		}
+	}
+	return result;
+}
+
+void ShaderPreprocessor::Invalidate(const std::string& filename) {
+	_files.erase(std::filesystem::path(filename).lexically_normal().string());
+}
+
+void ShaderPreprocessor::ClearCache() {
+	_files.clear();
+}
+
+const ShaderPreprocessor::CachedFile* ShaderPreprocessor::_GetFile(const std::string& path) {
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+	if (error) {
+		return nullptr;
+	}
+
+	auto it = _files.find(path);
+	if (it != _files.end() && it->second.WriteTime == writeTime) {
+		return &it->second;
+	}
+
+	CachedFile& file = _files[path];
+	file.WriteTime = writeTime;
+	file.Segments.clear();
+
+	// Split the file into runs of text between include lines, in a single pass over the contents
+	const std::string contents = FileHelpers::ReadFile(path);
+	const std::filesystem::path folder = std::filesystem::path(path).parent_path();
+	const char* includeToken = "#include";
+	const size_t includeTokenLen = const_strlen(includeToken);
+
+	Segment segment = Segment();
+	size_t lineStart = 0;
+	int lineNumber = 1;
+	while (lineStart < contents.size()) {
+		size_t lineEnd = contents.find('\n', lineStart);
+		lineEnd = lineEnd == std::string::npos ? contents.size() : lineEnd + 1;
+
+		size_t firstChar = contents.find_first_not_of(" \t", lineStart);
+		if (firstChar < lineEnd && contents.compare(firstChar, includeTokenLen, includeToken) == 0) {
+			// Trim whitespace and any quotes
+			std::string includePath = contents.substr(firstChar + includeTokenLen, lineEnd - firstChar - includeTokenLen);
+			StringTools::Trim(includePath);
+			StringTools::Trim(includePath, '"');
+
+			// If it starts with '/', it's relative to application directory, otherwise it's relative to this file
+			std::filesystem::path target = includePath[0] == '/' ? std::filesystem::path(includePath) : folder / includePath;
+
+			segment.Include = target.lexically_normal().string();
+			segment.NextLine = lineNumber + 1;
+			file.Segments.push_back(std::move(segment));
+			segment = Segment();
+		} else {
+			segment.Text.append(contents, lineStart, lineEnd - lineStart);
+		}
+
+		lineStart = lineEnd;
+		lineNumber++;
+	}
+	segment.NextLine = lineNumber;
+	file.Segments.push_back(std::move(segment));
+
+	return &file;
+}
+
+void ShaderPreprocessor::_Append(const std::string& path, Result& result, std::unordered_set<std::string>& included) {
+	included.insert(path);
+
+	const CachedFile* file = _GetFile(path);
+	if (file == nullptr) {
+		LOG_ERROR("Could not find shader file \"{}\"", path);
+		return;
+	}
+
+	// The root file keeps source string 0, so that it's #version stays the first line
+	const int sourceIndex = static_cast<int>(result.Files.size());
+	result.Files.push_back(path);
+	if (sourceIndex > 0) {
+		result.Source += "#line 1 " + std::to_string(sourceIndex) + "\n";
+	}
+
+	for (const Segment& segment : file->Segments) {
+		result.Source += segment.Text;
+		if (segment.Include.empty()) {
+			continue;
+		}
+
+		// Files that have already been included anywhere in this output are skipped, but we keep
+		// a blank line in place of the include so that the line numbers still match
+		if (included.count(segment.Include) != 0) {
+			result.Source += "\n";
+			continue;
+		}
+
+		_Append(segment.Include, result, included);
+		if (!result.Source.empty() && result.Source.back() != '\n') {
+			result.Source += "\n";
+		}
+		result.Source += "#line " + std::to_string(segment.NextLine) + " " + std::to_string(sourceIndex) + "\n";
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+
+/// <summary>
+/// Resolves #include directives in GLSL files
+///
+/// Files are split into their text and include lines once, and kept until their modification time
+/// changes, so a file included by many shaders is only read from disk once. Each file is only
+/// included once per output, no matter how deep in the include tree it's first seen. Included text
+/// is surrounded by #line directives that give every file it's own source string number, so line
+/// numbers in compiler errors can be traced back to the right file with the Files list in the result
+/// </summary>
+class ShaderPreprocessor {
+public:
+	ShaderPreprocessor() = delete;
+
+	/// <summary>
+	/// The output of processing a file
+	/// </summary>
+	struct Result {
+		// The source with all includes resolved
+		std::string              Source;
+		// Every file that went into the source, indexed by the source string number in it's #line directives
+		std::vector<std::string> Files;
+	};
+
+	/// <summary>
+	/// Reads a file and recursively resolves all of it's includes
+	/// </summary>
+	/// <param name="filename">The path of the file to process</param>
+	static Result Process(const std::string& filename);
+
+	/// <summary>
+	/// Gets the files that the given file directly includes, as of the last time it was processed
+	/// </summary>
+	/// <param name="filename">The normalized path of the file, as it appears in Result::Files</param>
+	static std::vector<std::string> GetIncludes(const std::string& filename);
+	/// <summary>
+	/// Gets every cached file that includes the given file, directly or through other includes
+	/// </summary>
+	/// <param name="filename">The normalized path of the file, as it appears in Result::Files</param>
+	static std::vector<std::string> GetIncludedBy(const std::string& filename);
+
+	/// <summary>
+	/// Drops a file from the cache, so that it is read from disk the next time it's needed
+	/// </summary>
+	static void Invalidate(const std::string& filename);
+	/// <summary>
+	/// Drops every file from the cache
+	/// </summary>
+	static void ClearCache();
+
+protected:
+	// A run of text from a file, followed by an include (or the end of the file)
+	struct Segment {
+		std::string Text;
+		// The normalized path of the file to include after the text, empty for the last segment
+		std::string Include;
+		// The line number of the line following the include
+		int         NextLine;
+	};
+
+	struct CachedFile {
+		std::filesystem::file_time_type WriteTime;
+		std::vector<Segment>            Segments;
+	};
+
+	static std::unordered_map<std::string, CachedFile> _files;
+
+	/// <summary>
+	/// Gets a file from the cache, reading and splitting it if it has changed on disk
+	/// </summary>
+	/// <returns>The cached file, or nullptr if it could not be found</returns>
+	static const CachedFile* _GetFile(const std::string& path);
+	/// <summary>
+	/// Appends a file and everything it includes to the result
+	/// </summary>
+	static void _Append(const std::string& path, Result& result, std::unordered_set<std::string>& included);
+};
@@ -3,22 +3,56 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Graphics/ShaderBinaryCache.h"
+#include "Graphics/ShaderPreprocessor.h"
+#include "Graphics/GlStateTracker.h"
+
+// From GL_KHR_parallel_shader_compile, which our GL loader may not include
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+int ShaderProgram::_batchDepth = 0;
+bool ShaderProgram::_parallelCompileSupported = false;
+std::vector<ShaderProgram*> ShaderProgram::_pendingPrograms;
+std::vector<ShaderProgram*> ShaderProgram::_livePrograms;
 
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_interleavedVaryings(true),
+	_defines(),
+	_linkPending(false),
+	_linkSucceeded(false),
+	_storeInCache(false),
+	_cacheKey(0),
+	_linkStart(),
+	_reloadCount(0)
 {
 	_rendererId = glCreateProgram();
+	_livePrograms.push_back(this);
 }
 
-ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths) :
+ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths, const std::map<std::string, std::string>& defines) :
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_interleavedVaryings(true),
+	_defines(defines),
+	_linkPending(false),
+	_linkSucceeded(false),
+	_storeInCache(false),
+	_cacheKey(0),
+	_linkStart(),
+	_reloadCount(0)
 {
 	_rendererId = glCreateProgram();
+	_livePrograms.push_back(this);
 	for (auto& [type, path] : filePaths) {
 		LoadShaderPartFromFile(path.c_str(), type);
 	}
@@ -26,20 +60,83 @@ ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::strin
 }
 
 ShaderProgram::~ShaderProgram() {
+	// Make sure a batch doesn't try to resolve us after we're gone
+	auto it = std::find(_pendingPrograms.begin(), _pendingPrograms.end(), this);
+	if (it != _pendingPrograms.end()) {
+		_pendingPrograms.erase(it);
+	}
+	_livePrograms.erase(std::remove(_livePrograms.begin(), _livePrograms.end(), this), _livePrograms.end());
+	for (auto& [type, id] : _handles) {
+		glDeleteShader(id);
+	}
+
 	if (_rendererId != 0) {
+		GlStateTracker::OnProgramDeleted(_rendererId);
 		glDeleteProgram(_rendererId);
 		_rendererId = 0;
 	}
 }
 
 bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
+	if (source == nullptr || source[0] == '\0') {
+		LOG_WARN("Ignoring empty source for {} stage", ~type);
+		return false;
+	}
+
+	// If we're overwriting, warn before we store
+	if (_stageSources.count(type) != 0) {
+		LOG_WARN("Another shader has been attached to this slot, overwriting");
+	}
+	_stageSources[type] = source;
+	_stageFiles.erase(type);
+
+	// Store info about where we got this data from
+	_fileSourceMap[type].IsFilePath = false;
+	_fileSourceMap[type].Source = source;
+
+	return true;
+}
+
+int ShaderProgram::_CompileStage(ShaderPartType type, const std::string& source) {
 	// Creates a new shader part (VS, FS, GS, etc...)
 	GLuint handle = glCreateShader((GLenum)type);
 
 	// Load the GLSL source and compile it
-	glShaderSource(handle, 1, &source, nullptr);
+	const char* sourcePtr = source.c_str();
+	glShaderSource(handle, 1, &sourcePtr, nullptr);
 	glCompileShader(handle);
 
+	return handle;
+}
+
+std::string ShaderProgram::_InjectDefines(const std::string& source) const {
+	if (_defines.empty()) {
+		return source;
+	}
+
+	// Defines have to come after #version, which has to be the first thing in the file
+	size_t insertAt = 0;
+	size_t version = source.find("#version");
+	if (version != std::string::npos) {
+		size_t lineEnd = source.find('\n', version);
+		insertAt = lineEnd != std::string::npos ? lineEnd + 1 : source.size();
+	}
+
+	std::stringstream result;
+	result << source.substr(0, insertAt);
+	if (insertAt > 0 && source[insertAt - 1] != '\n') {
+		result << '\n';
+	}
+	for (const auto& [name, value] : _defines) {
+		result << "#define " << name << " " << value << "\n";
+	}
+	// Keep line numbers in compiler errors matching the file
+	result << "#line " << (std::count(source.begin(), source.begin() + insertAt, '\n') + 1) << "\n";
+	result << source.substr(insertAt);
+	return result.str();
+}
+
+bool ShaderProgram::_CheckStageStatus(ShaderPartType type, int handle) {
 	// Get the compilation status for the shader part
 	GLint status = 0;
 	glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
@@ -57,44 +154,35 @@ bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
 
 		// Dump error log
 		LOG_ERROR("Failed to compile shader part:\n{}", log);
+		if (_fileSourceMap[type].IsFilePath) {
+			LOG_ERROR("Source File: {}", _fileSourceMap[type].Source);
+		}
+		// The source string numbers in the log are set by #line directives around our includes
+		auto files = _stageFiles.find(type);
+		if (files != _stageFiles.end() && files->second.size() > 1) {
+			LOG_ERROR("Source strings:");
+			for (size_t ix = 0; ix < files->second.size(); ix++) {
+				LOG_ERROR("\t{}: {}", ix, files->second[ix]);
+			}
+		}
 
 		// Clean up our log memory
 		delete[] log;
-
-		// Delete the broken shader result
-		glDeleteShader(handle);
-		handle = 0;
-
-		return false;
 	}
 
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
-		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
-	}
-	_handles[type] = handle;
-
-	// Store info about where we got this data from
-	_fileSourceMap[type].IsFilePath = false;
-	_fileSourceMap[type].Source = source;
-
 	return status != GL_FALSE;
 }
 
 bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
 	// Make sure that the file exists before we try reading
 	if (std::filesystem::exists(path)) {
-		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// Load the source from the file, resolving any #include directives
+		ShaderPreprocessor::Result processed = ShaderPreprocessor::Process(path);
 		// Pass off to LoadShaderPart
-		bool result =  LoadShaderPart(source.c_str(), type);
+		bool result =  LoadShaderPart(processed.Source.c_str(), type);
 		_fileSourceMap[type].IsFilePath = true;
 		_fileSourceMap[type].Source = path;
-		if (result == false) {
-			LOG_ERROR("Source File: {}", path);
-		}
+		_stageFiles[type] = std::move(processed.Files);
 		return result; 
 	} else {
 		LOG_WARN("Could not open file at \"{}\"", path);
@@ -103,26 +191,84 @@ bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type
 }
 
 bool ShaderProgram::Link() {
+	// Make sure we're not replacing a program that is still in flight
+	_EnsureLinked();
 
+	if (!_SubmitLink()) {
+		return _linkSucceeded;
+	}
+
+	// In a batch, we check on the program once it's needed, so that the driver can keep compiling in the meantime
+	if (_batchDepth > 0) {
+		_pendingPrograms.push_back(this);
+		return true;
+	}
+	return _ResolveLink();
+}
+
+bool ShaderProgram::_SubmitLink() {
 	LOG_TRACE("Starting shader link:");
+
+	// If we've linked this exact source before, the driver can give us back the program without compiling anything
+	std::unordered_map<ShaderPartType, std::string> sources;
+	for (auto& [type, source] : _stageSources) {
+		sources[type] = _InjectDefines(source);
+	}
+
+	_storeInCache = ShaderBinaryCache::IsEnabled() && !sources.empty();
+	if (_storeInCache) {
+		_cacheKey = ShaderBinaryCache::ComputeKey(sources, _varyings, _interleavedVaryings);
+		nlohmann::json introspection;
+		if (ShaderBinaryCache::TryLoad(_cacheKey, _rendererId, introspection)) {
+			LOG_TRACE("Loaded program from binary cache, skipping compile");
+			_IntrospectionFromJson(introspection);
+			_linkSucceeded = true;
+			return false;
+		}
+	}
+
+	_linkStart = std::chrono::high_resolution_clock::now();
+
+	// Submit all our stages, we don't check on them until the program is resolved so that they can compile in parallel
+	for (auto& [type, source] : sources) {
+		_handles[type] = _CompileStage(type, source);
+	}
 	
 	// Attach all our shaders
 	for (auto& [type, id] : _handles) {
-		if (id != 0) {
-			glAttachShader(_rendererId, id);
-			LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
-		}
+		glAttachShader(_rendererId, id);
+		LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+	}
+
+	// Let the driver know we'll want the binary back, so that it can keep it around
+	if (_storeInCache) {
+		glProgramParameteri(_rendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	}
 
 	// Perform linking
 	glLinkProgram(_rendererId);
 
+	_linkPending = true;
+	return true;
+}
+
+bool ShaderProgram::_ResolveLink() {
+	_linkPending = false;
+	auto it = std::find(_pendingPrograms.begin(), _pendingPrograms.end(), this);
+	if (it != _pendingPrograms.end()) {
+		_pendingPrograms.erase(it);
+	}
+
+	// Check on all our stages, this is where we'll wait on the driver if it's still compiling
+	bool compiled = true;
+	for (auto& [type, id] : _handles) {
+		compiled &= _CheckStageStatus(type, id);
+	}
+
 	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
 	for (auto& [type, id] : _handles) { 
-		if (id != 0) {
-			glDetachShader(_rendererId, id);
-			glDeleteShader(id);
-		}
+		glDetachShader(_rendererId, id);
+		glDeleteShader(id);
 	}
 	// Remove all the handles so we don't accidentally use them
 	_handles.clear();
@@ -141,10 +287,10 @@ bool ShaderProgram::Link() {
 			// Read the log from openGL
 			char* log = new char[length];
 			glGetProgramInfoLog(_rendererId, length, &length, log);
-			LOG_ERROR("Shader failed to link:\n{}", log);
+			LOG_ERROR("Shader \"{}\" failed to link:\n{}", _debugName, log);
 			delete[] log;
 		} else {
-			LOG_ERROR("Shader failed to link for an unknown reason!");
+			LOG_ERROR("Shader \"{}\" failed to link for an unknown reason!", _debugName);
 		}
 	} else {
 		LOG_TRACE("Linking complete, starting introspection");
@@ -153,17 +299,159 @@ bool ShaderProgram::Link() {
 	// Perform our uniform introspection to see what uniforms are in the shader
 	_Introspect();
 
-	return status != GL_FALSE;
+	_linkSucceeded = compiled && status != GL_FALSE;
+	if (_storeInCache && _linkSucceeded) {
+		double compileMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _linkStart).count();
+		ShaderBinaryCache::Store(_cacheKey, _rendererId, _IntrospectionToJson(), compileMs);
+	}
+
+	return _linkSucceeded;
+}
+
+void ShaderProgram::_EnsureLinked() const {
+	if (_linkPending) {
+		// Resolving only fills in what the link already determined, so we treat it as part of reading the results
+		const_cast<ShaderProgram*>(this)->_ResolveLink();
+	}
+}
+
+bool ShaderProgram::IsLinkComplete() const {
+	if (!_linkPending) {
+		return true;
+	}
+	if (!_parallelCompileSupported) {
+		return false;
+	}
+	GLint complete = GL_FALSE;
+	glGetProgramiv(_rendererId, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete != GL_FALSE;
+}
+
+void ShaderProgram::BeginCompileBatch() {
+	_batchDepth++;
+}
+
+void ShaderProgram::AwaitCompileBatch() {
+	LOG_ASSERT(_batchDepth > 0, "AwaitCompileBatch called without a matching BeginCompileBatch");
+	if (--_batchDepth > 0 || _pendingPrograms.empty()) {
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	size_t count = _pendingPrograms.size();
+
+	// Resolve programs as the driver finishes them, so that introspection overlaps with the compiles that are still running.
+	// Without the extension we can't ask, so we just go in order
+	while (!_pendingPrograms.empty()) {
+		bool resolvedAny = false;
+		for (size_t ix = 0; ix < _pendingPrograms.size();) {
+			ShaderProgram* program = _pendingPrograms[ix];
+			if (!_parallelCompileSupported || program->IsLinkComplete()) {
+				// Resolving removes the program from the pending list
+				program->_ResolveLink();
+				resolvedAny = true;
+			} else {
+				ix++;
+			}
+		}
+		if (!resolvedAny) {
+			std::this_thread::yield();
+		}
+	}
+
+	double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	LOG_INFO("Waited {:.2f}ms for {} batched shader programs", elapsedMs, count);
+}
+
+bool ShaderProgram::Reload() {
+	// Build the new program on the side, so that we can keep using the old one if it's broken
+	ShaderProgram reloaded;
+	reloaded._debugName = _debugName;
+	reloaded._defines = _defines;
+
+	bool success = !_fileSourceMap.empty();
+	for (auto& [type, source] : _fileSourceMap) {
+		if (source.IsFilePath) {
+			success &= reloaded.LoadShaderPartFromFile(source.Source.c_str(), type);
+		} else {
+			success &= reloaded.LoadShaderPart(source.Source.c_str(), type);
+		}
+	}
+	if (!_varyings.empty()) {
+		std::vector<const char*> names;
+		for (const std::string& name : _varyings) {
+			names.push_back(name.c_str());
+		}
+		reloaded.RegisterVaryings(names.data(), static_cast<int>(names.size()), _interleavedVaryings);
+	}
+
+	// We need to know right away if it worked, even if a batch is open
+	if (success) {
+		reloaded.Link();
+		reloaded._EnsureLinked();
+	}
+	if (!success || !reloaded._linkSucceeded) {
+		LOG_WARN("Failed to reload shader \"{}\", keeping the old program", _debugName);
+		return false;
+	}
+
+	// Swap the new program into this object, the old one will be deleted along with reloaded
+	_EnsureLinked();
+	std::swap(_rendererId, reloaded._rendererId);
+	std::swap(_uniforms, reloaded._uniforms);
+	std::swap(_uniformTable, reloaded._uniformTable);
+	std::swap(_uniformBlocks, reloaded._uniformBlocks);
+	std::swap(_stageSources, reloaded._stageSources);
+	std::swap(_stageFiles, reloaded._stageFiles);
+	_linkSucceeded = true;
+
+	// Carry over any block bindings that were changed after the old program was linked
+	for (const auto& [name, block] : reloaded._uniformBlocks) {
+		if (block.CurrentBinding != block.DefaultBinding) {
+			BindUniformBlockToSlot(name, block.CurrentBinding);
+		}
+	}
+
+	_reloadCount++;
+	return true;
+}
+
+int ShaderProgram::ReloadDependents(const std::string& path) {
+	// Reloading creates and destroys programs, so find everything we need to reload first
+	std::vector<ShaderProgram*> dependents;
+	for (ShaderProgram* program : _livePrograms) {
+		if (program->DependsOn(path)) {
+			dependents.push_back(program);
+		}
+	}
+
+	int result = 0;
+	for (ShaderProgram* program : dependents) {
+		if (program->Reload()) {
+			LOG_INFO("Reloaded shader \"{}\"", program->_debugName);
+			result++;
+		}
+	}
+	return result;
+}
+
+void ShaderProgram::SetParallelCompileSupported(bool value) {
+	_parallelCompileSupported = value;
+}
+
+bool ShaderProgram::IsParallelCompileSupported() {
+	return _parallelCompileSupported;
 }
 
 void ShaderProgram::Bind() {
-	// Simply calls glUseProgram with our shader handle
-	glUseProgram(_rendererId);
+	_EnsureLinked();
+	// Goes through the state tracker, so re-binding the current program is free
+	GlStateTracker::UseProgram(_rendererId);
 }
 
 void ShaderProgram::Unbind() {
 	// We unbind a shader program by using the default program (0)
-	glUseProgram(0);
+	GlStateTracker::UseProgram(0);
 }
 
 void ShaderProgram::SetUniformMatrix(int location, const glm::mat3* value, int count, bool transposed) {
@@ -216,7 +504,7 @@ void ShaderProgram::SetUniform(int location, const glm::bvec4* value, int count)
 	glProgramUniform4i(location, value->x, value->y, value->z, value->w, 1);
 }
 
-void ShaderProgram::SetUniform(int location, ShaderDataType type, void* data, int count /*= 1*/, bool transposed  /* =false*/) {
+void ShaderProgram::SetUniform(int location, ShaderDataType type, const void* data, int count /*= 1*/, bool transposed  /* =false*/) {
 	switch (type)
 	{
 		case ShaderDataType::Bool:    glProgramUniform1i(_rendererId, location, *static_cast<const bool*>(data)); break;
@@ -306,11 +594,97 @@ void ShaderProgram::SetUniform(int location, ShaderDataType type, void* data, in
 	}
 }
 
+int ShaderProgram::GetUniformLocation(const UniformHandle& handle) {
+	_EnsureLinked();
+	return _FindUniformLocation(handle.Hash, handle.Name);
+}
+
 int ShaderProgram::__GetUniformLocation(const std::string& name) {
-	// Since the default constructor for UniformInfo sets location to -1,
-	// we can simply index the map and if it doesn't exist, the default
-	// will be used
-	return _uniforms[name].Location;
+	_EnsureLinked();
+	return _FindUniformLocation(Fnv1a::Hash(name), name.c_str());
+}
+
+int ShaderProgram::_FindUniformLocation(uint64_t hash, const char* name) {
+	auto it = std::lower_bound(_uniformTable.begin(), _uniformTable.end(), hash, [](const UniformLocation& entry, uint64_t value) {
+		return entry.Hash < value;
+	});
+	if (it != _uniformTable.end() && it->Hash == hash) {
+		return it->Location;
+	}
+
+	// Remember the miss so we only warn about it once
+	LOG_WARN("Ignoring uniform \"{}\" in shader \"{}\"", name, _debugName);
+	_uniformTable.insert(it, { hash, -1 });
+	return -1;
+}
+
+void ShaderProgram::_BuildUniformTable() {
+	_uniformTable.clear();
+	_uniformTable.reserve(_uniforms.size());
+	for (const auto& [name, uniform] : _uniforms) {
+		_uniformTable.push_back({ Fnv1a::Hash(name), uniform.Location });
+	}
+	std::sort(_uniformTable.begin(), _uniformTable.end(), [](const UniformLocation& a, const UniformLocation& b) {
+		return a.Hash < b.Hash;
+	});
+
+	for (size_t ix = 1; ix < _uniformTable.size(); ix++) {
+		if (_uniformTable[ix].Hash == _uniformTable[ix - 1].Hash) {
+			LOG_ERROR("Two uniforms in shader \"{}\" have the same name hash, uniform handles will be unreliable", _debugName);
+		}
+	}
+}
+
+const std::string& ShaderProgram::GetShaderPartPath(ShaderPartType type) const {
+	static const std::string empty = "";
+	auto it = _fileSourceMap.find(type);
+	return (it != _fileSourceMap.end() && it->second.IsFilePath) ? it->second.Source : empty;
+}
+
+std::vector<std::string> ShaderProgram::GetDependencies() const {
+	std::vector<std::string> result;
+	for (const auto& [type, files] : _stageFiles) {
+		for (const std::string& file : files) {
+			if (std::find(result.begin(), result.end(), file) == result.end()) {
+				result.push_back(file);
+			}
+		}
+	}
+	return result;
+}
+
+bool ShaderProgram::DependsOn(const std::string& path) const {
+	for (const auto& [type, files] : _stageFiles) {
+		if (std::find(files.begin(), files.end(), path) != files.end()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+ShaderProgram::Sptr ShaderProgram::CreateVariant(const std::map<std::string, std::string>& defines) const {
+	ShaderProgram::Sptr result = ShaderProgram::Create();
+	result->SetDebugName(_debugName + " - variant");
+	result->_defines = _defines;
+	for (const auto& [name, value] : defines) {
+		result->_defines[name] = value;
+	}
+
+	// Copy over all our stages, the defines are what make the variant different
+	bool success = true;
+	for (auto& [key, value] : _fileSourceMap) {
+		if (value.IsFilePath) {
+			success &= result->LoadShaderPartFromFile(value.Source.c_str(), key);
+		} else {
+			success &= result->LoadShaderPart(value.Source.c_str(), key);
+		}
+	}
+
+	if (!success || !result->Link()) {
+		LOG_WARN("Failed to create variant of shader \"{}\"", _debugName);
+		return nullptr;
+	}
+	return result;
 }
 
 nlohmann::json ShaderProgram::ToJson() const {
@@ -319,6 +693,9 @@ nlohmann::json ShaderProgram::ToJson() const {
 	for (auto& [key, value] : _fileSourceMap) {
 		result[~key][value.IsFilePath ? "path" : "source"] = value.Source;
 	}
+	if (!_defines.empty()) {
+		result["defines"] = _defines;
+	}
 	return result;
 
 }
@@ -326,6 +703,9 @@ nlohmann::json ShaderProgram::ToJson() const {
 ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 	ShaderProgram::Sptr result = std::make_shared<ShaderProgram>();
 	result->SetDebugName(JsonGet(data, "name", result->_debugName));
+	if (data.contains("defines")) {
+		result->_defines = data["defines"].get<std::map<std::string, std::string>>();
+	}
 	for (auto& [key, blob] : data.items()) {
 		// Get the shader part type from the key
 		ShaderPartType type = ParseShaderPartType(key, ShaderPartType::Unknown);
@@ -349,6 +729,90 @@ ShaderProgram::Sptr ShaderProgram::FromJson(const nlohmann::json& data) {
 void ShaderProgram::_Introspect() {
 	_IntrospectUniforms();
 	_IntrospectUnifromBlocks();
+	_BuildUniformTable();
+}
+
+/// <summary>
+/// Converts a uniform's info into JSON for the binary cache
+/// </summary>
+static nlohmann::json UniformInfoToJson(const ShaderProgram::UniformInfo& info) {
+	return {
+		{ "name",          info.Name },
+		{ "type",         ~info.Type },
+		{ "array_size",    info.ArraySize },
+		{ "location",      info.Location },
+		{ "binding",       info.Binding },
+		{ "array_stride",  info.ArrayStride },
+		{ "matrix_stride", info.MatrixStride }
+	};
+}
+
+/// <summary>
+/// Restores a uniform's info from the binary cache
+/// </summary>
+static ShaderProgram::UniformInfo UniformInfoFromJson(const nlohmann::json& data) {
+	ShaderProgram::UniformInfo result = ShaderProgram::UniformInfo();
+	result.Name         = data["name"].get<std::string>();
+	result.Type         = ParseShaderDataType(data["type"].get<std::string>(), ShaderDataType::None);
+	result.ArraySize    = data["array_size"].get<int>();
+	result.Location     = data["location"].get<int>();
+	result.Binding      = data["binding"].get<int>();
+	result.ArrayStride  = data["array_stride"].get<int>();
+	result.MatrixStride = data["matrix_stride"].get<int>();
+	return result;
+}
+
+nlohmann::json ShaderProgram::_IntrospectionToJson() const {
+	nlohmann::json uniforms = nlohmann::json::array();
+	for (const auto& [name, uniform] : _uniforms) {
+		uniforms.push_back(UniformInfoToJson(uniform));
+	}
+
+	nlohmann::json blocks = nlohmann::json::array();
+	for (const auto& [name, block] : _uniformBlocks) {
+		nlohmann::json members = nlohmann::json::array();
+		for (const UniformInfo& member : block.SubUniforms) {
+			members.push_back(UniformInfoToJson(member));
+		}
+		blocks.push_back({
+			{ "name",          block.Name },
+			{ "binding",       block.DefaultBinding },
+			{ "block_index",   block.BlockIndex },
+			{ "size",          block.SizeInBytes },
+			{ "members",       members }
+		});
+	}
+
+	return {
+		{ "uniforms", uniforms },
+		{ "blocks",   blocks }
+	};
+}
+
+void ShaderProgram::_IntrospectionFromJson(const nlohmann::json& data) {
+	_uniforms.clear();
+	_uniformBlocks.clear();
+
+	for (const nlohmann::json& blob : data["uniforms"]) {
+		UniformInfo uniform = UniformInfoFromJson(blob);
+		_uniforms[uniform.Name] = uniform;
+	}
+
+	for (const nlohmann::json& blob : data["blocks"]) {
+		UniformBlockInfo block = UniformBlockInfo();
+		block.Name           = blob["name"].get<std::string>();
+		block.DefaultBinding = blob["binding"].get<int>();
+		block.CurrentBinding = block.DefaultBinding;
+		block.BlockIndex     = blob["block_index"].get<int>();
+		block.SizeInBytes    = blob["size"].get<int>();
+		for (const nlohmann::json& member : blob["members"]) {
+			block.SubUniforms.push_back(UniformInfoFromJson(member));
+		}
+		block.NumVariables   = static_cast<int>(block.SubUniforms.size());
+		_uniformBlocks[block.Name] = block;
+	}
+
+	_BuildUniformTable();
 }
 
 void ShaderProgram::_IntrospectUniforms() {
@@ -460,17 +924,21 @@ void ShaderProgram::_IntrospectUnifromBlocks() {
 				GL_NAME_LENGTH,
 				GL_TYPE,
 				GL_ARRAY_SIZE,
-				GL_OFFSET
+				GL_OFFSET,
+				GL_ARRAY_STRIDE,
+				GL_MATRIX_STRIDE
 			};
 			// Query data from the program
-			int props[4];
-			glGetProgramResourceiv(_rendererId, GL_UNIFORM, activeVars[v], 4, pNames, 4, NULL, props);
+			int props[6];
+			glGetProgramResourceiv(_rendererId, GL_UNIFORM, activeVars[v], 6, pNames, 6, NULL, props);
 
 			// Store properties into the UniformInfo
 			UniformInfo var = UniformInfo();
 			var.Type = FromGLShaderDataType(props[1]);
 			var.Location = props[3];
 			var.ArraySize = props[2];
+			var.ArrayStride = props[4];
+			var.MatrixStride = props[5];
 
 			// Get the uniform name
 			var.Name.resize(props[0] - 1);
@@ -493,6 +961,7 @@ void ShaderProgram::_IntrospectUnifromBlocks() {
 
 void ShaderProgram::BindUniformBlockToSlot(const std::string& name, int uboSlot)
 {
+	_EnsureLinked();
 	auto& it = _uniformBlocks.find(name);
 	if (it != _uniformBlocks.end()) {
 		UniformBlockInfo& block = it->second;
@@ -501,7 +970,14 @@ void ShaderProgram::BindUniformBlockToSlot(const std::string& name, int uboSlot)
 	}
 }
 
+const ShaderProgram::UniformBlockInfo* ShaderProgram::FindUniformBlock(const std::string& name) const {
+	_EnsureLinked();
+	auto it = _uniformBlocks.find(name);
+	return it != _uniformBlocks.end() ? &it->second : nullptr;
+}
+
 bool ShaderProgram::FindUniform(const std::string& name, UniformInfo* out) {
+	_EnsureLinked();
 	for (auto& [key, uniform] : _uniforms) {
 		if (uniform.Name == name) {
 			if (out != nullptr) {
@@ -517,7 +993,13 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 	return GlResourceType::ShaderProgram;
 }
 
+void ShaderProgram::SetDefine(const std::string& name, const std::string& value) {
+	_defines[name] = value;
+}
+
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
+	_varyings.assign(names, names + numVaryings);
+	_interleavedVaryings = interleaved;
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
 }
@@ -1,8 +1,11 @@
 #pragma once
 #include <glad/glad.h>
 #include <memory>
+#include <vector>
+#include <chrono>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <map>
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include <Logging.h>            // for the logging functions
@@ -11,6 +14,7 @@
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
+#include "Graphics/UniformHandle.h"
 
 /// <summary>
 /// This class will wrap around an OpenGL shader program
@@ -29,8 +33,12 @@ public:
 	struct UniformInfo {
 		ShaderDataType Type;
 		int            ArraySize;
+		// The uniform location, or the byte offset within the block for uniform block members
 		int            Location;
 		int            Binding;
+		// The distance in bytes between array elements and matrix columns (uniform block members only)
+		int            ArrayStride;
+		int            MatrixStride;
 		std::string    Name;
 
 		UniformInfo() :
@@ -38,6 +46,8 @@ public:
 			ArraySize(0),
 			Location(-1),
 			Binding(-1),
+			ArrayStride(0),
+			MatrixStride(0),
 			Name("") {}
 	};
 
@@ -64,13 +74,19 @@ public:
 	/// </summary>
 	ShaderProgram();
 
-	ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths);
+	/// <summary>
+	/// Creates and links a new shader from the given files
+	/// </summary>
+	/// <param name="filePaths">The path to the file for each stage</param>
+	/// <param name="defines">Preprocessor defines to add to every stage, see SetDefine</param>
+	ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths, const std::map<std::string, std::string>& defines = {});
 
 	// Note, we don't need to make this virtual since this class is marked final (basically it can't be used as a base class)
 	~ShaderProgram();
 
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader)
+	/// Compiling is deferred until Link, so that it can be skipped if the program is in the binary cache
 	/// </summary>
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
@@ -93,11 +109,65 @@ public:
 	void RegisterVaryings(const char* const* names, int numVaryings, bool interleaved = true);
 
 	/// <summary>
-	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// Adds a #define to every stage of this shader, right after the #version directive. Must be called before Link
+	/// </summary>
+	/// <param name="name">The name of the macro to define</param>
+	/// <param name="value">The value to give the macro</param>
+	void SetDefine(const std::string& name, const std::string& value = "1");
+	const std::map<std::string, std::string>& GetDefines() const { return _defines; }
+
+	/// <summary>
+	/// Compiles and links all the loaded stages, and allows this shader program to be used. If the
+	/// program is in the binary cache, the cached binary is used instead
+	/// 
+	/// While a compile batch is open, this only submits the work to the driver and returns true. The
+	/// result is checked when the program is first used or the batch is awaited, and errors are logged then
 	/// </summary>
-	/// <returns>True if the linking was successful, false if otherwise</returns>
+	/// <returns>True if the linking was successful or deferred, false if otherwise</returns>
 	bool Link();
 
+	/// <summary>
+	/// Returns true if the program has been linked and checked, or if the driver reports that it has
+	/// finished linking so that checking it will not stall
+	/// </summary>
+	bool IsLinkComplete() const;
+
+	/// <summary>
+	/// Starts a batch of shader compiles. Until the batch is awaited, Link will only submit programs
+	/// to the driver, so that compiling them can overlap. Batches can be nested
+	/// </summary>
+	static void BeginCompileBatch();
+	/// <summary>
+	/// Ends the current batch. When the outermost batch ends, every program linked during it that has
+	/// not been used yet is checked and introspected, in the order that the driver finishes them
+	/// </summary>
+	static void AwaitCompileBatch();
+
+	/// <summary>
+	/// Lets shader programs know if the driver supports GL_KHR_parallel_shader_compile, which lets us
+	/// ask whether a program has finished linking without waiting on it
+	/// </summary>
+	static void SetParallelCompileSupported(bool value);
+	static bool IsParallelCompileSupported();
+
+	/// <summary>
+	/// Rebuilds this program from it's files, keeping the same object so that anything holding onto it
+	/// (like materials) picks up the changes. If the new program fails to compile or link, the old one is kept
+	/// </summary>
+	/// <returns>True if the program was replaced</returns>
+	bool Reload();
+	/// <summary>
+	/// Gets the number of times this program has been successfully reloaded, so that anything caching
+	/// uniform locations can tell when it needs to look them up again
+	/// </summary>
+	uint32_t GetReloadCount() const { return _reloadCount; }
+	/// <summary>
+	/// Reloads every live program that was loaded from or includes the given file
+	/// </summary>
+	/// <param name="path">The normalized path of the file that changed</param>
+	/// <returns>The number of programs that were reloaded successfully</returns>
+	static int ReloadDependents(const std::string& path);
+
 	/// <summary>
 	/// Binds this shader for use
 	/// </summary>
@@ -107,7 +177,38 @@ public:
 	/// </summary>
 	static void Unbind();
 
-	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
+	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { _EnsureLinked(); return _uniforms; }
+
+	/// <summary>
+	/// Gets the uniform block with the given name, or nullptr if the program does not use the block
+	/// </summary>
+	/// <param name="name">The name of the block as declared in the shader (ex: b_Material)</param>
+	const UniformBlockInfo* FindUniformBlock(const std::string& name) const;
+
+	/// <summary>
+	/// Gets the path of the file that the given shader stage was loaded from, or an empty string
+	/// if the stage was loaded from source or does not exist
+	/// </summary>
+	/// <param name="type">The shader stage to get the path for</param>
+	const std::string& GetShaderPartPath(ShaderPartType type) const;
+
+	/// <summary>
+	/// Gets every file that went into this program's stages, including the files they include
+	/// </summary>
+	std::vector<std::string> GetDependencies() const;
+	/// <summary>
+	/// Returns true if any of this program's stages were loaded from or include the given file
+	/// </summary>
+	/// <param name="path">The normalized path of the file (ex: ../res/shaders/fragments/frame_uniforms.glsl)</param>
+	bool DependsOn(const std::string& path) const;
+
+	/// <summary>
+	/// Creates and links a new shader program that uses the same stages and defines as this one, with
+	/// some extra defines added. Useful for things like instanced versions of a shader
+	/// </summary>
+	/// <param name="defines">The defines to add, or override if this program already has them</param>
+	/// <returns>The new shader program, or nullptr if it failed to link</returns>
+	ShaderProgram::Sptr CreateVariant(const std::map<std::string, std::string>& defines) const;
 
 	// Inherited from IGraphicsResource
 
@@ -120,6 +221,12 @@ public:
 
 public:
 	bool FindUniform(const std::string& name, UniformInfo* out);
+	/// <summary>
+	/// Gets the location of a uniform from its handle, without touching any strings. Logs a warning
+	/// the first time a handle that isn't in the program is used
+	/// </summary>
+	/// <returns>The uniform location, or -1 if the program has no such uniform</returns>
+	int GetUniformLocation(const UniformHandle& handle);
 
 	void SetUniformMatrix(int location, const glm::mat3* value, int count = 1, bool transposed = false);
 	void SetUniformMatrix(int location, const glm::mat4* value, int count = 1, bool transposed = false);
@@ -144,24 +251,43 @@ public:
 	/// <param name="data">A pointer to the data to upload</param>
 	/// <param name="count">The size of the uniform array, in elements</param>
 	/// <param name="transposed"True if matrices should be transposed</param>
-	void SetUniform(int location, ShaderDataType type, void* data, int count = 1, bool transposed = false);
+	void SetUniform(int location, ShaderDataType type, const void* data, int count = 1, bool transposed = false);
+
+	template <typename T>
+	void SetUniform(const UniformHandle& handle, const T& value) {
+		int location = GetUniformLocation(handle);
+		if (location != -1) {
+			SetUniform(location, &value, 1);
+		}
+	}
+	template <typename T>
+	void SetUniform(const UniformHandle& handle, const T* values, int count = 1) {
+		int location = GetUniformLocation(handle);
+		if (location != -1) {
+			SetUniform(location, values, count);
+		}
+	}
+	template <typename T>
+	void SetUniformMatrix(const UniformHandle& handle, const T& value, bool transposed = false) {
+		int location = GetUniformLocation(handle);
+		if (location != -1) {
+			SetUniformMatrix(location, &value, 1, transposed);
+		}
+	}
 
+	// The string versions hash the name on every call, prefer handles for anything set every frame
 	template <typename T>
 	void SetUniform(const std::string& name, const T& value) {
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
 			SetUniform(location, &value, 1);
-		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
 		}
 	}
 	template <typename T>
 	void SetUniform(const std::string& name, const T* values, int count = 1) {
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
-			SetUniform(location, &values, count);
-		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
+			SetUniform(location, values, count);
 		}
 	}
 	template <typename T>
@@ -169,8 +295,6 @@ public:
 		int location = __GetUniformLocation(name);
 		if (location != -1) {
 			SetUniformMatrix(location, &value, 1, transposed);
-		} else {
-			LOG_WARN("Ignoring uniform \"{}\"", name);
 		}
 	}
 	
@@ -185,6 +309,14 @@ protected:
 	std::unordered_map<std::string, UniformInfo> _uniforms;
 	std::unordered_map<std::string, UniformBlockInfo> _uniformBlocks;
 
+	// Uniform locations keyed on the hash of their name, sorted by hash so handles can be found with
+	// a binary search. Names that were looked up but don't exist are added with a location of -1
+	struct UniformLocation {
+		uint64_t Hash;
+		int      Location;
+	};
+	std::vector<UniformLocation> _uniformTable;
+
 	// Stores information about the source of our shader parts
 	// EX: if a VS shader is loaded from a file, will contain
 	// the file path, and IsFilePath=true
@@ -194,6 +326,66 @@ protected:
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	// The fully resolved source for each stage, compiled during Link
+	std::unordered_map<ShaderPartType, std::string> _stageSources;
+	// The files that went into each stage loaded from a file, indexed by their #line source string number
+	std::unordered_map<ShaderPartType, std::vector<std::string>> _stageFiles;
+	// The transform feedback varyings, kept so that they can be part of the binary cache key
+	std::vector<std::string> _varyings;
+	bool                     _interleavedVaryings;
+	// Macros injected into every stage, sorted so that the same set always produces the same source
+	std::map<std::string, std::string> _defines;
+
+	// True if the program was submitted to the driver, but we haven't checked the result yet
+	bool     _linkPending;
+	bool     _linkSucceeded;
+	// Whether the linked program should be stored in the binary cache, and under which key
+	bool     _storeInCache;
+	uint64_t _cacheKey;
+	std::chrono::high_resolution_clock::time_point _linkStart;
+
+	uint32_t _reloadCount;
+
+	static int  _batchDepth;
+	static bool _parallelCompileSupported;
+	// Every program that currently exists, so we can find the ones to reload when a file changes
+	static std::vector<ShaderProgram*> _livePrograms;
+	// Programs that were submitted during a batch and have not been resolved yet
+	static std::vector<ShaderProgram*> _pendingPrograms;
+
+	/// <summary>
+	/// Starts compiling a single shader stage, without waiting for the result
+	/// </summary>
+	/// <param name="type">The stage to compile</param>
+	/// <param name="source">The GLSL source for the stage</param>
+	/// <returns>The handle to the shader</returns>
+	int _CompileStage(ShaderPartType type, const std::string& source);
+	/// <summary>
+	/// Gets the source for a stage with our defines added after the #version directive
+	/// </summary>
+	std::string _InjectDefines(const std::string& source) const;
+	/// <summary>
+	/// Checks if a shader stage compiled, logging the errors if it did not
+	/// </summary>
+	/// <returns>True if the stage compiled successfully</returns>
+	bool _CheckStageStatus(ShaderPartType type, int handle);
+
+	/// <summary>
+	/// Submits all of our stages to the driver for compiling and linking, without checking the results.
+	/// If the program is in the binary cache, it is loaded and resolved immediately instead
+	/// </summary>
+	/// <returns>True if the program needs to be resolved with _ResolveLink</returns>
+	bool _SubmitLink();
+	/// <summary>
+	/// Checks the results of a submitted link, cleans up the stages, and performs introspection
+	/// </summary>
+	/// <returns>True if the program linked successfully</returns>
+	bool _ResolveLink();
+	/// <summary>
+	/// Resolves the program if it is still pending, called before anything that needs the link results
+	/// </summary>
+	void _EnsureLinked() const;
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -208,6 +400,22 @@ protected:
 	/// fed data from a uniform buffer
 	/// </summary>
 	void _IntrospectUnifromBlocks();
+	/// <summary>
+	/// Stores the results of introspection, so they can be cached with the program binary
+	/// </summary>
+	nlohmann::json _IntrospectionToJson() const;
+	/// <summary>
+	/// Restores introspection results that were cached with a program binary
+	/// </summary>
+	void _IntrospectionFromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Rebuilds the uniform table from the introspected uniforms
+	/// </summary>
+	void _BuildUniformTable();
+	/// <summary>
+	/// Looks up a uniform location in the uniform table, logging a warning the first time a missing name is used
+	/// </summary>
+	int _FindUniformLocation(uint64_t hash, const char* name);
 
 	int __GetUniformLocation(const std::string& name);
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "Graphics/ShaderTemplate.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Logging.h"
+
+ShaderTemplate::ShaderTemplate(const std::string& name, const std::unordered_map<ShaderPartType, std::string>& filePaths, const std::vector<std::string>& features) :
+	_name(name),
+	_filePaths(filePaths),
+	_features(features),
+	_variants()
+{
+	LOG_ASSERT(_features.size() <= MAX_FEATURES, "Shader templates can have at most 32 features");
+}
+
+ShaderTemplate::~ShaderTemplate() = default;
+
+uint32_t ShaderTemplate::GetFeatureBit(const std::string& feature) const {
+	for (size_t ix = 0; ix < _features.size(); ix++) {
+		if (_features[ix] == feature) {
+			return 1u << ix;
+		}
+	}
+	LOG_WARN("Shader template \"{}\" has no feature \"{}\"", _name, feature);
+	return 0;
+}
+
+uint32_t ShaderTemplate::GetFeatureMask(const std::vector<std::string>& features) const {
+	uint32_t result = 0;
+	for (const std::string& feature : features) {
+		result |= GetFeatureBit(feature);
+	}
+	return result;
+}
+
+ShaderProgram::Sptr ShaderTemplate::Get(uint32_t features) {
+	auto it = _variants.find(features);
+	if (it != _variants.end()) {
+		return it->second;
+	}
+
+	// Each enabled feature becomes a define, and the debug name lists them so variants are easy to tell apart
+	std::map<std::string, std::string> defines;
+	std::string debugName = _name;
+	for (size_t ix = 0; ix < _features.size(); ix++) {
+		if ((features & (1u << ix)) != 0) {
+			defines[_features[ix]] = "1";
+			debugName += (defines.size() == 1 ? " [" : " | ") + _features[ix];
+		}
+	}
+	if (!defines.empty()) {
+		debugName += "]";
+	}
+
+	// Variants are created as resources so that materials using them can be saved and loaded
+	ShaderProgram::Sptr result = ResourceManager::CreateAsset<ShaderProgram>(_filePaths, defines);
+	result->SetDebugName(debugName);
+	LOG_TRACE("Created shader variant \"{}\"", debugName);
+
+	_variants[features] = result;
+	return result;
+}
+
+ShaderProgram::Sptr ShaderTemplate::Get(const std::vector<std::string>& features) {
+	return Get(GetFeatureMask(features));
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+#include "Graphics/ShaderProgram.h"
+
+/// <summary>
+/// A set of shader stages with optional features that are turned on with preprocessor defines,
+/// so that one set of shader files can replace many hand written variants
+///
+/// Each feature is the name of a macro the shader checks with #ifdef, and is given a bit in a feature
+/// mask in the order it was passed in. Each combination of features is compiled the first time it's
+/// requested, and kept so that later requests for the same mask get the same program
+/// </summary>
+class ShaderTemplate {
+public:
+	MAKE_PTRS(ShaderTemplate);
+	NO_COPY(ShaderTemplate);
+	NO_MOVE(ShaderTemplate);
+
+	/// <summary>
+	/// The most features a template can have, since we store them as bits in a uint32_t
+	/// </summary>
+	static const size_t MAX_FEATURES = 32;
+
+	/// <summary>
+	/// Creates a new template, no programs are compiled until they are requested with Get
+	/// </summary>
+	/// <param name="name">The name of the template, used for the debug names of it's programs</param>
+	/// <param name="filePaths">The path to the file for each stage</param>
+	/// <param name="features">The names of the feature macros, in bit order</param>
+	ShaderTemplate(const std::string& name, const std::unordered_map<ShaderPartType, std::string>& filePaths, const std::vector<std::string>& features);
+	~ShaderTemplate();
+
+	/// <summary>
+	/// Gets the bit for a feature, or 0 if the template does not have the feature
+	/// </summary>
+	uint32_t GetFeatureBit(const std::string& feature) const;
+	/// <summary>
+	/// Gets the mask with the bits for all of the given features set
+	/// </summary>
+	uint32_t GetFeatureMask(const std::vector<std::string>& features) const;
+
+	/// <summary>
+	/// Gets the program with the given features enabled, compiling it if this is the first time
+	/// the combination has been requested
+	/// </summary>
+	/// <param name="features">A mask of the features to enable, from GetFeatureMask</param>
+	ShaderProgram::Sptr Get(uint32_t features = 0);
+	/// <summary>
+	/// Gets the program with the given features enabled, compiling it if this is the first time
+	/// the combination has been requested
+	/// </summary>
+	/// <param name="features">The names of the features to enable</param>
+	ShaderProgram::Sptr Get(const std::vector<std::string>& features);
+
+	const std::string& GetName() const { return _name; }
+	const std::vector<std::string>& GetFeatures() const { return _features; }
+	/// <summary>
+	/// Gets the number of feature combinations that have been compiled so far
+	/// </summary>
+	size_t GetVariantCount() const { return _variants.size(); }
+
+protected:
+	std::string                                     _name;
+	std::unordered_map<ShaderPartType, std::string> _filePaths;
+	std::vector<std::string>                        _features;
+	std::unordered_map<uint32_t, ShaderProgram::Sptr> _variants;
+};
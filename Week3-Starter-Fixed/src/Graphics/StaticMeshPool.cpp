@@ -0,0 +1,246 @@
+#include "Graphics/StaticMeshPool.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <vector>
+
+// Returns true if two vertex declarations will read the same data from a buffer
+static bool DeclarationsMatch(const VertexArrayObject::VertexDeclaration& a, const VertexArrayObject::VertexDeclaration& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (size_t ix = 0; ix < a.size(); ix++) {
+		if (a[ix].Slot != b[ix].Slot || a[ix].Size != b[ix].Size || a[ix].Type != b[ix].Type ||
+			a[ix].Normalized != b[ix].Normalized || a[ix].Stride != b[ix].Stride || a[ix].Offset != b[ix].Offset) {
+			return false;
+		}
+	}
+	return true;
+}
+
+StaticMeshPool::StaticMeshPool(const VertexArrayObject::VertexDeclaration& vDecl, const VertexBuffer::Sptr& instanceBuffer, const VertexArrayObject::VertexDeclaration& instanceDecl) :
+	_vDecl(vDecl),
+	_stride(vDecl.empty() ? 0 : vDecl[0].Stride),
+	_vertices(nullptr),
+	_indices(nullptr),
+	_vertexCount(0),
+	_indexCount(0),
+	_freeVertices(),
+	_freeIndices(),
+	_instanceBuffer(instanceBuffer),
+	_instanceDecl(instanceDecl),
+	_vao(nullptr),
+	_meshes()
+{
+	LOG_ASSERT(_stride > 0, "Mesh pools require a vertex declaration with a stride");
+
+	// Start with enough room for a handful of props, we'll grow as needed
+	_vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	_vertices->LoadData(nullptr, _stride, 4096);
+	_vertices->SetDebugName("Static Mesh Pool Vertices");
+
+	_indices = IndexBuffer::Create(BufferUsage::StaticDraw, IndexType::UInt);
+	_indices->LoadData(nullptr, sizeof(uint32_t), 16384, IndexType::UInt);
+	_indices->SetDebugName("Static Mesh Pool Indices");
+
+	_RebuildVao();
+}
+
+StaticMeshPool::~StaticMeshPool() = default;
+
+bool StaticMeshPool::CanPool(const VertexArrayObject::Sptr& mesh) {
+	if (mesh == nullptr || mesh->GetIndexBuffer() == nullptr || mesh->GetElementCount() == 0) {
+		return false;
+	}
+
+	// All the vertex data needs to come from one buffer that we can copy once
+	const auto& buffers = mesh->GetVertexBuffers();
+	if (buffers.size() != 1 || buffers[0]->IsInstanced() || buffers[0]->GetAttributes().empty()) {
+		return false;
+	}
+	return buffers[0]->GetBuffer()->GetUsage() == BufferUsage::StaticDraw;
+}
+
+bool StaticMeshPool::IsCompatible(const VertexArrayObject::Sptr& mesh) const {
+	return CanPool(mesh) && DeclarationsMatch(mesh->GetVertexBuffers()[0]->GetAttributes(), _vDecl);
+}
+
+bool StaticMeshPool::GetOrAdd(const VertexArrayObject::Sptr& mesh, MeshRange& outRange) {
+	// Re-use the existing copy if we've seen this mesh before (and it's not a new mesh at the same address)
+	auto it = _meshes.find(mesh.get());
+	if (it != _meshes.end()) {
+		if (it->second.Source.lock() == mesh) {
+			it->second.Used = true;
+			outRange = it->second.Range;
+			return true;
+		}
+		// The old mesh is gone, so it's space can go to the new one
+		_Release(it->second);
+		_meshes.erase(it);
+	}
+
+	if (!IsCompatible(mesh)) {
+		return false;
+	}
+
+	const IBuffer::Sptr& sourceVertices = mesh->GetVertexBuffers()[0]->GetBuffer();
+	const IndexBuffer::Sptr& sourceIndices = mesh->GetIndexBuffer();
+	uint32_t vertexCount = sourceVertices->GetElementCount();
+	uint32_t indexCount = mesh->GetElementCount();
+
+	// Fill gaps left by removed meshes first, and only grow if nothing fits
+	uint32_t firstVertex = _freeVertices.Allocate(vertexCount);
+	uint32_t firstIndex = _freeIndices.Allocate(indexCount);
+	_Reserve(_freeVertices.End, _freeIndices.End);
+
+	// Vertex data can be copied over without leaving the GPU
+	glCopyNamedBufferSubData(sourceVertices->GetHandle(), _vertices->GetHandle(), 0, (GLintptr)firstVertex * _stride, (GLsizeiptr)vertexCount * _stride);
+
+	// Indices may be 8 or 16 bit, so we read them back and widen them. This only happens once per mesh
+	size_t indexSize = GetIndexTypeSize(sourceIndices->GetElementType());
+	std::vector<uint8_t> rawIndices(indexSize * indexCount);
+	glGetNamedBufferSubData(sourceIndices->GetHandle(), 0, (GLsizeiptr)rawIndices.size(), rawIndices.data());
+
+	std::vector<uint32_t> indices(indexCount);
+	for (uint32_t ix = 0; ix < indexCount; ix++) {
+		switch (sourceIndices->GetElementType()) {
+			case IndexType::UByte:  indices[ix] = rawIndices[ix]; break;
+			case IndexType::UShort: indices[ix] = reinterpret_cast<const uint16_t*>(rawIndices.data())[ix]; break;
+			default:                indices[ix] = reinterpret_cast<const uint32_t*>(rawIndices.data())[ix]; break;
+		}
+	}
+	_indices->UpdateSubData(indices.data(), firstIndex * sizeof(uint32_t), indexCount * sizeof(uint32_t));
+
+	PooledMesh& entry = _meshes[mesh.get()];
+	entry.Source = mesh;
+	entry.Range.IndexCount = indexCount;
+	entry.Range.FirstIndex = firstIndex;
+	entry.Range.BaseVertex = static_cast<int32_t>(firstVertex);
+	entry.VertexCount = vertexCount;
+	entry.Used = true;
+
+	_vertexCount += vertexCount;
+	_indexCount += indexCount;
+
+	outRange = entry.Range;
+	return true;
+}
+
+bool StaticMeshPool::Remove(const VertexArrayObject::Sptr& mesh) {
+	auto it = _meshes.find(mesh.get());
+	if (it == _meshes.end() || it->second.Source.lock() != mesh) {
+		return false;
+	}
+	_Release(it->second);
+	_meshes.erase(it);
+	return true;
+}
+
+size_t StaticMeshPool::RemoveUnused() {
+	size_t removed = 0;
+	for (auto it = _meshes.begin(); it != _meshes.end();) {
+		if (!it->second.Used || it->second.Source.expired()) {
+			_Release(it->second);
+			it = _meshes.erase(it);
+			removed++;
+		} else {
+			it->second.Used = false;
+			it++;
+		}
+	}
+	return removed;
+}
+
+void StaticMeshPool::_Release(const PooledMesh& mesh) {
+	_freeVertices.Free(static_cast<uint32_t>(mesh.Range.BaseVertex), mesh.VertexCount);
+	_freeIndices.Free(mesh.Range.FirstIndex, mesh.Range.IndexCount);
+	_vertexCount -= mesh.VertexCount;
+	_indexCount -= mesh.Range.IndexCount;
+}
+
+uint32_t StaticMeshPool::FreeList::Allocate(uint32_t count) {
+	// First fit is good enough, pools only change when the render queue does
+	for (size_t ix = 0; ix < Ranges.size(); ix++) {
+		FreeRange& range = Ranges[ix];
+		if (range.Count >= count) {
+			uint32_t start = range.Start;
+			range.Start += count;
+			range.Count -= count;
+			if (range.Count == 0) {
+				Ranges.erase(Ranges.begin() + ix);
+			}
+			return start;
+		}
+	}
+
+	uint32_t start = End;
+	End += count;
+	return start;
+}
+
+void StaticMeshPool::FreeList::Free(uint32_t start, uint32_t count) {
+	if (count == 0) {
+		return;
+	}
+
+	// Keep the list sorted, and merge with the ranges on either side if they touch
+	auto it = std::lower_bound(Ranges.begin(), Ranges.end(), start, [](const FreeRange& range, uint32_t value) {
+		return range.Start < value;
+	});
+	size_t ix = static_cast<size_t>(it - Ranges.begin());
+	Ranges.insert(it, { start, count });
+
+	if (ix + 1 < Ranges.size() && Ranges[ix].Start + Ranges[ix].Count == Ranges[ix + 1].Start) {
+		Ranges[ix].Count += Ranges[ix + 1].Count;
+		Ranges.erase(Ranges.begin() + ix + 1);
+	}
+	if (ix > 0 && Ranges[ix - 1].Start + Ranges[ix - 1].Count == Ranges[ix].Start) {
+		Ranges[ix - 1].Count += Ranges[ix].Count;
+		Ranges.erase(Ranges.begin() + ix);
+		ix--;
+	}
+
+	// Space at the end goes back to being unallocated, so the pool can grow into it
+	if (Ranges[ix].Start + Ranges[ix].Count == End) {
+		End = Ranges[ix].Start;
+		Ranges.erase(Ranges.begin() + ix);
+	}
+}
+
+void StaticMeshPool::_Reserve(uint32_t vertexCount, uint32_t indexCount) {
+	bool changed = false;
+
+	// Buffers are re-created at the new size, and the old contents are copied over on the GPU
+	if (vertexCount > _vertices->GetElementCount()) {
+		VertexBuffer::Sptr vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+		vertices->LoadData(nullptr, _stride, std::max(vertexCount, _vertices->GetElementCount() * 2));
+		vertices->SetDebugName(_vertices->GetDebugName());
+		glCopyNamedBufferSubData(_vertices->GetHandle(), vertices->GetHandle(), 0, 0, (GLsizeiptr)_vertices->GetElementCount() * _stride);
+		_vertices = vertices;
+		changed = true;
+	}
+
+	if (indexCount > _indices->GetElementCount()) {
+		IndexBuffer::Sptr indices = IndexBuffer::Create(BufferUsage::StaticDraw, IndexType::UInt);
+		indices->LoadData(nullptr, sizeof(uint32_t), std::max(indexCount, _indices->GetElementCount() * 2), IndexType::UInt);
+		indices->SetDebugName(_indices->GetDebugName());
+		glCopyNamedBufferSubData(_indices->GetHandle(), indices->GetHandle(), 0, 0, (GLsizeiptr)_indices->GetElementCount() * sizeof(uint32_t));
+		_indices = indices;
+		changed = true;
+	}
+
+	if (changed) {
+		_RebuildVao();
+	}
+}
+
+void StaticMeshPool::_RebuildVao() {
+	_vao = VertexArrayObject::Create();
+	_vao->SetDebugName("Static Mesh Pool");
+	_vao->AddVertexBuffer(_vertices, _vDecl);
+	_vao->SetIndexBuffer(_indices);
+	if (_instanceBuffer != nullptr) {
+		_vao->AddVertexBuffer(_instanceBuffer, _instanceDecl, true);
+	}
+	_vao->SetVDecl(_vDecl);
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include <unordered_map>
+#include <memory>
+#include <vector>
+
+#include "Graphics/VertexArrayObject.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Packs the vertex and index data of static meshes that share a vertex declaration into a single
+/// vertex buffer and a single 32 bit index buffer. Every mesh in the pool can then be drawn from the
+/// same VAO, which lets us submit many different meshes with one glMultiDrawElementsIndirect
+///
+/// Meshes are copied into the pool the first time they are added, so only meshes whose vertex data
+/// will not change afterwards (static draw buffers) can be pooled. Removing a mesh frees it's ranges,
+/// which are re-used by meshes added later
+/// </summary>
+class StaticMeshPool {
+public:
+	MAKE_PTRS(StaticMeshPool);
+
+	/// <summary>
+	/// The location of a mesh within the pool, matches the fields of DrawElementsIndirectCommand
+	/// </summary>
+	struct MeshRange {
+		uint32_t IndexCount;
+		uint32_t FirstIndex;
+		int32_t  BaseVertex;
+	};
+
+	/// <summary>
+	/// Creates a new empty mesh pool
+	/// </summary>
+	/// <param name="vDecl">The vertex attributes that all meshes in the pool share</param>
+	/// <param name="instanceBuffer">A per-instance buffer to attach to the pool's VAO, or nullptr for none</param>
+	/// <param name="instanceDecl">The attributes of the instance buffer</param>
+	StaticMeshPool(const VertexArrayObject::VertexDeclaration& vDecl, const VertexBuffer::Sptr& instanceBuffer, const VertexArrayObject::VertexDeclaration& instanceDecl);
+	~StaticMeshPool();
+
+	NO_COPY(StaticMeshPool);
+	NO_MOVE(StaticMeshPool);
+
+	/// <summary>
+	/// Returns true if the mesh can be stored in a pool, meaning it is indexed, has all it's vertex
+	/// data in a single static draw buffer, and is not instanced
+	/// </summary>
+	static bool CanPool(const VertexArrayObject::Sptr& mesh);
+
+	/// <summary>
+	/// Returns true if the mesh can be pooled, and it's vertex layout matches this pool
+	/// </summary>
+	bool IsCompatible(const VertexArrayObject::Sptr& mesh) const;
+
+	/// <summary>
+	/// Gets the range of a mesh within the pool, copying it into the pool if this is the first time
+	/// we have seen it. Note that this may re-create the pool's VAO
+	/// </summary>
+	/// <param name="mesh">The mesh to look up, must be compatible with this pool</param>
+	/// <param name="outRange">Will store the location of the mesh in the pool's buffers</param>
+	/// <returns>True if the mesh is in the pool</returns>
+	bool GetOrAdd(const VertexArrayObject::Sptr& mesh, MeshRange& outRange);
+
+	/// <summary>
+	/// Removes a mesh from the pool, freeing it's space for other meshes
+	/// </summary>
+	/// <param name="mesh">The mesh to remove</param>
+	/// <returns>True if the mesh was in the pool</returns>
+	bool Remove(const VertexArrayObject::Sptr& mesh);
+	/// <summary>
+	/// Removes every mesh that has not been passed to GetOrAdd since the last call to this, along
+	/// with any meshes that have been destroyed
+	/// </summary>
+	/// <returns>The number of meshes that were removed</returns>
+	size_t RemoveUnused();
+
+	/// <summary>
+	/// Gets the VAO that references the pool's shared buffers
+	/// </summary>
+	const VertexArrayObject::Sptr& GetVao() const { return _vao; }
+
+	/// <summary>
+	/// Gets the number of vertices for the meshes currently in the pool
+	/// </summary>
+	uint32_t GetVertexCount() const { return _vertexCount; }
+	/// <summary>
+	/// Gets the number of indices for the meshes currently in the pool
+	/// </summary>
+	uint32_t GetIndexCount() const { return _indexCount; }
+	/// <summary>
+	/// Gets the number of meshes currently in the pool
+	/// </summary>
+	size_t GetMeshCount() const { return _meshes.size(); }
+
+protected:
+	struct PooledMesh {
+		std::weak_ptr<VertexArrayObject> Source;
+		MeshRange                        Range;
+		uint32_t                         VertexCount;
+		// True if the mesh has been looked up since the last RemoveUnused
+		bool                             Used;
+	};
+
+	// A free block of vertices or indices, as a start element and a count
+	struct FreeRange {
+		uint32_t Start;
+		uint32_t Count;
+	};
+
+	// Free space in the buffers, sorted by start and merged with their neighbours. Space past the
+	// end of the last mesh isn't included
+	struct FreeList {
+		std::vector<FreeRange> Ranges;
+		// The end of the last allocated range
+		uint32_t               End = 0;
+
+		// Finds space for count elements, either in a free range or past the end
+		uint32_t Allocate(uint32_t count);
+		// Returns a range to the list, merging it with any neighbours
+		void Free(uint32_t start, uint32_t count);
+	};
+
+	VertexArrayObject::VertexDeclaration _vDecl;
+	uint32_t                             _stride;
+
+	VertexBuffer::Sptr                   _vertices;
+	IndexBuffer::Sptr                    _indices;
+	uint32_t                             _vertexCount;
+	uint32_t                             _indexCount;
+	FreeList                             _freeVertices;
+	FreeList                             _freeIndices;
+
+	VertexBuffer::Sptr                   _instanceBuffer;
+	VertexArrayObject::VertexDeclaration _instanceDecl;
+
+	VertexArrayObject::Sptr              _vao;
+
+	// The meshes that have already been copied in, keyed on the source VAO
+	std::unordered_map<const VertexArrayObject*, PooledMesh> _meshes;
+
+	// Frees the ranges used by a mesh, does not remove it from _meshes
+	void _Release(const PooledMesh& mesh);
+	// Makes sure the shared buffers can fit the given number of vertices and indices, and re-creates the VAO if they grow
+	void _Reserve(uint32_t vertexCount, uint32_t indexCount);
+	// Re-creates the VAO so that it points at our current buffers
+	void _RebuildVao();
+};
@@ -0,0 +1,80 @@
+#include "Graphics/StreamingVertices.h"
+#include "Logging.h"
+#include <algorithm>
+
+RingBuffer::Sptr StreamingVertices::_buffer = nullptr;
+uint32_t StreamingVertices::_bufferVersion = 0;
+uint32_t StreamingVertices::_requiredRegionSize = 0;
+StreamingVertices::FrameStats StreamingVertices::_currentFrame;
+StreamingVertices::FrameStats StreamingVertices::_lastFrame;
+
+void* StreamingVertices::Allocate(uint32_t vertexSize, uint32_t count, uint32_t& outFirstVertex) {
+	const RingBuffer::Sptr& buffer = GetBuffer();
+	void* result = buffer->AllocateElements(vertexSize, count, outFirstVertex);
+	if (result == nullptr) {
+		// Leave room for the alignment padding as well, so the next frame is guaranteed to fit
+		if (_currentFrame.FailedAllocations == 0) {
+			LOG_WARN("Streaming vertex ring is out of room, dropping geometry until the next frame");
+		}
+		_requiredRegionSize = std::max(_requiredRegionSize, _currentFrame.BytesUsed + vertexSize * (count + 1));
+		_currentFrame.FailedAllocations++;
+		return nullptr;
+	}
+
+	_currentFrame.BytesUsed += vertexSize * count;
+	_currentFrame.Allocations++;
+	return result;
+}
+
+void StreamingVertices::Trim(uint32_t vertexSize, uint32_t firstVertex, uint32_t count, uint32_t usedCount) {
+	if (_buffer != nullptr && _buffer->Trim(firstVertex * vertexSize, count * vertexSize, usedCount * vertexSize)) {
+		_currentFrame.BytesUsed -= (count - usedCount) * vertexSize;
+	}
+}
+
+const RingBuffer::Sptr& StreamingVertices::GetBuffer() {
+	if (_buffer == nullptr) {
+		_buffer = std::make_shared<RingBuffer>(BufferType::Vertex, INITIAL_REGION_SIZE, REGION_COUNT);
+		_buffer->SetDebugName("Streaming Vertices");
+		_bufferVersion++;
+	}
+	return _buffer;
+}
+
+uint32_t StreamingVertices::GetBufferVersion() {
+	return _bufferVersion;
+}
+
+void StreamingVertices::BeginFrame() {
+	const RingBuffer::Sptr& buffer = GetBuffer();
+
+	// Growing waits for the GPU to finish with every region, so we only do it between frames
+	if (_requiredRegionSize > buffer->GetRegionSize()) {
+		buffer->Reserve(_requiredRegionSize);
+		_bufferVersion++;
+		_currentFrame.Reallocations++;
+	}
+	_requiredRegionSize = 0;
+
+	buffer->BeginFrame();
+}
+
+void StreamingVertices::EndFrame() {
+	if (_buffer != nullptr) {
+		_buffer->EndFrame();
+	}
+
+	_lastFrame = _currentFrame;
+	_currentFrame.BytesUsed = 0;
+	_currentFrame.Allocations = 0;
+	_currentFrame.FailedAllocations = 0;
+}
+
+const StreamingVertices::FrameStats& StreamingVertices::GetLastFrameStats() {
+	return _lastFrame;
+}
+
+void StreamingVertices::Release() {
+	_buffer = nullptr;
+	_requiredRegionSize = 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include "Graphics/Buffers/RingBuffer.h"
+
+/// <summary>
+/// A shared, persistently mapped ring of vertices for geometry that gets rebuilt every frame, such as
+/// the GUI and debug lines
+///
+/// Vertices are written straight into the mapped buffer, so there's no CPU side copy and the buffer
+/// is never re-specified. Each frame writes into it's own region of the ring, which is fenced once the
+/// frame is done with it, so the GPU can keep reading earlier frames while we write the next one.
+/// If a frame runs out of room, allocations fail for the rest of that frame, and the ring is grown
+/// at the start of the next one
+/// </summary>
+class StreamingVertices {
+public:
+	StreamingVertices() = delete;
+
+	/// <summary>
+	/// The size of each region when the ring is first created, in bytes
+	/// </summary>
+	static constexpr uint32_t INITIAL_REGION_SIZE = 2 * 1024 * 1024;
+	/// <summary>
+	/// The number of frames that can be in flight before we wait on the GPU
+	/// </summary>
+	static constexpr uint32_t REGION_COUNT = 3;
+
+	struct FrameStats {
+		uint32_t BytesUsed         = 0;
+		uint32_t Allocations       = 0;
+		uint32_t FailedAllocations = 0;
+		// The number of times the ring has been re-created since it was first made
+		uint32_t Reallocations     = 0;
+	};
+
+	/// <summary>
+	/// Allocates space for vertices in this frame's region of the ring
+	/// </summary>
+	/// <param name="vertexSize">The size of a single vertex in bytes</param>
+	/// <param name="count">The number of vertices to allocate</param>
+	/// <param name="outFirstVertex">Will store the index of the first vertex, to be used when drawing</param>
+	/// <returns>A pointer to write the vertices to, or nullptr if the frame is out of room</returns>
+	static void* Allocate(uint32_t vertexSize, uint32_t count, uint32_t& outFirstVertex);
+	template <typename VertexType>
+	static VertexType* Allocate(uint32_t count, uint32_t& outFirstVertex) {
+		return reinterpret_cast<VertexType*>(Allocate(sizeof(VertexType), count, outFirstVertex));
+	}
+	/// <summary>
+	/// Gives back the vertices at the end of an allocation that were not written, this only
+	/// does anything if nothing has been allocated since
+	/// </summary>
+	/// <param name="vertexSize">The size of a single vertex in bytes</param>
+	/// <param name="firstVertex">The first vertex of the allocation</param>
+	/// <param name="count">The number of vertices that were allocated</param>
+	/// <param name="usedCount">The number of vertices that were written</param>
+	static void Trim(uint32_t vertexSize, uint32_t firstVertex, uint32_t count, uint32_t usedCount);
+
+	/// <summary>
+	/// Gets the buffer that vertices are written to, VAOs that draw streamed vertices should use it as their vertex buffer
+	/// </summary>
+	static const RingBuffer::Sptr& GetBuffer();
+	/// <summary>
+	/// Gets a number that changes whenever the buffer is re-created. VAOs using the old buffer
+	/// need to be pointed at the new one when this changes
+	/// </summary>
+	static uint32_t GetBufferVersion();
+
+	/// <summary>
+	/// Moves on to the next region of the ring, growing the ring first if the last frame ran out of room
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Fences this frame's region, should be called after the last draw that uses streamed vertices
+	/// </summary>
+	static void EndFrame();
+	/// <summary>
+	/// Gets the stats for the most recently completed frame
+	/// </summary>
+	static const FrameStats& GetLastFrameStats();
+
+	/// <summary>
+	/// Releases the ring, should be called while we still have a context
+	/// </summary>
+	static void Release();
+
+protected:
+	static RingBuffer::Sptr _buffer;
+	static uint32_t         _bufferVersion;
+	// The region size needed to fit everything the last frame that ran out of room tried to allocate
+	static uint32_t         _requiredRegionSize;
+	static FrameStats       _currentFrame;
+	static FrameStats       _lastFrame;
+};
@@ -1,4 +1,5 @@
 #include "ITexture.h"
+#include "Graphics/GlStateTracker.h"
 
 ITexture::Limits ITexture::__limits = ITexture::Limits();
 bool ITexture::__isStaticInit = false;
@@ -7,6 +8,7 @@ ITexture::ITexture(TextureType type) :
 	IGraphicsResource(),
 	_type(type)
 {
+	_gpuMemoryCategory = GpuMemoryTracker::Category::Texture;
 	__StaticInit();
 	_Recreate();
 }
@@ -14,6 +16,7 @@ ITexture::ITexture(TextureType type) :
 void ITexture::_Recreate()
 {
 	if (_rendererId == 0) {
+		GlStateTracker::OnTextureDeleted(_rendererId);
 		glDeleteTextures(1, &_rendererId);
 	}
 	glCreateTextures((GLenum)_type, 1, &_rendererId);
@@ -21,6 +24,7 @@ void ITexture::_Recreate()
 
 ITexture::~ITexture() {
 	if (glIsTexture(_rendererId)) {
+		GlStateTracker::OnTextureDeleted(_rendererId);
 		glDeleteTextures(1, &_rendererId);
 		_rendererId = 0;
 	}
@@ -29,12 +33,12 @@ ITexture::~ITexture() {
 void ITexture::Bind(int slot) {
 	if (_rendererId != 0) {
 		// Instead of glActiveTexture + glBindTexture, we can one line it now :D
-		glBindTextureUnit(slot, _rendererId); 
+		GlStateTracker::BindTextureUnit(slot, _rendererId);
 	}
 }
 
 void ITexture::Unbind(int slot) {
-	glBindTextureUnit(slot, 0);
+	GlStateTracker::BindTextureUnit(slot, 0);
 }
 
 void ITexture::Clear(const glm::vec4& color) {
@@ -43,6 +47,14 @@ void ITexture::Clear(const glm::vec4& color) {
 	}
 }
 
+size_t ITexture::_CalcStorageSize(GLenum format, int width, int height, int depth, int levels) {
+	size_t result = 0;
+	for (int ix = 0; ix < levels; ix++) {
+		result += (size_t)glm::max(width >> ix, 1) * glm::max(height >> ix, 1) * glm::max(depth >> ix, 1);
+	}
+	return result * GetInternalFormatTexelSize(format);
+}
+
 GlResourceType ITexture::GetResourceClass() const {
 	return GlResourceType::Texture;
 }
@@ -60,7 +72,7 @@ void ITexture::__StaticInit()
 	glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &__limits.MAX_ANISOTROPY);
 
 	// Enable seamless cube maps (we'll need this later!)
-	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	GlStateTracker::Enable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 
 	// Let's write all our info into the console so we know what's up
 	LOG_INFO("==== Texture Limits =====");
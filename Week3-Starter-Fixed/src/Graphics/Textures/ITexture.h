@@ -60,6 +60,18 @@ protected:
 	/// </summary>
 	virtual void _Recreate();
 
+	/// <summary>
+	/// Estimates the amount of GPU memory a texture's storage takes, with every dimension
+	/// halving at each mip level
+	/// </summary>
+	/// <param name="format">The internal format of the texture</param>
+	/// <param name="width">The width of the first level, in texels</param>
+	/// <param name="height">The height of the first level, in texels</param>
+	/// <param name="depth">The depth of the first level, in texels</param>
+	/// <param name="levels">The number of mip levels</param>
+	/// <returns>The size of the storage in bytes</returns>
+	static size_t _CalcStorageSize(GLenum format, int width, int height, int depth, int levels);
+
 	TextureType _type; // The type for this texture, mainly used for debugging
 
 // STATIC SECTION
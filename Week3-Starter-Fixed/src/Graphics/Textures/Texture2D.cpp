@@ -4,6 +4,7 @@
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Graphics/GlStateTracker.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -202,6 +203,7 @@ void Texture2D::_LoadDataFromFile() {
 void Texture2D::_SetTextureParams() {
 	// If we have a multisampled texture, and the current type is 2D, change it to 2D multisampled
 	if (_description.MultisampleCount > 1 && _type == TextureType::_2D) {
+		GlStateTracker::OnTextureDeleted(_rendererId);
 		glDeleteTextures(1, &_rendererId);
 		_type = TextureType::_2DMultisample;
 		glCreateTextures(*_type, 1, &_rendererId);
@@ -220,6 +222,7 @@ void Texture2D::_SetTextureParams() {
 			int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height) : 1;
 			// Allocates the memory for our texture
 			glTextureStorage2D(_rendererId, layers, (GLenum)_description.Format, _description.Width, _description.Height);
+			_SetGpuMemorySize(_CalcStorageSize(*_description.Format, _description.Width, _description.Height, 1, layers));
 
 			glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
 			glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
@@ -228,6 +231,7 @@ void Texture2D::_SetTextureParams() {
 		// Texture is multisampled, we need to allocate memory differently
 		else {
 			glTextureStorage2DMultisample(_rendererId, _description.MultisampleCount, *_description.Format, _description.Width, _description.Height, true);
+			_SetGpuMemorySize(_CalcStorageSize(*_description.Format, _description.Width, _description.Height, 1, 1) * _description.MultisampleCount);
 		}
 
 		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
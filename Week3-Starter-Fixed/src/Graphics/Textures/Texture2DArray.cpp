@@ -0,0 +1,174 @@
+#include "Texture2DArray.h"
+#include <stb_image.h>
+#include <Logging.h>
+#include "GLM/glm.hpp"
+#include "Utils/JsonGlmHelpers.h"
+
+/// <summary>
+/// Get the number of mipmap levels required for a texture of the given size
+/// </summary>
+/// <param name="width">The width of the texture in pixels</param>
+/// <param name="height">The height of the texture in pixels</param>
+/// <returns>Number of mip levels required for the texture</returns>
+inline int CalcRequiredMipLevels2D(int width, int height) {
+	return (1 + floor(log2(glm::max(width, height))));
+}
+
+Texture2DArray::Texture2DArray(const Texture2DArrayDescription& description) :
+	ITexture(TextureType::_2DArray),
+	_description(description)
+{
+	// If the anisotropy is negative, we assume that we want max anisotropy
+	if (_description.MaxAnisotropic < 0.0f) {
+		_description.MaxAnisotropic = ITexture::GetLimits().MAX_ANISOTROPY;
+	}
+
+	// Make sure we have a layer for every file
+	if (_description.Layers < _description.Filenames.size()) {
+		_description.Layers = static_cast<uint32_t>(_description.Filenames.size());
+	}
+	_description.Filenames.resize(_description.Layers);
+
+	// If we have a size we can allocate now, otherwise we wait for the first file to tell us our size
+	if (_description.Width * _description.Height > 0) {
+		_SetTextureParams();
+	}
+	_LoadLayersFromFiles();
+}
+
+void Texture2DArray::LoadLayerData(uint32_t layer, uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* data, uint32_t offsetX, uint32_t offsetY) {
+	// Ensure the rectangle we're setting is within the bounds of the image
+	LOG_ASSERT(layer < _description.Layers, "Layer is outside of the bounds of the array!");
+	LOG_ASSERT((width + offsetX) <= _description.Width, "Pixel bounds are outside of the X extents of the image!");
+	LOG_ASSERT((height + offsetY) <= _description.Height, "Pixel bounds are outside of the Y extents of the image!");
+
+	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
+	int componentSize = (GLint)GetTexelComponentSize(type);
+	glPixelStorei(GL_PACK_ALIGNMENT, componentSize);
+
+	// Upload our data to the layer
+	glTextureSubImage3D(_rendererId, 0, offsetX, offsetY, layer, width, height, 1, (GLenum)format, (GLenum)type, data);
+}
+
+bool Texture2DArray::CopyLayerFrom(uint32_t layer, const Texture2D::Sptr& texture) {
+	if (texture == nullptr || layer >= _description.Layers ||
+		texture->GetWidth() != _description.Width || texture->GetHeight() != _description.Height ||
+		texture->GetFormat() != _description.Format) {
+		return false;
+	}
+
+	// The copy happens entirely on the GPU, so we don't need to go back to the source file
+	glCopyImageSubData(
+		texture->GetHandle(), GL_TEXTURE_2D, 0, 0, 0, 0,
+		_rendererId, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+		_description.Width, _description.Height, 1);
+
+	// Remember where the layer came from so that we can be re-loaded from JSON
+	_description.Filenames[layer] = texture->GetDescription().Filename;
+	return true;
+}
+
+void Texture2DArray::GenerateMipMaps() {
+	if (_description.GenerateMipMaps) {
+		glGenerateTextureMipmap(_rendererId);
+	}
+}
+
+nlohmann::json Texture2DArray::ToJson() const {
+	nlohmann::json result = {
+		{ "size_x",            _description.Width },
+		{ "size_y",            _description.Height },
+		{ "layers",            _description.Layers },
+		{ "internal_format",  ~_description.Format },
+		{ "wrap_s",           ~_description.HorizontalWrap },
+		{ "wrap_t",           ~_description.VerticalWrap },
+		{ "filter_min",       ~_description.MinificationFilter },
+		{ "filter_mag",       ~_description.MagnificationFilter },
+		{ "anisotropic",       _description.MaxAnisotropic },
+		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "filenames",         _description.Filenames }
+	};
+
+	return result;
+}
+
+Texture2DArray::Sptr Texture2DArray::FromJson(const nlohmann::json& data) {
+	Texture2DArrayDescription descr = Texture2DArrayDescription();
+	descr.Width               = JsonGet(data, "size_x", descr.Width);
+	descr.Height              = JsonGet(data, "size_y", descr.Height);
+	descr.Layers              = JsonGet(data, "layers", descr.Layers);
+	descr.Format              = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::Unknown);
+	descr.HorizontalWrap      = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
+	descr.VerticalWrap        = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
+	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
+	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
+	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
+	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	if (data.contains("filenames") && data["filenames"].is_array()) {
+		descr.Filenames = data["filenames"].get<std::vector<std::string>>();
+	}
+
+	return std::make_shared<Texture2DArray>(descr);
+}
+
+void Texture2DArray::_LoadLayersFromFiles() {
+	bool loadedAny = false;
+
+	for (uint32_t layer = 0; layer < _description.Filenames.size(); layer++) {
+		const std::string& filename = _description.Filenames[layer];
+		if (filename.empty()) {
+			continue;
+		}
+
+		// Layers always get loaded as RGBA, so that every layer has the same format
+		int width, height, numChannels;
+		stbi_set_flip_vertically_on_load(true);
+		uint8_t* data = stbi_load(filename.c_str(), &width, &height, &numChannels, 4);
+		if (data == nullptr) {
+			LOG_WARN("STBI Failed to load image from \"{}\"", filename);
+			continue;
+		}
+
+		// The first file we load determines our size if we weren't given one
+		if (_description.Width * _description.Height == 0) {
+			_description.Width = width;
+			_description.Height = height;
+			if (_description.Format == InternalFormat::Unknown) {
+				_description.Format = GetInternalFormatForChannels8(4);
+			}
+			_SetTextureParams();
+		}
+
+		if (width == (int)_description.Width && height == (int)_description.Height) {
+			LoadLayerData(layer, width, height, PixelFormat::RGBA, PixelType::UByte, data);
+			loadedAny = true;
+		} else {
+			LOG_WARN("Layer \"{}\" is {}x{}, but array is {}x{}, skipping", filename, width, height, _description.Width, _description.Height);
+		}
+
+		stbi_image_free(data);
+	}
+
+	// Generating mips once after all the layers are in is much cheaper than once per layer
+	if (loadedAny) {
+		GenerateMipMaps();
+	}
+}
+
+void Texture2DArray::_SetTextureParams() {
+	// Make sure the size is greater than zero and that we have a format specified before trying to set parameters
+	if ((_description.Width * _description.Height * _description.Layers > 0) && _description.Format != InternalFormat::Unknown) {
+		// Calculate how many levels of storage to allocate based on whether mipmaps are enabled or not
+		int levels = _description.GenerateMipMaps ? CalcRequiredMipLevels2D(_description.Width, _description.Height) : 1;
+		// Allocates the memory for all of our layers
+		glTextureStorage3D(_rendererId, levels, (GLenum)_description.Format, _description.Width, _description.Height, _description.Layers);
+		// Layers don't shrink with each mip level like depth does
+		_SetGpuMemorySize(_CalcStorageSize(*_description.Format, _description.Width, _description.Height, 1, levels) * _description.Layers);
+
+		glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
+		glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
+		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
+		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, (GLenum)_description.HorizontalWrap);
+		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_T, (GLenum)_description.VerticalWrap);
+	}
+}
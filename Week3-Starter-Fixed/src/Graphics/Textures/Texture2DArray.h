@@ -0,0 +1,152 @@
+#pragma once
+#include "ITexture.h"
+#include "Texture2D.h"
+#include <vector>
+
+/// <summary>
+/// Describes all parameters we can manipulate with our 2D Texture Arrays
+/// </summary>
+struct Texture2DArrayDescription {
+	/// <summary>
+	/// The number of texels in each layer along the x axis
+	/// </summary>
+	uint32_t       Width;
+	/// <summary>
+	/// The number of texels in each layer along the y axis
+	/// </summary>
+	uint32_t       Height;
+	/// <summary>
+	/// The number of layers in the array
+	/// </summary>
+	uint32_t       Layers;
+	/// <summary>
+	/// The internal format that OpenGL should use when storing this texture
+	/// </summary>
+	InternalFormat Format;
+	/// <summary>
+	/// The wrap mode to use when a UV coordinate is outside the 0-1 range on the x axis
+	/// </summary>
+	WrapMode       HorizontalWrap;
+	/// <summary>
+	/// The wrap mode to use when a UV coordinate is outside the 0-1 range on the y axis
+	/// </summary>
+	WrapMode       VerticalWrap;
+	/// <summary>
+	/// The filter to use when multiple texels will map to a single pixel
+	/// </summary>
+	MinFilter      MinificationFilter;
+	/// <summary>
+	/// The filter to use when one texel will map to multiple pixels
+	/// </summary>
+	MagFilter      MagnificationFilter;
+	/// <summary>
+	/// The level of anisotropic filtering to use when this texture is viewed at an oblique angle
+	/// </summary>
+	float          MaxAnisotropic;
+	/// <summary>
+	/// True if this texture should generate mip maps (smaller copies of the image with filtering pre-applied)
+	/// </summary>
+	bool           GenerateMipMaps;
+
+	/// <summary>
+	/// The paths to the source files for each layer, layers with an empty path have been generated
+	/// or copied from another texture at runtime. If Width and Height are 0, the first file determines
+	/// the size of the array
+	/// </summary>
+	std::vector<std::string> Filenames;
+
+	Texture2DArrayDescription() :
+		Width(0), Height(0), Layers(0),
+		Format(InternalFormat::Unknown),
+		HorizontalWrap(WrapMode::Repeat),
+		VerticalWrap(WrapMode::Repeat),
+		MinificationFilter(MinFilter::NearestMipLinear),
+		MagnificationFilter(MagFilter::Linear),
+		MaxAnisotropic(-1.0f), // max aniso by default
+		GenerateMipMaps(true),
+		Filenames()
+	{ }
+};
+
+/// <summary>
+/// A stack of same sized 2D images that can be bound to a single texture slot, and sampled
+/// in shaders with a sampler2DArray and a layer index
+/// </summary>
+class Texture2DArray : public ITexture {
+public:
+	DEFINE_RESOURCE(Texture2DArray)
+
+	// Make sure we mark our destructor as virtual so base class is called
+	virtual ~Texture2DArray() = default;
+
+public:
+	Texture2DArray(const Texture2DArrayDescription& description);
+
+	/// <summary>
+	/// Gets the internal format OpenGL is using for this texture
+	/// </summary>
+	InternalFormat GetFormat() const { return _description.Format; }
+	/// <summary>
+	/// Gets the width of each layer in pixels
+	/// </summary>
+	uint32_t GetWidth() const { return _description.Width; }
+	/// <summary>
+	/// Gets the height of each layer in pixels
+	/// </summary>
+	uint32_t GetHeight() const { return _description.Height; }
+	/// <summary>
+	/// Gets the number of layers in the array
+	/// </summary>
+	uint32_t GetLayers() const { return _description.Layers; }
+
+	/// <summary>
+	/// Loads a region of data into a single layer of this texture
+	/// Bounds must be contained by the bounds of the texture
+	/// format and type must be convertible to the texture's internal format
+	/// </summary>
+	/// <param name="layer">The index of the layer to load into</param>
+	/// <param name="width">The width of the data frame, in pixels</param>
+	/// <param name="height">The height of the data frame, in pixels</param>
+	/// <param name="format">The pixel layout of the data</param>
+	/// <param name="type">The pixel base type of the data</param>
+	/// <param name="data">A pointer to the data to load into this texture</param>
+	/// <param name="offsetX">The x edge of the destination rectangle in the layer, left->right</param>
+	/// <param name="offsetY">The y edge of the destination rectangle in the layer, bottom->top</param>
+	void LoadLayerData(uint32_t layer, uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* data, uint32_t offsetX = 0, uint32_t offsetY = 0);
+
+	/// <summary>
+	/// Copies the contents of a 2D texture into one of our layers on the GPU, the texture
+	/// must have the same size and format as this array. Mip maps are not regenerated, call
+	/// GenerateMipMaps once all layers have been copied
+	/// </summary>
+	/// <param name="layer">The index of the layer to copy into</param>
+	/// <param name="texture">The texture to copy from</param>
+	/// <returns>True if the texture was copied, false if it is not compatible</returns>
+	bool CopyLayerFrom(uint32_t layer, const Texture2D::Sptr& texture);
+
+	/// <summary>
+	/// Re-generates the mip maps for all layers, if the array was created with mip maps
+	/// </summary>
+	void GenerateMipMaps();
+
+	/// <summary>
+	/// Gets this texture's description, which contains basic information about the
+	/// texture's dimensions and creation parameters
+	/// </summary>
+	const Texture2DArrayDescription& GetDescription() const { return _description; }
+
+	virtual nlohmann::json ToJson() const override;
+	static Texture2DArray::Sptr FromJson(const nlohmann::json& data);
+
+protected:
+	Texture2DArrayDescription _description;
+
+	/// <summary>
+	/// Loads every layer that has a filename in the description
+	/// </summary>
+	void _LoadLayersFromFiles();
+	/// <summary>
+	/// Allocates our texture's memory and sets sampling / filtering parameters
+	/// </summary>
+	void _SetTextureParams();
+};
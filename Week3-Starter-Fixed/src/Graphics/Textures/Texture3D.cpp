@@ -272,6 +272,7 @@ void Texture3D::_SetTextureParams()
 	int layers = _description.GenerateMipMaps ? CalcRequiredMipLevels(_description.Width, _description.Height, _description.Depth) : 1;
 	// Allocates the memory for our texture
 	glTextureStorage3D(_rendererId, layers, (GLenum)_description.Format, _description.Width, _description.Height, _description.Depth);
+	_SetGpuMemorySize(_CalcStorageSize(*_description.Format, _description.Width, _description.Height, _description.Depth, layers));
 
 	glTextureParameteri(_rendererId, GL_TEXTURE_MIN_FILTER, (GLenum)_description.MinificationFilter);
 	glTextureParameteri(_rendererId, GL_TEXTURE_MAG_FILTER, (GLenum)_description.MagnificationFilter);
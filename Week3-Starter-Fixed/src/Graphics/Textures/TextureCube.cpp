@@ -182,6 +182,7 @@ void TextureCube::_SetTextureParams(){
 	if (_description.Size > 0 && _description.Format != InternalFormat::Unknown) {
 		// Allocates the memory for our texture
 		glTextureStorage2D(_rendererId, 1, (GLenum)_description.Format, _description.Size, _description.Size);
+		_SetGpuMemorySize(_CalcStorageSize(*_description.Format, _description.Size, _description.Size, 1, 1) * 6);
 
 		// Set up our texture parameters
 		glTextureParameteri(_rendererId, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -0,0 +1,21 @@
+#pragma once
+#include "Utils/Fnv1a.h"
+
+/// <summary>
+/// Names a uniform by the hash of its name, so that setting it never has to hash or compare strings
+///
+/// Handles should be declared static constexpr, so that the hash is worked out at compile time:
+///     static constexpr UniformHandle ClippedView("u_ClippedView");
+/// Each program resolves handles against a small table of its uniforms, built when it is linked,
+/// so the same handle can be used with any program
+/// </summary>
+struct UniformHandle {
+	uint64_t    Hash;
+	// Only used for logging, must outlive the handle (usually a string literal)
+	const char* Name;
+
+	constexpr explicit UniformHandle(const char* name) :
+		Hash(Fnv1a::Hash(name)),
+		Name(name)
+	{ }
+};
@@ -2,13 +2,18 @@
 #include "Buffers/IndexBuffer.h"
 #include "Buffers/VertexBuffer.h"
 #include "Logging.h"
+#include "Graphics/GlStateTracker.h"
 
 VertexArrayObject::VertexArrayObject() :
 	_indexBuffer(nullptr),
 	_handle(0),
 	_vertexCount(0),
 	_elementCount(0),
-	_vertexBuffers(std::vector<VertexBufferBinding*>())
+	_vertexBuffers(std::vector<VertexBufferBinding*>()),
+	_bounds(),
+	_boundingSphere(),
+	_positionDequantization(1.0f),
+	_hasQuantizedPositions(false)
 {
 	glCreateVertexArrays(1, &_handle);
 }
@@ -16,6 +21,7 @@ VertexArrayObject::VertexArrayObject() :
 VertexArrayObject::~VertexArrayObject()
 {
 	if (_handle != 0) {
+		GlStateTracker::OnVertexArrayDeleted(_handle);
 		glDeleteVertexArrays(1, &_handle);
 		_handle = 0;
 	}
@@ -36,14 +42,14 @@ void VertexArrayObject::SetIndexBuffer(const IndexBuffer::Sptr& ibo) {
 	Unbind();
 }
 
-VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const VertexBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes, bool instanced) {
+VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const IBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes, bool instanced) {
 	if (_vertexBuffers.size() == 0) {
 		_vertexCount = buffer->GetElementCount();
 		if (_indexBuffer == nullptr) {
 			_elementCount = _vertexCount;
 		}
 	} 
-	else if (buffer->GetElementCount() != _vertexCount) {
+	else if (!instanced && buffer->GetElementCount() != _vertexCount) {
 		LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 	}
 
@@ -69,7 +75,7 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 	return binding;
 }
 
-void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const VertexBuffer::Sptr& buffer)
+void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const IBuffer::Sptr& buffer)
 {
 	// Search for the BufferAttribute with the matching usage
 	auto& it = std::find_if(_vertexBuffers.begin(), _vertexBuffers.end(), [&](const VertexBufferBinding* buffer) {
@@ -113,27 +119,47 @@ void VertexArrayObject::Draw(DrawMode mode) {
 	Unbind();
 }
 
-void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
+void VertexArrayObject::DrawRange(uint32_t firstVertex, uint32_t count, DrawMode mode /*= DrawMode::TriangleList*/)
+{
+	Bind();
+	if (_indexBuffer == nullptr) {
+		glDrawArrays((GLenum)mode, firstVertex, count);
+	} else {
+		glDrawElementsBaseVertex((GLenum)mode, count, (GLenum)_indexBuffer->GetElementType(), nullptr, firstVertex);
+	}
+	Unbind();
+}
+
+void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/, uint32_t baseInstance /*= 0*/)
 {
 	Bind();
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
-		glDrawArraysInstanced((GLenum)mode, 0, elements, instanceCount);
+		glDrawArraysInstancedBaseInstance((GLenum)mode, 0, elements, instanceCount, baseInstance);
 	}
 	else {
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
-		glDrawElementsInstanced((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount);
+		glDrawElementsInstancedBaseInstance((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount, baseInstance);
 	}
 	Unbind();
 	
 }
 
+void VertexArrayObject::MultiDrawIndirect(const IBuffer& indirectBuffer, uint32_t offset, uint32_t drawCount, DrawMode mode /*= DrawMode::TriangleList*/)
+{
+	LOG_ASSERT(_indexBuffer != nullptr, "Indirect draws require an index buffer!");
+	Bind();
+	indirectBuffer.Bind();
+	glMultiDrawElementsIndirect((GLenum)mode, (GLenum)_indexBuffer->GetElementType(), (const void*)(size_t)offset, drawCount, sizeof(DrawElementsIndirectCommand));
+	Unbind();
+}
+
 void VertexArrayObject::Bind() {
-	glBindVertexArray(_handle);
+	GlStateTracker::BindVertexArray(_handle);
 }
 
 void VertexArrayObject::Unbind() {
-	glBindVertexArray(0);
+	GlStateTracker::BindVertexArray(0);
 }
 
 void VertexArrayObject::SetVDecl(const VertexDeclaration& vDecl) {
@@ -144,6 +170,16 @@ const VertexArrayObject::VertexDeclaration& VertexArrayObject::GetVDecl() {
 	return _vDecl;
 }
 
+void VertexArrayObject::SetBounds(const BoundingBox& bounds) {
+	_bounds = bounds;
+	_boundingSphere = BoundingSphere::FromBox(bounds);
+}
+
+void VertexArrayObject::SetPositionDequantization(const glm::mat4& transform) {
+	_positionDequantization = transform;
+	_hasQuantizedPositions = transform != glm::mat4(1.0f);
+}
+
 GlResourceType VertexArrayObject::GetResourceClass() const {
 	return GlResourceType::VertexArray;
 }
@@ -177,6 +213,8 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	result->SetBounds(_bounds);
+	result->SetPositionDequantization(_positionDequantization);
 
 	return result;
 }
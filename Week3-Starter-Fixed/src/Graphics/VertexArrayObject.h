@@ -9,6 +9,7 @@
 #include "Graphics/Buffers/IndexBuffer.h"
 #include "Graphics/GlEnums.h"
 #include "Graphics/IGraphicsResource.h"
+#include "Utils/Bounds.h"
 
 /// <summary>
 /// This structure will represent the parameters passed to the glVertexAttribPointer commands
@@ -50,6 +51,18 @@ struct BufferAttribute {
 		Slot(slot), Size(size), Type(type), Stride(stride), Offset(offset), Usage(usage), Normalized(normalized) { }
 };
 
+/// <summary>
+/// Matches the layout that glMultiDrawElementsIndirect expects for each draw in the indirect buffer
+/// </summary>
+/// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glMultiDrawElementsIndirect.xhtml</see>
+struct DrawElementsIndirectCommand {
+	uint32_t Count;
+	uint32_t InstanceCount;
+	uint32_t FirstIndex;
+	int32_t  BaseVertex;
+	uint32_t BaseInstance;
+};
+
 /// <summary>
 /// The Vertex Array Object wraps around an OpenGL VAO and basically represents all of the data for a mesh
 /// </summary>
@@ -65,14 +78,14 @@ public:
 
 	// Helper structure to store a buffer and the attributes
 	struct VertexBufferBinding {
-		const VertexBuffer::Sptr& GetBuffer() const { return Buffer; }
+		const IBuffer::Sptr& GetBuffer() const { return Buffer; }
 		const std::vector<BufferAttribute>& GetAttributes() const { return Attributes; }
 		bool IsInstanced() const { return Instanced; }
 
 	protected:
 		friend class VertexArrayObject;
 
-		VertexBuffer::Sptr Buffer;
+		IBuffer::Sptr Buffer;
 		std::vector<BufferAttribute> Attributes;
 		bool Instanced;
 	};
@@ -105,12 +118,13 @@ public:
 	/// <summary>
 	/// Adds a vertex buffer to this VAO, with the specified attributes
 	/// </summary>
-	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later)</param>
+	/// <param name="buffer">The buffer to add (note, does not take ownership, you will still need to delete later). Usually a
+	/// VertexBuffer, but any buffer can be used, such as a RingBuffer for streamed vertices</param>
 	/// <param name="attributes">A list of vertex attributes that will be fed by this buffer</param>
 	/// <param name="instanced">True if the buffer should contain one set of data per instance, false for per vertex</param>
-	VertexBufferBinding* AddVertexBuffer(const VertexBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes, bool instanced = false);
+	VertexBufferBinding* AddVertexBuffer(const IBuffer::Sptr& buffer, const std::vector<BufferAttribute>& attributes, bool instanced = false);
 
-	void ReplaceVertexBuffer(VertexBufferBinding* binding, const VertexBuffer::Sptr& buffer);
+	void ReplaceVertexBuffer(VertexBufferBinding* binding, const IBuffer::Sptr& buffer);
 
 	/// <summary>
 	/// Gets the buffer binding that has an attribute with the given usage
@@ -119,12 +133,24 @@ public:
 	/// <param name="usage">The attribute usage hint to search for</param>
 	/// <returns>A const pointer to the binding, or nullptr if none is found</returns>
 	VertexBufferBinding* GetBufferBinding(AttribUsage usage);
+	/// <summary>
+	/// Gets all the vertex buffers that have been added to this VAO
+	/// </summary>
+	const std::vector<VertexBufferBinding*>& GetVertexBuffers() const { return _vertexBuffers; }
 
 	/// <summary>
 	/// Renders this VAO, using the specified draw mode
 	/// </summary>
 	/// <param name="mode">The draw mode for primitives in this VAO</param>
 	void Draw(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders part of this VAO. Without an index buffer, this draws count vertices starting at firstVertex.
+	/// With one, this draws the first count indices, with firstVertex added to each index
+	/// </summary>
+	/// <param name="firstVertex">The first vertex to draw, or the base vertex for indexed draws</param>
+	/// <param name="count">The number of vertices or indices to draw</param>
+	/// <param name="mode">The draw mode for primitives in this VAO</param>
+	void DrawRange(uint32_t firstVertex, uint32_t count, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Renders this VAO with the given instance count, using the specified draw mode. 
@@ -132,7 +158,18 @@ public:
 	/// </summary>
 	/// <param name="instanceCount">The number of instances to render</param>
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
-	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
+	/// <param name="baseInstance">The index of the first instance to read from instanced buffers</param>
+	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList, uint32_t baseInstance = 0);
+
+	/// <summary>
+	/// Renders a list of draws stored in an indirect buffer with a single glMultiDrawElementsIndirect
+	/// call. The VAO must have an index buffer
+	/// </summary>
+	/// <param name="indirectBuffer">The buffer containing the DrawElementsIndirectCommands</param>
+	/// <param name="offset">The offset of the first command from the start of the buffer, in bytes</param>
+	/// <param name="drawCount">The number of commands to draw</param>
+	/// <param name="mode">The primitive mode for rendering the mesh</param>
+	void MultiDrawIndirect(const IBuffer& indirectBuffer, uint32_t offset, uint32_t drawCount, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -151,6 +188,33 @@ public:
 	void SetVDecl(const VertexDeclaration& vDecl);
 	const VertexDeclaration& GetVDecl();
 
+	/// <summary>
+	/// Sets the local space bounds of the mesh, should be called by whatever builds the mesh
+	/// </summary>
+	/// <param name="bounds">The axis aligned bounds of the vertex positions</param>
+	void SetBounds(const BoundingBox& bounds);
+	/// <summary>
+	/// Gets the local space axis aligned bounds of this mesh, will be invalid if the bounds were never set
+	/// </summary>
+	const BoundingBox& GetBounds() const { return _bounds; }
+	/// <summary>
+	/// Gets the local space bounding sphere of this mesh, will be invalid if the bounds were never set
+	/// </summary>
+	const BoundingSphere& GetBoundingSphere() const { return _boundingSphere; }
+
+	/// <summary>
+	/// Sets the transform that takes the stored vertex positions back into mesh space, for meshes whose
+	/// positions are quantized relative to their bounds (see VertexPacking.h)
+	/// </summary>
+	/// <param name="transform">The dequantization transform</param>
+	void SetPositionDequantization(const glm::mat4& transform);
+	/// <summary>
+	/// Gets the transform that takes stored vertex positions back into mesh space, anything drawing
+	/// the mesh should apply this before the model matrix. Identity unless HasQuantizedPositions is true
+	/// </summary>
+	const glm::mat4& GetPositionDequantization() const { return _positionDequantization; }
+	bool HasQuantizedPositions() const { return _hasQuantizedPositions; }
+
 protected:
 	
 	// The index buffer bound to this VAO
@@ -165,6 +229,13 @@ protected:
 	uint32_t _vertexCount;
 	uint32_t _elementCount;
 
+	// The local space bounds of the mesh
+	BoundingBox    _bounds;
+	BoundingSphere _boundingSphere;
+
+	glm::mat4      _positionDequantization;
+	bool           _hasQuantizedPositions;
+
 	// The underlying OpenGL handle that this class is wrapping around
 	GLuint _handle;
 
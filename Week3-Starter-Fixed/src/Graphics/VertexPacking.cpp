@@ -0,0 +1,219 @@
+#include "Graphics/VertexPacking.h"
+#include "Logging.h"
+#include <cstring>
+
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/packing.hpp>
+
+// How a single attribute gets stored in the packed vertex
+enum class AttribEncoding {
+	Copy,
+	QuantizedPosition,
+	Snorm10,
+	Half2,
+	Unorm8
+};
+
+// Gets the number of bytes an attribute takes up in a vertex
+static uint32_t GetAttributeByteSize(const BufferAttribute& attrib) {
+	switch (attrib.Type) {
+		case AttributeType::Byte:
+		case AttributeType::UByte:
+			return attrib.Size;
+		case AttributeType::Short:
+		case AttributeType::UShort:
+		case AttributeType::HalfFloat:
+			return attrib.Size * 2;
+		case AttributeType::Double:
+			return attrib.Size * 8;
+		case AttributeType::Int_2_10_10_10_Rev:
+			return 4;
+		default:
+			return attrib.Size * 4;
+	}
+}
+
+static AttribEncoding ChooseEncoding(const BufferAttribute& attrib, VertexPacking packing, bool canQuantize) {
+	// We only know how to pack floats, anything that's already packed gets left alone
+	if (packing == VertexPacking::None || attrib.Type != AttributeType::Float) {
+		return AttribEncoding::Copy;
+	}
+
+	switch (attrib.Usage) {
+		case AttribUsage::Position:
+			return packing == VertexPacking::Quantized && canQuantize && attrib.Size == 3 ? AttribEncoding::QuantizedPosition : AttribEncoding::Copy;
+		case AttribUsage::Normal:
+		case AttribUsage::Tangent:
+		case AttribUsage::BiTangent:
+			return attrib.Size == 3 ? AttribEncoding::Snorm10 : AttribEncoding::Copy;
+		case AttribUsage::Texture:
+			return attrib.Size == 2 ? AttribEncoding::Half2 : AttribEncoding::Copy;
+		case AttribUsage::Color:
+			return attrib.Size == 3 || attrib.Size == 4 ? AttribEncoding::Unorm8 : AttribEncoding::Copy;
+		default:
+			return AttribEncoding::Copy;
+	}
+}
+
+VertexPacker::Result VertexPacker::Pack(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, VertexPacking packing) {
+	Result result;
+	result.Stride = 0;
+	result.PositionDequantization = glm::mat4(1.0f);
+
+	const uint8_t* source = reinterpret_cast<const uint8_t*>(vertices);
+	uint32_t sourceStride = vDecl.empty() ? 0 : vDecl[0].Stride;
+
+	// We need the bounds of the positions before we can quantize them
+	for (const BufferAttribute& attrib : vDecl) {
+		if (attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size >= 3) {
+			result.Bounds = BoundingBox::FromVertexData(vertices, vertexCount, sourceStride, attrib.Offset);
+			break;
+		}
+	}
+	bool canQuantize = result.Bounds.IsValid();
+
+	// Work out the layout of the packed vertex
+	std::vector<AttribEncoding> encodings;
+	encodings.reserve(vDecl.size());
+	result.VDecl.reserve(vDecl.size());
+	for (const BufferAttribute& attrib : vDecl) {
+		AttribEncoding encoding = ChooseEncoding(attrib, packing, canQuantize);
+		encodings.push_back(encoding);
+
+		BufferAttribute packed = attrib;
+		packed.Offset = result.Stride;
+		switch (encoding) {
+			case AttribEncoding::QuantizedPosition:
+				// The 4th component is padding, so that each vertex stays 4 byte aligned
+				packed.Type = AttributeType::UShort;
+				packed.Size = 4;
+				packed.Normalized = true;
+				break;
+			case AttribEncoding::Snorm10:
+				packed.Type = AttributeType::Int_2_10_10_10_Rev;
+				packed.Size = 4;
+				packed.Normalized = true;
+				break;
+			case AttribEncoding::Half2:
+				packed.Type = AttributeType::HalfFloat;
+				packed.Normalized = false;
+				break;
+			case AttribEncoding::Unorm8:
+				packed.Type = AttributeType::UByte;
+				packed.Size = 4;
+				packed.Normalized = true;
+				break;
+			default:
+				break;
+		}
+
+		// Keep every attribute 4 byte aligned
+		result.Stride += (GetAttributeByteSize(packed) + 3) & ~3u;
+		result.VDecl.push_back(packed);
+	}
+	for (BufferAttribute& attrib : result.VDecl) {
+		attrib.Stride = result.Stride;
+	}
+
+	// Quantized positions are stored in [0, 1] across the bounds
+	glm::vec3 quantizeScale = glm::vec3(0.0f);
+	if (canQuantize && packing == VertexPacking::Quantized) {
+		glm::vec3 size = result.Bounds.Max - result.Bounds.Min;
+		for (int ix = 0; ix < 3; ix++) {
+			quantizeScale[ix] = size[ix] > 0.0f ? 1.0f / size[ix] : 0.0f;
+		}
+		result.PositionDequantization = glm::scale(glm::translate(glm::mat4(1.0f), result.Bounds.Min), size);
+	}
+
+	result.Data.resize((size_t)result.Stride * vertexCount);
+	for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+		const uint8_t* in = source + (size_t)vertex * sourceStride;
+		uint8_t* out = result.Data.data() + (size_t)vertex * result.Stride;
+
+		for (size_t ix = 0; ix < vDecl.size(); ix++) {
+			const uint8_t* inAttrib = in + vDecl[ix].Offset;
+			uint8_t* outAttrib = out + result.VDecl[ix].Offset;
+
+			switch (encodings[ix]) {
+				case AttribEncoding::QuantizedPosition:
+				{
+					glm::vec3 position;
+					memcpy(&position, inAttrib, sizeof(glm::vec3));
+					glm::u16vec4 packed = glm::packUnorm<uint16_t>(glm::vec4((position - result.Bounds.Min) * quantizeScale, 0.0f));
+					memcpy(outAttrib, &packed, sizeof(glm::u16vec4));
+					break;
+				}
+				case AttribEncoding::Snorm10:
+				{
+					glm::vec3 direction;
+					memcpy(&direction, inAttrib, sizeof(glm::vec3));
+					// Packing clamps to [-1, 1], so we need unit vectors to keep the direction
+					float length = glm::length(direction);
+					if (length > 0.0f) {
+						direction /= length;
+					}
+					uint32_t packed = glm::packSnorm3x10_1x2(glm::vec4(direction, 0.0f));
+					memcpy(outAttrib, &packed, sizeof(uint32_t));
+					break;
+				}
+				case AttribEncoding::Half2:
+				{
+					glm::vec2 uv;
+					memcpy(&uv, inAttrib, sizeof(glm::vec2));
+					uint32_t packed = glm::packHalf2x16(uv);
+					memcpy(outAttrib, &packed, sizeof(uint32_t));
+					break;
+				}
+				case AttribEncoding::Unorm8:
+				{
+					glm::vec4 color = glm::vec4(1.0f);
+					memcpy(&color, inAttrib, vDecl[ix].Size * sizeof(float));
+					uint32_t packed = glm::packUnorm4x8(color);
+					memcpy(outAttrib, &packed, sizeof(uint32_t));
+					break;
+				}
+				default:
+					memcpy(outAttrib, inAttrib, GetAttributeByteSize(vDecl[ix]));
+					break;
+			}
+		}
+	}
+
+	LOG_TRACE("Packed {} vertices from {} to {} bytes per vertex", vertexCount, sourceStride, result.Stride);
+	return result;
+}
+
+VertexArrayObject::Sptr VertexPacker::CreateVao(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, const IndexBuffer::Sptr& indices, VertexPacking packing) {
+	Result packed = Pack(vertices, vertexCount, vDecl, packing);
+
+	VertexBuffer::Sptr vbo = VertexBuffer::Create();
+	vbo->LoadData(packed.Data.data(), packed.Stride, vertexCount);
+
+	// Create VAO and attach the buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->AddVertexBuffer(vbo, packed.VDecl);
+	result->SetIndexBuffer(indices);
+
+	result->SetVDecl(packed.VDecl);
+	result->SetBounds(packed.Bounds);
+	result->SetPositionDequantization(packed.PositionDequantization);
+
+	return result;
+}
+
+glm::vec3 VertexPacker::ReadPosition(const uint8_t* vertex, const BufferAttribute& attrib, const glm::mat4& dequantization) {
+	const uint8_t* data = vertex + attrib.Offset;
+	if (attrib.Type == AttributeType::Float) {
+		glm::vec3 result;
+		memcpy(&result, data, sizeof(glm::vec3));
+		return result;
+	}
+	else if (attrib.Type == AttributeType::UShort && attrib.Normalized) {
+		glm::u16vec3 packed;
+		memcpy(&packed, data, sizeof(glm::u16vec3));
+		return glm::vec3(dequantization * glm::vec4(glm::vec3(packed) / 65535.0f, 1.0f));
+	}
+
+	LOG_WARN("Unsupported position attribute type: {}", ~attrib.Type);
+	return glm::vec3(0.0f);
+}
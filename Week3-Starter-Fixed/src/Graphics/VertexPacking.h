@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <GLM/glm.hpp>
+#include <EnumToString.h>
+
+#include "Graphics/VertexArrayObject.h"
+
+/// <summary>
+/// How vertex attributes are stored in GPU memory
+///
+/// None keeps everything as 32 bit floats.
+/// Packed stores normals, tangents and bitangents as 10:10:10:2 signed normalized
+/// integers, UVs as half floats and colors as 8 bit unsigned normalized integers.
+/// Quantized is the same as Packed, and also stores positions as 16 bit unsigned
+/// normalized integers relative to the mesh bounds
+/// </summary>
+ENUM(VertexPacking, uint8_t,
+	None      = 0,
+	Packed    = 1,
+	Quantized = 2
+)
+
+/// <summary>
+/// Converts interleaved float vertex data into a packed layout, using the vertex declaration to
+/// figure out what each attribute is. Works with any of our vertex types
+///
+/// Shaders don't need to know about packing, since normalized attributes are expanded back to floats
+/// when they are fetched. Quantized positions are the exception, they come out in [0, 1] and need to be
+/// transformed by the VAO's position dequantization, which fragments/vs_common.glsl applies to inPosition
+/// </summary>
+class VertexPacker {
+public:
+	VertexPacker() = delete;
+
+	struct Result {
+		// The packed, interleaved vertices
+		std::vector<uint8_t> Data;
+		// The attributes of the packed vertices
+		VertexArrayObject::VertexDeclaration VDecl;
+		// The size of a single packed vertex
+		uint32_t Stride;
+		// The bounds of the positions, in mesh space
+		BoundingBox Bounds;
+		// Takes stored positions back into mesh space, identity unless positions were quantized
+		glm::mat4 PositionDequantization;
+	};
+
+	/// <summary>
+	/// Packs a set of interleaved vertices. Attributes that aren't floats, or that we don't know
+	/// how to pack, are copied over as-is
+	/// </summary>
+	/// <param name="vertices">The interleaved vertex data to pack</param>
+	/// <param name="vertexCount">The number of vertices in the data</param>
+	/// <param name="vDecl">The attributes of the source vertices</param>
+	/// <param name="packing">How to pack the vertices</param>
+	/// <returns>The packed vertices, and everything needed to draw them</returns>
+	static Result Pack(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, VertexPacking packing);
+
+	/// <summary>
+	/// Packs a set of interleaved vertices, and creates a VAO for them
+	/// </summary>
+	/// <param name="vertices">The interleaved vertex data to pack</param>
+	/// <param name="vertexCount">The number of vertices in the data</param>
+	/// <param name="vDecl">The attributes of the source vertices</param>
+	/// <param name="indices">The index buffer for the mesh, or nullptr if the mesh is not indexed</param>
+	/// <param name="packing">How to pack the vertices</param>
+	/// <returns>A new VAO with the bounds and dequantization filled in</returns>
+	static VertexArrayObject::Sptr CreateVao(const void* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, const IndexBuffer::Sptr& indices, VertexPacking packing);
+
+	/// <summary>
+	/// Reads a position from a single vertex, handling both float and quantized positions
+	/// </summary>
+	/// <param name="vertex">A pointer to the start of the vertex</param>
+	/// <param name="attrib">The position attribute</param>
+	/// <param name="dequantization">The mesh's position dequantization</param>
+	/// <returns>The position in mesh space</returns>
+	static glm::vec3 ReadPosition(const uint8_t* vertex, const BufferAttribute& attrib, const glm::mat4& dequantization);
+};
@@ -0,0 +1,451 @@
+#include "Utils/AABBTree.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <limits>
+
+// Returns the smallest box that contains both a and b
+static BoundingBox CombineBounds(const BoundingBox& a, const BoundingBox& b) {
+	return BoundingBox(glm::min(a.Min, b.Min), glm::max(a.Max, b.Max));
+}
+
+AABBTree::AABBTree(float fatMargin) :
+	_nodes(std::vector<Node>()),
+	_root(NullNode),
+	_freeList(NullNode),
+	_proxyCount(0),
+	_fatMargin(fatMargin),
+	_stack(std::vector<int32_t>())
+{
+	_stack.reserve(64);
+}
+
+AABBTree::~AABBTree() = default;
+
+int32_t AABBTree::CreateProxy(const BoundingBox& bounds, void* userData) {
+	int32_t proxy = _AllocateNode();
+	Node& node = _nodes[proxy];
+	node.Bounds = BoundingBox(bounds.Min - glm::vec3(_fatMargin), bounds.Max + glm::vec3(_fatMargin));
+	node.UserData = userData;
+	node.Height = 0;
+
+	_InsertLeaf(proxy);
+	_proxyCount++;
+	return proxy;
+}
+
+void AABBTree::DestroyProxy(int32_t proxy) {
+	LOG_ASSERT(proxy >= 0 && proxy < (int32_t)_nodes.size() && _nodes[proxy].IsLeaf(), "Invalid proxy ID");
+	_RemoveLeaf(proxy);
+	_FreeNode(proxy);
+	_proxyCount--;
+}
+
+bool AABBTree::MoveProxy(int32_t proxy, const BoundingBox& bounds) {
+	LOG_ASSERT(proxy >= 0 && proxy < (int32_t)_nodes.size() && _nodes[proxy].IsLeaf(), "Invalid proxy ID");
+
+	// Still inside our fat box, nothing in the tree needs to change
+	if (_nodes[proxy].Bounds.Contains(bounds)) {
+		return false;
+	}
+
+	_RemoveLeaf(proxy);
+	_nodes[proxy].Bounds = BoundingBox(bounds.Min - glm::vec3(_fatMargin), bounds.Max + glm::vec3(_fatMargin));
+	_InsertLeaf(proxy);
+	return true;
+}
+
+void* AABBTree::GetUserData(int32_t proxy) const {
+	return _nodes[proxy].UserData;
+}
+
+const BoundingBox& AABBTree::GetFatBounds(int32_t proxy) const {
+	return _nodes[proxy].Bounds;
+}
+
+template <typename Test>
+void AABBTree::_Query(const Test& test, const QueryCallback& callback) const {
+	if (_root == NullNode) {
+		return;
+	}
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty()) {
+		int32_t index = _stack.back();
+		_stack.pop_back();
+
+		const Node& node = _nodes[index];
+		if (!test(node.Bounds)) {
+			continue;
+		}
+
+		if (node.IsLeaf()) {
+			if (!callback(index, node.UserData)) {
+				return;
+			}
+		} else {
+			_stack.push_back(node.Left);
+			_stack.push_back(node.Right);
+		}
+	}
+}
+
+void AABBTree::QueryBox(const BoundingBox& box, const QueryCallback& callback) const {
+	_Query([&](const BoundingBox& bounds) { return bounds.Intersects(box); }, callback);
+}
+
+void AABBTree::QuerySphere(const BoundingSphere& sphere, const QueryCallback& callback) const {
+	float radiusSq = sphere.Radius * sphere.Radius;
+	_Query([&](const BoundingBox& bounds) {
+		// Distance from the sphere's center to the closest point on the box
+		glm::vec3 closest = glm::clamp(sphere.Center, bounds.Min, bounds.Max);
+		glm::vec3 delta = closest - sphere.Center;
+		return glm::dot(delta, delta) <= radiusSq;
+	}, callback);
+}
+
+void AABBTree::QueryFrustum(const Frustum& frustum, const QueryCallback& callback) const {
+	if (_root == NullNode) {
+		return;
+	}
+
+	// We track whether a node is fully inside the frustum in the sign bit of the stack entry, so that
+	// we can skip plane tests for everything below it
+	const int32_t insideFlag = std::numeric_limits<int32_t>::min();
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty()) {
+		int32_t entry = _stack.back();
+		_stack.pop_back();
+
+		bool inside = (entry & insideFlag) != 0;
+		int32_t index = entry & ~insideFlag;
+		const Node& node = _nodes[index];
+
+		if (!inside) {
+			glm::vec3 center = node.Bounds.GetCenter();
+			glm::vec3 extents = node.Bounds.GetExtents();
+
+			bool outside = false;
+			inside = true;
+			for (int ix = 0; ix < 6; ix++) {
+				const glm::vec4& plane = frustum.GetPlane(ix);
+				glm::vec3 normal = glm::vec3(plane);
+				float radius = glm::dot(extents, glm::abs(normal));
+				float distance = glm::dot(normal, center) + plane.w;
+				if (distance < -radius) {
+					outside = true;
+					break;
+				}
+				inside &= distance >= radius;
+			}
+			if (outside) {
+				continue;
+			}
+		}
+
+		if (node.IsLeaf()) {
+			if (!callback(index, node.UserData)) {
+				return;
+			}
+		} else {
+			int32_t flag = inside ? insideFlag : 0;
+			_stack.push_back(node.Left | flag);
+			_stack.push_back(node.Right | flag);
+		}
+	}
+}
+
+void AABBTree::RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCastCallback& callback) const {
+	if (_root == NullNode) {
+		return;
+	}
+
+	// Division by zero gives us infinities here, which the slab test below handles correctly
+	glm::vec3 invDir = 1.0f / direction;
+
+	// Slab test, returns the entry distance along the ray or a negative value on a miss
+	auto intersect = [&](const BoundingBox& bounds) {
+		glm::vec3 t0 = (bounds.Min - origin) * invDir;
+		glm::vec3 t1 = (bounds.Max - origin) * invDir;
+		glm::vec3 tMin = glm::min(t0, t1);
+		glm::vec3 tMax = glm::max(t0, t1);
+		float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+		float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDistance));
+		return enter <= exit ? enter : -1.0f;
+	};
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty()) {
+		int32_t index = _stack.back();
+		_stack.pop_back();
+
+		const Node& node = _nodes[index];
+		float distance = intersect(node.Bounds);
+		if (distance < 0.0f) {
+			continue;
+		}
+
+		if (node.IsLeaf()) {
+			float result = callback(index, node.UserData, distance);
+			if (result < 0.0f) {
+				return;
+			}
+			maxDistance = glm::min(maxDistance, result);
+		} else {
+			_stack.push_back(node.Left);
+			_stack.push_back(node.Right);
+		}
+	}
+}
+
+void AABBTree::Clear() {
+	_nodes.clear();
+	_root = NullNode;
+	_freeList = NullNode;
+	_proxyCount = 0;
+}
+
+int32_t AABBTree::GetHeight() const {
+	return _root == NullNode ? 0 : _nodes[_root].Height;
+}
+
+int32_t AABBTree::_AllocateNode() {
+	int32_t result;
+	if (_freeList != NullNode) {
+		result = _freeList;
+		_freeList = _nodes[result].Parent;
+	} else {
+		result = static_cast<int32_t>(_nodes.size());
+		_nodes.emplace_back();
+	}
+
+	Node& node = _nodes[result];
+	node.Bounds = BoundingBox();
+	node.UserData = nullptr;
+	node.Parent = NullNode;
+	node.Left = NullNode;
+	node.Right = NullNode;
+	node.Height = 0;
+	return result;
+}
+
+void AABBTree::_FreeNode(int32_t node) {
+	_nodes[node].Parent = _freeList;
+	_nodes[node].Height = -1;
+	_freeList = node;
+}
+
+void AABBTree::_InsertLeaf(int32_t leaf) {
+	if (_root == NullNode) {
+		_root = leaf;
+		_nodes[leaf].Parent = NullNode;
+		return;
+	}
+
+	// Walk down the tree to find the best sibling, using the surface area heuristic
+	BoundingBox leafBounds = _nodes[leaf].Bounds;
+	int32_t index = _root;
+	while (!_nodes[index].IsLeaf()) {
+		const Node& node = _nodes[index];
+
+		float area = node.Bounds.GetSurfaceArea();
+		float combinedArea = CombineBounds(node.Bounds, leafBounds).GetSurfaceArea();
+
+		// Cost of making a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		// Minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		auto childCost = [&](int32_t child) {
+			const Node& childNode = _nodes[child];
+			float newArea = CombineBounds(childNode.Bounds, leafBounds).GetSurfaceArea();
+			return childNode.IsLeaf() ?
+				newArea + inheritanceCost :
+				(newArea - childNode.Bounds.GetSurfaceArea()) + inheritanceCost;
+		};
+		float costLeft = childCost(node.Left);
+		float costRight = childCost(node.Right);
+
+		if (cost < costLeft && cost < costRight) {
+			break;
+		}
+		index = costLeft < costRight ? node.Left : node.Right;
+	}
+	int32_t sibling = index;
+
+	// Create a new parent to hold the sibling and the leaf, note that this may resize _nodes
+	int32_t oldParent = _nodes[sibling].Parent;
+	int32_t newParent = _AllocateNode();
+	_nodes[newParent].Parent = oldParent;
+	_nodes[newParent].Bounds = CombineBounds(leafBounds, _nodes[sibling].Bounds);
+	_nodes[newParent].Height = _nodes[sibling].Height + 1;
+	_nodes[newParent].Left = sibling;
+	_nodes[newParent].Right = leaf;
+	_nodes[sibling].Parent = newParent;
+	_nodes[leaf].Parent = newParent;
+
+	if (oldParent != NullNode) {
+		if (_nodes[oldParent].Left == sibling) {
+			_nodes[oldParent].Left = newParent;
+		} else {
+			_nodes[oldParent].Right = newParent;
+		}
+	} else {
+		_root = newParent;
+	}
+
+	_RefitAncestors(_nodes[leaf].Parent);
+}
+
+void AABBTree::_RemoveLeaf(int32_t leaf) {
+	if (leaf == _root) {
+		_root = NullNode;
+		return;
+	}
+
+	int32_t parent = _nodes[leaf].Parent;
+	int32_t grandParent = _nodes[parent].Parent;
+	int32_t sibling = _nodes[parent].Left == leaf ? _nodes[parent].Right : _nodes[parent].Left;
+
+	// Our sibling takes the place of our parent
+	if (grandParent != NullNode) {
+		if (_nodes[grandParent].Left == parent) {
+			_nodes[grandParent].Left = sibling;
+		} else {
+			_nodes[grandParent].Right = sibling;
+		}
+		_nodes[sibling].Parent = grandParent;
+		_FreeNode(parent);
+
+		_RefitAncestors(grandParent);
+	} else {
+		_root = sibling;
+		_nodes[sibling].Parent = NullNode;
+		_FreeNode(parent);
+	}
+}
+
+void AABBTree::_RefitAncestors(int32_t node) {
+	int32_t index = node;
+	while (index != NullNode) {
+		index = _Balance(index);
+
+		Node& current = _nodes[index];
+		const Node& left = _nodes[current.Left];
+		const Node& right = _nodes[current.Right];
+		current.Height = 1 + glm::max(left.Height, right.Height);
+		current.Bounds = CombineBounds(left.Bounds, right.Bounds);
+
+		index = current.Parent;
+	}
+}
+
+int32_t AABBTree::_Balance(int32_t iA) {
+	Node& A = _nodes[iA];
+	if (A.IsLeaf() || A.Height < 2) {
+		return iA;
+	}
+
+	int32_t iB = A.Left;
+	int32_t iC = A.Right;
+	Node& B = _nodes[iB];
+	Node& C = _nodes[iC];
+
+	int32_t balance = C.Height - B.Height;
+
+	// Rotate C up
+	if (balance > 1) {
+		int32_t iF = C.Left;
+		int32_t iG = C.Right;
+		Node& F = _nodes[iF];
+		Node& G = _nodes[iG];
+
+		// Swap A and C
+		C.Left = iA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+
+		// A's old parent should point to C
+		if (C.Parent != NullNode) {
+			if (_nodes[C.Parent].Left == iA) {
+				_nodes[C.Parent].Left = iC;
+			} else {
+				_nodes[C.Parent].Right = iC;
+			}
+		} else {
+			_root = iC;
+		}
+
+		// Keep the taller of C's children under C
+		if (F.Height > G.Height) {
+			C.Right = iF;
+			A.Right = iG;
+			G.Parent = iA;
+			A.Bounds = CombineBounds(B.Bounds, G.Bounds);
+			C.Bounds = CombineBounds(A.Bounds, F.Bounds);
+			A.Height = 1 + glm::max(B.Height, G.Height);
+			C.Height = 1 + glm::max(A.Height, F.Height);
+		} else {
+			C.Right = iG;
+			A.Right = iF;
+			F.Parent = iA;
+			A.Bounds = CombineBounds(B.Bounds, F.Bounds);
+			C.Bounds = CombineBounds(A.Bounds, G.Bounds);
+			A.Height = 1 + glm::max(B.Height, F.Height);
+			C.Height = 1 + glm::max(A.Height, G.Height);
+		}
+
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1) {
+		int32_t iD = B.Left;
+		int32_t iE = B.Right;
+		Node& D = _nodes[iD];
+		Node& E = _nodes[iE];
+
+		// Swap A and B
+		B.Left = iA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+
+		// A's old parent should point to B
+		if (B.Parent != NullNode) {
+			if (_nodes[B.Parent].Left == iA) {
+				_nodes[B.Parent].Left = iB;
+			} else {
+				_nodes[B.Parent].Right = iB;
+			}
+		} else {
+			_root = iB;
+		}
+
+		// Keep the taller of B's children under B
+		if (D.Height > E.Height) {
+			B.Right = iD;
+			A.Left = iE;
+			E.Parent = iA;
+			A.Bounds = CombineBounds(C.Bounds, E.Bounds);
+			B.Bounds = CombineBounds(A.Bounds, D.Bounds);
+			A.Height = 1 + glm::max(C.Height, E.Height);
+			B.Height = 1 + glm::max(A.Height, D.Height);
+		} else {
+			B.Right = iE;
+			A.Left = iD;
+			D.Parent = iA;
+			A.Bounds = CombineBounds(C.Bounds, D.Bounds);
+			B.Bounds = CombineBounds(A.Bounds, E.Bounds);
+			A.Height = 1 + glm::max(C.Height, D.Height);
+			B.Height = 1 + glm::max(A.Height, E.Height);
+		}
+
+		return iB;
+	}
+
+	return iA;
+}
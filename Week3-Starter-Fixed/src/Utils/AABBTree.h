@@ -0,0 +1,147 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include <functional>
+
+#include "Utils/Bounds.h"
+#include "Utils/Frustum.h"
+
+/// <summary>
+/// A dynamic bounding volume hierarchy made of axis aligned boxes, which allows objects to be
+/// inserted, moved and removed without rebuilding the whole tree
+///
+/// Leaves store a "fat" box that is slightly bigger than the bounds they were given, so small
+/// movements don't require any changes to the tree. Insertions use the surface area heuristic
+/// to pick a sibling, and the tree is kept balanced with AVL style rotations
+/// </summary>
+class AABBTree {
+public:
+	/// <summary>
+	/// Value used for invalid proxy and node indices
+	/// </summary>
+	static const int32_t NullNode = -1;
+
+	/// <summary>
+	/// Callback for overlap queries, receives the proxy ID and it's user data.
+	/// Return false to stop the query early
+	/// </summary>
+	typedef std::function<bool(int32_t proxy, void* userData)> QueryCallback;
+	/// <summary>
+	/// Callback for ray casts, receives the proxy ID, it's user data, and the distance along the
+	/// ray that the fat box was entered at. Return the new maximum distance for the ray (ex: the
+	/// distance that was passed in to only find closer hits), or a negative value to stop the ray cast
+	/// </summary>
+	typedef std::function<float(int32_t proxy, void* userData, float distance)> RayCastCallback;
+
+	/// <summary>
+	/// Creates a new empty tree
+	/// </summary>
+	/// <param name="fatMargin">The distance to expand leaf bounds by on every side</param>
+	AABBTree(float fatMargin = 0.1f);
+	~AABBTree();
+
+	/// <summary>
+	/// Adds a new leaf to the tree
+	/// </summary>
+	/// <param name="bounds">The world space bounds of the object</param>
+	/// <param name="userData">A pointer that will be passed back from queries</param>
+	/// <returns>The ID of the new proxy, used to move or remove it later</returns>
+	int32_t CreateProxy(const BoundingBox& bounds, void* userData);
+	/// <summary>
+	/// Removes a leaf from the tree, the ID may be handed out again by CreateProxy
+	/// </summary>
+	void DestroyProxy(int32_t proxy);
+	/// <summary>
+	/// Updates the bounds of a leaf. If the new bounds still fit inside the leaf's fat box,
+	/// the tree is left untouched
+	/// </summary>
+	/// <returns>True if the leaf needed to be re-inserted</returns>
+	bool MoveProxy(int32_t proxy, const BoundingBox& bounds);
+
+	/// <summary>
+	/// Gets the user data that was given when the proxy was created
+	/// </summary>
+	void* GetUserData(int32_t proxy) const;
+	/// <summary>
+	/// Gets the expanded bounds that are stored in the tree for the given proxy
+	/// </summary>
+	const BoundingBox& GetFatBounds(int32_t proxy) const;
+
+	/// <summary>
+	/// Finds all proxies whose fat bounds overlap the box
+	/// </summary>
+	void QueryBox(const BoundingBox& box, const QueryCallback& callback) const;
+	/// <summary>
+	/// Finds all proxies whose fat bounds overlap the sphere
+	/// </summary>
+	void QuerySphere(const BoundingSphere& sphere, const QueryCallback& callback) const;
+	/// <summary>
+	/// Finds all proxies whose fat bounds are at least partially inside the frustum. Subtrees that
+	/// are entirely inside the frustum are reported without testing their children
+	/// </summary>
+	void QueryFrustum(const Frustum& frustum, const QueryCallback& callback) const;
+	/// <summary>
+	/// Walks the tree along a ray, invoking the callback for each proxy whose fat bounds the ray enters
+	/// </summary>
+	/// <param name="origin">The start point of the ray</param>
+	/// <param name="direction">The direction of the ray, does not need to be normalized</param>
+	/// <param name="maxDistance">The max distance along the ray (in multiples of direction) to search</param>
+	/// <param name="callback">The callback to invoke for each hit, see RayCastCallback</param>
+	void RayCast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, const RayCastCallback& callback) const;
+
+	/// <summary>
+	/// Removes all proxies from the tree
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Gets the number of proxies in the tree
+	/// </summary>
+	int32_t GetProxyCount() const { return _proxyCount; }
+	/// <summary>
+	/// Gets the number of nodes allocated by the tree, proxy IDs are always less than this. Lets
+	/// callers store per-proxy data in a flat array
+	/// </summary>
+	int32_t GetNodeCapacity() const { return static_cast<int32_t>(_nodes.size()); }
+	/// <summary>
+	/// Gets the height of the tree, 0 for an empty tree or a tree with a single leaf
+	/// </summary>
+	int32_t GetHeight() const;
+
+protected:
+	struct Node {
+		BoundingBox Bounds;
+		void*       UserData;
+		// Parent for nodes in the tree, next free node for nodes in the free list
+		int32_t     Parent;
+		int32_t     Left;
+		int32_t     Right;
+		// Leaves have a height of 0, free nodes have a height of -1
+		int32_t     Height;
+
+		bool IsLeaf() const { return Left == NullNode; }
+	};
+
+	std::vector<Node> _nodes;
+	int32_t           _root;
+	int32_t           _freeList;
+	int32_t           _proxyCount;
+	float             _fatMargin;
+
+	// Scratch stack for traversals, so that queries don't allocate every call
+	mutable std::vector<int32_t> _stack;
+
+	int32_t _AllocateNode();
+	void _FreeNode(int32_t node);
+
+	void _InsertLeaf(int32_t leaf);
+	void _RemoveLeaf(int32_t leaf);
+	// Performs a rotation at the given node if it is imbalanced, returns the new root of the subtree
+	int32_t _Balance(int32_t node);
+	// Walks from the given node to the root, rebalancing and refitting the bounds along the way
+	void _RefitAncestors(int32_t node);
+
+	template <typename Test>
+	void _Query(const Test& test, const QueryCallback& callback) const;
+};
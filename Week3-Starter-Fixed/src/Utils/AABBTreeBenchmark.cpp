@@ -0,0 +1,132 @@
+#include "Utils/AABBTreeBenchmark.h"
+#include "Utils/AABBTree.h"
+#include "Utils/Benchmark.h"
+#include "Logging.h"
+
+#include <GLM/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+static void BenchmarkObjectCount(int count) {
+	const int   queries   = 1000;
+	// World grows with the object count so that the density stays the same
+	const float worldSize = glm::pow(static_cast<float>(count), 1.0f / 3.0f) * 4.0f;
+
+	std::mt19937 rng = Benchmark::CreateRandom();
+	std::uniform_real_distribution<float> position(-worldSize, worldSize);
+	std::uniform_real_distribution<float> size(0.25f, 1.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<BoundingBox> boxes(count);
+	for (int ix = 0; ix < count; ix++) {
+		glm::vec3 center = glm::vec3(position(rng), position(rng), position(rng));
+		boxes[ix] = BoundingBox(center - glm::vec3(size(rng)), center + glm::vec3(size(rng)));
+	}
+
+	AABBTree tree;
+	std::vector<int32_t> proxies(count);
+	double buildMs = Benchmark::TimeMs([&]() {
+		for (int ix = 0; ix < count; ix++) {
+			proxies[ix] = tree.CreateProxy(boxes[ix], reinterpret_cast<void*>(static_cast<intptr_t>(ix)));
+		}
+	});
+
+	// Move 10% of the objects by a small amount, as a typical frame would
+	double moveMs = Benchmark::TimeMs([&]() {
+		for (int ix = 0; ix < count; ix += 10) {
+			glm::vec3 offset = glm::vec3(unit(rng), unit(rng), unit(rng)) * 0.05f;
+			boxes[ix] = BoundingBox(boxes[ix].Min + offset, boxes[ix].Max + offset);
+			tree.MoveProxy(proxies[ix], boxes[ix]);
+		}
+	});
+
+	// Box queries
+	std::vector<BoundingBox> queryBoxes(queries);
+	for (auto& box : queryBoxes) {
+		glm::vec3 center = glm::vec3(position(rng), position(rng), position(rng));
+		box = BoundingBox(center - glm::vec3(5.0f), center + glm::vec3(5.0f));
+	}
+	size_t linearHits = 0, treeHits = 0;
+	double linearBoxMs = Benchmark::TimeMs([&]() {
+		for (const auto& query : queryBoxes) {
+			for (const auto& box : boxes) {
+				linearHits += box.Intersects(query) ? 1 : 0;
+			}
+		}
+	});
+	double treeBoxMs = Benchmark::TimeMs([&]() {
+		for (const auto& query : queryBoxes) {
+			tree.QueryBox(query, [&](int32_t, void*) { treeHits++; return true; });
+		}
+	});
+
+	// Frustum queries, using a camera at the center of the world looking in random directions
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, worldSize);
+	std::vector<Frustum> frustums(queries / 10);
+	for (auto& frustum : frustums) {
+		glm::vec3 forward = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 0.0f, 0.001f));
+		frustum.SetFromViewProjection(projection * glm::lookAt(glm::vec3(0.0f), forward, glm::vec3(0.0f, 0.0f, 1.0f)));
+	}
+	size_t linearVisible = 0, treeVisible = 0;
+	double linearFrustumMs = Benchmark::TimeMs([&]() {
+		for (const auto& frustum : frustums) {
+			for (const auto& box : boxes) {
+				linearVisible += frustum.TestBox(box) ? 1 : 0;
+			}
+		}
+	});
+	double treeFrustumMs = Benchmark::TimeMs([&]() {
+		for (const auto& frustum : frustums) {
+			tree.QueryFrustum(frustum, [&](int32_t, void*) { treeVisible++; return true; });
+		}
+	});
+
+	// Closest hit ray casts from random points in random directions
+	std::vector<glm::vec3> rayOrigins(queries), rayDirections(queries);
+	for (int ix = 0; ix < queries; ix++) {
+		rayOrigins[ix] = glm::vec3(position(rng), position(rng), position(rng));
+		rayDirections[ix] = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 0.0f, 0.001f));
+	}
+	// Both sides add up their closest hits and log them, so the compiler can't throw away either loop
+	float linearRayDistance = 0.0f, treeRayDistance = 0.0f;
+	double linearRayMs = Benchmark::TimeMs([&]() {
+		for (int ix = 0; ix < queries; ix++) {
+			glm::vec3 invDir = 1.0f / rayDirections[ix];
+			float closest = worldSize;
+			for (const auto& box : boxes) {
+				glm::vec3 t0 = (box.Min - rayOrigins[ix]) * invDir;
+				glm::vec3 t1 = (box.Max - rayOrigins[ix]) * invDir;
+				glm::vec3 tMin = glm::min(t0, t1);
+				glm::vec3 tMax = glm::max(t0, t1);
+				float enter = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.0f));
+				float exit = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, closest));
+				if (enter <= exit) {
+					closest = enter;
+				}
+			}
+			linearRayDistance += closest;
+		}
+	});
+	double treeRayMs = Benchmark::TimeMs([&]() {
+		for (int ix = 0; ix < queries; ix++) {
+			float closest = worldSize;
+			tree.RayCast(rayOrigins[ix], rayDirections[ix], worldSize, [&](int32_t, void*, float distance) {
+				closest = glm::min(closest, distance);
+				return distance;
+			});
+			treeRayDistance += closest;
+		}
+	});
+
+	LOG_INFO("\t{} objects (tree height {}):", count, tree.GetHeight());
+	LOG_INFO("\t\tBuild:         {:.3f}ms, moving 10%: {:.3f}ms", buildMs, moveMs);
+	LOG_INFO("\t\tBox queries:   linear {:.3f}ms, tree {:.3f}ms ({} vs {} hits, the tree tests fat bounds)", linearBoxMs, treeBoxMs, linearHits, treeHits);
+	LOG_INFO("\t\tFrustum:       linear {:.3f}ms, tree {:.3f}ms ({} vs {} visible)", linearFrustumMs, treeFrustumMs, linearVisible, treeVisible);
+	LOG_INFO("\t\tRay casts:     linear {:.3f}ms, tree {:.3f}ms ({:.1f} vs {:.1f} total distance)", linearRayMs, treeRayMs, linearRayDistance, treeRayDistance);
+}
+
+void RunAABBTreeBenchmark() {
+	BenchmarkObjectCount(1000);
+	BenchmarkObjectCount(10000);
+	BenchmarkObjectCount(100000);
+}
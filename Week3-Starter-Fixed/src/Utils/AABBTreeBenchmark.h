@@ -0,0 +1,8 @@
+#pragma once
+
+/// <summary>
+/// Compares the AABBTree against linear scans over the same set of boxes for box, frustum and ray
+/// queries at 1k, 10k and 100k objects, including the cost of moving a portion of the objects each
+/// "frame". Results are written to the log
+/// </summary>
+void RunAABBTreeBenchmark();
@@ -0,0 +1,20 @@
+#include "Utils/Benchmark.h"
+#include "Utils/AABBTreeBenchmark.h"
+#include "Utils/MeshOptimizerBenchmark.h"
+#include "Utils/TransformBenchmark.h"
+#include "Logging.h"
+
+const std::vector<Benchmark::Entry>& Benchmark::GetAll() {
+	static const std::vector<Entry> benchmarks = {
+		{ "BVH",            RunAABBTreeBenchmark },
+		{ "Transform",      RunTransformBenchmark },
+		{ "Mesh Optimizer", RunMeshOptimizerBenchmark }
+	};
+	return benchmarks;
+}
+
+void Benchmark::Run(const Entry& benchmark) {
+	LOG_INFO("{} benchmark:", benchmark.Name);
+	double totalMs = TimeMs(benchmark.Run);
+	LOG_INFO("{} benchmark finished in {:.1f}ms", benchmark.Name, totalMs);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Shared timing, random data and reporting for the benchmarks that can be run from the debug window,
+/// so that they all measure and log their results the same way. Each benchmark logs it's own results
+/// as indented lines, under the title that Run logs for it
+/// </summary>
+class Benchmark {
+public:
+	Benchmark() = delete;
+
+	/// <summary>
+	/// The seed every benchmark uses for it's random data, so that results can be compared between runs
+	/// </summary>
+	static constexpr uint32_t SEED = 1234;
+
+	/// <summary>
+	/// A benchmark that can be run from the debug window
+	/// </summary>
+	struct Entry {
+		// The name of the benchmark, used for it's button and log title
+		const char* Name;
+		// Runs the benchmark, writing the results to the log
+		void      (*Run)();
+	};
+
+	/// <summary>
+	/// Gets every benchmark that can be run from the debug window
+	/// </summary>
+	static const std::vector<Entry>& GetAll();
+
+	/// <summary>
+	/// Runs a benchmark, logging it's title before and how long it took in total after
+	/// </summary>
+	/// <param name="benchmark">The benchmark to run</param>
+	static void Run(const Entry& benchmark);
+
+	/// <summary>
+	/// Creates a random number generator seeded with SEED
+	/// </summary>
+	static std::mt19937 CreateRandom() { return std::mt19937(SEED); }
+
+	/// <summary>
+	/// Returns the time in milliseconds taken to run func
+	/// </summary>
+	template <typename Func>
+	static double TimeMs(Func&& func) {
+		auto start = std::chrono::high_resolution_clock::now();
+		func();
+		auto end = std::chrono::high_resolution_clock::now();
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	/// <summary>
+	/// Returns the average time in nanoseconds per item taken to run func iterations times, where
+	/// each run of func processes count items
+	/// </summary>
+	template <typename Func>
+	static double TimePerItemNs(int iterations, size_t count, Func&& func) {
+		double totalMs = TimeMs([&]() {
+			for (int ix = 0; ix < iterations; ix++) {
+				func();
+			}
+		});
+		return totalMs * 1000000.0 / (static_cast<double>(iterations) * count);
+	}
+};
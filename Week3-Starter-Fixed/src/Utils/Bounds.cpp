@@ -0,0 +1,112 @@
+#include "Utils/Bounds.h"
+#include <limits>
+
+BoundingBox::BoundingBox() :
+	Min(glm::vec3(std::numeric_limits<float>::max())),
+	Max(glm::vec3(std::numeric_limits<float>::lowest()))
+{ }
+
+BoundingBox::BoundingBox(const glm::vec3& min, const glm::vec3& max) :
+	Min(min),
+	Max(max)
+{ }
+
+bool BoundingBox::IsValid() const {
+	return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+}
+
+glm::vec3 BoundingBox::GetCenter() const {
+	return (Min + Max) * 0.5f;
+}
+
+glm::vec3 BoundingBox::GetExtents() const {
+	return (Max - Min) * 0.5f;
+}
+
+void BoundingBox::Encapsulate(const glm::vec3& point) {
+	Min = glm::min(Min, point);
+	Max = glm::max(Max, point);
+}
+
+void BoundingBox::Encapsulate(const BoundingBox& other) {
+	if (other.IsValid()) {
+		Min = glm::min(Min, other.Min);
+		Max = glm::max(Max, other.Max);
+	}
+}
+
+bool BoundingBox::Intersects(const BoundingBox& other) const {
+	return 
+		Min.x <= other.Max.x && Max.x >= other.Min.x &&
+		Min.y <= other.Max.y && Max.y >= other.Min.y &&
+		Min.z <= other.Max.z && Max.z >= other.Min.z;
+}
+
+bool BoundingBox::Contains(const BoundingBox& other) const {
+	return
+		Min.x <= other.Min.x && Max.x >= other.Max.x &&
+		Min.y <= other.Min.y && Max.y >= other.Max.y &&
+		Min.z <= other.Min.z && Max.z >= other.Max.z;
+}
+
+float BoundingBox::GetSurfaceArea() const {
+	glm::vec3 size = Max - Min;
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+BoundingBox BoundingBox::Transform(const glm::mat4& transform) const {
+	if (!IsValid()) {
+		return *this;
+	}
+
+	// Transform the center, then project the extents onto each world axis using the absolute
+	// value of the rotation/scale part of the matrix (Arvo's method)
+	glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extents = GetExtents();
+	glm::vec3 worldExtents = 
+		glm::abs(glm::vec3(transform[0])) * extents.x +
+		glm::abs(glm::vec3(transform[1])) * extents.y +
+		glm::abs(glm::vec3(transform[2])) * extents.z;
+
+	return BoundingBox(center - worldExtents, center + worldExtents);
+}
+
+BoundingBox BoundingBox::FromVertexData(const void* data, size_t vertexCount, size_t stride, size_t positionOffset) {
+	BoundingBox result;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data) + positionOffset;
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		const float* position = reinterpret_cast<const float*>(bytes + ix * stride);
+		result.Encapsulate(glm::vec3(position[0], position[1], position[2]));
+	}
+	return result;
+}
+
+BoundingSphere::BoundingSphere() :
+	Center(glm::vec3(0.0f)),
+	Radius(-1.0f)
+{ }
+
+BoundingSphere::BoundingSphere(const glm::vec3& center, float radius) :
+	Center(center),
+	Radius(radius)
+{ }
+
+bool BoundingSphere::IsValid() const {
+	return Radius >= 0.0f;
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const {
+	// The largest scale along any axis determines how much the radius grows
+	float scale = glm::sqrt(glm::max(
+		glm::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])), glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1]))),
+		glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))
+	));
+	return BoundingSphere(glm::vec3(transform * glm::vec4(Center, 1.0f)), Radius * scale);
+}
+
+BoundingSphere BoundingSphere::FromBox(const BoundingBox& box) {
+	if (!box.IsValid()) {
+		return BoundingSphere();
+	}
+	return BoundingSphere(box.GetCenter(), glm::length(box.GetExtents()));
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Represents an axis aligned bounding box, defined by it's minimum and maximum corners
+/// </summary>
+struct BoundingBox {
+	glm::vec3 Min;
+	glm::vec3 Max;
+
+	/// <summary>
+	/// Creates an empty (invalid) bounding box, which will take on the bounds of the 
+	/// first point or box that is encapsulated
+	/// </summary>
+	BoundingBox();
+	BoundingBox(const glm::vec3& min, const glm::vec3& max);
+
+	/// <summary>
+	/// Returns true if this box contains at least one point
+	/// </summary>
+	bool IsValid() const;
+	/// <summary>
+	/// Gets the center point of the box
+	/// </summary>
+	glm::vec3 GetCenter() const;
+	/// <summary>
+	/// Gets the half-size of the box along each axis
+	/// </summary>
+	glm::vec3 GetExtents() const;
+
+	/// <summary>
+	/// Expands this box so that it contains the given point
+	/// </summary>
+	void Encapsulate(const glm::vec3& point);
+	/// <summary>
+	/// Expands this box so that it contains the given box
+	/// </summary>
+	void Encapsulate(const BoundingBox& other);
+
+	/// <summary>
+	/// Returns true if this box overlaps the other box
+	/// </summary>
+	bool Intersects(const BoundingBox& other) const;
+	/// <summary>
+	/// Returns true if the other box is entirely inside of this box
+	/// </summary>
+	bool Contains(const BoundingBox& other) const;
+	/// <summary>
+	/// Gets the total area of all 6 faces of the box, used as a cost heuristic when building trees
+	/// </summary>
+	float GetSurfaceArea() const;
+
+	/// <summary>
+	/// Transforms this box by a matrix, returning the axis aligned box that encloses the result
+	/// </summary>
+	/// <param name="transform">The transform to apply (ex: a GameObject's world transform)</param>
+	BoundingBox Transform(const glm::mat4& transform) const;
+
+	/// <summary>
+	/// Calculates the bounds of a block of interleaved vertex data
+	/// </summary>
+	/// <param name="data">A pointer to the first vertex</param>
+	/// <param name="vertexCount">The number of vertices in data</param>
+	/// <param name="stride">The size of a single vertex in bytes</param>
+	/// <param name="positionOffset">The offset of the position (as 3 floats) from the start of the vertex</param>
+	static BoundingBox FromVertexData(const void* data, size_t vertexCount, size_t stride, size_t positionOffset);
+};
+
+/// <summary>
+/// Represents a sphere that encloses a set of points
+/// </summary>
+struct BoundingSphere {
+	glm::vec3 Center;
+	float     Radius;
+
+	/// <summary>
+	/// Creates an empty (invalid) bounding sphere, with a negative radius
+	/// </summary>
+	BoundingSphere();
+	BoundingSphere(const glm::vec3& center, float radius);
+
+	/// <summary>
+	/// Returns true if this sphere has a non-negative radius
+	/// </summary>
+	bool IsValid() const;
+
+	/// <summary>
+	/// Transforms this sphere by a matrix. Non-uniform scaling will use the largest axis scale
+	/// </summary>
+	/// <param name="transform">The transform to apply (ex: a GameObject's world transform)</param>
+	BoundingSphere Transform(const glm::mat4& transform) const;
+
+	/// <summary>
+	/// Creates a sphere that encloses the given box
+	/// </summary>
+	static BoundingSphere FromBox(const BoundingBox& box);
+};
@@ -0,0 +1,154 @@
+#include "Utils/FileWatcher.h"
+#include "Logging.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+FileWatcher::FileWatcher(const std::string& root, const std::string& extension) :
+	_root(std::filesystem::path(root).lexically_normal().string()),
+	_extension(extension),
+#ifdef __linux__
+	_inotifyFd(-1),
+	_watchedFolders()
+#else
+	_writeTimes(),
+	_lastScan(std::chrono::steady_clock::now())
+#endif
+{
+	if (!std::filesystem::is_directory(_root)) {
+		LOG_WARN("Cannot watch \"{}\", it is not a folder", _root);
+		return;
+	}
+
+#ifdef __linux__
+	_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_inotifyFd < 0) {
+		LOG_WARN("Failed to start inotify for \"{}\" (errno {})", _root, errno);
+		return;
+	}
+	_AddWatch(_root);
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(_root)) {
+		if (entry.is_directory()) {
+			_AddWatch(entry.path().lexically_normal().string());
+		}
+	}
+	LOG_INFO("Watching {} folders under \"{}\" for {} changes", _watchedFolders.size(), _root, _extension);
+#else
+	// Record the starting times, so that only files modified from now on are reported
+	_Scan(nullptr);
+	LOG_INFO("Polling {} {} files under \"{}\" for changes", _writeTimes.size(), _extension, _root);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+	if (_inotifyFd >= 0) {
+		close(_inotifyFd);
+		_inotifyFd = -1;
+	}
+#endif
+}
+
+bool FileWatcher::IsWatching() const {
+#ifdef __linux__
+	return _inotifyFd >= 0;
+#else
+	return !_writeTimes.empty();
+#endif
+}
+
+std::vector<std::string> FileWatcher::Poll() {
+	std::vector<std::string> result;
+
+#ifdef __linux__
+	if (_inotifyFd < 0) {
+		return result;
+	}
+
+	// Events are variable length, so we read as many as will fit and walk through them
+	alignas(inotify_event) char buffer[4096];
+	while (true) {
+		ssize_t length = read(_inotifyFd, buffer, sizeof(buffer));
+		if (length <= 0) {
+			break;
+		}
+
+		for (char* ptr = buffer; ptr < buffer + length;) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+			ptr += sizeof(inotify_event) + event->len;
+
+			auto folder = _watchedFolders.find(event->wd);
+			if (folder == _watchedFolders.end() || event->len == 0) {
+				continue;
+			}
+
+			std::filesystem::path path = (std::filesystem::path(folder->second) / event->name).lexically_normal();
+			if ((event->mask & IN_ISDIR) != 0) {
+				// Start watching new sub folders as they show up
+				if ((event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+					_AddWatch(path.string());
+				}
+			} else if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) != 0 && _Matches(path)) {
+				// Editors often write a file more than once when saving, we only report it once
+				std::string pathStr = path.string();
+				if (std::find(result.begin(), result.end(), pathStr) == result.end()) {
+					result.push_back(pathStr);
+				}
+			}
+		}
+	}
+#else
+	auto now = std::chrono::steady_clock::now();
+	if (now - _lastScan >= POLL_INTERVAL) {
+		_lastScan = now;
+		_Scan(&result);
+	}
+#endif
+
+	return result;
+}
+
+#ifdef __linux__
+void FileWatcher::_AddWatch(const std::string& folder) {
+	int wd = inotify_add_watch(_inotifyFd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (wd < 0) {
+		LOG_WARN("Failed to watch \"{}\" (errno {})", folder, errno);
+	} else {
+		_watchedFolders[wd] = folder;
+	}
+}
+#else
+void FileWatcher::_Scan(std::vector<std::string>* changed) {
+	std::error_code error;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(_root, error)) {
+		if (!entry.is_regular_file() || !_Matches(entry.path())) {
+			continue;
+		}
+
+		std::string path = entry.path().lexically_normal().string();
+		std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+		auto it = _writeTimes.find(path);
+		if (it == _writeTimes.end()) {
+			_writeTimes[path] = writeTime;
+			if (changed != nullptr) {
+				changed->push_back(path);
+			}
+		} else if (it->second != writeTime) {
+			it->second = writeTime;
+			if (changed != nullptr) {
+				changed->push_back(path);
+			}
+		}
+	}
+}
+#endif
+
+bool FileWatcher::_Matches(const std::filesystem::path& path) const {
+	return path.extension().string() == _extension;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <chrono>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Watches a folder and all of it's sub folders for files with a given extension being modified
+///
+/// On Linux this uses inotify, so polling is just a non-blocking read of any events the kernel
+/// has queued up. Everywhere else we fall back to checking the modification time of every matching
+/// file, at most once every POLL_INTERVAL
+/// </summary>
+class FileWatcher {
+public:
+	MAKE_PTRS(FileWatcher);
+	NO_COPY(FileWatcher);
+	NO_MOVE(FileWatcher);
+
+	/// <summary>
+	/// How often the fallback watcher scans the folder
+	/// </summary>
+	static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(500);
+
+	/// <summary>
+	/// Starts watching a folder
+	/// </summary>
+	/// <param name="root">The folder to watch, returned paths will be relative to the same place as this path</param>
+	/// <param name="extension">The extension of the files to report, including the dot (ex: .glsl)</param>
+	FileWatcher(const std::string& root, const std::string& extension);
+	~FileWatcher();
+
+	/// <summary>
+	/// Returns true if the watcher is running, false if the folder could not be watched
+	/// </summary>
+	bool IsWatching() const;
+
+	/// <summary>
+	/// Gets the files that have been modified since the last poll, without blocking. Paths are
+	/// lexically normalized, and each file is only reported once per poll
+	/// </summary>
+	std::vector<std::string> Poll();
+
+protected:
+	std::string _root;
+	std::string _extension;
+
+#ifdef __linux__
+	int _inotifyFd;
+	// Maps inotify watch descriptors to the folders they're watching
+	std::unordered_map<int, std::string> _watchedFolders;
+
+	void _AddWatch(const std::string& folder);
+#else
+	std::unordered_map<std::string, std::filesystem::file_time_type> _writeTimes;
+	std::chrono::steady_clock::time_point _lastScan;
+
+	void _Scan(std::vector<std::string>* changed);
+#endif
+
+	bool _Matches(const std::filesystem::path& path) const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+/// <summary>
+/// 64 bit FNV-1a hashing, see http://www.isthe.com/chongo/tech/comp/fnv/
+///
+/// The string versions are constexpr, so hashes of string literals can be computed at compile time
+/// </summary>
+class Fnv1a {
+public:
+	Fnv1a() = delete;
+
+	static constexpr uint64_t OFFSET_BASIS = 0xcbf29ce484222325ull;
+	static constexpr uint64_t PRIME        = 0x100000001b3ull;
+
+	/// <summary>
+	/// Hashes size characters of a string, continuing from the given hash
+	/// </summary>
+	static constexpr uint64_t Hash(const char* data, size_t size, uint64_t hash = OFFSET_BASIS) {
+		for (size_t ix = 0; ix < size; ix++) {
+			hash ^= static_cast<uint8_t>(data[ix]);
+			hash *= PRIME;
+		}
+		return hash;
+	}
+
+	/// <summary>
+	/// Hashes a null terminated string, not including the terminator
+	/// </summary>
+	static constexpr uint64_t Hash(const char* str) {
+		uint64_t hash = OFFSET_BASIS;
+		for (; *str != '\0'; str++) {
+			hash ^= static_cast<uint8_t>(*str);
+			hash *= PRIME;
+		}
+		return hash;
+	}
+
+	static inline uint64_t Hash(const std::string& value, uint64_t hash = OFFSET_BASIS) {
+		return Hash(value.data(), value.size(), hash);
+	}
+
+	/// <summary>
+	/// Hashes raw bytes, continuing from the given hash
+	/// </summary>
+	static inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = OFFSET_BASIS) {
+		return Hash(static_cast<const char*>(data), size, hash);
+	}
+};
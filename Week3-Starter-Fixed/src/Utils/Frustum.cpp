@@ -0,0 +1,112 @@
+#include "Utils/Frustum.h"
+
+// SSE2 is guaranteed on x64, and is what we need for the bitwise ops below
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define FRUSTUM_USE_SSE
+#include <emmintrin.h>
+#endif
+
+Frustum::Frustum() {
+	for (int ix = 0; ix < 6; ix++) {
+		_planes[ix] = glm::vec4(0.0f);
+	}
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+	SetFromViewProjection(viewProjection);
+}
+
+void Frustum::SetFromViewProjection(const glm::mat4& viewProjection) {
+	// Gribb & Hartmann, planes are sums/differences of the rows of the matrix
+	// GLM is column major, so we pull out the rows manually
+	glm::vec4 rows[4];
+	for (int ix = 0; ix < 4; ix++) {
+		rows[ix] = glm::vec4(viewProjection[0][ix], viewProjection[1][ix], viewProjection[2][ix], viewProjection[3][ix]);
+	}
+
+	_planes[0] = rows[3] + rows[0]; // Left
+	_planes[1] = rows[3] - rows[0]; // Right
+	_planes[2] = rows[3] + rows[1]; // Bottom
+	_planes[3] = rows[3] - rows[1]; // Top
+	_planes[4] = rows[3] + rows[2]; // Near
+	_planes[5] = rows[3] - rows[2]; // Far
+
+	// Normalize so that plane distances are in world units
+	for (int ix = 0; ix < 6; ix++) {
+		_planes[ix] /= glm::length(glm::vec3(_planes[ix]));
+	}
+}
+
+bool Frustum::TestSphere(const BoundingSphere& sphere) const {
+	for (int ix = 0; ix < 6; ix++) {
+		if (glm::dot(glm::vec3(_planes[ix]), sphere.Center) + _planes[ix].w < -sphere.Radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::TestBox(const BoundingBox& box) const {
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extents = box.GetExtents();
+	for (int ix = 0; ix < 6; ix++) {
+		glm::vec3 normal = glm::vec3(_planes[ix]);
+		// Project the extents onto the plane normal to get the "radius" of the box along it
+		float radius = glm::dot(extents, glm::abs(normal));
+		if (glm::dot(normal, center) + _planes[ix].w < -radius) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t Frustum::CullSpheres(const glm::vec4* spheres, size_t count, uint8_t* outVisible) const {
+	size_t visible = 0;
+	size_t ix = 0;
+
+#ifdef FRUSTUM_USE_SSE
+	// Splat each plane component across a register, so we can test 4 spheres per plane at once
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++) {
+		planeX[p] = _mm_set1_ps(_planes[p].x);
+		planeY[p] = _mm_set1_ps(_planes[p].y);
+		planeZ[p] = _mm_set1_ps(_planes[p].z);
+		planeW[p] = _mm_set1_ps(_planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; ix + 4 <= count; ix += 4) {
+		// Load 4 spheres and transpose them so each register holds one component for all 4
+		__m128 x = _mm_loadu_ps(&spheres[ix + 0].x);
+		__m128 y = _mm_loadu_ps(&spheres[ix + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[ix + 2].x);
+		__m128 r = _mm_loadu_ps(&spheres[ix + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+		__m128 negRadius = _mm_sub_ps(zero, r);
+
+		// A sphere is visible if it's not entirely behind any plane
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++) {
+			__m128 dist = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])),
+				_mm_add_ps(_mm_mul_ps(z, planeZ[p]), planeW[p])
+			);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(dist, negRadius));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (int jx = 0; jx < 4; jx++) {
+			outVisible[ix + jx] = (mask >> jx) & 1;
+			visible += outVisible[ix + jx];
+		}
+	}
+#endif
+
+	// Handle whatever is left over (or everything if SSE is unavailable)
+	for (; ix < count; ix++) {
+		outVisible[ix] = TestSphere(BoundingSphere(glm::vec3(spheres[ix]), spheres[ix].w)) ? 1 : 0;
+		visible += outVisible[ix];
+	}
+
+	return visible;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <cstddef>
+
+#include "Utils/Bounds.h"
+
+/// <summary>
+/// Represents a view frustum as 6 planes, which can be used to test whether bounding volumes are visible
+/// to a camera. Planes are stored as (normal, distance), with normals pointing inwards
+/// </summary>
+class Frustum {
+public:
+	Frustum();
+	/// <summary>
+	/// Extracts the frustum planes from a view projection matrix
+	/// </summary>
+	/// <param name="viewProjection">The camera's view projection matrix</param>
+	Frustum(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Re-extracts the frustum planes from a view projection matrix
+	/// </summary>
+	/// <param name="viewProjection">The camera's view projection matrix</param>
+	void SetFromViewProjection(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Gets one of the 6 planes of the frustum, in the order left, right, bottom, top, near, far
+	/// </summary>
+	const glm::vec4& GetPlane(int index) const { return _planes[index]; }
+
+	/// <summary>
+	/// Returns true if the sphere is at least partially inside the frustum
+	/// </summary>
+	bool TestSphere(const BoundingSphere& sphere) const;
+	/// <summary>
+	/// Returns true if the box is at least partially inside the frustum. May return true
+	/// for some boxes near the corners of the frustum that are outside
+	/// </summary>
+	bool TestBox(const BoundingBox& box) const;
+
+	/// <summary>
+	/// Tests a list of spheres against the frustum, 4 at a time where SSE is available
+	/// </summary>
+	/// <param name="spheres">The spheres to test, packed as (center.xyz, radius)</param>
+	/// <param name="count">The number of spheres to test</param>
+	/// <param name="outVisible">Receives 1 for each sphere that is visible, 0 otherwise, must have room for count elements</param>
+	/// <returns>The number of visible spheres</returns>
+	size_t CullSpheres(const glm::vec4* spheres, size_t count, uint8_t* outVisible) const;
+
+protected:
+	glm::vec4 _planes[6];
+};
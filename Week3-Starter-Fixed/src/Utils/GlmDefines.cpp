@@ -1,4 +1,11 @@
 #include "Utils/GlmDefines.h"
+#include <cstdint>
+
+// SSE is guaranteed on x64, and is all we need for the multiply-adds below
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define GLM_DEFINES_USE_SSE
+#include <xmmintrin.h>
+#endif
 
 glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
 glm::mat3 MAT3_IDENTITY = glm::mat3(1.0f);
@@ -35,3 +42,32 @@ glm::mat4 NormalizeScale(const glm::mat4& transform) {
 	NormalizeScaleRef(result);
 	return result;
 }
+
+void MultiplyMatrices(const glm::mat4& lhs, const glm::mat4* rhs, size_t count, void* out, size_t outStride) {
+	uint8_t* dest = reinterpret_cast<uint8_t*>(out);
+
+#ifdef GLM_DEFINES_USE_SSE
+	// The columns of lhs stay in registers for the whole batch. Each column of the result is
+	// a linear combination of lhs's columns, weighted by the matching column of rhs
+	const __m128 col0 = _mm_loadu_ps(&lhs[0][0]);
+	const __m128 col1 = _mm_loadu_ps(&lhs[1][0]);
+	const __m128 col2 = _mm_loadu_ps(&lhs[2][0]);
+	const __m128 col3 = _mm_loadu_ps(&lhs[3][0]);
+
+	for (size_t ix = 0; ix < count; ix++) {
+		const float* src = &rhs[ix][0][0];
+		float* result = reinterpret_cast<float*>(dest + ix * outStride);
+		for (int c = 0; c < 4; c++) {
+			__m128 value = _mm_mul_ps(col0, _mm_set1_ps(src[c * 4 + 0]));
+			value = _mm_add_ps(value, _mm_mul_ps(col1, _mm_set1_ps(src[c * 4 + 1])));
+			value = _mm_add_ps(value, _mm_mul_ps(col2, _mm_set1_ps(src[c * 4 + 2])));
+			value = _mm_add_ps(value, _mm_mul_ps(col3, _mm_set1_ps(src[c * 4 + 3])));
+			_mm_storeu_ps(result + c * 4, value);
+		}
+	}
+#else
+	for (size_t ix = 0; ix < count; ix++) {
+		*reinterpret_cast<glm::mat4*>(dest + ix * outStride) = lhs * rhs[ix];
+	}
+#endif
+}
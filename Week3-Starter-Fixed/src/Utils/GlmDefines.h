@@ -32,6 +32,17 @@ void NormalizeScaleRef(glm::mat4& transform);
 /// <returns>A copy of transform with scaling normalized</returns>
 glm::mat4 NormalizeScale(const glm::mat4& transform);
 
+/// <summary>
+/// Multiplies a list of matrices by the same matrix (out[i] = lhs * rhs[i]), 4 floats at a time where SSE is
+/// available. Used for things like calculating MVP matrices for every object in a frame in one pass
+/// </summary>
+/// <param name="lhs">The matrix to multiply every element of rhs by (ex: the camera's view projection)</param>
+/// <param name="rhs">The array of matrices to transform</param>
+/// <param name="count">The number of matrices in rhs</param>
+/// <param name="out">The location to store the first result</param>
+/// <param name="outStride">The distance in bytes between results, so that results can be written directly into arrays of structures</param>
+void MultiplyMatrices(const glm::mat4& lhs, const glm::mat4* rhs, size_t count, void* out, size_t outStride = sizeof(glm::mat4));
+
 template <typename T, typename V>
 T Wrap(const T& x, const V& min, const V& max) {
 	return glm::mod((glm::mod((x - min), (max - min)) + (max - min)), (max - min)) + min;
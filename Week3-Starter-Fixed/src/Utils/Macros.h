@@ -2,6 +2,10 @@
 
 #include <memory>
 
+// Pastes two tokens together, expanding any macros in them first (ex: MACRO_CONCAT(name, __LINE__))
+#define MACRO_CONCAT_INNER(a, b) a##b
+#define MACRO_CONCAT(a, b) MACRO_CONCAT_INNER(a, b)
+
 #define MAKE_PTRS(Type) \
 	typedef std::shared_ptr<Type> Sptr; \
 	typedef std::unique_ptr<Type> Uptr; \
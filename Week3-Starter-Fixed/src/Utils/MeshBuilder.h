@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/VertexPacking.h"
+#include "Utils/MeshOptimizer.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -119,17 +121,23 @@ public:
 	/// <summary>
 	/// Creates and returns a VertexArraybject from the current data
 	/// </summary>
+	/// <param name="packing">How to store the vertices on the GPU, by default they are left as floats</param>
 	/// <returns>A VertexArrayObject</returns>
-	VertexArrayObject::Sptr Bake() {
-		VertexBuffer::Sptr vbo = VertexBuffer::Create();
-		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
-
+	VertexArrayObject::Sptr Bake(VertexPacking packing = VertexPacking::None) {
 		IndexBuffer::Sptr ebo = nullptr;
 		if (_indices.size() > 0) {
 			ebo = IndexBuffer::Create();
-			ebo->LoadData(GetIndexDataPtr(), _indices.size());
+			ebo->LoadDataNarrowed(GetIndexDataPtr(), (uint32_t)_indices.size());
 		}
 
+		// The packer handles the VBO, bounds and dequantization for us
+		if (packing != VertexPacking::None) {
+			return VertexPacker::CreateVao(GetVertexDataPtr(), (uint32_t)_vertices.size(), VertType::V_DECL, ebo, packing);
+		}
+
+		VertexBuffer::Sptr vbo = VertexBuffer::Create();
+		vbo->LoadData(GetVertexDataPtr(), _vertices.size());
+
 		// Create VAO and attach the buffers
 		VertexArrayObject::Sptr result = VertexArrayObject::Create();
 		result->AddVertexBuffer(vbo, VertType::V_DECL);
@@ -138,9 +146,27 @@ public:
 		// Store our vertex type in the VAO's vertex declaration
 		result->SetVDecl(VertType::V_DECL);
 
+		// Calculate the bounds once up front, so they can be used for culling
+		BoundingBox bounds;
+		for (const VertType& vertex : _vertices) {
+			bounds.Encapsulate(vertex.Position);
+		}
+		result->SetBounds(bounds);
+
 		return result;
 	}
 	
+	/// <summary>
+	/// Reorders the triangles and vertices in this mesh so the GPU can make better use of its caches,
+	/// see MeshOptimizer. Does nothing for meshes without indices
+	/// </summary>
+	/// <param name="reduceOverdraw">True to also sort triangle clusters to reduce overdraw</param>
+	/// <returns>The vertex cache stats from before and after optimizing</returns>
+	MeshOptimizer::Result Optimize(bool reduceOverdraw = true) {
+		return MeshOptimizer::Optimize(reinterpret_cast<uint8_t*>(_vertices.data()), (uint32_t)_vertices.size(), VertType::V_DECL,
+									   _indices.data(), (uint32_t)_indices.size(), reduceOverdraw);
+	}
+
 	/// <summary>
 	/// Resets this mesh, removing all vertices and indices
 	/// </summary>
@@ -0,0 +1,330 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <GLM/glm.hpp>
+
+static constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+// Simulates a FIFO cache using timestamps, a vertex is in the cache if it was added within the last Size misses
+struct FifoCache {
+	std::vector<uint32_t> Timestamps;
+	uint32_t Time;
+	uint32_t Size;
+
+	FifoCache(uint32_t vertexCount, uint32_t size) :
+		Timestamps(vertexCount, 0),
+		Time(size + 1),
+		Size(size)
+	{ }
+
+	// Returns true if the vertex was not in the cache
+	bool Access(uint32_t vertex) {
+		if (Time - Timestamps[vertex] > Size) {
+			Timestamps[vertex] = Time++;
+			return true;
+		}
+		return false;
+	}
+
+	// Returns the number of vertices in the triangle that were not in the cache
+	uint32_t AccessTriangle(const uint32_t* triangle) {
+		return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+	}
+
+	// Pushes every vertex out of the cache
+	void Clear() {
+		Time += Size + 1;
+	}
+};
+
+MeshOptimizer::Result MeshOptimizer::Optimize(uint8_t* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, uint32_t* indices, uint32_t indexCount, bool reduceOverdraw) {
+	Result result;
+	if (indexCount < 3 || vertexCount == 0 || vDecl.empty()) {
+		return result;
+	}
+	uint32_t stride = vDecl[0].Stride;
+
+	result.Before = AnalyzeVertexCache(indices, indexCount, vertexCount);
+
+	OptimizeVertexCache(indices, indexCount, vertexCount);
+
+	// Sorting clusters needs to know where the triangles are
+	if (reduceOverdraw) {
+		for (const BufferAttribute& attrib : vDecl) {
+			if (attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size == 3) {
+				OptimizeOverdraw(indices, indexCount, vertices, vertexCount, stride, attrib.Offset);
+				break;
+			}
+		}
+	}
+
+	// This needs to go last, since it depends on the final triangle order
+	OptimizeVertexFetch(vertices, vertexCount, stride, indices, indexCount);
+
+	result.After = AnalyzeVertexCache(indices, indexCount, vertexCount);
+	return result;
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize) {
+	CacheStats result;
+	uint32_t triCount = indexCount / 3;
+	if (triCount == 0) {
+		return result;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> used(vertexCount, false);
+	uint32_t usedCount = 0;
+	uint32_t misses = 0;
+	for (uint32_t ix = 0; ix < triCount * 3; ix++) {
+		uint32_t vertex = indices[ix];
+		misses += cache.Access(vertex);
+		if (!used[vertex]) {
+			used[vertex] = true;
+			usedCount++;
+		}
+	}
+
+	result.ACMR = static_cast<float>(misses) / triCount;
+	result.ATVR = static_cast<float>(misses) / usedCount;
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize) {
+	uint32_t triCount = indexCount / 3;
+	if (triCount == 0) {
+		return;
+	}
+
+	// Count how many triangles use each vertex, these will be decremented as triangles are emitted
+	std::vector<uint32_t> liveTris(vertexCount, 0);
+	for (uint32_t ix = 0; ix < triCount * 3; ix++) {
+		liveTris[indices[ix]]++;
+	}
+
+	// Build a list of the triangles that use each vertex
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		offsets[ix + 1] = offsets[ix] + liveTris[ix];
+	}
+	std::vector<uint32_t> adjacency(offsets[vertexCount]);
+	std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+	for (uint32_t ix = 0; ix < triCount * 3; ix++) {
+		adjacency[fill[indices[ix]]++] = ix / 3;
+	}
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> emitted(triCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+	deadEnds.reserve(triCount * 3);
+	result.reserve(triCount * 3);
+
+	// The next vertex to check when we run out of dead ends
+	uint32_t cursor = 1;
+	// The vertex that we are emitting the triangle fan around
+	uint32_t fanning = 0;
+
+	while (fanning != NO_VERTEX) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the vertex
+		for (uint32_t ix = offsets[fanning]; ix < offsets[fanning + 1]; ix++) {
+			uint32_t tri = adjacency[ix];
+			if (emitted[tri]) {
+				continue;
+			}
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t vertex = indices[tri * 3 + corner];
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTris[vertex]--;
+				cache.Access(vertex);
+			}
+			emitted[tri] = true;
+		}
+
+		// Fan around the oldest vertex that will still be in the cache once all of its triangles are emitted
+		uint32_t next = NO_VERTEX;
+		int bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (liveTris[vertex] > 0) {
+				int priority = 0;
+				uint32_t age = cache.Time - cache.Timestamps[vertex];
+				if (age + 2 * liveTris[vertex] <= cacheSize) {
+					priority = static_cast<int>(age);
+				}
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					next = vertex;
+				}
+			}
+		}
+
+		// If none of the candidates have triangles left, we've hit a dead end. Try recently used vertices
+		// first, since they may still be in the cache, and fall back to walking the vertex list
+		if (next == NO_VERTEX) {
+			while (!deadEnds.empty()) {
+				uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTris[vertex] > 0) {
+					next = vertex;
+					break;
+				}
+			}
+		}
+		if (next == NO_VERTEX) {
+			for (; cursor < vertexCount; cursor++) {
+				if (liveTris[cursor] > 0) {
+					next = cursor;
+					break;
+				}
+			}
+		}
+
+		fanning = next;
+	}
+
+	memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const uint8_t* vertices, uint32_t vertexCount, uint32_t stride, uint32_t positionOffset, float threshold, uint32_t cacheSize) {
+	uint32_t triCount = indexCount / 3;
+	if (triCount == 0) {
+		return;
+	}
+
+	// Hard boundaries are where every vertex of a triangle misses the cache, which usually means the
+	// cache optimizer has moved on to a new patch of the mesh, so we can split there for free
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint32_t> hardBoundaries;
+	for (uint32_t tri = 0; tri < triCount; tri++) {
+		uint32_t misses = cache.AccessTriangle(indices + tri * 3);
+		if (tri == 0 || misses == 3) {
+			hardBoundaries.push_back(tri);
+		}
+	}
+	hardBoundaries.push_back(triCount);
+
+	// Split each hard cluster further, as long as the cache efficiency of the pieces stays within the threshold
+	std::vector<uint32_t> clusters;
+	for (size_t ix = 0; ix + 1 < hardBoundaries.size(); ix++) {
+		uint32_t start = hardBoundaries[ix];
+		uint32_t end = hardBoundaries[ix + 1];
+
+		cache.Clear();
+		uint32_t clusterMisses = 0;
+		for (uint32_t tri = start; tri < end; tri++) {
+			clusterMisses += cache.AccessTriangle(indices + tri * 3);
+		}
+		float clusterThreshold = threshold * static_cast<float>(clusterMisses) / (end - start);
+
+		cache.Clear();
+		clusters.push_back(start);
+		uint32_t runMisses = 0;
+		uint32_t runTris = 0;
+		for (uint32_t tri = start; tri < end; tri++) {
+			runMisses += cache.AccessTriangle(indices + tri * 3);
+			runTris++;
+
+			if (tri + 1 < end && static_cast<float>(runMisses) / runTris <= clusterThreshold) {
+				clusters.push_back(tri + 1);
+				runMisses = 0;
+				runTris = 0;
+				cache.Clear();
+			}
+		}
+	}
+	clusters.push_back(triCount);
+
+	auto getPosition = [&](uint32_t vertex) {
+		glm::vec3 result;
+		memcpy(&result, vertices + (size_t)vertex * stride + positionOffset, sizeof(glm::vec3));
+		return result;
+	};
+
+	glm::vec3 meshCenter = glm::vec3(0.0f);
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		meshCenter += getPosition(ix);
+	}
+	meshCenter /= static_cast<float>(vertexCount);
+
+	// Clusters on the outside of the mesh facing away from the center are the most likely to cover
+	// the rest of the mesh, so we want to draw those first
+	size_t clusterCount = clusters.size() - 1;
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t ix = 0; ix < clusterCount; ix++) {
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 normal = glm::vec3(0.0f);
+		float area = 0.0f;
+
+		for (uint32_t tri = clusters[ix]; tri < clusters[ix + 1]; tri++) {
+			glm::vec3 p0 = getPosition(indices[tri * 3 + 0]);
+			glm::vec3 p1 = getPosition(indices[tri * 3 + 1]);
+			glm::vec3 p2 = getPosition(indices[tri * 3 + 2]);
+
+			// The cross product's length is twice the triangle's area, we only need relative weights
+			glm::vec3 triNormal = glm::cross(p1 - p0, p2 - p0);
+			float triArea = glm::length(triNormal);
+
+			center += (p0 + p1 + p2) * (triArea / 3.0f);
+			normal += triNormal;
+			area += triArea;
+		}
+
+		if (area > 0.0f) {
+			center /= area;
+		}
+		float normalLength = glm::length(normal);
+		if (normalLength > 0.0f) {
+			normal /= normalLength;
+		}
+		sortKeys[ix] = glm::dot(center - meshCenter, normal);
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(triCount * 3);
+	for (uint32_t cluster : order) {
+		result.insert(result.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+	}
+
+	memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+}
+
+void MeshOptimizer::OptimizeVertexFetch(uint8_t* vertices, uint32_t vertexCount, uint32_t stride, uint32_t* indices, uint32_t indexCount) {
+	if (vertexCount == 0) {
+		return;
+	}
+
+	// Give each vertex a new index based on when it's first used
+	std::vector<uint32_t> remap(vertexCount, NO_VERTEX);
+	uint32_t nextIndex = 0;
+	for (uint32_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& vertex = remap[indices[ix]];
+		if (vertex == NO_VERTEX) {
+			vertex = nextIndex++;
+		}
+		indices[ix] = vertex;
+	}
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		if (remap[ix] == NO_VERTEX) {
+			remap[ix] = nextIndex++;
+		}
+	}
+
+	std::vector<uint8_t> reordered((size_t)vertexCount * stride);
+	for (uint32_t ix = 0; ix < vertexCount; ix++) {
+		memcpy(reordered.data() + (size_t)remap[ix] * stride, vertices + (size_t)ix * stride, stride);
+	}
+	memcpy(vertices, reordered.data(), reordered.size());
+}
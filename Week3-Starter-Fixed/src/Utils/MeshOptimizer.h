@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/VertexArrayObject.h"
+
+/// <summary>
+/// Reorders the triangles and vertices of indexed meshes so that the GPU can make better use of
+/// its caches. This is meant to be run once when a mesh is imported, not every frame
+///
+/// Triangles are reordered using Tipsify (Sander, Nehab and Barczak, 2007), which keeps triangles that
+/// share vertices close together so the post-transform cache can skip re-running the vertex shader.
+/// The result can then be split into clusters and sorted so outward facing clusters are drawn first,
+/// which reduces overdraw. Finally the vertices are reordered to match the order they are used in,
+/// so vertex fetches walk through memory linearly
+/// </summary>
+class MeshOptimizer {
+public:
+	MeshOptimizer() = delete;
+
+	/// <summary>
+	/// The number of entries in the simulated FIFO post-transform cache
+	/// </summary>
+	static constexpr uint32_t CACHE_SIZE = 16;
+	/// <summary>
+	/// How much worse than the mesh's ACMR a cluster can get before we stop splitting it
+	/// when reducing overdraw, 1.05 will let the ACMR get up to 5% worse
+	/// </summary>
+	static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+	struct CacheStats {
+		// Average cache miss ratio, the number of vertex shader runs per triangle. 0.5 is the best case, 3 is the worst
+		float ACMR = 0.0f;
+		// Average transform to vertex ratio, the number of vertex shader runs per vertex. 1 is the best case
+		float ATVR = 0.0f;
+	};
+
+	struct Result {
+		CacheStats Before;
+		CacheStats After;
+	};
+
+	/// <summary>
+	/// Runs all of the optimization steps on a mesh, updating the vertices and indices in place
+	/// </summary>
+	/// <param name="vertices">The interleaved vertex data</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="vDecl">The attributes of the vertices, used to find the stride and positions</param>
+	/// <param name="indices">The mesh's triangle list indices</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	/// <param name="reduceOverdraw">True to also sort triangle clusters to reduce overdraw, requires float3 positions</param>
+	/// <returns>The cache stats from before and after optimizing</returns>
+	static Result Optimize(uint8_t* vertices, uint32_t vertexCount, const VertexArrayObject::VertexDeclaration& vDecl, uint32_t* indices, uint32_t indexCount, bool reduceOverdraw = true);
+
+	/// <summary>
+	/// Simulates a FIFO post-transform cache to see how well a set of indices uses it
+	/// </summary>
+	/// <param name="indices">The mesh's triangle list indices</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="cacheSize">The number of entries in the cache</param>
+	static CacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+
+	/// <summary>
+	/// Reorders triangles for the post-transform cache using Tipsify
+	/// </summary>
+	/// <param name="indices">The mesh's triangle list indices, will be reordered in place</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="cacheSize">The number of entries in the cache to optimize for</param>
+	static void OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+
+	/// <summary>
+	/// Splits cache optimized triangles into clusters, and sorts the clusters so that the ones facing
+	/// away from the center of the mesh are drawn first. Should be run after OptimizeVertexCache
+	/// </summary>
+	/// <param name="indices">The mesh's triangle list indices, will be reordered in place</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	/// <param name="vertices">The interleaved vertex data</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="positionOffset">The offset of the float3 position within a vertex, in bytes</param>
+	/// <param name="threshold">How much the cache efficiency of a cluster can degrade before we stop splitting it</param>
+	/// <param name="cacheSize">The number of entries in the cache</param>
+	static void OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const uint8_t* vertices, uint32_t vertexCount, uint32_t stride, uint32_t positionOffset, float threshold = OVERDRAW_THRESHOLD, uint32_t cacheSize = CACHE_SIZE);
+
+	/// <summary>
+	/// Reorders vertices into the order they are first used by the indices, and updates the indices to match.
+	/// Vertices that are never used are moved to the end
+	/// </summary>
+	/// <param name="vertices">The interleaved vertex data, will be reordered in place</param>
+	/// <param name="vertexCount">The number of vertices in the mesh</param>
+	/// <param name="stride">The size of a single vertex, in bytes</param>
+	/// <param name="indices">The mesh's triangle list indices, will be remapped in place</param>
+	/// <param name="indexCount">The number of indices in the mesh</param>
+	static void OptimizeVertexFetch(uint8_t* vertices, uint32_t vertexCount, uint32_t stride, uint32_t* indices, uint32_t indexCount);
+};
@@ -0,0 +1,81 @@
+#include "Utils/MeshOptimizerBenchmark.h"
+#include "Utils/Benchmark.h"
+#include "Utils/MeshOptimizer.h"
+#include "Graphics/VertexTypes.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+typedef std::array<uint32_t, 3> Triangle;
+
+// Gets the triangles of an index list in terms of grid cells rather than vertex indices, since the optimizer
+// is free to reorder vertices. Each triangle is rotated so it starts at it's lowest cell, keeping the winding,
+// and the list is sorted so that two meshes with the same triangles give the same result
+static std::vector<Triangle> GetTriangleSet(const std::vector<VertexPosNormTexCol>& vertices, const std::vector<uint32_t>& indices, uint32_t gridWidth) {
+	std::vector<Triangle> result(indices.size() / 3);
+	for (size_t ix = 0; ix < result.size(); ix++) {
+		Triangle& tri = result[ix];
+		for (int corner = 0; corner < 3; corner++) {
+			const glm::vec3& pos = vertices[indices[ix * 3 + corner]].Position;
+			tri[corner] = static_cast<uint32_t>(glm::round(pos.y)) * gridWidth + static_cast<uint32_t>(glm::round(pos.x));
+		}
+		std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+void RunMeshOptimizerBenchmark() {
+	const uint32_t quads = 100;
+	const uint32_t gridWidth = quads + 1;
+
+	std::vector<VertexPosNormTexCol> vertices;
+	vertices.reserve(gridWidth * gridWidth);
+	for (uint32_t y = 0; y < gridWidth; y++) {
+		for (uint32_t x = 0; x < gridWidth; x++) {
+			vertices.emplace_back(glm::vec3(x, y, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(x, y) / static_cast<float>(quads), glm::vec4(1.0f));
+		}
+	}
+
+	std::vector<Triangle> triangles;
+	triangles.reserve(quads * quads * 2);
+	for (uint32_t y = 0; y < quads; y++) {
+		for (uint32_t x = 0; x < quads; x++) {
+			uint32_t corner = y * gridWidth + x;
+			triangles.push_back({ corner, corner + 1, corner + gridWidth + 1 });
+			triangles.push_back({ corner, corner + gridWidth + 1, corner + gridWidth });
+		}
+	}
+
+	// Shuffle the triangles so we start from a worst case order, like an exporter that doesn't care about caches
+	std::mt19937 rng = Benchmark::CreateRandom();
+	std::shuffle(triangles.begin(), triangles.end(), rng);
+
+	std::vector<uint32_t> indices;
+	indices.reserve(triangles.size() * 3);
+	for (const Triangle& tri : triangles) {
+		indices.insert(indices.end(), tri.begin(), tri.end());
+	}
+
+	std::vector<Triangle> expected = GetTriangleSet(vertices, indices, gridWidth);
+
+	MeshOptimizer::Result result;
+	double optimizeMs = Benchmark::TimeMs([&]() {
+		result = MeshOptimizer::Optimize(reinterpret_cast<uint8_t*>(vertices.data()), (uint32_t)vertices.size(), VertexPosNormTexCol::V_DECL, indices.data(), (uint32_t)indices.size());
+	});
+
+	bool sameTriangles = GetTriangleSet(vertices, indices, gridWidth) == expected;
+
+	LOG_INFO("\t{}x{} shuffled grid ({} vertices, {} triangles):", quads, quads, vertices.size(), triangles.size());
+	LOG_INFO("\t\tOptimize: {:.3f}ms", optimizeMs);
+	LOG_INFO("\t\tACMR:     {:.3f} -> {:.3f}", result.Before.ACMR, result.After.ACMR);
+	LOG_INFO("\t\tATVR:     {:.3f} -> {:.3f}", result.Before.ATVR, result.After.ATVR);
+	LOG_INFO("\t\tTriangle set {}", sameTriangles ? "preserved" : "CHANGED");
+
+	LOG_ASSERT(sameTriangles, "MeshOptimizer changed the triangles of the mesh!");
+	LOG_ASSERT(result.After.ACMR < result.Before.ACMR, "MeshOptimizer did not improve the ACMR!");
+	LOG_ASSERT(result.After.ATVR < result.Before.ATVR, "MeshOptimizer did not improve the ATVR!");
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/// <summary>
+/// Runs the MeshOptimizer on a 100x100 quad grid with shuffled triangles, checking that the triangle set
+/// and winding are unchanged and that both ACMR and ATVR improve. Results are written to the log
+/// </summary>
+void RunMeshOptimizerBenchmark();
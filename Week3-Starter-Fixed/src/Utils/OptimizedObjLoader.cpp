@@ -17,7 +17,7 @@ const std::string binaryExtension = ".bin";
 
 namespace fs = std::filesystem;
 
-VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename, VertexPacking packing) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -32,11 +32,11 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 			ConvertToBinary(filename, binPath.string());
 		}
 		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		return _LoadFromBinFile(binPath.string(), packing);
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return _LoadFromBinFile(filename, packing);
 	}
 	// We've never met this extension in our life
 	else {
@@ -51,6 +51,10 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 
 	float startTime = static_cast<float>(glfwGetTime());
 
+	// Triangles come out in file order, reorder them so the GPU can make better use of its caches. We only
+	// need to do this once, since the binary file will store the optimized order
+	MeshOptimizer::Result optimized = mesh->Optimize();
+
 	// If we didn't get an output path, just take the input and replace the extension
 	std::string outFileName = outFile;
 	if (outFileName.empty()) { 
@@ -67,6 +71,7 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
+	LOG_INFO("Optimized \"{}\": ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", inFile, optimized.Before.ACMR, optimized.After.ACMR, optimized.Before.ATVR, optimized.After.ATVR);
 
 	// We no longer need the mesh data, free it
 	delete mesh;
@@ -233,7 +238,7 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	return mesh;
 }
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, VertexPacking packing) {
 
 	// Open the output file
 	std::ifstream file(filename, std::ios::binary);
@@ -283,6 +288,7 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 		// These will have the buffer pointers
 		IndexBuffer::Sptr indices = nullptr;
 		VertexBuffer::Sptr vertices = nullptr;
+		VertexArrayObject::Sptr result = nullptr;
 
 		// If we have index data, load it
 		if (header.NumIndices > 0) {
@@ -293,29 +299,50 @@ VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string&
 			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
 			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
 			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
+			// Load data into OpenGL and free the CPU memory we allocated. Files converted before we narrowed
+			// indices will have 32 bit indices, so we try to narrow those here
+			if (header.IndicesType == IndexType::UInt) {
+				indices->LoadDataNarrowed(reinterpret_cast<const uint32_t*>(dataStore), header.NumIndices);
+			} else {
+				indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
+			}
 			free(dataStore);
 		}
 
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
-
 		// Create memory to store vertices and load from file
 		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
 		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
 
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+		// If we want packed vertices, let the packer build the VBO and VAO from the CPU copy
+		if (packing != VertexPacking::None) {
+			result = VertexPacker::CreateVao(vertexStore, header.NumVertices, vertexDeclaration, indices, packing);
+			free(vertexStore);
+		} else {
+			// Create a new VBO
+			vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+
+			// Load data into OpenGL
+			vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
+
+			// Calculate the mesh bounds from the position attribute before we free the CPU copy
+			BoundingBox bounds;
+			for (const BufferAttribute& attrib : vertexDeclaration) {
+				if (attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size >= 3) {
+					bounds = BoundingBox::FromVertexData(vertexStore, header.NumVertices, header.VertexStride, attrib.Offset);
+					break;
+				}
+			}
+			free(vertexStore);
 
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
+			// Create the VAO and attach our index and vertex buffers
+			result = VertexArrayObject::Create();
+			result->SetIndexBuffer(indices);
+			result->AddVertexBuffer(vertices, vertexDeclaration);
 
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
+			// Copy in the vertex declaration we loaded
+			result->SetVDecl(vertexDeclaration);
+			result->SetBounds(bounds);
+		}
 
 		// Calculate and trace out how long it took us to load
 		float endTime = static_cast<float>(glfwGetTime());
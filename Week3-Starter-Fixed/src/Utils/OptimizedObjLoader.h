@@ -10,6 +10,7 @@
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
+#include "Graphics/VertexPacking.h"
 
 #include "Utils/MeshBuilder.h"
 
@@ -24,8 +25,9 @@ public:
 	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
 	/// </summary>
 	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="packing">How to store the vertices on the GPU, the binary file always stores floats</param>
 	/// <returns>A VAO loaded from disk</returns>
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, VertexPacking packing = VertexPacking::None);
 	/// <summary>
 	/// Manually converts an OBJ file into a binary mesh file
 	/// </summary>
@@ -65,7 +67,7 @@ protected:
 	~OptimizedObjLoader() = default;
 
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, VertexPacking packing);
 };
 
 template <typename VertexType>
@@ -76,11 +78,14 @@ void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std
 		throw std::runtime_error("Failed to open output file");
 	}
 
+	// Store the indices as 16 bit if they all fit, so the loader doesn't need to narrow them every time
+	bool narrowIndices = IndexBuffer::CanNarrow(mesh.GetIndexDataPtr(), (uint32_t)mesh.GetIndexCount());
+
 	// Create the fixed size header for our output file
 	BinaryHeader header  = BinaryHeader();
 	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
 	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
+	header.IndicesType   = narrowIndices ? IndexType::UShort : IndexType::UInt;
 	header.NumVertices   = mesh.GetVertexCount();
 	header.VertexStride  = sizeof(VertexType);
 	header.NumAttributes = VertexType::V_DECL.size();
@@ -93,7 +98,11 @@ void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std
 		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
 	}
 	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
+	if (narrowIndices) {
+		std::vector<uint16_t> indices = IndexBuffer::Narrow(mesh.GetIndexDataPtr(), (uint32_t)mesh.GetIndexCount());
+		file.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint16_t));
+	}
+	else if (mesh.GetIndexCount() > 0) {
 		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
 	}
 
@@ -0,0 +1,128 @@
+#include "Utils/Profiler.h"
+#include "Logging.h"
+#include "Utils/FileHelpers.h"
+
+#include <chrono>
+#include <json.hpp>
+
+std::atomic<bool> CpuProfiler::_enabled(true);
+std::mutex CpuProfiler::_threadsMutex;
+std::vector<std::unique_ptr<CpuProfiler::ThreadBuffer>> CpuProfiler::_threads;
+CpuProfiler::FrameMarker CpuProfiler::_frames[CpuProfiler::FRAME_HISTORY];
+uint64_t CpuProfiler::_frameCount = 0;
+uint64_t CpuProfiler::_frameStartNs = 0;
+
+// All times are relative to this, so they stay small enough to be exact when exported as doubles
+static const std::chrono::steady_clock::time_point ProfilerEpoch = std::chrono::steady_clock::now();
+
+void CpuProfiler::SetEnabled(bool value) {
+	_enabled.store(value, std::memory_order_relaxed);
+}
+
+bool CpuProfiler::IsEnabled() {
+	return _enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(const std::string& name) {
+	ThreadBuffer& buffer = _GetThreadBuffer();
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	buffer.Name = name;
+}
+
+void CpuProfiler::BeginFrame() {
+	_frameStartNs = GetTimeNs();
+}
+
+void CpuProfiler::EndFrame() {
+	uint64_t endNs = GetTimeNs();
+	_frames[_frameCount % FRAME_HISTORY] = { _frameCount, _frameStartNs, endNs };
+	_frameCount++;
+	RecordZone("Frame", _frameStartNs, endNs);
+}
+
+double CpuProfiler::GetLastFrameMs() {
+	if (_frameCount == 0) {
+		return 0.0;
+	}
+	const FrameMarker& frame = _frames[(_frameCount - 1) % FRAME_HISTORY];
+	return (frame.EndNs - frame.StartNs) / 1000000.0;
+}
+
+void CpuProfiler::RecordZone(const char* name, uint64_t startNs, uint64_t endNs) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	ThreadBuffer& buffer = _GetThreadBuffer();
+	// Only this thread writes to the buffer, so we just need to publish the new head once the event is written
+	uint64_t head = buffer.Head.load(std::memory_order_relaxed);
+	buffer.Events[head % EVENTS_PER_THREAD] = { name, startNs, endNs };
+	buffer.Head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t CpuProfiler::GetTimeNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ProfilerEpoch).count();
+}
+
+void CpuProfiler::ExportChromeTrace(const std::string& path) {
+	// Only export zones that started within the frames we've kept
+	uint64_t keptFrames = _frameCount < FRAME_HISTORY ? _frameCount : FRAME_HISTORY;
+	uint64_t windowStart = keptFrames > 0 ? _frames[(_frameCount - keptFrames) % FRAME_HISTORY].StartNs : 0;
+
+	nlohmann::json events = nlohmann::json::array();
+	size_t zoneCount = 0;
+
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	for (const auto& buffer : _threads) {
+		events.push_back({
+			{ "name", "thread_name" },
+			{ "ph", "M" },
+			{ "pid", 1 },
+			{ "tid", buffer->ThreadIndex },
+			{ "args", { { "name", buffer->Name } } }
+		});
+
+		uint64_t head = buffer->Head.load(std::memory_order_acquire);
+		uint64_t tail = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+		for (uint64_t ix = tail; ix < head; ix++) {
+			const ZoneEvent& zone = buffer->Events[ix % EVENTS_PER_THREAD];
+			if (zone.StartNs < windowStart) {
+				continue;
+			}
+
+			// Chrome traces use microseconds
+			events.push_back({
+				{ "name", zone.Name },
+				{ "cat", "cpu" },
+				{ "ph", "X" },
+				{ "pid", 1 },
+				{ "tid", buffer->ThreadIndex },
+				{ "ts", zone.StartNs / 1000.0 },
+				{ "dur", (zone.EndNs - zone.StartNs) / 1000.0 }
+			});
+			zoneCount++;
+		}
+	}
+
+	nlohmann::json trace;
+	trace["traceEvents"] = events;
+	trace["displayTimeUnit"] = "ms";
+	FileHelpers::WriteContentsToFile(path, trace.dump());
+	LOG_INFO("Exported {} CPU profiler zones from {} frames to {}", zoneCount, keptFrames, path);
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::_GetThreadBuffer() {
+	thread_local ThreadBuffer* threadBuffer = nullptr;
+	if (threadBuffer == nullptr) {
+		std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+		buffer->Events.resize(EVENTS_PER_THREAD);
+		buffer->Head.store(0, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(_threadsMutex);
+		buffer->ThreadIndex = static_cast<uint32_t>(_threads.size());
+		buffer->Name = "Thread " + std::to_string(buffer->ThreadIndex);
+		threadBuffer = buffer.get();
+		_threads.push_back(std::move(buffer));
+	}
+	return *threadBuffer;
+}
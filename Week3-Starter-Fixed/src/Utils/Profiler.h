@@ -0,0 +1,165 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include "Utils/Macros.h"
+
+// Set to 0 to compile out every PROFILE_ macro
+#ifndef CPU_PROFILER_ENABLED
+	#define CPU_PROFILER_ENABLED 1
+#endif
+
+/// <summary>
+/// Records how long named zones of code take on the CPU, on any thread
+///
+/// Every thread writes zones into its own fixed size ring, so recording a zone never takes a lock.
+/// The main thread marks frame boundaries, and the last FRAME_HISTORY frames worth of zones from
+/// all threads can be exported in the Chrome trace format (open with about:tracing or ui.perfetto.dev)
+///
+/// Zone names are stored as pointers, so they must outlive the profiler (string literals, type names
+/// or the names of long lived objects)
+/// </summary>
+class CpuProfiler {
+public:
+	CpuProfiler() = delete;
+
+	/// <summary>
+	/// The number of zones each thread can hold before it starts overwriting its oldest zones
+	/// </summary>
+	static const size_t EVENTS_PER_THREAD = 1 << 16;
+	/// <summary>
+	/// The number of frames that are kept for exporting
+	/// </summary>
+	static const size_t FRAME_HISTORY = 120;
+
+	/// <summary>
+	/// Enables or disables recording at runtime, zones that are compiled in but disabled only
+	/// cost a single check
+	/// </summary>
+	static void SetEnabled(bool value);
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Sets the name that the calling thread will show up as in exported traces
+	/// </summary>
+	static void SetThreadName(const std::string& name);
+
+	/// <summary>
+	/// Marks the start of a new frame, should be called from the main thread
+	/// </summary>
+	static void BeginFrame();
+	/// <summary>
+	/// Marks the end of the current frame, should be called from the main thread
+	/// </summary>
+	static void EndFrame();
+
+	/// <summary>
+	/// Gets the length of the most recently completed frame, in milliseconds
+	/// </summary>
+	static double GetLastFrameMs();
+
+	/// <summary>
+	/// Records a finished zone for the calling thread
+	/// </summary>
+	/// <param name="name">The name of the zone, must outlive the profiler</param>
+	/// <param name="startNs">The time the zone started, from GetTimeNs</param>
+	/// <param name="endNs">The time the zone ended, from GetTimeNs</param>
+	static void RecordZone(const char* name, uint64_t startNs, uint64_t endNs);
+
+	/// <summary>
+	/// Gets the current time in nanoseconds, relative to when the application started
+	/// </summary>
+	static uint64_t GetTimeNs();
+
+	/// <summary>
+	/// Writes every zone recorded during the kept frames to a Chrome trace JSON file. Should be called
+	/// from the main thread while no other threads are recording
+	/// </summary>
+	/// <param name="path">The path of the file to write</param>
+	static void ExportChromeTrace(const std::string& path);
+
+protected:
+	struct ZoneEvent {
+		const char* Name;
+		uint64_t    StartNs;
+		uint64_t    EndNs;
+	};
+
+	// Zones recorded by a single thread, only ever written by that thread
+	struct ThreadBuffer {
+		uint32_t               ThreadIndex;
+		std::string            Name;
+		std::vector<ZoneEvent> Events;
+		// The total number of zones written, the newest zone is at (Head - 1) % EVENTS_PER_THREAD
+		std::atomic<uint64_t>  Head;
+	};
+
+	struct FrameMarker {
+		uint64_t Index;
+		uint64_t StartNs;
+		uint64_t EndNs;
+	};
+
+	static std::atomic<bool> _enabled;
+
+	// Buffers for every thread that has recorded a zone, only locked when a thread records its first zone
+	static std::mutex _threadsMutex;
+	static std::vector<std::unique_ptr<ThreadBuffer>> _threads;
+
+	static FrameMarker _frames[FRAME_HISTORY];
+	static uint64_t    _frameCount;
+	static uint64_t    _frameStartNs;
+
+	static ThreadBuffer& _GetThreadBuffer();
+};
+
+#if CPU_PROFILER_ENABLED
+
+/// <summary>
+/// Records a CPU profiler zone covering the lifetime of the object
+/// </summary>
+class CpuProfileZone {
+public:
+	NO_COPY(CpuProfileZone);
+	NO_MOVE(CpuProfileZone);
+
+	CpuProfileZone(const char* name) :
+		_name(name),
+		_startNs(CpuProfiler::IsEnabled() ? CpuProfiler::GetTimeNs() : 0)
+	{ }
+
+	~CpuProfileZone() {
+		if (_startNs != 0) {
+			CpuProfiler::RecordZone(_name, _startNs, CpuProfiler::GetTimeNs());
+		}
+	}
+
+protected:
+	const char* _name;
+	uint64_t    _startNs;
+};
+
+/// <summary>
+/// Profiles the rest of the enclosing block under the given name
+/// </summary>
+#define PROFILE_ZONE(name) CpuProfileZone MACRO_CONCAT(__cpuProfileZone, __LINE__)(name)
+/// <summary>
+/// Profiles the rest of the enclosing function under the function's name
+/// </summary>
+#define PROFILE_FUNCTION() PROFILE_ZONE(__FUNCTION__)
+#define PROFILE_FRAME_BEGIN() CpuProfiler::BeginFrame()
+#define PROFILE_FRAME_END() CpuProfiler::EndFrame()
+#define PROFILE_THREAD_NAME(name) CpuProfiler::SetThreadName(name)
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END()
+#define PROFILE_THREAD_NAME(name)
+
+#endif
@@ -22,6 +22,7 @@ const nlohmann::ordered_json& ResourceManager::GetManifest() {
 }
 
 void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets) {
+	PROFILE_FUNCTION();
 	std::string contents = FileHelpers::ReadFile(path);
 	nlohmann::ordered_json blob = nlohmann::ordered_json::parse(contents);
 	_manifest = blob;
@@ -31,13 +32,26 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 			auto& func = _typeLoaders[typeName];
 			if (func) {
 				for (auto& [guid, blob] : items.items()) {
-					func(blob);
+					// Resources like material instances load their dependencies on demand, so they may already be loaded
+					if (!_IsLoaded(Guid(guid))) {
+						func(blob);
+					}
 				}
 			}
 		}
 	}
 }
 
+bool ResourceManager::_IsLoaded(Guid id) {
+	for (auto& [type, map] : _resources) {
+		auto it = map.find(id);
+		if (it != map.end() && it->second != nullptr) {
+			return true;
+		}
+	}
+	return false;
+}
+
 void ResourceManager::SaveManifest(const std::string& path) {
 	// Update all resources in the manifest so they match their current representation
 	for (auto& [type, map] : _resources) {
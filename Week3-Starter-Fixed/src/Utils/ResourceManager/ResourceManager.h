@@ -7,6 +7,7 @@
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Profiler.h"
 
 /// <summary>
 /// Utility class for managing and loading resources from JSON
@@ -29,6 +30,9 @@ public:
 	/// <returns>The GUID of the newly created asset</returns>
 	template <typename T, typename ... TArgs, typename = std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> CreateAsset(TArgs&&... args) {
+		// Zones are named after the asset's type, since loading is done by the constructor
+		PROFILE_ZONE(typeid(T).name());
+
 		// Create and store the asset
 		std::shared_ptr<T> asset = std::make_shared<T>(std::forward<TArgs>(args)...);
 		_resources[std::type_index(typeid(T))][asset->IResource::GetGUID()] = asset;
@@ -88,6 +92,7 @@ public:
 
 		// Create the type loader for the type
 		_typeLoaders[typeName] = [](const nlohmann::json& data) {
+			PROFILE_ZONE(typeid(T).name());
 			IResource::Sptr res = T::FromJson(data);
 			res->OverrideGUID(Guid(data["guid"]));
 			_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
@@ -164,4 +169,9 @@ protected:
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
+
+	/// <summary>
+	/// Returns true if a resource of any type with the given GUID has been loaded
+	/// </summary>
+	static bool _IsLoaded(Guid id);
 };
\ No newline at end of file
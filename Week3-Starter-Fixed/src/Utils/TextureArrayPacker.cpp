@@ -0,0 +1,157 @@
+#include "Utils/TextureArrayPacker.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Logging.h"
+
+#include <map>
+#include <tuple>
+
+TextureArrayPacker::TextureArrayPacker() :
+	_variants(),
+	_materials(),
+	_arrays(),
+	_layers()
+{ }
+
+void TextureArrayPacker::AddShaderVariant(const ShaderProgram::Sptr& shader, const ShaderProgram::Sptr& arrayShader) {
+	_variants[shader] = arrayShader;
+}
+
+void TextureArrayPacker::AddMaterial(const Gameplay::Material::Sptr& material) {
+	// Instances can't change shaders, they follow their parent
+	if (material != nullptr && !material->IsInstance() && _variants.count(material->GetShader()) > 0) {
+		_materials.push_back(material);
+	}
+}
+
+int TextureArrayPacker::Pack() {
+	_arrays.clear();
+	_layers.clear();
+
+	// The textures that each material will need to have packed before it can switch shaders
+	struct MaterialTextures {
+		Gameplay::Material::Sptr Material;
+		ShaderProgram::Sptr      ArrayShader;
+		std::vector<std::pair<std::string, Texture2D::Sptr>> Textures;
+	};
+	std::vector<MaterialTextures> materials;
+	materials.reserve(_materials.size());
+
+	// Textures can only share an array if they have the same size, format and number of mip levels.
+	// We use an ordered map so that the layout of the arrays doesn't change between runs
+	typedef std::tuple<uint32_t, uint32_t, GLint, bool> GroupKey;
+	std::map<GroupKey, std::vector<Texture2D::Sptr>> groups;
+	std::unordered_map<Texture2D::Sptr, bool> seen;
+
+	for (const Gameplay::Material::Sptr& material : _materials) {
+		MaterialTextures entry;
+		entry.Material = material;
+		entry.ArrayShader = _variants[material->GetShader()];
+		if (!_GetPackableTextures(material, entry.ArrayShader, entry.Textures)) {
+			continue;
+		}
+
+		for (const auto& [name, texture] : entry.Textures) {
+			if (seen.emplace(texture, true).second) {
+				const Texture2DDescription& descr = texture->GetDescription();
+				groups[GroupKey(descr.Width, descr.Height, *descr.Format, descr.GenerateMipMaps)].push_back(texture);
+			}
+		}
+		materials.push_back(std::move(entry));
+	}
+
+	// Build an array for every group that has more than one texture
+	for (const auto& [key, textures] : groups) {
+		if (textures.size() < 2) {
+			continue;
+		}
+
+		// The array takes it's sampler state from the first texture in the group
+		const Texture2DDescription& first = textures[0]->GetDescription();
+		Texture2DArrayDescription descr;
+		descr.Width               = first.Width;
+		descr.Height              = first.Height;
+		descr.Layers              = static_cast<uint32_t>(textures.size());
+		descr.Format              = first.Format;
+		descr.HorizontalWrap      = first.HorizontalWrap;
+		descr.VerticalWrap        = first.VerticalWrap;
+		descr.MinificationFilter  = first.MinificationFilter;
+		descr.MagnificationFilter = first.MagnificationFilter;
+		descr.MaxAnisotropic      = first.MaxAnisotropic;
+		descr.GenerateMipMaps     = first.GenerateMipMaps;
+
+		Texture2DArray::Sptr array = ResourceManager::CreateAsset<Texture2DArray>(descr);
+		array->SetDebugName("Packed " + std::to_string(descr.Width) + "x" + std::to_string(descr.Height));
+
+		for (uint32_t layer = 0; layer < textures.size(); layer++) {
+			if (array->CopyLayerFrom(layer, textures[layer])) {
+				_layers[textures[layer]] = { array, (int)layer };
+			}
+		}
+		array->GenerateMipMaps();
+		_arrays.push_back(array);
+
+		LOG_INFO("Packed {} textures into a {}x{} texture array", textures.size(), descr.Width, descr.Height);
+	}
+
+	// Switch over every material that had all of it's textures packed
+	int packedMaterials = 0;
+	for (const MaterialTextures& entry : materials) {
+		bool allPacked = true;
+		for (const auto& [name, texture] : entry.Textures) {
+			allPacked &= _layers.count(texture) > 0;
+		}
+		if (!allPacked) {
+			continue;
+		}
+
+		entry.Material->SetShader(entry.ArrayShader);
+		for (const auto& [name, texture] : entry.Textures) {
+			const PackedLayer& packed = _layers[texture];
+			entry.Material->Set(name, packed.Array);
+			entry.Material->Set(name + LAYER_SUFFIX, packed.Layer);
+		}
+		packedMaterials++;
+	}
+
+	_materials.clear();
+	return packedMaterials;
+}
+
+bool TextureArrayPacker::TryGetLayer(const Texture2D::Sptr& texture, PackedLayer& out) const {
+	auto it = _layers.find(texture);
+	if (it != _layers.end()) {
+		out = it->second;
+		return true;
+	}
+	return false;
+}
+
+bool TextureArrayPacker::_GetPackableTextures(const Gameplay::Material::Sptr& material, const ShaderProgram::Sptr& arrayShader, std::vector<std::pair<std::string, Texture2D::Sptr>>& outTextures) {
+	const ShaderProgram::UniformBlockInfo* block = arrayShader->FindUniformBlock(Gameplay::Material::PARAM_BLOCK_NAME);
+
+	for (const auto& [name, uniform] : arrayShader->GetUniforms()) {
+		if (uniform.Type != ShaderDataType::Tex2D_Array) {
+			continue;
+		}
+
+		// The array shader needs somewhere to get the layer from
+		bool hasLayer = false;
+		if (block != nullptr && name.compare(0, Gameplay::Material::PARAM_BLOCK_PREFIX.size(), Gameplay::Material::PARAM_BLOCK_PREFIX) == 0) {
+			std::string layerName = Gameplay::Material::PARAM_BLOCK_NAME + "." + name.substr(Gameplay::Material::PARAM_BLOCK_PREFIX.size()) + LAYER_SUFFIX;
+			for (const ShaderProgram::UniformInfo& member : block->SubUniforms) {
+				hasLayer |= member.Name == layerName;
+			}
+		}
+		if (!hasLayer) {
+			LOG_WARN("Array shader \"{}\" has no layer parameter for \"{}\"", arrayShader->GetDebugName(), name);
+			return false;
+		}
+
+		Texture2D::Sptr texture = std::dynamic_pointer_cast<Texture2D>(material->GetTexture(name));
+		if (texture == nullptr) {
+			return false;
+		}
+		outTextures.push_back(std::make_pair(name, texture));
+	}
+	return !outTextures.empty();
+}
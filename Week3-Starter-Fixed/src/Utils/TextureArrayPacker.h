@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+
+#include "Graphics/Textures/Texture2DArray.h"
+#include "Gameplay/Material.h"
+
+/// <summary>
+/// Packs the 2D textures of many materials into texture arrays, so that materials which used to
+/// bind their own textures all bind the same array and only differ by the layer indices in their
+/// parameter block
+///
+/// Only materials whose shader has an array variant registered with AddShaderVariant are packed.
+/// The variant must declare each packed texture as a sampler2DArray with the same name, and an int
+/// parameter block member named after the texture with a Layer suffix (ex: u_Material.Diffuse and
+/// u_Material.DiffuseLayer). Textures are grouped by size and format, and groups with only one
+/// texture are left alone since there is nothing to gain from packing them
+/// </summary>
+class TextureArrayPacker {
+public:
+	/// <summary>
+	/// The suffix added to a texture parameter's name to get the name of it's layer index parameter
+	/// </summary>
+	inline static const std::string LAYER_SUFFIX = "Layer";
+
+	/// <summary>
+	/// Where a packed texture ended up
+	/// </summary>
+	struct PackedLayer {
+		Texture2DArray::Sptr Array;
+		int                  Layer;
+	};
+
+	TextureArrayPacker();
+
+	/// <summary>
+	/// Registers the shader that materials using the given shader will be switched to once packed
+	/// </summary>
+	/// <param name="shader">The shader that materials are using</param>
+	/// <param name="arrayShader">The version of the shader that samples from texture arrays</param>
+	void AddShaderVariant(const ShaderProgram::Sptr& shader, const ShaderProgram::Sptr& arrayShader);
+
+	/// <summary>
+	/// Adds a material to be packed, materials without a registered shader variant are ignored
+	/// </summary>
+	void AddMaterial(const Gameplay::Material::Sptr& material);
+
+	/// <summary>
+	/// Creates the texture arrays for all the materials that have been added, and switches
+	/// the materials over to their array shader
+	/// </summary>
+	/// <returns>The number of materials that were packed</returns>
+	int Pack();
+
+	/// <summary>
+	/// Gets the location of a texture that was packed by the last call to Pack
+	/// </summary>
+	/// <param name="texture">The texture to look up</param>
+	/// <param name="out">Will store the array and layer the texture was packed into</param>
+	/// <returns>True if the texture was packed</returns>
+	bool TryGetLayer(const Texture2D::Sptr& texture, PackedLayer& out) const;
+
+	/// <summary>
+	/// Gets all the arrays created by the last call to Pack
+	/// </summary>
+	const std::vector<Texture2DArray::Sptr>& GetArrays() const { return _arrays; }
+
+protected:
+	std::unordered_map<ShaderProgram::Sptr, ShaderProgram::Sptr> _variants;
+	std::vector<Gameplay::Material::Sptr>                        _materials;
+	std::vector<Texture2DArray::Sptr>                            _arrays;
+	std::unordered_map<Texture2D::Sptr, PackedLayer>             _layers;
+
+	/// <summary>
+	/// Gets the texture parameters of a material that the array shader samples from an array
+	/// </summary>
+	/// <param name="material">The material to search</param>
+	/// <param name="arrayShader">The array variant of the material's shader</param>
+	/// <param name="outTextures">Will store the parameter names and the textures they hold</param>
+	/// <returns>False if the array shader needs a texture that the material does not have as a Texture2D</returns>
+	static bool _GetPackableTextures(const Gameplay::Material::Sptr& material, const ShaderProgram::Sptr& arrayShader, std::vector<std::pair<std::string, Texture2D::Sptr>>& outTextures);
+};
@@ -0,0 +1,123 @@
+#include "Utils/ThreadPool.h"
+#include "Utils/Profiler.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int workerCount) :
+	_workers(),
+	_job(nullptr),
+	_jobCount(0),
+	_jobChunks(0),
+	_generation(0),
+	_activeWorkers(0),
+	_stopping(false),
+	_nextChunk(0),
+	_chunksDone(0)
+{
+	if (workerCount < 0) {
+		// hardware_concurrency may return 0 if it can't tell, in which case we stay single threaded
+		unsigned int cores = std::thread::hardware_concurrency();
+		workerCount = cores > 1 ? static_cast<int>(cores) - 1 : 0;
+	}
+
+	_workers.reserve(workerCount);
+	for (int ix = 0; ix < workerCount; ix++) {
+		_workers.emplace_back(&ThreadPool::_WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wakeCondition.notify_all();
+
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::GetChunkCount(size_t count, size_t minChunkSize) const {
+	minChunkSize = std::max<size_t>(minChunkSize, 1);
+	size_t chunks = (count + minChunkSize - 1) / minChunkSize;
+	return std::max<size_t>(std::min<size_t>(chunks, GetThreadCount()), 1);
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t minChunkSize, const RangeFunc& func) {
+	if (count == 0) {
+		return;
+	}
+
+	size_t chunks = GetChunkCount(count, minChunkSize);
+	if (chunks == 1) {
+		func(0, count, 0);
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		// Make sure no workers are still on their way out of the previous job before we replace it
+		_doneCondition.wait(lock, [&]() { return _activeWorkers == 0; });
+
+		_job = &func;
+		_jobCount = count;
+		_jobChunks = chunks;
+		_nextChunk = 0;
+		_chunksDone = 0;
+		_generation++;
+	}
+	_wakeCondition.notify_all();
+
+	// The calling thread helps out instead of sitting idle
+	_RunChunks();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_doneCondition.wait(lock, [&]() { return _chunksDone == _jobChunks; });
+	_job = nullptr;
+}
+
+void ThreadPool::_WorkerLoop() {
+	PROFILE_THREAD_NAME("Worker");
+
+	uint64_t lastGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wakeCondition.wait(lock, [&]() { return _stopping || _generation != lastGeneration; });
+			if (_stopping) {
+				return;
+			}
+			lastGeneration = _generation;
+			_activeWorkers++;
+		}
+
+		_RunChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_activeWorkers--;
+		}
+		_doneCondition.notify_all();
+	}
+}
+
+void ThreadPool::_RunChunks() {
+	while (true) {
+		size_t chunk = _nextChunk.fetch_add(1);
+		if (chunk >= _jobChunks) {
+			return;
+		}
+
+		// Split evenly, so that chunk boundaries are the same no matter which thread runs them
+		size_t begin = (_jobCount * chunk) / _jobChunks;
+		size_t end = (_jobCount * (chunk + 1)) / _jobChunks;
+		(*_job)(begin, end, chunk);
+
+		if (_chunksDone.fetch_add(1) + 1 == _jobChunks) {
+			// Take the lock so the notify can't slip in between the waiter checking and sleeping
+			std::lock_guard<std::mutex> lock(_mutex);
+			_doneCondition.notify_all();
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A fixed set of worker threads that can split loops across all available cores. The calling thread
+/// also takes part in the work, so a pool with no workers simply runs everything inline
+///
+/// Note that workers do not have an OpenGL context, so work handed to the pool must never make GL calls
+/// </summary>
+class ThreadPool {
+public:
+	MAKE_PTRS(ThreadPool);
+
+	/// <summary>
+	/// Callback for ParallelFor, invoked with a range of [begin, end) and the index of the chunk
+	/// </summary>
+	typedef std::function<void(size_t begin, size_t end, size_t chunk)> RangeFunc;
+
+	/// <summary>
+	/// Creates a new pool and starts it's workers
+	/// </summary>
+	/// <param name="workerCount">The number of worker threads to create, or -1 to use one less than the number of cores</param>
+	ThreadPool(int workerCount = -1);
+	~ThreadPool();
+
+	NO_COPY(ThreadPool);
+	NO_MOVE(ThreadPool);
+
+	/// <summary>
+	/// Gets the number of threads that will run work, including the calling thread
+	/// </summary>
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(_workers.size()) + 1; }
+
+	/// <summary>
+	/// Gets the number of chunks that ParallelFor will split a loop into
+	/// </summary>
+	/// <param name="count">The number of elements in the loop</param>
+	/// <param name="minChunkSize">The smallest number of elements to give to a single chunk</param>
+	/// <returns>The number of chunks, always at least 1</returns>
+	size_t GetChunkCount(size_t count, size_t minChunkSize) const;
+
+	/// <summary>
+	/// Splits the range [0, count) into contiguous chunks and runs them across the pool, returning once all
+	/// chunks have completed. Chunks are numbered in order, so results can be stored per chunk and merged
+	/// afterwards to get the same order as a serial loop
+	/// </summary>
+	/// <param name="count">The number of elements in the loop</param>
+	/// <param name="minChunkSize">The smallest number of elements to give to a single chunk</param>
+	/// <param name="func">The function to run for each chunk</param>
+	void ParallelFor(size_t count, size_t minChunkSize, const RangeFunc& func);
+
+protected:
+	std::vector<std::thread> _workers;
+
+	std::mutex               _mutex;
+	// Signaled when a new job is posted, or the pool is shutting down
+	std::condition_variable  _wakeCondition;
+	// Signaled when the last chunk of a job finishes, or a worker leaves a job
+	std::condition_variable  _doneCondition;
+
+	// The current job, only changed while no workers are running
+	const RangeFunc*         _job;
+	size_t                   _jobCount;
+	size_t                   _jobChunks;
+	uint64_t                 _generation;
+	uint32_t                 _activeWorkers;
+	bool                     _stopping;
+
+	std::atomic<size_t>      _nextChunk;
+	std::atomic<size_t>      _chunksDone;
+
+	void _WorkerLoop();
+	// Grabs and runs chunks of the current job until there are none left
+	void _RunChunks();
+};
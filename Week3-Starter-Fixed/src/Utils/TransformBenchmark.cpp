@@ -0,0 +1,82 @@
+#include "Utils/TransformBenchmark.h"
+#include "Utils/Benchmark.h"
+#include "Utils/GlmDefines.h"
+#include "Logging.h"
+
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// Matches the layout of RenderLayer::InstanceLevelUniforms
+struct BenchmarkUniforms {
+	glm::mat4 ModelViewProjection;
+	glm::mat4 Model;
+	glm::mat4 NormalMatrix;
+};
+
+void RunTransformBenchmark() {
+	const size_t count = 10000;
+	const int    iterations = 100;
+
+	std::mt19937 rng = Benchmark::CreateRandom();
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+
+	std::vector<glm::vec3> positions(count), scales(count);
+	std::vector<glm::quat> rotations(count);
+	std::vector<glm::mat4> models(count), inverses(count);
+	std::vector<glm::mat3> normals(count);
+	for (size_t ix = 0; ix < count; ix++) {
+		positions[ix] = glm::vec3(position(rng), position(rng), position(rng));
+		scales[ix] = glm::vec3(scale(rng), scale(rng), scale(rng));
+		rotations[ix] = glm::quat(glm::vec3(angle(rng), angle(rng), angle(rng)));
+		models[ix] = glm::translate(MAT4_IDENTITY, positions[ix]) * glm::mat4_cast(rotations[ix]) * glm::scale(MAT4_IDENTITY, scales[ix]);
+		inverses[ix] = glm::inverse(models[ix]);
+		normals[ix] = glm::transpose(glm::mat3(inverses[ix]));
+	}
+
+	glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) *
+		glm::lookAt(glm::vec3(0.0f, -50.0f, 20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	std::vector<BenchmarkUniforms> uniforms(count);
+
+	// Per frame, before: every draw inverts it's transform for the normal matrix, and multiplies it's own MVP
+	double perDrawNs = Benchmark::TimePerItemNs(iterations, count, [&]() {
+		for (size_t ix = 0; ix < count; ix++) {
+			uniforms[ix].Model = models[ix];
+			uniforms[ix].ModelViewProjection = viewProj * models[ix];
+			uniforms[ix].NormalMatrix = glm::mat3(glm::transpose(glm::inverse(models[ix])));
+		}
+	});
+
+	// Per frame, after: normal matrices come from the transform cache, MVPs are calculated in one batch
+	double batchedNs = Benchmark::TimePerItemNs(iterations, count, [&]() {
+		MultiplyMatrices(viewProj, models.data(), count, reinterpret_cast<uint8_t*>(uniforms.data()) + offsetof(BenchmarkUniforms, ModelViewProjection), sizeof(BenchmarkUniforms));
+		for (size_t ix = 0; ix < count; ix++) {
+			uniforms[ix].Model = models[ix];
+			uniforms[ix].NormalMatrix = glm::mat4(normals[ix]);
+		}
+	});
+
+	// When a transform changes, before: the inverse is calculated with a general 4x4 inverse
+	double generalInverseNs = Benchmark::TimePerItemNs(iterations, count, [&]() {
+		for (size_t ix = 0; ix < count; ix++) {
+			inverses[ix] = glm::inverse(models[ix]);
+			normals[ix] = glm::transpose(glm::mat3(inverses[ix]));
+		}
+	});
+
+	// When a transform changes, after: the inverse is built from the inverted translation, rotation and scale
+	double trsInverseNs = Benchmark::TimePerItemNs(iterations, count, [&]() {
+		for (size_t ix = 0; ix < count; ix++) {
+			inverses[ix] = glm::scale(MAT4_IDENTITY, 1.0f / scales[ix]) * glm::mat4_cast(glm::conjugate(rotations[ix])) * glm::translate(MAT4_IDENTITY, -positions[ix]);
+			normals[ix] = glm::transpose(glm::mat3(inverses[ix]));
+		}
+	});
+
+	LOG_INFO("\t{} objects x {} frames:", count, iterations);
+	LOG_INFO("\t\tPer frame:        per-draw inverse + MVP {:.2f}ns/object, cached normal + batched MVP {:.2f}ns/object", perDrawNs, batchedNs);
+	LOG_INFO("\t\tOn recalculation: 4x4 inverse {:.2f}ns/object, TRS inverse {:.2f}ns/object", generalInverseNs, trsInverseNs);
+}
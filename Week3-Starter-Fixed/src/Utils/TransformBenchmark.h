@@ -0,0 +1,8 @@
+#pragma once
+
+/// <summary>
+/// Measures the per-object cost of calculating the matrices the render layer uploads for each draw,
+/// comparing per-draw inverses and MVP multiplies against cached normal matrices and a batched SIMD
+/// MVP pass. Results are written to the log
+/// </summary>
+void RunTransformBenchmark();